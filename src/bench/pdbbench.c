@@ -0,0 +1,849 @@
+/************************************************************************/
+/**
+
+   \file       pdbbench.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Time BiopTools programs on synthetic structures
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The benchmark driver run by 'make bench'. For each structure size a
+   PDB file (and a PIR alignment for scorecons) is made with pdbgen.
+   Each program is then run on it several times, with its output
+   thrown away and its standard error appended to a log file.
+
+   For each program and size the results are written as JSON:
+   - the best and median elapsed times
+   - the user and system CPU time of the best run
+   - throughput in atoms and in megabytes of input per second, from
+     the best run
+   - the peak resident set size of the largest run (from wait4())
+   - a status of "ok", "failed", "timeout" or "missing"
+   A program that fails is not run again at that size. The JSON has
+   one result per line so that runs can be compared with diff.
+
+   wait4() and the resource usage it returns are not POSIX, but are
+   available on Linux and the BSDs.
+
+**************************************************************************
+
+   Usage:
+   ======
+   pdbbench [-s sizes] [-c nchains] [-H hetfrac] [-m nmodels]
+            [-a nseq] [-r repeats] [-t programs] [-l limit]
+            [-b bindir] [-g pdbgen] [-w workdir] [-k] [-o out.json]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#define _GNU_SOURCE   /* wait4()                                        */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <sys/utsname.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF       256
+#define MAXARGS       8
+#define MAXSIZES      16
+#define MAXREPEATS    100
+#define DEF_SIZES     "1000,10000,100000"
+#define DEF_NCHAINS   "4"
+#define DEF_HETFRAC   "0.05"
+#define DEF_NMODELS   "1"
+#define DEF_NSEQ      "50"
+#define DEF_REPEATS   3
+#define DEF_LIMIT     300
+#define DEF_BINDIR    "."
+#define DEF_PDBGEN    "bench/pdbgen"
+#define DEF_WORKDIR   "bench"
+#define LOGFILE       "bench.log"
+#define PDB_ARG       "@PDB@"  /* Replaced by the generated PDB file    */
+#define PIR_ARG       "@PIR@"  /* Replaced by the generated alignment   */
+
+typedef struct
+{
+   char *name;
+   char *args[MAXARGS];
+}  BENCHPROG;
+
+typedef struct
+{
+   REAL elapsed,
+        user,
+        system;
+   long maxRSS;               /* Kbytes                                 */
+   int  status;
+}  RUNRESULT;
+
+#define RUN_OK      0
+#define RUN_FAILED  1
+#define RUN_TIMEOUT 2
+#define RUN_MISSING 3
+
+typedef struct
+{
+   int  sizes[MAXSIZES],
+        nsizes,
+        repeats,
+        limit;
+   char nchains[MAXBUFF],
+        hetFrac[MAXBUFF],
+        nmodels[MAXBUFF],
+        nseq[MAXBUFF],
+        programs[MAXBUFF],
+        bindir[MAXBUFF],
+        pdbgen[MAXBUFF],
+        workdir[MAXBUFF],
+        outfile[MAXBUFF];
+   BOOL keep;
+}  BENCHOPTIONS;
+
+/************************************************************************/
+/* Globals
+*/
+/* The analysis programs and then the I/O-bound filters                 */
+static BENCHPROG sPrograms[] =
+{
+   {"pdbhbond",      {PDB_ARG, NULL}},
+   {"chaincontacts", {PDB_ARG, NULL}},
+   {"distmat",       {"-p", PDB_ARG, NULL}},
+   {"pdbsolv",       {PDB_ARG, NULL}},
+   {"scorecons",     {PIR_ARG, NULL}},
+   {"pdbmakepatch",  {"A10", "CA", PDB_ARG, NULL}},
+   {"pdbatomcount",  {PDB_ARG, NULL}},
+   {"pdbcount",      {PDB_ARG, NULL}},
+   {"pdbatoms",      {PDB_ARG, NULL}},
+   {"pdbhstrip",     {PDB_ARG, NULL}},
+   {"pdbhetstrip",   {PDB_ARG, NULL}},
+   {"pdbdummystrip", {PDB_ARG, NULL}},
+   {"pdbrenum",      {PDB_ARG, NULL}},
+   {"pdbtranslate",  {"-x", "1.0", PDB_ARG, NULL}},
+   {"pdb2pdbml",     {PDB_ARG, NULL}},
+   {NULL,            {NULL}}
+};
+
+static char sLogFile[MAXBUFF];
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, BENCHOPTIONS *opts);
+BOOL ParseSizes(char *list, BENCHOPTIONS *opts);
+void Usage(void);
+BOOL GenerateInput(BENCHOPTIONS *opts, int natoms, char *pdbFile,
+                   char *pirFile);
+BOOL WantProgram(BENCHOPTIONS *opts, char *name);
+void BenchProgram(FILE *out, BENCHOPTIONS *opts, BENCHPROG *prog,
+                  int natoms, char *pdbFile, char *pirFile,
+                  BOOL *first);
+BOOL RunProgram(char **argv, char *outFile, int limit,
+                RUNRESULT *result);
+REAL Seconds(struct timeval *tv);
+long FileSize(char *filename);
+void WriteJSONString(FILE *out, char *string);
+void WriteJSONStart(FILE *out, BENCHOPTIONS *opts);
+int CompareReals(const void *a, const void *b);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program
+
+-  19.10.26 Original    By: agent
+*/
+int main(int argc, char **argv)
+{
+   BENCHOPTIONS opts;
+   FILE         *out = stdout;
+   char         pdbFile[MAXBUFF],
+                pirFile[MAXBUFF];
+   int          size,
+                natoms,
+                i;
+   BOOL         first = TRUE;
+
+   if(!ParseCmdLine(argc, argv, &opts))
+   {
+      Usage();
+      return(0);
+   }
+
+   sprintf(sLogFile, "%.200s/%s", opts.workdir, LOGFILE);
+   if((opts.outfile[0] != '\0') &&
+      ((out = fopen(opts.outfile, "w")) == NULL))
+   {
+      fprintf(stderr,"Error: (pdbbench) Unable to write %s\n",
+              opts.outfile);
+      return(1);
+   }
+
+   WriteJSONStart(out, &opts);
+
+   for(size=0; size<opts.nsizes; size++)
+   {
+      natoms = opts.sizes[size];
+      if(!GenerateInput(&opts, natoms, pdbFile, pirFile))
+         return(1);
+
+      for(i=0; sPrograms[i].name != NULL; i++)
+      {
+         if(WantProgram(&opts, sPrograms[i].name))
+            BenchProgram(out, &opts, &(sPrograms[i]), natoms,
+                         pdbFile, pirFile, &first);
+      }
+
+      if(!opts.keep)
+      {
+         unlink(pdbFile);
+         unlink(pirFile);
+      }
+   }
+
+   fprintf(out, "\n   ]\n}\n");
+   if(out != stdout)
+      fclose(out);
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, BENCHOPTIONS *opts)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]      argc         Argument count
+   \param[in]      **argv       Argument array
+   \param[out]     *opts        Benchmark options
+   \return                      Success?
+
+   Parse the command line. The generator options are kept as strings
+   since they are only passed on to pdbgen.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL ParseCmdLine(int argc, char **argv, BENCHOPTIONS *opts)
+{
+   char *value;
+
+   argc--;
+   argv++;
+
+   ParseSizes(DEF_SIZES, opts);
+   opts->repeats = DEF_REPEATS;
+   opts->limit   = DEF_LIMIT;
+   opts->keep    = FALSE;
+   strcpy(opts->nchains, DEF_NCHAINS);
+   strcpy(opts->hetFrac, DEF_HETFRAC);
+   strcpy(opts->nmodels, DEF_NMODELS);
+   strcpy(opts->nseq,    DEF_NSEQ);
+   strcpy(opts->bindir,  DEF_BINDIR);
+   strcpy(opts->pdbgen,  DEF_PDBGEN);
+   strcpy(opts->workdir, DEF_WORKDIR);
+   opts->programs[0] = opts->outfile[0] = '\0';
+
+   while(argc)
+   {
+      if((argv[0][0] != '-') || (argv[0][1] == '\0') ||
+         (argv[0][2] != '\0'))
+         return(FALSE);
+
+      if(argv[0][1] == 'k')
+      {
+         opts->keep = TRUE;
+         argc--;
+         argv++;
+         continue;
+      }
+
+      if(argc < 2)
+         return(FALSE);
+      value = argv[1];
+      if(strlen(value) >= MAXBUFF)
+         return(FALSE);
+
+      switch(argv[0][1])
+      {
+      case 's':
+         if(!ParseSizes(value, opts))
+            return(FALSE);
+         break;
+      case 'c':
+         strcpy(opts->nchains, value);
+         break;
+      case 'H':
+         strcpy(opts->hetFrac, value);
+         break;
+      case 'm':
+         strcpy(opts->nmodels, value);
+         break;
+      case 'a':
+         strcpy(opts->nseq, value);
+         break;
+      case 'r':
+         if((sscanf(value, "%d", &(opts->repeats)) != 1) ||
+            (opts->repeats < 1) || (opts->repeats > MAXREPEATS))
+            return(FALSE);
+         break;
+      case 'l':
+         if((sscanf(value, "%d", &(opts->limit)) != 1) ||
+            (opts->limit < 1))
+            return(FALSE);
+         break;
+      case 't':
+         strcpy(opts->programs, value);
+         break;
+      case 'b':
+         strcpy(opts->bindir, value);
+         break;
+      case 'g':
+         strcpy(opts->pdbgen, value);
+         break;
+      case 'w':
+         strcpy(opts->workdir, value);
+         break;
+      case 'o':
+         strcpy(opts->outfile, value);
+         break;
+      default:
+         return(FALSE);
+      }
+      argc -= 2;
+      argv += 2;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseSizes(char *list, BENCHOPTIONS *opts)
+   -----------------------------------------------
+*//**
+
+   \param[in]      *list      Comma-separated atom counts
+   \param[out]     *opts      Benchmark options
+   \return                    Success?
+
+-  19.10.26 Original    By: agent
+*/
+BOOL ParseSizes(char *list, BENCHOPTIONS *opts)
+{
+   char *c = list;
+
+   opts->nsizes = 0;
+   while(*c != '\0')
+   {
+      if((opts->nsizes == MAXSIZES) ||
+         (sscanf(c, "%d", &(opts->sizes[opts->nsizes])) != 1) ||
+         (opts->sizes[opts->nsizes] < 1))
+         return(FALSE);
+      opts->nsizes++;
+
+      while((*c != '\0') && (*c != ','))
+         c++;
+      if(*c == ',')
+         c++;
+   }
+
+   return(opts->nsizes > 0);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Prints a usage message
+
+-  19.10.26 Original    By: agent
+*/
+void Usage(void)
+{
+   int i;
+
+   fprintf(stderr,"\npdbbench V1.0 (c) 2026 UCL\n");
+   fprintf(stderr,"\nUsage: pdbbench [-s sizes] [-c nchains] [-H hetfrac] \
+[-m nmodels] [-a nseq]\n");
+   fprintf(stderr,"                [-r repeats] [-t programs] [-l limit] \
+[-b bindir] [-g pdbgen]\n");
+   fprintf(stderr,"                [-w workdir] [-k] [-o out.json]\n");
+   fprintf(stderr,"       -s Comma-separated numbers of atoms (Default: \
+%s)\n", DEF_SIZES);
+   fprintf(stderr,"       -c Chains in each structure (Default: %s)\n",
+           DEF_NCHAINS);
+   fprintf(stderr,"       -H Fraction of HETATMs (Default: %s)\n",
+           DEF_HETFRAC);
+   fprintf(stderr,"       -m NMR models; sizes are per model \
+(Default: %s)\n", DEF_NMODELS);
+   fprintf(stderr,"       -a Sequences in the scorecons alignment \
+(Default: %s)\n", DEF_NSEQ);
+   fprintf(stderr,"       -r Runs of each program (Default: %d)\n",
+           DEF_REPEATS);
+   fprintf(stderr,"       -t Comma-separated programs to run \
+(Default: all)\n");
+   fprintf(stderr,"       -l Seconds before a run is stopped \
+(Default: %d)\n", DEF_LIMIT);
+   fprintf(stderr,"       -b Directory holding the programs \
+(Default: %s)\n", DEF_BINDIR);
+   fprintf(stderr,"       -g The pdbgen program (Default: %s)\n",
+           DEF_PDBGEN);
+   fprintf(stderr,"       -w Directory for the generated files and %s \
+(Default: %s)\n", LOGFILE, DEF_WORKDIR);
+   fprintf(stderr,"       -k Keep the generated files\n");
+   fprintf(stderr,"       -o JSON output file (Default: stdout)\n");
+   fprintf(stderr,"\nTimes BiopTools programs on synthetic structures \
+made by pdbgen and\n");
+   fprintf(stderr,"reports elapsed time, CPU time, throughput and peak \
+memory as JSON.\n");
+   fprintf(stderr,"pdbhbond, pdbsolv and scorecons need DATADIR to be \
+set. The programs are:\n");
+   for(i=0; sPrograms[i].name != NULL; i++)
+      fprintf(stderr,"%s%s", ((i%6) ? " " : "\n   "), sPrograms[i].name);
+   fprintf(stderr,"\n\n");
+}
+
+
+/************************************************************************/
+/*>BOOL GenerateInput(BENCHOPTIONS *opts, int natoms, char *pdbFile,
+                      char *pirFile)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *opts      Benchmark options
+   \param[in]      natoms     Atoms in each model
+   \param[out]     *pdbFile   Generated PDB file
+   \param[out]     *pirFile   Generated alignment
+   \return                    Success?
+
+   Runs pdbgen to make the input files for one size
+
+-  19.10.26 Original    By: agent
+*/
+BOOL GenerateInput(BENCHOPTIONS *opts, int natoms, char *pdbFile,
+                   char *pirFile)
+{
+   RUNRESULT result;
+   char      atoms[MAXBUFF],
+             *argv[16];
+   int       i;
+
+   sprintf(atoms,   "%d", natoms);
+   sprintf(pdbFile, "%.200s/bench_%d.pdb", opts->workdir, natoms);
+   sprintf(pirFile, "%.200s/bench_%d.pir", opts->workdir, natoms);
+
+   for(i=0; i<2; i++)
+   {
+      argv[0]  = opts->pdbgen;
+      argv[1]  = "-n";   argv[2]  = atoms;
+      argv[3]  = "-c";   argv[4]  = opts->nchains;
+      argv[5]  = "-H";   argv[6]  = opts->hetFrac;
+      argv[7]  = "-m";   argv[8]  = opts->nmodels;
+      argv[9]  = (i ? "-a" : NULL);
+      argv[10] = opts->nseq;
+      argv[11] = NULL;
+
+      if(!RunProgram(argv, (i ? pirFile : pdbFile), 0, &result) ||
+         (result.status != RUN_OK))
+      {
+         fprintf(stderr,"Error: (pdbbench) Unable to generate %s with \
+%s (see %s)\n", (i ? pirFile : pdbFile), opts->pdbgen, sLogFile);
+         return(FALSE);
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL WantProgram(BENCHOPTIONS *opts, char *name)
+   ------------------------------------------------
+*//**
+
+   \param[in]      *opts      Benchmark options
+   \param[in]      *name      Program name
+   \return                    Is it in the list to run (or is there no
+                              list)?
+
+-  19.10.26 Original    By: agent
+*/
+BOOL WantProgram(BENCHOPTIONS *opts, char *name)
+{
+   char   *c;
+   size_t len = strlen(name);
+
+   if(opts->programs[0] == '\0')
+      return(TRUE);
+
+   for(c=opts->programs; c!=NULL; c=strchr(c, ','))
+   {
+      if(*c == ',')
+         c++;
+      if(!strncmp(c, name, len) && ((c[len] == ',') || (c[len] == '\0')))
+         return(TRUE);
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>void BenchProgram(FILE *out, BENCHOPTIONS *opts, BENCHPROG *prog,
+                     int natoms, char *pdbFile, char *pirFile,
+                     BOOL *first)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *out       JSON output file
+   \param[in]      *opts      Benchmark options
+   \param[in]      *prog      Program to run
+   \param[in]      natoms     Atoms in each model
+   \param[in]      *pdbFile   Generated PDB file
+   \param[in]      *pirFile   Generated alignment
+   \param[in,out]  *first     Is this the first result?
+
+   Runs a program the requested number of times and writes its result
+
+-  19.10.26 Original    By: agent
+*/
+void BenchProgram(FILE *out, BENCHOPTIONS *opts, BENCHPROG *prog,
+                  int natoms, char *pdbFile, char *pirFile,
+                  BOOL *first)
+{
+   RUNRESULT result,
+             best;
+   REAL      times[MAXREPEATS];
+   char      path[MAXBUFF+MAXBUFF],
+             *argv[MAXARGS+1],
+             *input  = pdbFile,
+             *status = "ok";
+   long      maxRSS  = 0L,
+             nbytes;
+   int       nruns   = 0,
+             totalAtoms,
+             i;
+
+   sprintf(path, "%s/%s", opts->bindir, prog->name);
+   argv[0] = path;
+   for(i=0; prog->args[i] != NULL; i++)
+   {
+      if(!strcmp(prog->args[i], PDB_ARG))
+      {
+         argv[i+1] = pdbFile;
+      }
+      else if(!strcmp(prog->args[i], PIR_ARG))
+      {
+         argv[i+1] = pirFile;
+         input     = pirFile;
+      }
+      else
+      {
+         argv[i+1] = prog->args[i];
+      }
+   }
+   argv[i+1] = NULL;
+
+   best.elapsed = best.user = best.system = 0.0;
+   for(nruns=0; nruns<opts->repeats; nruns++)
+   {
+      if(!RunProgram(argv, NULL, opts->limit, &result))
+      {
+         status = "failed";
+         break;
+      }
+      if(result.status != RUN_OK)
+      {
+         status = ((result.status == RUN_TIMEOUT) ? "timeout" :
+                   ((result.status == RUN_MISSING) ? "missing" :
+                    "failed"));
+         break;
+      }
+
+      times[nruns] = result.elapsed;
+      if((nruns == 0) || (result.elapsed < best.elapsed))
+         best = result;
+      if(result.maxRSS > maxRSS)
+         maxRSS = result.maxRSS;
+   }
+
+   totalAtoms = natoms * atoi(opts->nmodels);
+   nbytes     = FileSize(input);
+
+   fprintf(stderr, "%-14s %8d atoms  ", prog->name, totalAtoms);
+   if(nruns)
+      fprintf(stderr, "%9.4fs %8ldKb", best.elapsed, maxRSS);
+   fprintf(stderr, "  %s\n", status);
+
+   fprintf(out, "%s      {\"program\": ", (*first ? "" : ",\n"));
+   WriteJSONString(out, prog->name);
+   fprintf(out, ", \"atoms\": %d, \"input_bytes\": %ld, \"status\": \
+\"%s\", \"runs\": %d", totalAtoms, nbytes, status, nruns);
+   if(nruns)
+   {
+      qsort(times, nruns, sizeof(REAL), CompareReals);
+      if(best.elapsed <= 0.0)
+         best.elapsed = 1.0e-6;
+      fprintf(out, ", \"best_seconds\": %.6f, \"median_seconds\": %.6f, \
+\"user_seconds\": %.6f, \"system_seconds\": %.6f, \"atoms_per_second\": \
+%.1f, \"mbytes_per_second\": %.3f, \"peak_rss_kb\": %ld",
+              best.elapsed, times[nruns/2], best.user, best.system,
+              totalAtoms / best.elapsed,
+              nbytes / best.elapsed / 1.0e6, maxRSS);
+   }
+   fprintf(out, "}");
+   fflush(out);
+   *first = FALSE;
+}
+
+
+/************************************************************************/
+/*>BOOL RunProgram(char **argv, char *outFile, int limit,
+                   RUNRESULT *result)
+   ------------------------------------------------------
+*//**
+
+   \param[in]      **argv     Program and arguments
+   \param[in]      *outFile   File for standard output (NULL to throw
+                              it away)
+   \param[in]      limit      Seconds before the program is stopped
+                              (0 for no limit)
+   \param[out]     *result    Time, memory and status
+   \return                    Was the program started?
+
+   Runs a program and waits for it. Standard error is appended to the
+   log file. The limit is set with alarm(), which is kept across
+   exec().
+
+-  19.10.26 Original    By: agent
+*/
+BOOL RunProgram(char **argv, char *outFile, int limit,
+                RUNRESULT *result)
+{
+   struct timeval start,
+                  end;
+   struct rusage  usage;
+   pid_t          pid;
+   int            status,
+                  fd;
+
+   fflush(NULL);
+   gettimeofday(&start, NULL);
+   if((pid = fork()) < 0)
+      return(FALSE);
+
+   if(pid == 0)
+   {
+      fd = open(((outFile == NULL) ? "/dev/null" : outFile),
+                O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if((fd < 0) || (dup2(fd, 1) < 0))
+         _exit(126);
+      close(fd);
+      if((fd = open(sLogFile, O_WRONLY | O_CREAT | O_APPEND, 0644)) >= 0)
+      {
+         dup2(fd, 2);
+         close(fd);
+      }
+      if(limit > 0)
+         alarm(limit);
+      execv(argv[0], argv);
+      _exit(127);
+   }
+
+   if(wait4(pid, &status, 0, &usage) < 0)
+      return(FALSE);
+   gettimeofday(&end, NULL);
+
+   result->elapsed = Seconds(&end) - Seconds(&start);
+   result->user    = Seconds(&(usage.ru_utime));
+   result->system  = Seconds(&(usage.ru_stime));
+   result->maxRSS  = usage.ru_maxrss;
+
+   if(WIFEXITED(status) && (WEXITSTATUS(status) == 0))
+      result->status = RUN_OK;
+   else if(WIFEXITED(status) && (WEXITSTATUS(status) == 127))
+      result->status = RUN_MISSING;
+   else if(WIFSIGNALED(status) && (WTERMSIG(status) == SIGALRM))
+      result->status = RUN_TIMEOUT;
+   else
+      result->status = RUN_FAILED;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>REAL Seconds(struct timeval *tv)
+   --------------------------------
+*//**
+
+   \param[in]      *tv     Time
+   \return                 Time in seconds
+
+-  19.10.26 Original    By: agent
+*/
+REAL Seconds(struct timeval *tv)
+{
+   return((REAL)tv->tv_sec + (REAL)tv->tv_usec / 1.0e6);
+}
+
+
+/************************************************************************/
+/*>long FileSize(char *filename)
+   -----------------------------
+*//**
+
+   \param[in]      *filename   File
+   \return                     Size in bytes (0 if not found)
+
+-  19.10.26 Original    By: agent
+*/
+long FileSize(char *filename)
+{
+   struct stat statBuff;
+
+   if(stat(filename, &statBuff))
+      return(0L);
+   return((long)statBuff.st_size);
+}
+
+
+/************************************************************************/
+/*>void WriteJSONString(FILE *out, char *string)
+   ---------------------------------------------
+*//**
+
+   \param[in]      *out       Output file
+   \param[in]      *string    String to write
+
+   Writes a quoted JSON string
+
+-  19.10.26 Original    By: agent
+*/
+void WriteJSONString(FILE *out, char *string)
+{
+   char *c;
+
+   fputc('"', out);
+   for(c=string; *c!='\0'; c++)
+   {
+      if((*c == '"') || (*c == '\\'))
+         fprintf(out, "\\%c", *c);
+      else if((unsigned char)*c < ' ')
+         fprintf(out, "\\u%04x", (unsigned int)(unsigned char)*c);
+      else
+         fputc(*c, out);
+   }
+   fputc('"', out);
+}
+
+
+/************************************************************************/
+/*>void WriteJSONStart(FILE *out, BENCHOPTIONS *opts)
+   --------------------------------------------------
+*//**
+
+   \param[in]      *out       Output file
+   \param[in]      *opts      Benchmark options
+
+   Writes the description of the machine and the benchmark settings
+   and opens the list of results
+
+-  19.10.26 Original    By: agent
+*/
+void WriteJSONStart(FILE *out, BENCHOPTIONS *opts)
+{
+   struct utsname host;
+   time_t         now = time(NULL);
+   char           date[MAXBUFF];
+
+   strftime(date, MAXBUFF, "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+   if(uname(&host))
+   {
+      strcpy(host.nodename, "unknown");
+      strcpy(host.machine,  "unknown");
+   }
+
+   fprintf(out, "{\n   \"benchmark\": \"bioptools\",\n");
+   fprintf(out, "   \"version\": 1,\n");
+   fprintf(out, "   \"date\": \"%s\",\n", date);
+   fprintf(out, "   \"host\": ");
+   WriteJSONString(out, host.nodename);
+   fprintf(out, ",\n   \"machine\": ");
+   WriteJSONString(out, host.machine);
+   fprintf(out, ",\n   \"chains\": ");
+   WriteJSONString(out, opts->nchains);
+   fprintf(out, ",\n   \"het_fraction\": ");
+   WriteJSONString(out, opts->hetFrac);
+   fprintf(out, ",\n   \"models\": ");
+   WriteJSONString(out, opts->nmodels);
+   fprintf(out, ",\n   \"alignment_sequences\": ");
+   WriteJSONString(out, opts->nseq);
+   fprintf(out, ",\n   \"repeats\": %d,\n", opts->repeats);
+   fprintf(out, "   \"results\":\n   [\n");
+}
+
+
+/************************************************************************/
+/*>int CompareReals(const void *a, const void *b)
+   ----------------------------------------------
+*//**
+
+   qsort() comparison for REALs
+
+-  19.10.26 Original    By: agent
+*/
+int CompareReals(const void *a, const void *b)
+{
+   REAL ra = *(const REAL *)a,
+        rb = *(const REAL *)b;
+
+   return((ra < rb) ? -1 : ((ra > rb) ? 1 : 0));
+}
+
@@ -0,0 +1,778 @@
+/************************************************************************/
+/**
+
+   \file       pdbgen.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Generate synthetic PDB files for benchmarking
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes a PDB file of a given number of atoms for the benchmarks run
+   by pdbbench. The structure is not a real protein, but it looks like
+   one to the programs:
+   - residues have the standard atom names and are chosen at random
+   - the C-alphas are 3.8A apart on a path that fills a box at about
+     protein density
+   - the chains are equal in size and are followed by their HETATMs
+     (ligands of 20 atoms and waters)
+   - NMR models are copies of the first with the coordinates moved
+     slightly
+   The header has SEQRES records and the B-values are random, which
+   serve as accessibilities for pdbmakepatch.
+
+   The output depends only on the options. The random numbers come
+   from our own generator, so a given seed gives the same file on any
+   machine.
+
+   With -a, a PIR alignment is written instead. It has the sequence of
+   the first chain and randomly mutated copies of it, for scorecons.
+
+   Residue numbers wrap round after 9999 and atom numbers after 99999,
+   as the PDB format allows no more.
+
+**************************************************************************
+
+   Usage:
+   ======
+   pdbgen [-n natoms] [-c nchains] [-H hetfrac] [-m nmodels] [-s seed]
+          [-a nseq] [out.pdb]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/macros.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF       256
+#define DEF_NATOMS    10000
+#define DEF_NCHAINS   4
+#define DEF_HETFRAC   0.05
+#define DEF_SEED      1
+#define MAXSIDECHAIN  10
+#define NRESTYPES     20
+#define CA_SPACING    3.8      /* Between residues along the path       */
+#define ROW_SPACING   5.5      /* Between rows and layers of the path   */
+#define LIGAND_ATOMS  20
+#define LIGAND_FRAC   0.25     /* Fraction of HETATMs in ligands        */
+#define NMR_JITTER    0.25     /* Largest coordinate change in models   */
+#define MUTATE_FRAC   0.3      /* Fraction changed in aligned sequences */
+#define GAP_FRAC      0.05
+#define PIR_LINE      60
+#define MAXRESNUM     9999
+#define MAXATNUM      99999
+#define SEQRES_PER_LINE 13
+
+#define CHAINLABELS \
+   "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"
+
+typedef struct
+{
+   char *resnam;
+   char code;
+   char *sideChain[MAXSIDECHAIN+1];
+}  RESTEMPLATE;
+
+typedef struct
+{
+   int    natoms,
+          nchains,
+          nmodels,
+          nseq;
+   REAL   hetFrac;
+   ULONG  seed;
+}  GENOPTIONS;
+
+typedef struct
+{
+   int    *resType,     /* Template of each residue                    */
+          *chainOf,     /* Chain of each residue                       */
+          *chainStart,  /* First residue of each chain                 */
+          nres,
+          nhet;
+   int    nx, ny;       /* Residues per row and rows per layer         */
+}  STRUCTURE;
+
+/************************************************************************/
+/* Globals
+*/
+static RESTEMPLATE sResidues[NRESTYPES] =
+{
+   {"GLY", 'G', {NULL}},
+   {"ALA", 'A', {"CB", NULL}},
+   {"SER", 'S', {"CB", "OG", NULL}},
+   {"CYS", 'C', {"CB", "SG", NULL}},
+   {"VAL", 'V', {"CB", "CG1", "CG2", NULL}},
+   {"THR", 'T', {"CB", "OG1", "CG2", NULL}},
+   {"PRO", 'P', {"CB", "CG", "CD", NULL}},
+   {"LEU", 'L', {"CB", "CG", "CD1", "CD2", NULL}},
+   {"ILE", 'I', {"CB", "CG1", "CG2", "CD1", NULL}},
+   {"ASP", 'D', {"CB", "CG", "OD1", "OD2", NULL}},
+   {"ASN", 'N', {"CB", "CG", "OD1", "ND2", NULL}},
+   {"MET", 'M', {"CB", "CG", "SD", "CE", NULL}},
+   {"GLU", 'E', {"CB", "CG", "CD", "OE1", "OE2", NULL}},
+   {"GLN", 'Q', {"CB", "CG", "CD", "OE1", "NE2", NULL}},
+   {"LYS", 'K', {"CB", "CG", "CD", "CE", "NZ", NULL}},
+   {"HIS", 'H', {"CB", "CG", "ND1", "CD2", "CE1", "NE2", NULL}},
+   {"PHE", 'F', {"CB", "CG", "CD1", "CD2", "CE1", "CE2", "CZ", NULL}},
+   {"ARG", 'R', {"CB", "CG", "CD", "NE", "CZ", "NH1", "NH2", NULL}},
+   {"TYR", 'Y', {"CB", "CG", "CD1", "CD2", "CE1", "CE2", "CZ", "OH",
+                 NULL}},
+   {"TRP", 'W', {"CB", "CG", "CD1", "CD2", "NE1", "CE2", "CE3", "CZ2",
+                 "CZ3", "CH2"}}
+};
+
+static char *sBackbone[] = {"N", "CA", "C", "O", NULL};
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, GENOPTIONS *opts,
+                  char *outfile);
+void Usage(void);
+REAL Random(ULONG *state);
+int ResidueSize(int type);
+BOOL BuildSequence(GENOPTIONS *opts, STRUCTURE *str);
+void WriteHeader(FILE *out, GENOPTIONS *opts, STRUCTURE *str);
+void WriteModel(FILE *out, GENOPTIONS *opts, STRUCTURE *str, int model);
+void WriteAtom(FILE *out, char *record, int serial, char *atnam,
+               char *resnam, char chain, int resnum,
+               REAL x, REAL y, REAL z, REAL bval);
+void ResidueCentre(STRUCTURE *str, int res, REAL *x, REAL *y, REAL *z,
+                   int *direction);
+void WriteAlignment(FILE *out, GENOPTIONS *opts, STRUCTURE *str);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program
+
+-  19.10.26 Original    By: agent
+*/
+int main(int argc, char **argv)
+{
+   GENOPTIONS opts;
+   STRUCTURE  str;
+   FILE       *out = stdout;
+   char       outfile[MAXBUFF];
+   int        model;
+
+   if(!ParseCmdLine(argc, argv, &opts, outfile))
+   {
+      Usage();
+      return(0);
+   }
+
+   if((outfile[0] != '\0') && ((out = fopen(outfile, "w")) == NULL))
+   {
+      fprintf(stderr,"Error: (pdbgen) Unable to write %s\n", outfile);
+      return(1);
+   }
+
+   if(!BuildSequence(&opts, &str))
+   {
+      fprintf(stderr,"Error: (pdbgen) No memory for sequence\n");
+      return(1);
+   }
+
+   if(opts.nseq > 0)
+   {
+      WriteAlignment(out, &opts, &str);
+   }
+   else
+   {
+      WriteHeader(out, &opts, &str);
+      for(model=1; model<=opts.nmodels; model++)
+         WriteModel(out, &opts, &str, model);
+      fprintf(out, "END   \n");
+   }
+
+   if(fclose(out) == EOF)
+   {
+      fprintf(stderr,"Error: (pdbgen) Error writing output\n");
+      return(1);
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, GENOPTIONS *opts,
+                     char *outfile)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]      argc         Argument count
+   \param[in]      **argv       Argument array
+   \param[out]     *opts        Generation options
+   \param[out]     *outfile     Output file (or blank string)
+   \return                      Success?
+
+   Parse the command line
+
+-  19.10.26 Original    By: agent
+*/
+BOOL ParseCmdLine(int argc, char **argv, GENOPTIONS *opts,
+                  char *outfile)
+{
+   long seed;
+
+   argc--;
+   argv++;
+
+   opts->natoms  = DEF_NATOMS;
+   opts->nchains = DEF_NCHAINS;
+   opts->nmodels = 1;
+   opts->nseq    = 0;
+   opts->hetFrac = DEF_HETFRAC;
+   opts->seed    = DEF_SEED;
+   outfile[0]    = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if((argc < 2) || (argv[0][2] != '\0'))
+            return(FALSE);
+
+         switch(argv[0][1])
+         {
+         case 'n':
+            if((sscanf(argv[1], "%d", &(opts->natoms)) != 1) ||
+               (opts->natoms < 1))
+               return(FALSE);
+            break;
+         case 'c':
+            if((sscanf(argv[1], "%d", &(opts->nchains)) != 1) ||
+               (opts->nchains < 1) ||
+               (opts->nchains > (int)strlen(CHAINLABELS)))
+               return(FALSE);
+            break;
+         case 'H':
+            if((sscanf(argv[1], "%lf", &(opts->hetFrac)) != 1) ||
+               (opts->hetFrac < 0.0) || (opts->hetFrac > 0.9))
+               return(FALSE);
+            break;
+         case 'm':
+            if((sscanf(argv[1], "%d", &(opts->nmodels)) != 1) ||
+               (opts->nmodels < 1))
+               return(FALSE);
+            break;
+         case 's':
+            if(sscanf(argv[1], "%ld", &seed) != 1)
+               return(FALSE);
+            opts->seed = (ULONG)seed;
+            break;
+         case 'a':
+            if((sscanf(argv[1], "%d", &(opts->nseq)) != 1) ||
+               (opts->nseq < 1))
+               return(FALSE);
+            break;
+         default:
+            return(FALSE);
+         }
+         argc -= 2;
+         argv += 2;
+      }
+      else
+      {
+         if(argc > 1)
+            return(FALSE);
+         strncpy(outfile, argv[0], MAXBUFF);
+         outfile[MAXBUFF-1] = '\0';
+         argc--;
+         argv++;
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Prints a usage message
+
+-  19.10.26 Original    By: agent
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\npdbgen V1.0 (c) 2026 UCL\n");
+   fprintf(stderr,"\nUsage: pdbgen [-n natoms] [-c nchains] [-H hetfrac] \
+[-m nmodels] [-s seed]\n");
+   fprintf(stderr,"              [-a nseq] [out.pdb]\n");
+   fprintf(stderr,"       -n Atoms in each model (Default: %d)\n",
+           DEF_NATOMS);
+   fprintf(stderr,"       -c Number of chains, at most %d (Default: \
+%d)\n", (int)strlen(CHAINLABELS), DEF_NCHAINS);
+   fprintf(stderr,"       -H Fraction of the atoms that are HETATMs \
+(Default: %.2f)\n", DEF_HETFRAC);
+   fprintf(stderr,"       -m Number of NMR models (Default: 1)\n");
+   fprintf(stderr,"       -s Random number seed (Default: %d)\n",
+           DEF_SEED);
+   fprintf(stderr,"       -a Write a PIR alignment of this many \
+sequences instead\n");
+   fprintf(stderr,"\nGenerates a synthetic PDB file for benchmarking. \
+The file has the\n");
+   fprintf(stderr,"given number of atoms, standard residues at about \
+protein density,\n");
+   fprintf(stderr,"ligands and waters. The same options always give the \
+same file.\n\n");
+}
+
+
+/************************************************************************/
+/*>REAL Random(ULONG *state)
+   -------------------------
+*//**
+
+   \param[in,out]  *state    Generator state
+   \return                   Random number in [0,1)
+
+   A 31-bit linear congruential generator, so that the output does not
+   depend on the C library
+
+-  19.10.26 Original    By: agent
+*/
+REAL Random(ULONG *state)
+{
+   *state = (*state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+   return((REAL)(*state >> 7) / (REAL)(1UL << 24));
+}
+
+
+/************************************************************************/
+/*>int ResidueSize(int type)
+   -------------------------
+*//**
+
+   \param[in]      type     Residue template
+   \return                  Number of atoms in the residue
+
+-  19.10.26 Original    By: agent
+*/
+int ResidueSize(int type)
+{
+   int n = 4;
+
+   while((n-4 < MAXSIDECHAIN) && (sResidues[type].sideChain[n-4] != NULL))
+      n++;
+   return(n);
+}
+
+
+/************************************************************************/
+/*>BOOL BuildSequence(GENOPTIONS *opts, STRUCTURE *str)
+   ----------------------------------------------------
+*//**
+
+   \param[in]      *opts    Generation options
+   \param[out]     *str     Residue types and chains
+   \return                  Success?
+
+   Chooses the residues. Residues are added until the next would take
+   the protein past its share of the atoms; any atoms left over are
+   made up with extra waters. The chains are split by atom count.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL BuildSequence(GENOPTIONS *opts, STRUCTURE *str)
+{
+   ULONG state = opts->seed;
+   int   nprotein,
+         maxres,
+         size,
+         type,
+         atoms = 0,
+         chain = 0;
+   REAL  side;
+
+   nprotein = opts->natoms - (int)(opts->natoms * opts->hetFrac + 0.5);
+   maxres   = nprotein / 4 + 1;
+
+   str->resType    = (int *)malloc(maxres * sizeof(int));
+   str->chainOf    = (int *)malloc(maxres * sizeof(int));
+   str->chainStart = (int *)malloc((opts->nchains+1) * sizeof(int));
+   if((str->resType == NULL) || (str->chainOf == NULL) ||
+      (str->chainStart == NULL))
+      return(FALSE);
+
+   str->nres = 0;
+   str->chainStart[0] = 0;
+   for(;;)
+   {
+      type = (int)(Random(&state) * NRESTYPES);
+      size = ResidueSize(type);
+      if(atoms + size > nprotein)
+         break;
+
+      while((chain < opts->nchains-1) &&
+            (atoms >= (double)nprotein * (chain+1) / opts->nchains))
+         str->chainStart[++chain] = str->nres;
+
+      str->resType[str->nres] = type;
+      str->chainOf[str->nres] = chain;
+      str->nres++;
+      atoms += size;
+   }
+   while(chain < opts->nchains-1)
+      str->chainStart[++chain] = str->nres;
+   str->chainStart[opts->nchains] = str->nres;
+
+   str->nhet = opts->natoms - atoms;
+
+   /* Size the box so that it is roughly a cube                         */
+   side    = pow((REAL)(str->nres+1) * CA_SPACING * ROW_SPACING *
+                 ROW_SPACING, 1.0/3.0);
+   str->nx = MAX(1, (int)(side / CA_SPACING));
+   str->ny = MAX(1, (int)(side / ROW_SPACING));
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void WriteHeader(FILE *out, GENOPTIONS *opts, STRUCTURE *str)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]      *out     Output file
+   \param[in]      *opts    Generation options
+   \param[in]      *str     Residue types and chains
+
+   Writes the header with the options in a REMARK and SEQRES records
+
+-  19.10.26 Original    By: agent
+*/
+void WriteHeader(FILE *out, GENOPTIONS *opts, STRUCTURE *str)
+{
+   int chain,
+       res,
+       nres,
+       line,
+       i;
+
+   fprintf(out, "HEADER    SYNTHETIC STRUCTURE                     \
+19-OCT-26   0GEN              \n");
+   fprintf(out, "TITLE     SYNTHETIC STRUCTURE GENERATED BY PDBGEN\n");
+   fprintf(out, "REMARK 999 PDBGEN -n %d -c %d -H %.3f -m %d -s %lu\n",
+           opts->natoms, opts->nchains, opts->hetFrac, opts->nmodels,
+           (unsigned long)opts->seed);
+
+   for(chain=0; chain<opts->nchains; chain++)
+   {
+      nres = str->chainStart[chain+1] - str->chainStart[chain];
+      for(res=str->chainStart[chain], line=1;
+          res<str->chainStart[chain+1];
+          line++)
+      {
+         fprintf(out, "SEQRES%4d %c%5d ", line % 10000,
+                 CHAINLABELS[chain], nres % 100000);
+         for(i=0; (i<SEQRES_PER_LINE) && (res<str->chainStart[chain+1]);
+             i++, res++)
+            fprintf(out, " %s", sResidues[str->resType[res]].resnam);
+         fprintf(out, "\n");
+      }
+   }
+
+   fprintf(out, "CRYST1    1.000    1.000    1.000  90.00  90.00  90.00 \
+P 1           1          \n");
+}
+
+
+/************************************************************************/
+/*>void WriteModel(FILE *out, GENOPTIONS *opts, STRUCTURE *str,
+                   int model)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]      *out     Output file
+   \param[in]      *opts    Generation options
+   \param[in]      *str     Residue types and chains
+   \param[in]      model    Model number (from 1)
+
+   Writes the atoms of one model. The positions use the same random
+   numbers in every model and models after the first are then moved
+   by a second generator.
+
+-  19.10.26 Original    By: agent
+*/
+void WriteModel(FILE *out, GENOPTIONS *opts, STRUCTURE *str, int model)
+{
+   ULONG place  = opts->seed + 1,
+         jitter = opts->seed + model;
+   REAL  jit    = ((model > 1) ? NMR_JITTER : 0.0),
+         cx, cy, cz,
+         x, y, z,
+         xmax, ymax, zmax;
+   int   serial = 0,
+         res,
+         resnum,
+         chain,
+         dir,
+         nlig,
+         nwater,
+         het,
+         k;
+   char  **names,
+         *resnam,
+         atnam[8];
+
+#define JITTER() (jit * (2.0 * Random(&jitter) - 1.0))
+
+   if(opts->nmodels > 1)
+      fprintf(out, "MODEL     %4d\n", model);
+
+   for(chain=0; chain<opts->nchains; chain++)
+   {
+      for(res=str->chainStart[chain]; res<str->chainStart[chain+1];
+          res++)
+      {
+         resnam = sResidues[str->resType[res]].resnam;
+         resnum = (res - str->chainStart[chain]) % MAXRESNUM + 1;
+         ResidueCentre(str, res, &cx, &cy, &cz, &dir);
+
+         /* Backbone along the direction of the path                    */
+         for(k=0, names=sBackbone; *names!=NULL; k++, names++)
+         {
+            x = cx + dir * ((k==0) ? -1.2 : ((k==1) ? 0.0 : 1.2));
+            y = cy + ((k==1) ? 0.0 : 0.83);
+            z = cz + ((k==3) ? ((res%2) ? 1.23 : -1.23) : 0.0);
+            WriteAtom(out, "ATOM  ", ++serial, *names, resnam,
+                      CHAINLABELS[chain], resnum,
+                      x+JITTER(), y+JITTER(), z+JITTER(),
+                      5.0 + 55.0 * Random(&place));
+         }
+
+         /* Side chain zig-zags away from the backbone                  */
+         names = sResidues[str->resType[res]].sideChain;
+         for(k=0; (k<MAXSIDECHAIN) && (names[k]!=NULL); k++)
+         {
+            x = cx + dir * 0.8 * ((k%3) - 1);
+            y = cy - 1.0 - 1.1 * k;
+            z = cz + ((k%2) ? 0.6 : -0.6);
+            WriteAtom(out, "ATOM  ", ++serial, names[k], resnam,
+                      CHAINLABELS[chain], resnum,
+                      x+JITTER(), y+JITTER(), z+JITTER(),
+                      5.0 + 55.0 * Random(&place));
+         }
+      }
+      fprintf(out, "TER   \n");
+   }
+
+   /* HETATMs go anywhere in the box                                    */
+   xmax = str->nx * CA_SPACING;
+   ymax = str->ny * ROW_SPACING;
+   zmax = ((str->nres / (str->nx * str->ny)) + 1) * ROW_SPACING;
+
+   nlig   = (int)(str->nhet * LIGAND_FRAC) / LIGAND_ATOMS;
+   nwater = str->nhet - nlig * LIGAND_ATOMS;
+   for(het=0; het<nlig+nwater; het++)
+   {
+      /* Spread the ligands and then the waters over the chains         */
+      if(het < nlig)
+         chain = het * opts->nchains / nlig;
+      else
+         chain = (het - nlig) * opts->nchains / nwater;
+      resnum = (str->chainStart[chain+1] - str->chainStart[chain] +
+                het) % MAXRESNUM + 1;
+
+      x = xmax * Random(&place);
+      y = ymax * Random(&place);
+      z = zmax * Random(&place);
+
+      if(het < nlig)
+      {
+         for(k=0; k<LIGAND_ATOMS; k++)
+         {
+            sprintf(atnam, "%c%d", ((k%5==4) ? 'N' : ((k%7==6)?'O':'C')),
+                    k+1);
+            WriteAtom(out, "HETATM", ++serial, atnam, "LIG",
+                      CHAINLABELS[chain], resnum,
+                      x+JITTER(), y+JITTER(), z+JITTER(),
+                      20.0 + 40.0 * Random(&place));
+            x += 1.5 * ((k%3==0) ? 1 : 0);
+            y += 1.5 * ((k%3==1) ? 1 : 0);
+            z += 1.5 * ((k%3==2) ? 1 : 0);
+         }
+      }
+      else
+      {
+         WriteAtom(out, "HETATM", ++serial, "O", "HOH",
+                   CHAINLABELS[chain], resnum,
+                   x+JITTER(), y+JITTER(), z+JITTER(),
+                   20.0 + 40.0 * Random(&place));
+      }
+   }
+
+#undef JITTER
+
+   if(opts->nmodels > 1)
+      fprintf(out, "ENDMDL\n");
+}
+
+
+/************************************************************************/
+/*>void ResidueCentre(STRUCTURE *str, int res, REAL *x, REAL *y, REAL *z,
+                      int *direction)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]      *str        Residue types and chains
+   \param[in]      res         Residue number (from 0)
+   \param[out]     *x          C-alpha x
+   \param[out]     *y          C-alpha y
+   \param[out]     *z          C-alpha z
+   \param[out]     *direction  +1 or -1 for the direction along x
+
+   Places residues on a path that runs back and forth along x, filling
+   each layer row by row and then moving up a layer
+
+-  19.10.26 Original    By: agent
+*/
+void ResidueCentre(STRUCTURE *str, int res, REAL *x, REAL *y, REAL *z,
+                   int *direction)
+{
+   int perLayer = str->nx * str->ny,
+       layer    = res / perLayer,
+       row      = (res % perLayer) / str->nx,
+       col      = res % str->nx;
+
+   if(layer % 2)
+      row = str->ny - 1 - row;
+   *direction = ((row + layer) % 2) ? -1 : 1;
+   if(*direction < 0)
+      col = str->nx - 1 - col;
+
+   *x = col   * CA_SPACING;
+   *y = row   * ROW_SPACING;
+   *z = layer * ROW_SPACING;
+}
+
+
+/************************************************************************/
+/*>void WriteAtom(FILE *out, char *record, int serial, char *atnam,
+                  char *resnam, char chain, int resnum,
+                  REAL x, REAL y, REAL z, REAL bval)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]      *out      Output file
+   \param[in]      *record   "ATOM  " or "HETATM"
+   \param[in]      serial    Atom number
+   \param[in]      *atnam    Atom name
+   \param[in]      *resnam   Residue name
+   \param[in]      chain     Chain label
+   \param[in]      resnum    Residue number
+   \param[in]      x         x coordinate
+   \param[in]      y         y coordinate
+   \param[in]      z         z coordinate
+   \param[in]      bval      B-value
+
+   Writes one coordinate record. Names of fewer than four characters
+   start in column 14 and the element is the first letter of the name.
+
+-  19.10.26 Original    By: agent
+*/
+void WriteAtom(FILE *out, char *record, int serial, char *atnam,
+               char *resnam, char chain, int resnum,
+               REAL x, REAL y, REAL z, REAL bval)
+{
+   fprintf(out, "%s%5d %s%-*s %3s %c%4d    %8.3f%8.3f%8.3f%6.2f%6.2f\
+          %2c\n",
+           record, (serial - 1) % MAXATNUM + 1,
+           ((strlen(atnam) < 4) ? " " : ""),
+           ((strlen(atnam) < 4) ? 3 : 4), atnam,
+           resnam, chain, resnum, x, y, z, 1.0, bval, atnam[0]);
+}
+
+
+/************************************************************************/
+/*>void WriteAlignment(FILE *out, GENOPTIONS *opts, STRUCTURE *str)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]      *out     Output file
+   \param[in]      *opts    Generation options
+   \param[in]      *str     Residue types and chains
+
+   Writes a PIR alignment of the first chain's sequence and mutated
+   copies of it, with some positions deleted
+
+-  19.10.26 Original    By: agent
+*/
+void WriteAlignment(FILE *out, GENOPTIONS *opts, STRUCTURE *str)
+{
+   ULONG state = opts->seed + 2;
+   int   seq,
+         res,
+         pos;
+   REAL  r;
+   char  code;
+
+   for(seq=0; seq<opts->nseq; seq++)
+   {
+      fprintf(out, ">P1;SEQ%d\nSynthetic sequence %d\n", seq+1, seq+1);
+      for(res=str->chainStart[0], pos=0; res<str->chainStart[1];
+          res++, pos++)
+      {
+         code = sResidues[str->resType[res]].code;
+         if(seq > 0)
+         {
+            r = Random(&state);
+            if(r < GAP_FRAC)
+               code = '-';
+            else if(r < MUTATE_FRAC)
+               code = sResidues[(int)(Random(&state) * NRESTYPES)].code;
+         }
+         if(pos && !(pos % PIR_LINE))
+            fprintf(out, "\n");
+         fputc(code, out);
+      }
+      fprintf(out, "*\n");
+   }
+}
+
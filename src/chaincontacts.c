@@ -3,8 +3,8 @@
    Program:    chaincontacts
    File:       chaincontacts.c
    
-   Version:    V1.3
-   Date:       28.10.15
+   Version:    V1.6
+   Date:       19.10.26
    Function:   Calculate details of contacts between chains
    
    Copyright:  (c) Dr. Andrew C. R. Martin 1995-2015
@@ -50,6 +50,11 @@
    V1.2  04.02.15 Now only reads ATOM records
    V1.3  28.10.15 Now takes a -H option to allow analysis of contacts 
                   with HETATOMs
+   V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+   V1.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+   V1.6  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -63,6 +68,9 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -118,17 +126,19 @@ int main(int argc, char **argv)
         verbose    = FALSE,
         keepWater  = FALSE;
 
+   btInitTiming(&argc, argv);
+
    chainsx[0] = '\0';
    chainsy[0] = '\0';
    
    if(ParseCmdLine(argc, argv, infile, outfile, &radsq, chainsx, chainsy,
                    &doHet, &verbose, &keepWater))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          if(doHet)
          {
-            pdb = blReadPDB(in, &natom);
+            pdb = btReadPDB(in, &natom);
             if(!keepWater)
             {
                PDB *pdb2 = blStripWatersPDBAsCopy(pdb, &natom);
@@ -138,7 +148,7 @@ int main(int argc, char **argv)
          }
          else
          {
-            pdb = blReadPDBAtoms(in, &natom);
+            pdb = btReadPDBAtoms(in, &natom);
          }
          
          if(pdb != NULL)
@@ -180,7 +190,7 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nChainContacts V1.3 (c) 1995-2015, Andrew C.R. \
+   fprintf(stderr,"\nChainContacts V1.6 (c) 1995-2015, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: chaincontacts [-r radius] [-x CCC] \
 [-y CCC] [-H [-w]] [in.pdb [out.dat]]\n");
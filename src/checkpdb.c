@@ -3,8 +3,8 @@
 
    \file       checkpdb.c
    
-   \version    V1.0
-   \date       28.01.18
+   \version    V1.3
+   \date       19.10.26
    \brief      Check a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 1996-2018
@@ -52,6 +52,11 @@
    =================
 
 -  V1.0  16.08.18 Original
+-  V1.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.2  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.3  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -61,6 +66,9 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -104,11 +112,13 @@ int main(int argc, char **argv)
    PDB     *pdb    = NULL;
    BOOL    verbose = FALSE;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, inFile, outFile, &verbose))
    {
-      if(blOpenStdFiles(inFile, outFile, &in, &out))
+      if(btOpenStdFiles(inFile, outFile, &in, &out))
       {
-         if((pdb=blReadPDBAtoms(in, &natoms))!=NULL)
+         if((pdb=btReadPDBAtoms(in, &natoms))!=NULL)
          {
             PDBSTRUCT *pdbs = NULL;
             if((pdbs = blAllocPDBStructure(pdb))!=NULL)
@@ -408,7 +418,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   printf("\ncheckpdb V1.0 (c) 2018 UCL, Dr. Andrew C.R. Martin\n");
+   printf("\ncheckpdb V1.3 (c) 2018 UCL, Dr. Andrew C.R. Martin\n");
 
    printf("\nUsage: checkpdb [-v] [in.pdb [out.txt]]\n");
    printf("       -v   Verbose - prints information about errors\n");
@@ -0,0 +1,471 @@
+/************************************************************************/
+/**
+
+   \file       arena.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Arena allocation for PDB atoms, extras and copies
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Small requests are taken from the front block in turn. A request
+   bigger than a quarter of the block size gets a block of its own,
+   which is linked in behind the front block so that the space left in
+   the front block is not wasted.
+
+   btArenaCopyPDB() places the whole copy in a single allocation, so
+   the copied atoms are adjacent in memory in list order.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "arena.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef union
+{
+   double d;
+   long   l;
+   void   *p;
+}  ALIGNUNION;
+
+#define ALIGNMENT   sizeof(ALIGNUNION)
+#define ROUNDUP(n)  ((((n) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT)
+#define HEADERSIZE  ROUNDUP(sizeof(ARENABLOCK))
+#define BLOCKDATA(b) ((char *)(b) + HEADERSIZE)
+
+typedef struct
+{
+   PDB *atom;
+   int index;
+}  ATOMREF;
+
+/************************************************************************/
+/* Prototypes
+*/
+static ARENABLOCK *GetBlock(ARENA *arena, size_t size);
+static void FreeBlocks(ARENABLOCK *block);
+static BOOL RemapConects(PDB *copies, PDB *pdb,
+                         BOOL (*keep)(PDB *p, void *data), void *data,
+                         int natoms);
+static int  CompareAtomRefs(const void *a, const void *b);
+
+
+/************************************************************************/
+/*>ARENA *btNewArena(size_t blockSize)
+   -----------------------------------
+*//**
+   \param[in]  blockSize  Size of the blocks (0 for BT_ARENA_BLOCK)
+   \return                New, empty arena (NULL if no memory)
+
+-  19.10.26 Original   By: agent
+*/
+ARENA *btNewArena(size_t blockSize)
+{
+   ARENA *arena;
+
+   if((arena = (ARENA *)malloc(sizeof(ARENA))) == NULL)
+      return(NULL);
+
+   arena->blocks    = NULL;
+   arena->spare     = NULL;
+   arena->blockSize = (blockSize ? ROUNDUP(blockSize) : BT_ARENA_BLOCK);
+   return(arena);
+}
+
+
+/************************************************************************/
+/*>void *btArenaAlloc(ARENA *arena, size_t size)
+   ---------------------------------------------
+*//**
+   \param[in]  *arena  Arena
+   \param[in]  size    Bytes required
+   \return             Memory aligned as malloc() aligns it (NULL if
+                       no memory)
+
+   The memory is not cleared.
+
+-  19.10.26 Original   By: agent
+*/
+void *btArenaAlloc(ARENA *arena, size_t size)
+{
+   ARENABLOCK *block;
+   char       *mem;
+
+   size = ROUNDUP((size == 0) ? 1 : size);
+
+   /* Room in the front block                                           */
+   block = arena->blocks;
+   if((block != NULL) && (block->size - block->used >= size))
+   {
+      mem = BLOCKDATA(block) + block->used;
+      block->used += size;
+      return((void *)mem);
+   }
+
+   if((block = GetBlock(arena, size)) == NULL)
+      return(NULL);
+   block->used = size;
+
+   if((size > arena->blockSize / 4) && (arena->blocks != NULL))
+   {
+      /* Keep the front block for the small requests                    */
+      block->next = arena->blocks->next;
+      arena->blocks->next = block;
+   }
+   else
+   {
+      block->next = arena->blocks;
+      arena->blocks = block;
+   }
+
+   return((void *)BLOCKDATA(block));
+}
+
+
+/************************************************************************/
+/*>PDB *btArenaNewPDB(ARENA *arena)
+   --------------------------------
+*//**
+   \param[in]  *arena  Arena
+   \return             Uninitialised atom (NULL if no memory)
+
+   The arena equivalent of malloc(sizeof(PDB))
+
+-  19.10.26 Original   By: agent
+*/
+PDB *btArenaNewPDB(ARENA *arena)
+{
+   return((PDB *)btArenaAlloc(arena, sizeof(PDB)));
+}
+
+
+/************************************************************************/
+/*>PDB *btArenaCopyPDB(ARENA *arena, PDB *pdb,
+                       BOOL (*keep)(PDB *p, void *data), void *data,
+                       int *natoms)
+   ----------------------------------------------------------------
+*//**
+   \param[in]  *arena   Arena for the copy
+   \param[in]  *pdb     PDB linked list
+   \param[in]  keep     Function saying whether to copy an atom (NULL
+                        to copy them all)
+   \param[in]  *data    Passed to keep()
+   \param[out] *natoms  Number of atoms copied
+   \return              The copy (NULL if nothing was copied or there
+                        was no memory)
+
+   Copies the selected atoms into one array in the arena, linked in
+   the original order. CONECTs between copied atoms are moved to the
+   copies and CONECTs to atoms that were not copied are dropped. The
+   extras pointers of the copies are cleared.
+
+   This replaces blStripWatersPDBAsCopy(), blGetPDBChainAsCopy() and
+   the like for lists that are released with the arena.
+
+-  19.10.26 Original   By: agent
+*/
+PDB *btArenaCopyPDB(ARENA *arena, PDB *pdb,
+                    BOOL (*keep)(PDB *p, void *data), void *data,
+                    int *natoms)
+{
+   PDB  *p,
+        *copies;
+   int  n = 0,
+        i;
+   BOOL conects = FALSE;
+
+   *natoms = 0;
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((keep == NULL) || (*keep)(p, data))
+      {
+         n++;
+         if(p->nConect)
+            conects = TRUE;
+      }
+   }
+   if(n == 0)
+      return(NULL);
+
+   if((copies = (PDB *)btArenaAlloc(arena, n * sizeof(PDB))) == NULL)
+      return(NULL);
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p))
+   {
+      if((keep == NULL) || (*keep)(p, data))
+      {
+         copies[i]        = *p;
+         copies[i].extras = NULL;
+         copies[i].next   = (i < n-1) ? &(copies[i+1]) : NULL;
+         i++;
+      }
+   }
+
+   if(conects && !RemapConects(copies, pdb, keep, data, n))
+      return(NULL);
+
+   *natoms = n;
+   return(copies);
+}
+
+
+/************************************************************************/
+/*>BOOL btSelectNonWater(PDB *p, void *data)
+   -----------------------------------------
+*//**
+   \param[in]  *p     Atom
+   \param[in]  *data  Not used
+   \return            Is the atom not in a water?
+
+   Selection for btArenaCopyPDB() equivalent to
+   blStripWatersPDBAsCopy()
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btSelectNonWater(PDB *p, void *data)
+{
+   return((BOOL)!ISWATER(p));
+}
+
+
+/************************************************************************/
+/*>BOOL btSelectChain(PDB *p, void *data)
+   --------------------------------------
+*//**
+   \param[in]  *p     Atom
+   \param[in]  *data  Chain label (char *)
+   \return            Is the atom in this chain?
+
+   Selection for btArenaCopyPDB() equivalent to blGetPDBChainAsCopy()
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btSelectChain(PDB *p, void *data)
+{
+   return((BOOL)CHAINMATCH(p->chain, (char *)data));
+}
+
+
+/************************************************************************/
+/*>void btResetArena(ARENA *arena)
+   -------------------------------
+*//**
+   \param[in]  *arena  Arena
+
+   Releases everything allocated from the arena but keeps the blocks
+   for the next allocations, so repeated copies of similar size need
+   no further calls to malloc().
+
+-  19.10.26 Original   By: agent
+*/
+void btResetArena(ARENA *arena)
+{
+   ARENABLOCK *block;
+
+   while((block = arena->blocks) != NULL)
+   {
+      arena->blocks = block->next;
+      block->used   = 0;
+      block->next   = arena->spare;
+      arena->spare  = block;
+   }
+}
+
+
+/************************************************************************/
+/*>void btFreeArena(ARENA *arena)
+   ------------------------------
+*//**
+   \param[in]  *arena  Arena (may be NULL)
+
+   Releases the arena and everything allocated from it
+
+-  19.10.26 Original   By: agent
+*/
+void btFreeArena(ARENA *arena)
+{
+   if(arena == NULL)
+      return;
+
+   FreeBlocks(arena->blocks);
+   FreeBlocks(arena->spare);
+   free(arena);
+}
+
+
+/************************************************************************/
+/*>static ARENABLOCK *GetBlock(ARENA *arena, size_t size)
+   ------------------------------------------------------
+*//**
+   \param[in]  *arena  Arena
+   \param[in]  size    Bytes needed from the block
+   \return             Block with at least that much room (NULL if no
+                       memory)
+
+   Takes the first spare block that is big enough, or allocates one of
+   the arena's block size (or bigger if the request needs it).
+
+-  19.10.26 Original   By: agent
+*/
+static ARENABLOCK *GetBlock(ARENA *arena, size_t size)
+{
+   ARENABLOCK *block,
+              *prev = NULL;
+
+   for(block=arena->spare; block!=NULL; prev=block, NEXT(block))
+   {
+      if(block->size >= size)
+      {
+         if(prev == NULL)
+            arena->spare = block->next;
+         else
+            prev->next = block->next;
+         return(block);
+      }
+   }
+
+   if(size < arena->blockSize)
+      size = arena->blockSize;
+   if((block = (ARENABLOCK *)malloc(HEADERSIZE + size)) == NULL)
+      return(NULL);
+   block->size = size;
+   block->used = 0;
+   block->next = NULL;
+   return(block);
+}
+
+
+/************************************************************************/
+/*>static void FreeBlocks(ARENABLOCK *block)
+   -----------------------------------------
+*//**
+   \param[in]  *block  Linked list of blocks
+
+-  19.10.26 Original   By: agent
+*/
+static void FreeBlocks(ARENABLOCK *block)
+{
+   ARENABLOCK *next;
+
+   for(; block!=NULL; block=next)
+   {
+      next = block->next;
+      free(block);
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL RemapConects(PDB *copies, PDB *pdb,
+                            BOOL (*keep)(PDB *p, void *data),
+                            void *data, int natoms)
+   ----------------------------------------------------------
+*//**
+   \param[in,out] *copies  Array of copied atoms
+   \param[in]     *pdb     Original PDB linked list
+   \param[in]     keep     Selection function given to btArenaCopyPDB()
+   \param[in]     *data    Passed to keep()
+   \param[in]     natoms   Number of copies
+   \return                 FALSE if there was no memory
+
+   Points the CONECTs of the copies at the copied atoms, looking the
+   original atoms up by address.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL RemapConects(PDB *copies, PDB *pdb,
+                         BOOL (*keep)(PDB *p, void *data), void *data,
+                         int natoms)
+{
+   ATOMREF *refs,
+           key,
+           *found;
+   PDB     *p;
+   int     i, j, n;
+
+   if((refs = (ATOMREF *)malloc(natoms * sizeof(ATOMREF))) == NULL)
+      return(FALSE);
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p))
+   {
+      if((keep == NULL) || (*keep)(p, data))
+      {
+         refs[i].atom  = p;
+         refs[i].index = i;
+         i++;
+      }
+   }
+   qsort(refs, natoms, sizeof(ATOMREF), CompareAtomRefs);
+
+   key.index = 0;
+   for(i=0; i<natoms; i++)
+   {
+      for(j=0, n=0; j<copies[i].nConect; j++)
+      {
+         key.atom = copies[i].conect[j];
+         if((found = (ATOMREF *)bsearch(&key, refs, natoms,
+                                        sizeof(ATOMREF),
+                                        CompareAtomRefs)) != NULL)
+            copies[i].conect[n++] = &(copies[found->index]);
+      }
+      copies[i].nConect = n;
+   }
+
+   free(refs);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int CompareAtomRefs(const void *a, const void *b)
+   --------------------------------------------------------
+*//**
+   qsort() comparison of ATOMREFs by atom address
+
+-  19.10.26 Original   By: agent
+*/
+static int CompareAtomRefs(const void *a, const void *b)
+{
+   const char *pa = (const char *)((const ATOMREF *)a)->atom,
+              *pb = (const char *)((const ATOMREF *)b)->atom;
+
+   if(pa < pb)
+      return(-1);
+   if(pa > pb)
+      return(1);
+   return(0);
+}
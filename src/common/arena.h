@@ -0,0 +1,90 @@
+/************************************************************************/
+/**
+
+   \file       arena.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Arena allocation for PDB atoms, extras and copies
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   An arena hands out memory from large blocks and releases it all at
+   once. Atoms placed in an arena are contiguous in memory and the
+   whole structure is released with btFreeArena() (or btResetArena()
+   to reuse the blocks) rather than one free() per atom.
+
+   Nothing allocated from an arena may be passed to free(), so a list
+   of atoms in an arena must not be released with FREELIST() or given
+   to BiopLib routines that free or delete atoms.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_ARENA_H
+#define _BIOPTOOLS_ARENA_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stddef.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BT_ARENA_BLOCK  (1024 * 1024)   /* Default block size (bytes)  */
+
+typedef struct _arenablock
+{
+   struct _arenablock *next;
+   size_t             size,
+                      used;
+}  ARENABLOCK;
+
+typedef struct
+{
+   ARENABLOCK *blocks,      /* Blocks in use, most recent first         */
+              *spare;       /* Blocks kept by btResetArena()            */
+   size_t     blockSize;
+}  ARENA;
+
+/************************************************************************/
+/* Prototypes
+*/
+ARENA *btNewArena(size_t blockSize);
+void  *btArenaAlloc(ARENA *arena, size_t size);
+PDB   *btArenaNewPDB(ARENA *arena);
+PDB   *btArenaCopyPDB(ARENA *arena, PDB *pdb,
+                      BOOL (*keep)(PDB *p, void *data), void *data,
+                      int *natoms);
+BOOL  btSelectNonWater(PDB *p, void *data);
+BOOL  btSelectChain(PDB *p, void *data);
+void  btResetArena(ARENA *arena);
+void  btFreeArena(ARENA *arena);
+
+#endif
@@ -0,0 +1,940 @@
+/************************************************************************/
+/**
+
+   \file       binpdb.c
+
+   \version    V1.3
+   \date       19.10.26
+   \brief      Binary structure images and the structure cache
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A binary PDB (.bpdb) file is a cache of exactly what BiopLib read
+   from a PDB file. It contains:
+
+   - a BPDBHEADER (magic number, format version, structure layout,
+     counts and the gPDB... globals set when the structure was read)
+   - an image of the WHOLEPDB structure
+   - an image of each PDB structure in list order, with the pointers
+     cleared
+   - the CONECT data as atom indices, in the order of each atom's
+     conect[] array
+   - the header and trailer lines, each terminated by a NUL
+
+   Loading copies each image into a newly allocated structure and
+   restores the pointers, so there is no per-atom parsing and all
+   fields (including ones that bioptools never looks at) come back as
+   they were. Each atom is allocated separately so the list can be
+   freed with FREELIST() as usual.
+
+   The images are native, so a file can only be read by programs
+   built with the same BiopLib structure layout. The layout is
+   recorded in the header and checked on loading. The files are
+   intended as a cache rather than an archive format.
+
+   If BIOPTOOLS_CACHEDIR names a directory, btReadCachedPDB() and
+   btWriteCachedPDB() keep a binary image of each regular file read,
+   named from the device and inode numbers and checked against the
+   file's inode, size and modification and status change times (to
+   the nanosecond).
+
+   Every count, offset, CONECT index and string in an image is checked
+   against the size of the data before it is used, and an image whose
+   magic number, version or layout does not match is rejected.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Records the gPDB... globals and sets them on loading.
+                  Format version 2
+-  V1.2  19.10.26 Checks the whole image before using it. The cache is
+                  checked against a BTFILESTAMP. Checks the complete
+                  magic number of a regular file before reading it
+-  V1.3  19.10.26 Makes the temporary cache file with mkstemp() rather
+                  than from the PID
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "bioplib/macros.h"
+#include "bioplib/general.h"
+#include "binpdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BPDB_VERSION 2
+#define NLAYOUT      8
+#define MAXPATH      1024
+#define READCHUNK    65536
+
+typedef struct
+{
+   char magic[BPDB_MAGICLEN];
+   int  version,
+        atomsOnly,
+        layout[NLAYOUT],
+        partialOcc,
+        multiNMR,
+        xml;
+   long natoms,
+        nconect,
+        nheader,
+        ntrailer,
+        headerBytes,
+        trailerBytes;
+   BTFILESTAMP source;
+}  BPDBHEADER;
+
+typedef struct
+{
+   PDB *atom;
+   int index;
+}  ATOMREF;
+
+/************************************************************************/
+/* Prototypes
+*/
+static WHOLEPDB *LoadImage(char *data, size_t size, BOOL atomsOnly,
+                           struct stat *source);
+static BOOL LoadStrings(char *data, long nbytes, long nstrings,
+                        STRINGLIST **list);
+static BOOL CheckCounts(BPDBHEADER *header, size_t size);
+static BOOL HasMagic(FILE *fp);
+static void SetLayout(int *layout);
+static BOOL CachePath(FILE *fp, BOOL atomsOnly, BOOL atStart,
+                      char *path, struct stat *sbuf);
+static char *ReadStream(FILE *fp, size_t *size);
+static int  CompareAtomRefs(const void *a, const void *b);
+static int  FindAtomIndex(ATOMREF *refs, int natoms, PDB *atom);
+
+
+/************************************************************************/
+/*>BOOL btWriteBinaryPDB(FILE *fp, WHOLEPDB *wpdb, BOOL atomsOnly,
+                         struct stat *source)
+   -----------------------------------------------------------------
+*//**
+   \param[in]  *fp          Output file (opened for binary write)
+   \param[in]  *wpdb        Structure to write
+   \param[in]  atomsOnly    The structure was read without HETATMs
+   \param[in]  *source      stat() information for the source PDB
+                            file (or NULL)
+   \return                  Success?
+
+   The gPDB... globals are recorded as they stand, so this should be
+   called straight after reading the structure.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Records the gPDB... globals
+-  19.10.26 Takes the stat() information of the source
+*/
+BOOL btWriteBinaryPDB(FILE *fp, WHOLEPDB *wpdb, BOOL atomsOnly,
+                      struct stat *source)
+{
+   BPDBHEADER header;
+   WHOLEPDB   wpdbImage;
+   PDB        pdbImage,
+              *p;
+   STRINGLIST *s;
+   ATOMREF    *refs;
+   int        i,
+              k,
+              index;
+   BOOL       ok = TRUE;
+
+   memset(&header, 0, sizeof(BPDBHEADER));
+   memcpy(header.magic, BPDB_MAGIC, BPDB_MAGICLEN);
+   header.version    = BPDB_VERSION;
+   header.atomsOnly  = atomsOnly;
+   btGetFileStamp(source, &(header.source));
+   header.partialOcc = gPDBPartialOcc;
+   header.multiNMR   = gPDBMultiNMR;
+   header.xml        = gPDBXML;
+   SetLayout(header.layout);
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      header.natoms++;
+      header.nconect += p->nConect;
+   }
+   for(s=wpdb->header; s!=NULL; NEXT(s))
+   {
+      header.nheader++;
+      header.headerBytes += strlen(s->string) + 1;
+   }
+   for(s=wpdb->trailer; s!=NULL; NEXT(s))
+   {
+      header.ntrailer++;
+      header.trailerBytes += strlen(s->string) + 1;
+   }
+   if(header.natoms == 0)
+      return(FALSE);
+
+   /* Sorted atom pointers so that CONECTs can be written as indices    */
+   if((refs = (ATOMREF *)malloc(header.natoms * sizeof(ATOMREF)))==NULL)
+      return(FALSE);
+   for(p=wpdb->pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      refs[i].atom  = p;
+      refs[i].index = i;
+   }
+   qsort(refs, header.natoms, sizeof(ATOMREF), CompareAtomRefs);
+
+   fwrite(&header, sizeof(BPDBHEADER), 1, fp);
+
+   wpdbImage         = *wpdb;
+   wpdbImage.pdb     = NULL;
+   wpdbImage.header  = NULL;
+   wpdbImage.trailer = NULL;
+   fwrite(&wpdbImage, sizeof(WHOLEPDB), 1, fp);
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      pdbImage        = *p;
+      pdbImage.next   = NULL;
+      pdbImage.extras = NULL;
+      memset(pdbImage.conect, 0, sizeof(pdbImage.conect));
+      fwrite(&pdbImage, sizeof(PDB), 1, fp);
+   }
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      for(k=0; k<p->nConect; k++)
+      {
+         if((index = FindAtomIndex(refs, header.natoms,
+                                   p->conect[k])) < 0)
+            ok = FALSE;
+         fwrite(&index, sizeof(int), 1, fp);
+      }
+   }
+
+   for(s=wpdb->header; s!=NULL; NEXT(s))
+      fwrite(s->string, 1, strlen(s->string) + 1, fp);
+   for(s=wpdb->trailer; s!=NULL; NEXT(s))
+      fwrite(s->string, 1, strlen(s->string) + 1, fp);
+
+   free(refs);
+
+   return(ok && !ferror(fp));
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadBinaryPDB(FILE *fp, BOOL atomsOnly)
+   ---------------------------------------------------
+*//**
+   \param[in]  *fp        Input file
+   \param[in]  atomsOnly  Discard HETATM records
+   \return                Structure read from a binary PDB file, or
+                          NULL if this is not a binary PDB file (in
+                          which case nothing has been consumed)
+
+   Checks the input for the binary PDB magic number. For a regular
+   file the complete magic number is checked without reading anything
+   and the file is mapped into memory. Other input can only be 
+   checked on its first byte and is read into a buffer. If the input
+   is a binary PDB file that cannot be loaded, a message is printed
+   and the input is left at end of file.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Checks the complete magic number of a regular file
+*/
+WHOLEPDB *btReadBinaryPDB(FILE *fp, BOOL atomsOnly)
+{
+   struct stat sbuf;
+   WHOLEPDB    *wpdb = NULL;
+   char        *data;
+   size_t      size;
+   long        offset;
+   int         c;
+   BOOL        mapped = FALSE;
+
+   if((c = getc(fp)) == EOF)
+      return(NULL);
+   ungetc(c, fp);
+   if(c != (BPDB_MAGIC[0] & 0xff))
+      return(NULL);
+
+   if(!fstat(fileno(fp), &sbuf) && S_ISREG(sbuf.st_mode) &&
+      ((offset = ftell(fp)) >= 0) && (offset < (long)sbuf.st_size))
+   {
+      if(!HasMagic(fp))
+         return(NULL);
+
+      size = (size_t)sbuf.st_size;
+      if((data = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE,
+                              fileno(fp), 0)) != (char *)MAP_FAILED)
+      {
+         wpdb   = LoadImage(data + offset, size - offset, atomsOnly,
+                            NULL);
+         munmap(data, size);
+         mapped = TRUE;
+         fseek(fp, 0L, SEEK_END);
+      }
+   }
+
+   if(!mapped)
+   {
+      if((data = ReadStream(fp, &size)) != NULL)
+      {
+         wpdb = LoadImage(data, size, atomsOnly, NULL);
+         free(data);
+      }
+   }
+
+   if(wpdb == NULL)
+      fprintf(stderr,"Error: Unable to load binary PDB file. It may be \
+corrupt, truncated or\n       written by an incompatible build. \
+Regenerate it with pdb2bin.\n");
+
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadCachedPDB(FILE *fp, BOOL atomsOnly)
+   ---------------------------------------------------
+*//**
+   \param[in]  *fp        Input PDB file
+   \param[in]  atomsOnly  Discard HETATM records
+   \return                Structure from the cache, or NULL if caching
+                          is off or there is no up-to-date entry
+
+   On success fp is left at end of file.
+
+-  19.10.26 Original   By: agent
+*/
+WHOLEPDB *btReadCachedPDB(FILE *fp, BOOL atomsOnly)
+{
+   struct stat sbuf,
+               cbuf;
+   char        path[MAXPATH],
+               *data;
+   FILE        *cache;
+   WHOLEPDB    *wpdb = NULL;
+   size_t      size;
+
+   if(!CachePath(fp, atomsOnly, TRUE, path, &sbuf))
+      return(NULL);
+   if((cache = fopen(path, "rb")) == NULL)
+      return(NULL);
+
+   if(!fstat(fileno(cache), &cbuf) && (cbuf.st_size > 0))
+   {
+      size = (size_t)cbuf.st_size;
+      if((data = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE,
+                              fileno(cache), 0)) != (char *)MAP_FAILED)
+      {
+         wpdb = LoadImage(data, size, atomsOnly, &sbuf);
+         munmap(data, size);
+      }
+   }
+   fclose(cache);
+
+   if(wpdb != NULL)
+      fseek(fp, 0L, SEEK_END);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>void btWriteCachedPDB(FILE *fp, WHOLEPDB *wpdb, BOOL atomsOnly)
+   ---------------------------------------------------------------
+*//**
+   \param[in]  *fp        Input PDB file that wpdb was read from (the
+                          whole file must have been read)
+   \param[in]  *wpdb      Structure read from it
+   \param[in]  atomsOnly  HETATM records were discarded
+
+   Stores the structure in the cache if caching is on. The image is
+   written under a temporary name and renamed so that concurrent
+   readers never see a partial file. The temporary file is made with
+   mkstemp() since the cache directory may be shared; a predictable
+   name could be replaced by a symbolic link. Failures are silently
+   ignored.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Makes the temporary file with mkstemp()
+*/
+void btWriteCachedPDB(FILE *fp, WHOLEPDB *wpdb, BOOL atomsOnly)
+{
+   struct stat sbuf;
+   char        path[MAXPATH],
+               tmpPath[MAXPATH+32];
+   FILE        *cache;
+   int         fd;
+   BOOL        ok;
+
+   if((wpdb == NULL) || !CachePath(fp, atomsOnly, FALSE, path, &sbuf))
+      return;
+
+   sprintf(tmpPath, "%s.XXXXXX", path);
+   if((fd = mkstemp(tmpPath)) == (-1))
+      return;
+   /* mkstemp() makes the file private; other users may share the cache */
+   if(fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) ||
+      ((cache = fdopen(fd, "wb")) == NULL))
+   {
+      close(fd);
+      unlink(tmpPath);
+      return;
+   }
+   ok = btWriteBinaryPDB(cache, wpdb, atomsOnly, &sbuf);
+   if(fclose(cache))
+      ok = FALSE;
+
+   if(!ok || rename(tmpPath, path))
+      unlink(tmpPath);
+}
+
+
+/************************************************************************/
+/*>void btGetFileStamp(struct stat *sbuf, BTFILESTAMP *stamp)
+   ----------------------------------------------------------
+*//**
+   \param[in]  *sbuf    stat() information for a file (or NULL)
+   \param[out] *stamp   Identification of that version of the file
+                        (all zero if sbuf is NULL)
+
+-  19.10.26 Original   By: agent
+*/
+void btGetFileStamp(struct stat *sbuf, BTFILESTAMP *stamp)
+{
+   memset(stamp, 0, sizeof(BTFILESTAMP));
+   if(sbuf == NULL)
+      return;
+
+   stamp->device    = (unsigned long)sbuf->st_dev;
+   stamp->inode     = (unsigned long)sbuf->st_ino;
+   stamp->size      = (long)sbuf->st_size;
+   stamp->mtime     = (long)sbuf->st_mtim.tv_sec;
+   stamp->mtimeNsec = (long)sbuf->st_mtim.tv_nsec;
+   stamp->ctime     = (long)sbuf->st_ctim.tv_sec;
+   stamp->ctimeNsec = (long)sbuf->st_ctim.tv_nsec;
+}
+
+
+/************************************************************************/
+/*>BOOL btSameFileStamp(BTFILESTAMP *a, BTFILESTAMP *b)
+   ----------------------------------------------------
+*//**
+   \param[in]  *a     First file stamp
+   \param[in]  *b     Second file stamp
+   \return            Are they the same version of the same file?
+
+   The status change time is included because it cannot be set back
+   with touch or utime(), so a file rewritten within the resolution of
+   the modification time (or given its old time) is still seen as
+   changed.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btSameFileStamp(BTFILESTAMP *a, BTFILESTAMP *b)
+{
+   return((a->device    == b->device)    &&
+          (a->inode     == b->inode)     &&
+          (a->size      == b->size)      &&
+          (a->mtime     == b->mtime)     &&
+          (a->mtimeNsec == b->mtimeNsec) &&
+          (a->ctime     == b->ctime)     &&
+          (a->ctimeNsec == b->ctimeNsec));
+}
+
+
+/************************************************************************/
+/*>static WHOLEPDB *LoadImage(char *data, size_t size, BOOL atomsOnly,
+                              struct stat *source)
+   -------------------------------------------------------------------
+*//**
+   \param[in]  *data      Binary PDB data
+   \param[in]  size       Size of the data
+   \param[in]  atomsOnly  Discard HETATM records
+   \param[in]  *source    If not NULL, the source file that the data
+                          must have been made from
+   \return                Structure (NULL if the data are not usable)
+
+   On success the gPDB... globals are set as they were when the 
+   structure was read.
+
+   Nothing is trusted: the header must match this build and its counts
+   must fit in the data (CheckCounts()), each atom's nConect must be
+   within MAXCONECT and they must add up to the header's count, every
+   CONECT index must be a valid atom and the strings must exactly fill
+   their blocks (LoadStrings()).
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Sets the gPDB... globals
+-  19.10.26 Checks the whole image. Source checked with a BTFILESTAMP
+*/
+static WHOLEPDB *LoadImage(char *data, size_t size, BOOL atomsOnly,
+                           struct stat *source)
+{
+   BPDBHEADER  header;
+   BTFILESTAMP stamp;
+   WHOLEPDB    *wpdb;
+   PDB         **atoms,
+               *last = NULL;
+   char        *ptr,
+               *keep;
+   int         layout[NLAYOUT],
+               i, j, k,
+               index;
+   long        nconect = 0;
+   BOOL        ok = TRUE;
+
+   if(size < sizeof(BPDBHEADER))
+      return(NULL);
+   memcpy(&header, data, sizeof(BPDBHEADER));
+   SetLayout(layout);
+
+   if(memcmp(header.magic, BPDB_MAGIC, BPDB_MAGICLEN) ||
+      (header.version != BPDB_VERSION) ||
+      memcmp(header.layout, layout, sizeof(layout)) ||
+      !CheckCounts(&header, size))
+      return(NULL);
+   if(source != NULL)
+   {
+      btGetFileStamp(source, &stamp);
+      if(!btSameFileStamp(&stamp, &(header.source)) ||
+         (header.atomsOnly != atomsOnly))
+         return(NULL);
+   }
+
+   if((wpdb = (WHOLEPDB *)malloc(sizeof(WHOLEPDB))) == NULL)
+      return(NULL);
+   ptr = data + sizeof(BPDBHEADER);
+   memcpy(wpdb, ptr, sizeof(WHOLEPDB));
+   ptr += sizeof(WHOLEPDB);
+   wpdb->pdb     = NULL;
+   wpdb->header  = NULL;
+   wpdb->trailer = NULL;
+   wpdb->natoms  = 0;
+
+   atoms = (PDB **)calloc(header.natoms, sizeof(PDB *));
+   keep  = (char *)malloc(header.natoms * sizeof(char));
+   if((atoms == NULL) || (keep == NULL))
+   {
+      FREE(atoms);
+      FREE(keep);
+      free(wpdb);
+      return(NULL);
+   }
+
+   /* Atom images                                                       */
+   for(i=0; i<header.natoms; i++)
+   {
+      if((atoms[i] = (PDB *)malloc(sizeof(PDB))) == NULL)
+      {
+         ok = FALSE;
+         break;
+      }
+      memcpy(atoms[i], ptr, sizeof(PDB));
+      ptr += sizeof(PDB);
+      atoms[i]->next   = NULL;
+      atoms[i]->extras = NULL;
+
+      if((atoms[i]->nConect < 0) || (atoms[i]->nConect > MAXCONECT))
+      {
+         ok = FALSE;
+         break;
+      }
+      nconect += atoms[i]->nConect;
+
+      /* Strings must be terminated within their arrays                 */
+      atoms[i]->record_type[sizeof(atoms[i]->record_type) - 1] = '\0';
+      atoms[i]->atnam[sizeof(atoms[i]->atnam) - 1]             = '\0';
+      atoms[i]->atnam_raw[sizeof(atoms[i]->atnam_raw) - 1]     = '\0';
+      atoms[i]->resnam[sizeof(atoms[i]->resnam) - 1]           = '\0';
+      atoms[i]->insert[sizeof(atoms[i]->insert) - 1]           = '\0';
+      atoms[i]->chain[sizeof(atoms[i]->chain) - 1]             = '\0';
+      atoms[i]->element[sizeof(atoms[i]->element) - 1]         = '\0';
+      atoms[i]->segid[sizeof(atoms[i]->segid) - 1]             = '\0';
+
+      keep[i] = !(atomsOnly && !header.atomsOnly &&
+                  !strncmp(atoms[i]->record_type, "HETATM", 6));
+   }
+   if(nconect != header.nconect)
+      ok = FALSE;
+
+   /* CONECT indices                                                    */
+   for(i=0; ok && (i<header.natoms); i++)
+   {
+      for(k=0; k<atoms[i]->nConect; k++)
+      {
+         memcpy(&index, ptr, sizeof(int));
+         ptr += sizeof(int);
+         if((index < 0) || (index >= header.natoms))
+         {
+            ok = FALSE;
+            break;
+         }
+         atoms[i]->conect[k] = atoms[index];
+      }
+   }
+
+   if(ok)
+   {
+      ok = LoadStrings(ptr, header.headerBytes, header.nheader,
+                       &(wpdb->header));
+      ptr += header.headerBytes;
+      if(ok)
+         ok = LoadStrings(ptr, header.trailerBytes, header.ntrailer,
+                          &(wpdb->trailer));
+   }
+
+   if(ok)
+   {
+      /* Link the atoms we are keeping, dropping CONECTs to the others  */
+      for(i=0; i<header.natoms; i++)
+      {
+         if(!keep[i])
+            continue;
+
+         for(k=0, j=0; k<atoms[i]->nConect; k++)
+         {
+            if(strncmp(atoms[i]->conect[k]->record_type, "HETATM", 6) ||
+               !atomsOnly || header.atomsOnly)
+               atoms[i]->conect[j++] = atoms[i]->conect[k];
+         }
+         atoms[i]->nConect = j;
+
+         if(last == NULL)
+            wpdb->pdb = atoms[i];
+         else
+            last->next = atoms[i];
+         last = atoms[i];
+         wpdb->natoms++;
+      }
+   }
+
+   /* Free what we are not keeping                                      */
+   for(i=0; i<header.natoms; i++)
+   {
+      if((atoms[i] != NULL) && (!ok || !keep[i]))
+         free(atoms[i]);
+   }
+   free(atoms);
+   free(keep);
+
+   if(!ok)
+   {
+      if(wpdb->header != NULL)
+         blFreeStringList(wpdb->header);
+      if(wpdb->trailer != NULL)
+         blFreeStringList(wpdb->trailer);
+      free(wpdb);
+      return(NULL);
+   }
+
+   gPDBPartialOcc    = header.partialOcc;
+   gPDBMultiNMR      = header.multiNMR;
+   gPDBXML           = header.xml;
+   gPDBModelNotFound = FALSE;
+
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static BOOL CheckCounts(BPDBHEADER *header, size_t size)
+   --------------------------------------------------------
+*//**
+   \param[in]  *header   Header of a binary PDB image
+   \param[in]  size      Size of the whole image
+   \return               Are the counts sane and do the blocks that 
+                         they describe fit in the image?
+
+   Each block is checked against what is left of the data so nothing
+   can overflow.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL CheckCounts(BPDBHEADER *header, size_t size)
+{
+   size_t remaining;
+
+   if(size < sizeof(BPDBHEADER) + sizeof(WHOLEPDB))
+      return(FALSE);
+   remaining = size - sizeof(BPDBHEADER) - sizeof(WHOLEPDB);
+
+   if((header->natoms <= 0) ||
+      ((unsigned long)header->natoms > remaining / sizeof(PDB)))
+      return(FALSE);
+   remaining -= (size_t)header->natoms * sizeof(PDB);
+
+   if((header->nconect < 0) ||
+      (header->nconect > header->natoms * MAXCONECT) ||
+      ((unsigned long)header->nconect > remaining / sizeof(int)))
+      return(FALSE);
+   remaining -= (size_t)header->nconect * sizeof(int);
+
+   if((header->headerBytes < 0) || (header->trailerBytes < 0) ||
+      ((unsigned long)header->headerBytes > remaining))
+      return(FALSE);
+   remaining -= (size_t)header->headerBytes;
+   if((unsigned long)header->trailerBytes > remaining)
+      return(FALSE);
+
+   /* Each string takes at least its terminating NUL                    */
+   if((header->nheader  < 0) || (header->nheader  > header->headerBytes) ||
+      (header->ntrailer < 0) || (header->ntrailer > header->trailerBytes))
+      return(FALSE);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL LoadStrings(char *data, long nbytes, long nstrings,
+                           STRINGLIST **list)
+   ---------------------------------------------------------------
+*//**
+   \param[in]  *data     NUL-terminated strings packed together
+   \param[in]  nbytes    Size of the block of strings
+   \param[in]  nstrings  Number of strings
+   \param[out] **list    Linked list of the strings (NULL on failure)
+   \return               Success (FALSE if a string is not terminated
+                         within the block, the strings do not exactly
+                         fill it or there was no memory)
+
+   Passes the current tail to blStoreString() so that building the
+   list is linear in the number of strings.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Checks the strings against the size of the block
+*/
+static BOOL LoadStrings(char *data, long nbytes, long nstrings,
+                        STRINGLIST **list)
+{
+   STRINGLIST *tail = NULL;
+   char       *end  = data + nbytes,
+              *eos;
+   long       i;
+
+   *list = NULL;
+   for(i=0; i<nstrings; i++)
+   {
+      if((eos = (char *)memchr(data, '\0', (size_t)(end - data)))
+         == NULL)
+         break;
+
+      if(tail == NULL)
+      {
+         if((*list = tail = blStoreString(NULL, data)) == NULL)
+            break;
+      }
+      else
+      {
+         if(blStoreString(tail, data) == NULL)
+            break;
+         NEXT(tail);
+      }
+      data = eos + 1;
+   }
+
+   if((i < nstrings) || (data != end))
+   {
+      if(*list != NULL)
+         blFreeStringList(*list);
+      *list = NULL;
+      return(FALSE);
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL HasMagic(FILE *fp)
+   ------------------------------
+*//**
+   \param[in]  *fp    Regular file
+   \return            Does the file have the binary PDB magic number at
+                      the current position?
+
+   Uses pread() so nothing is consumed from fp.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL HasMagic(FILE *fp)
+{
+   char magic[BPDB_MAGICLEN];
+   long offset;
+
+   if((offset = ftell(fp)) < 0)
+      return(FALSE);
+   if(pread(fileno(fp), magic, BPDB_MAGICLEN, (off_t)offset) !=
+      BPDB_MAGICLEN)
+      return(FALSE);
+   return(!memcmp(magic, BPDB_MAGIC, BPDB_MAGICLEN));
+}
+
+
+/************************************************************************/
+/*>static void SetLayout(int *layout)
+   ----------------------------------
+*//**
+   \param[out] *layout   Sizes and offsets that describe this build's
+                         structures
+
+-  19.10.26 Original   By: agent
+*/
+static void SetLayout(int *layout)
+{
+   layout[0] = (int)sizeof(PDB);
+   layout[1] = (int)sizeof(WHOLEPDB);
+   layout[2] = (int)sizeof(REAL);
+   layout[3] = (int)sizeof(long);
+   layout[4] = (int)offsetof(PDB, next);
+   layout[5] = (int)offsetof(PDB, conect);
+   layout[6] = (int)offsetof(PDB, nConect);
+   layout[7] = (int)offsetof(PDB, extras);
+}
+
+
+/************************************************************************/
+/*>static BOOL CachePath(FILE *fp, BOOL atomsOnly, BOOL atStart,
+                         char *path, struct stat *sbuf)
+   --------------------------------------------------------------
+*//**
+   \param[in]  *fp        Input PDB file
+   \param[in]  atomsOnly  HETATM records discarded
+   \param[in]  atStart    fp must be positioned at the start
+   \param[out] *path      Cache file name
+   \param[out] *sbuf      stat() information for fp
+   \return                Caching is on and fp is a suitable regular
+                          file
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL CachePath(FILE *fp, BOOL atomsOnly, BOOL atStart,
+                      char *path, struct stat *sbuf)
+{
+   char *dir;
+
+   if(((dir = getenv(ENV_CACHEDIR)) == NULL) || (dir[0] == '\0') ||
+      (strlen(dir) > MAXPATH - 64))
+      return(FALSE);
+   if(fstat(fileno(fp), sbuf) || !S_ISREG(sbuf->st_mode) ||
+      (atStart && (ftell(fp) != 0L)))
+      return(FALSE);
+
+   sprintf(path, "%s/%lx-%lx-%c%s", dir,
+           (unsigned long)sbuf->st_dev, (unsigned long)sbuf->st_ino,
+           (atomsOnly ? 'a' : 'w'), BPDB_EXTENSION);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static char *ReadStream(FILE *fp, size_t *size)
+   -----------------------------------------------
+*//**
+   \param[in]  *fp     Input stream
+   \param[out] *size   Number of bytes read
+   \return             Buffer containing the rest of the stream
+
+-  19.10.26 Original   By: agent
+*/
+static char *ReadStream(FILE *fp, size_t *size)
+{
+   char   *data = NULL,
+          *newData;
+   size_t allocated = 0,
+          nread;
+
+   *size = 0;
+   do
+   {
+      if(*size + READCHUNK > allocated)
+      {
+         allocated = 2 * allocated + READCHUNK;
+         if((newData = (char *)realloc(data, allocated)) == NULL)
+         {
+            FREE(data);
+            return(NULL);
+         }
+         data = newData;
+      }
+      nread  = fread(data + *size, 1, READCHUNK, fp);
+      *size += nread;
+   }  while(nread == READCHUNK);
+
+   return(data);
+}
+
+
+/************************************************************************/
+/*>static int CompareAtomRefs(const void *a, const void *b)
+   --------------------------------------------------------
+*//**
+   qsort() comparison of ATOMREFs by atom address
+
+-  19.10.26 Original   By: agent
+*/
+static int CompareAtomRefs(const void *a, const void *b)
+{
+   const char *pa = (const char *)((const ATOMREF *)a)->atom,
+              *pb = (const char *)((const ATOMREF *)b)->atom;
+
+   if(pa < pb)
+      return(-1);
+   if(pa > pb)
+      return(1);
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static int FindAtomIndex(ATOMREF *refs, int natoms, PDB *atom)
+   --------------------------------------------------------------
+*//**
+   \param[in]  *refs    ATOMREFs sorted by address
+   \param[in]  natoms   Number of ATOMREFs
+   \param[in]  *atom    Atom to find
+   \return              Index of the atom in the list (-1 if absent)
+
+-  19.10.26 Original   By: agent
+*/
+static int FindAtomIndex(ATOMREF *refs, int natoms, PDB *atom)
+{
+   ATOMREF key,
+           *found;
+
+   key.atom  = atom;
+   key.index = 0;
+   found = (ATOMREF *)bsearch(&key, refs, natoms, sizeof(ATOMREF),
+                              CompareAtomRefs);
+   return((found == NULL) ? -1 : found->index);
+}
+
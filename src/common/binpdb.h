@@ -0,0 +1,87 @@
+/************************************************************************/
+/**
+
+   \file       binpdb.h
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Binary structure images and the structure cache
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Reads and writes a WHOLEPDB (atoms, CONECT data, header and
+   trailer) as a binary image that can be loaded without parsing.
+   BTFILESTAMP identifies the version of a file that something was
+   made from.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added BTFILESTAMP. btWriteBinaryPDB() takes the
+                  stat() information of the source
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_BINPDB_H
+#define _BIOPTOOLS_BINPDB_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BPDB_MAGIC      "\211BPDB\r\n\032"
+#define BPDB_MAGICLEN   8
+#define BPDB_EXTENSION  ".bpdb"
+#define ENV_CACHEDIR    "BIOPTOOLS_CACHEDIR"
+
+typedef struct
+{
+   unsigned long device,
+                 inode;
+   long          size,
+                 mtime,
+                 mtimeNsec,
+                 ctime,
+                 ctimeNsec;
+}  BTFILESTAMP;
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL     btWriteBinaryPDB(FILE *fp, WHOLEPDB *wpdb, BOOL atomsOnly,
+                          struct stat *source);
+WHOLEPDB *btReadBinaryPDB(FILE *fp, BOOL atomsOnly);
+WHOLEPDB *btReadCachedPDB(FILE *fp, BOOL atomsOnly);
+void     btWriteCachedPDB(FILE *fp, WHOLEPDB *wpdb, BOOL atomsOnly);
+void     btGetFileStamp(struct stat *sbuf, BTFILESTAMP *stamp);
+BOOL     btSameFileStamp(BTFILESTAMP *a, BTFILESTAMP *b);
+
+#endif
@@ -0,0 +1,291 @@
+/************************************************************************/
+/**
+
+   \file       coords.c
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Packed coordinate arrays and batch distance routines
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The arrays are padded to a multiple of BT_COORD_ALIGN bytes and
+   placed in one allocation. The distance loop in btDistSqToPoint() has
+   no branches, so gcc at -O3 turns it into SIMD code for whatever the
+   target supports. Counts and minima are taken over blocks of
+   distances from that loop since gcc will not vectorise a floating
+   point minimum or a mixed double/int count without -ffast-math.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btTransformCoords()
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "coords.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define PERBLOCK  (BT_COORD_ALIGN / sizeof(REAL))
+#define PADDED(n) ((((n) + PERBLOCK - 1) / PERBLOCK) * PERBLOCK)
+#define DISTBLOCK 256            /* Distances computed at a time        */
+
+
+/************************************************************************/
+/*>COORDVIEW *btBuildCoordView(PDB *pdb, BOOL withRadius)
+   ------------------------------------------------------
+*//**
+   \param[in]  *pdb        PDB linked list
+   \param[in]  withRadius  Also copy the radius of each atom
+   \return                 The view (NULL if no memory)
+
+-  19.10.26 Original   By: agent
+*/
+COORDVIEW *btBuildCoordView(PDB *pdb, BOOL withRadius)
+{
+   COORDVIEW *view;
+   PDB       *p;
+   REAL      *base;
+   size_t    npad,
+             offset;
+   int       i;
+
+   if((view = (COORDVIEW *)calloc(1, sizeof(COORDVIEW))) == NULL)
+      return(NULL);
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      view->natoms++;
+
+   npad = PADDED((size_t)view->natoms + 1);
+   view->atoms = (PDB **)malloc((view->natoms+1) * sizeof(PDB *));
+   view->store = malloc((withRadius ? 4 : 3) * npad * sizeof(REAL) +
+                        BT_COORD_ALIGN);
+   if((view->atoms == NULL) || (view->store == NULL))
+   {
+      btFreeCoordView(view);
+      return(NULL);
+   }
+
+   offset = (size_t)view->store % BT_COORD_ALIGN;
+   base   = (REAL *)((char *)view->store +
+                     (offset ? BT_COORD_ALIGN - offset : 0));
+   view->x = base;
+   view->y = base + npad;
+   view->z = base + 2*npad;
+   if(withRadius)
+      view->radius = base + 3*npad;
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      view->atoms[i] = p;
+      view->x[i]     = p->x;
+      view->y[i]     = p->y;
+      view->z[i]     = p->z;
+      if(withRadius)
+         view->radius[i] = p->radius;
+   }
+   view->atoms[i] = NULL;
+
+   return(view);
+}
+
+
+/************************************************************************/
+/*>void btFreeCoordView(COORDVIEW *view)
+   -------------------------------------
+*//**
+   \param[in]  *view    View to free (the PDB list is not touched)
+
+-  19.10.26 Original   By: agent
+*/
+void btFreeCoordView(COORDVIEW *view)
+{
+   if(view == NULL)
+      return;
+
+   FREE(view->atoms);
+   FREE(view->store);
+   free(view);
+}
+
+
+/************************************************************************/
+/*>void btDistSqToPoint(COORDVIEW *view, int first, int last,
+                        REAL x, REAL y, REAL z, REAL *distSq)
+   ----------------------------------------------------------
+*//**
+   \param[in]  *view    Coordinate view
+   \param[in]  first    First atom
+   \param[in]  last     Atom after the last one
+   \param[in]  x        Point
+   \param[in]  y        Point
+   \param[in]  z        Point
+   \param[out] *distSq  Squared distance of atom first+i in distSq[i]
+
+-  19.10.26 Original   By: agent
+*/
+void btDistSqToPoint(COORDVIEW *view, int first, int last,
+                     REAL x, REAL y, REAL z, REAL *distSq)
+{
+   REAL *vx = view->x + first,
+        *vy = view->y + first,
+        *vz = view->z + first,
+        dx, dy, dz;
+   int  i,
+        n   = last - first;
+
+   for(i=0; i<n; i++)
+   {
+      dx = vx[i] - x;
+      dy = vy[i] - y;
+      dz = vz[i] - z;
+      distSq[i] = dx*dx + dy*dy + dz*dz;
+   }
+}
+
+
+/************************************************************************/
+/*>int btCountInRange(COORDVIEW *view, int first, int last,
+                      REAL x, REAL y, REAL z,
+                      REAL minDistSq, REAL maxDistSq)
+   --------------------------------------------------------
+*//**
+   \param[in]  *view      Coordinate view
+   \param[in]  first      First atom
+   \param[in]  last       Atom after the last one
+   \param[in]  x          Point
+   \param[in]  y          Point
+   \param[in]  z          Point
+   \param[in]  minDistSq  Lower bound on the squared distance (included)
+   \param[in]  maxDistSq  Upper bound on the squared distance (excluded)
+   \return                Number of atoms with minDistSq <= d^2 < maxDistSq
+
+-  19.10.26 Original   By: agent
+*/
+int btCountInRange(COORDVIEW *view, int first, int last,
+                   REAL x, REAL y, REAL z,
+                   REAL minDistSq, REAL maxDistSq)
+{
+   REAL distSq[DISTBLOCK];
+   int  i, n,
+        count = 0;
+
+   for(; first<last; first+=n)
+   {
+      n = MIN(last-first, DISTBLOCK);
+      btDistSqToPoint(view, first, first+n, x, y, z, distSq);
+      for(i=0; i<n; i++)
+      {
+         if((distSq[i] >= minDistSq) && (distSq[i] < maxDistSq))
+            count++;
+      }
+   }
+
+   return(count);
+}
+
+
+/************************************************************************/
+/*>REAL btMinDistSqToPoint(COORDVIEW *view, int first, int last,
+                           REAL x, REAL y, REAL z)
+   -------------------------------------------------------------
+*//**
+   \param[in]  *view    Coordinate view
+   \param[in]  first    First atom
+   \param[in]  last     Atom after the last one
+   \param[in]  x        Point
+   \param[in]  y        Point
+   \param[in]  z        Point
+   \return              Smallest squared distance from the point to an
+                        atom in the range (-1 if the range is empty)
+
+-  19.10.26 Original   By: agent
+*/
+REAL btMinDistSqToPoint(COORDVIEW *view, int first, int last,
+                        REAL x, REAL y, REAL z)
+{
+   REAL distSq[DISTBLOCK],
+        minDistSq = (REAL)(-1.0);
+   int  i, n;
+
+   for(; first<last; first+=n)
+   {
+      n = MIN(last-first, DISTBLOCK);
+      btDistSqToPoint(view, first, first+n, x, y, z, distSq);
+      for(i=0; i<n; i++)
+      {
+         if((minDistSq < (REAL)0.0) || (distSq[i] < minDistSq))
+            minDistSq = distSq[i];
+      }
+   }
+
+   return(minDistSq);
+}
+
+
+/************************************************************************/
+/*>void btTransformCoords(REAL matrix[3][4], REAL *x, REAL *y, REAL *z,
+                          int n)
+   --------------------------------------------------------------------
+*//**
+   \param[in]     matrix   Rotation (columns 0-2) and translation
+                           (column 3)
+   \param[in,out] *x       Coordinates
+   \param[in,out] *y       Coordinates
+   \param[in,out] *z       Coordinates
+   \param[in]     n        Number of coordinates
+
+   x' = matrix[0][0]x + matrix[0][1]y + matrix[0][2]z + matrix[0][3]
+   and so on for y' and z'.
+
+-  19.10.26 Original   By: agent
+*/
+void btTransformCoords(REAL matrix[3][4], REAL *x, REAL *y, REAL *z,
+                       int n)
+{
+   REAL m00 = matrix[0][0], m01 = matrix[0][1],
+        m02 = matrix[0][2], m03 = matrix[0][3],
+        m10 = matrix[1][0], m11 = matrix[1][1],
+        m12 = matrix[1][2], m13 = matrix[1][3],
+        m20 = matrix[2][0], m21 = matrix[2][1],
+        m22 = matrix[2][2], m23 = matrix[2][3],
+        xi, yi, zi;
+   int  i;
+
+   for(i=0; i<n; i++)
+   {
+      xi   = x[i];
+      yi   = y[i];
+      zi   = z[i];
+      x[i] = m00*xi + m01*yi + m02*zi + m03;
+      y[i] = m10*xi + m11*yi + m12*zi + m13;
+      z[i] = m20*xi + m21*yi + m22*zi + m23;
+   }
+}
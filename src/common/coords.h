@@ -0,0 +1,94 @@
+/************************************************************************/
+/**
+
+   \file       coords.h
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Packed coordinate arrays and batch distance routines
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A COORDVIEW holds the coordinates (and optionally the radii) of the
+   atoms of a PDB linked list in separate aligned arrays, in list
+   order, with a pointer back to each atom. Atom i of the view is
+   view->atoms[i]. Since the order is that of the list, a residue or
+   chain is a contiguous range of the view.
+
+   The batch routines work on a range of the view, first up to (but
+   not including) last, and are written so that the compiler can
+   vectorise them.
+
+   The view is a copy: if the atoms are moved, build it again.
+
+   btTransformCoords() applies a 3x4 matrix (rotation in the first
+   three columns, translation in the fourth) to packed coordinates,
+   whether or not they belong to a view.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btTransformCoords()
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_COORDS_H
+#define _BIOPTOOLS_COORDS_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BT_COORD_ALIGN 64        /* Alignment of the arrays (bytes)     */
+
+typedef struct
+{
+   REAL *x, *y, *z,
+        *radius;                 /* NULL unless asked for               */
+   PDB  **atoms;                 /* Atom for each entry                 */
+   void *store;                  /* Single allocation for the arrays    */
+   int  natoms;
+}  COORDVIEW;
+
+/************************************************************************/
+/* Prototypes
+*/
+COORDVIEW *btBuildCoordView(PDB *pdb, BOOL withRadius);
+void      btFreeCoordView(COORDVIEW *view);
+void      btDistSqToPoint(COORDVIEW *view, int first, int last,
+                          REAL x, REAL y, REAL z, REAL *distSq);
+int       btCountInRange(COORDVIEW *view, int first, int last,
+                         REAL x, REAL y, REAL z,
+                         REAL minDistSq, REAL maxDistSq);
+REAL      btMinDistSqToPoint(COORDVIEW *view, int first, int last,
+                             REAL x, REAL y, REAL z);
+void      btTransformCoords(REAL matrix[3][4], REAL *x, REAL *y, REAL *z,
+                            int n);
+
+#endif
@@ -0,0 +1,515 @@
+/************************************************************************/
+/**
+
+   \file       pdbfilter.c
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Filter the records of a PDB file as a stream
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   btFilterPDB() reads a PDB file a line at a time and writes each line
+   out unchanged or drops it:
+   - ATOM and HETATM records are passed to a callback which decides
+     whether they are kept
+   - ANISOU, SIGATM and SIGUIJ records go with the atom before them
+   - a TER record is kept only if an atom has been kept since the
+     previous TER or MODEL record, so no empty chains are left
+   - everything else (the header, MODEL and ENDMDL records, the
+     trailer) is copied verbatim
+
+   Unlike reading the file with blReadWholePDB(), every model is
+   filtered, alternate positions are all kept and records are not
+   reformatted. CONECT and MASTER records are copied as they are, so
+   they may refer to atoms that have been removed.
+
+   With coordsOnly, only the kept ATOM and HETATM records and the TER
+   records of the first model are written, as blReadPDB() would read
+   them.
+
+   btTransformPDB() copies a file in the same way, applying a matrix to
+   the coordinates of every ATOM and HETATM record. Records are read in
+   batches of TRANSBATCH so that the coordinates can be transformed
+   together with btTransformCoords(); only the coordinate columns of a
+   record are rewritten. As with blApplyMatrixPDB(), atoms with NULL
+   coordinates (9999.0) are not moved. ANISOU and SIGUIJ records would
+   no longer be right after a rotation so they are dropped unless the
+   matrix is a pure translation.
+
+   btPDBCentroid() finds the centre of geometry in a first pass over the
+   file with btStreamPDB(), so it uses the same atoms as blGetCofGPDB()
+   on the structure read by blReadWholePDB(), and then returns to the
+   start of the file. It needs a file that can be repositioned.
+
+   Binary PDB and PDBML input, and a structure passed in memory from a
+   previous program in an in-process pipeline, cannot be filtered like
+   this; btCanFilterPDB() says whether the input can be.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btTransformPDB() and btPDBCentroid()
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+#include "coords.h"
+#include "pdbstream.h"
+#include "pipeline.h"
+#include "pdbfilter.h"
+#include "timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXLINE  1024
+#define OUTBUFF  (1024*1024)   /* stdio buffer for the output file      */
+#define TRANSBATCH 256         /* Records transformed together          */
+#define MINCOORDLEN 54         /* Record must reach the end of z        */
+#define NULLCOORD ((REAL)9999.0)
+
+typedef struct
+{
+   REAL x, y, z;
+   long natoms;
+}  CENTROIDSUM;
+
+#define ISRECORD(line, rec) (!strncmp((line), (rec), strlen(rec)))
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL WriteBatch(FILE *out, char (*lines)[MAXLINE], int nlines,
+                       REAL matrix[3][4], REAL *x, REAL *y, REAL *z,
+                       int *lineOfCoord, int ncoords);
+static BOOL IsTranslation(REAL matrix[3][4]);
+static BOOL AddToCentroid(PDB *p, void *data);
+
+
+/************************************************************************/
+/*>BOOL btCanFilterPDB(FILE *fp)
+   -----------------------------
+*//**
+   \param[in]  *fp    Input file
+   \return            Can the file be filtered with btFilterPDB()?
+
+   Peeks at the first character of the input without consuming it.
+   Binary PDB and PDBML files and input passed from an earlier stage of
+   an in-process pipeline must be read as a whole. Anything else that
+   does not start with a printable character (including white space)
+   is also left to the normal readers.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btCanFilterPDB(FILE *fp)
+{
+   int c;
+
+   if((fp == btPipeInput()) && (fp != NULL))
+      return(FALSE);
+
+   if((c = getc(fp)) == EOF)
+      return(TRUE);
+   ungetc(c, fp);
+
+   return(isprint(c) && (c != ' ') && (c != '<'));
+}
+
+
+/************************************************************************/
+/*>BOOL btFilterPDB(FILE *in, FILE *out, BOOL coordsOnly,
+                    RECORDFUNC keepFunc, void *data, int *natoms)
+   --------------------------------------------------------------
+*//**
+   \param[in]  *in         Input PDB file
+   \param[in]  *out        Output file (nothing must have been written
+                           to it yet)
+   \param[in]  coordsOnly  Write only the coordinate and TER records of
+                           the first model
+   \param[in]  keepFunc    Called with each ATOM and HETATM record;
+                           returns TRUE to keep it
+   \param[in]  *data       Passed to keepFunc
+   \param[out] *natoms     Number of atoms written
+   \return                 Success? (FALSE on a read or write error)
+
+   Copies the input to the output, keeping or dropping records as
+   described in the file header. Lines longer than the buffer are
+   passed to keepFunc truncated and then copied or dropped whole.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btFilterPDB(FILE *in, FILE *out, BOOL coordsOnly,
+                 RECORDFUNC keepFunc, void *data, int *natoms)
+{
+   char line[MAXLINE];
+   long nread        = 0;
+   BOOL newRecord    = TRUE,
+        write        = FALSE,
+        atomKept     = FALSE,
+        keptSinceTer = FALSE,
+        ok           = TRUE;
+
+   *natoms = 0;
+   setvbuf(out, NULL, _IOFBF, OUTBUFF);
+
+   while(fgets(line, MAXLINE, in))
+   {
+      /* The rest of an over-long line goes the same way as its start   */
+      if(newRecord)
+      {
+         if(ISRECORD(line, "ATOM  ") || ISRECORD(line, "HETATM"))
+         {
+            nread++;
+            atomKept = (*keepFunc)(line, data);
+            write    = atomKept;
+            if(atomKept)
+            {
+               (*natoms)++;
+               keptSinceTer = TRUE;
+            }
+         }
+         else if(ISRECORD(line, "ANISOU") || ISRECORD(line, "SIGATM") ||
+                 ISRECORD(line, "SIGUIJ"))
+         {
+            write = atomKept && !coordsOnly;
+         }
+         else if(ISRECORD(line, "TER"))
+         {
+            write        = keptSinceTer;
+            keptSinceTer = FALSE;
+         }
+         else if(ISRECORD(line, "MODEL "))
+         {
+            write        = !coordsOnly;
+            atomKept     = FALSE;
+            keptSinceTer = FALSE;
+         }
+         else if(ISRECORD(line, "ENDMDL") && coordsOnly)
+         {
+            break;
+         }
+         else
+         {
+            write = !coordsOnly;
+         }
+      }
+
+      if(write && (fputs(line, out) == EOF))
+      {
+         ok = FALSE;
+         break;
+      }
+      newRecord = (strchr(line, '\n') != NULL);
+   }
+
+   if(ferror(in) || (fflush(out) == EOF))
+      ok = FALSE;
+
+   btAddCount("atoms_read",    nread);
+   btAddCount("atoms_written", (long)(*natoms));
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>REAL btRecordReal(char *record, int start, int width)
+   -----------------------------------------------------
+*//**
+   \param[in]  *record   PDB record
+   \param[in]  start     Offset of the field
+   \param[in]  width     Width of the field
+   \return               Value of the field (0.0 if blank or missing)
+
+   Reads a number from a fixed-column field, allowing for a record that
+   ends before the field does.
+
+-  19.10.26 Original   By: agent
+*/
+REAL btRecordReal(char *record, int start, int width)
+{
+   char buffer[16];
+   int  i;
+
+   if(width > 15)
+      width = 15;
+
+   for(i=0; i<start; i++)
+   {
+      if((record[i] == '\0') || (record[i] == '\n'))
+         return((REAL)0.0);
+   }
+   for(i=0; (i<width) && record[start+i] && (record[start+i] != '\n');
+       i++)
+   {
+      buffer[i] = record[start+i];
+   }
+   buffer[i] = '\0';
+
+   return((REAL)atof(buffer));
+}
+
+
+/************************************************************************/
+/*>BOOL btTransformPDB(FILE *in, FILE *out, REAL matrix[3][4],
+                       int *natoms)
+   -----------------------------------------------------------
+*//**
+   \param[in]  *in       Input PDB file
+   \param[in]  *out      Output file (nothing must have been written to
+                         it yet)
+   \param[in]  matrix    Rotation (columns 0-2) and translation
+                         (column 3) as for btTransformCoords()
+   \param[out] *natoms   Number of atoms moved
+   \return               Success? (FALSE on a read or write error or if
+                         there was no memory)
+
+   Copies the input to the output, moving every atom as described in
+   the file header.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btTransformPDB(FILE *in, FILE *out, REAL matrix[3][4], int *natoms)
+{
+   char (*lines)[MAXLINE];
+   REAL x[TRANSBATCH],
+        y[TRANSBATCH],
+        z[TRANSBATCH];
+   int  lineOfCoord[TRANSBATCH],
+        nlines     = 0,
+        ncoords    = 0;
+   BOOL newRecord  = TRUE,
+        drop       = FALSE,
+        keepAniso  = IsTranslation(matrix),
+        ok         = TRUE;
+
+   *natoms = 0;
+   if((lines = (char (*)[MAXLINE])malloc(TRANSBATCH * MAXLINE)) == NULL)
+      return(FALSE);
+   setvbuf(out, NULL, _IOFBF, OUTBUFF);
+
+   while(ok && fgets(lines[nlines], MAXLINE, in))
+   {
+      char *line = lines[nlines];
+
+      /* The rest of an over-long line goes the same way as its start   */
+      if(newRecord)
+      {
+         drop = (ISRECORD(line, "ANISOU") || ISRECORD(line, "SIGUIJ")) &&
+                !keepAniso;
+
+         if(!drop &&
+            (ISRECORD(line, "ATOM  ") || ISRECORD(line, "HETATM")) &&
+            (strlen(line) >= MINCOORDLEN))
+         {
+            x[ncoords] = btRecordReal(line, 30, 8);
+            y[ncoords] = btRecordReal(line, 38, 8);
+            z[ncoords] = btRecordReal(line, 46, 8);
+            if((x[ncoords] != NULLCOORD) || (y[ncoords] != NULLCOORD) ||
+               (z[ncoords] != NULLCOORD))
+            {
+               lineOfCoord[ncoords++] = nlines;
+            }
+         }
+      }
+      newRecord = (strchr(line, '\n') != NULL);
+      if(drop)
+         continue;
+
+      if(++nlines == TRANSBATCH)
+      {
+         ok = WriteBatch(out, lines, nlines, matrix, x, y, z,
+                         lineOfCoord, ncoords);
+         *natoms += ncoords;
+         nlines = ncoords = 0;
+      }
+   }
+
+   if(ok)
+   {
+      ok = WriteBatch(out, lines, nlines, matrix, x, y, z,
+                      lineOfCoord, ncoords);
+      *natoms += ncoords;
+   }
+
+   if(ferror(in) || (fflush(out) == EOF))
+      ok = FALSE;
+
+   free(lines);
+   btAddCount("atoms_moved", (long)(*natoms));
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL btPDBCentroid(FILE *fp, VEC3F *centroid)
+   ---------------------------------------------
+*//**
+   \param[in]  *fp         Input PDB file
+   \param[out] *centroid   Centre of geometry
+   \return                 Success? (FALSE if the file cannot be
+                           repositioned or read)
+
+   Finds the centre of geometry of the atoms that blReadWholePDB()
+   would read, then returns to where the file was. If the file cannot
+   be repositioned, nothing is read from it.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btPDBCentroid(FILE *fp, VEC3F *centroid)
+{
+   CENTROIDSUM sum;
+   long        start;
+   BOOL        ok;
+
+   if((start = ftell(fp)) < 0)
+      return(FALSE);
+
+   sum.x = sum.y = sum.z = (REAL)0.0;
+   sum.natoms = 0;
+   ok = btStreamPDB(fp, FALSE, NULL, AddToCentroid, (void *)&sum);
+
+   /* Go back to the start even if the read failed                      */
+   clearerr(fp);
+   if(fseek(fp, start, SEEK_SET) || !ok)
+      return(FALSE);
+
+   centroid->x = centroid->y = centroid->z = (REAL)0.0;
+   if(sum.natoms)
+   {
+      centroid->x = sum.x / (REAL)sum.natoms;
+      centroid->y = sum.y / (REAL)sum.natoms;
+      centroid->z = sum.z / (REAL)sum.natoms;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteBatch(FILE *out, char (*lines)[MAXLINE], int nlines,
+                          REAL matrix[3][4], REAL *x, REAL *y, REAL *z,
+                          int *lineOfCoord, int ncoords)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]     *out          Output file
+   \param[in,out] lines         Records read
+   \param[in]     nlines        Number of records
+   \param[in]     matrix        Transformation
+   \param[in,out] *x            Coordinates of the atoms to move
+   \param[in,out] *y            Coordinates of the atoms to move
+   \param[in,out] *z            Coordinates of the atoms to move
+   \param[in]     *lineOfCoord  Record holding each atom
+   \param[in]     ncoords       Number of atoms to move
+   \return                      Success?
+
+   Transforms a batch of coordinates, writes them back into their
+   records and writes the records out.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL WriteBatch(FILE *out, char (*lines)[MAXLINE], int nlines,
+                       REAL matrix[3][4], REAL *x, REAL *y, REAL *z,
+                       int *lineOfCoord, int ncoords)
+{
+   char buffer[MAXLINE];
+   int  i;
+
+   btTransformCoords(matrix, x, y, z, ncoords);
+
+   for(i=0; i<ncoords; i++)
+   {
+      sprintf(buffer, "%8.3f%8.3f%8.3f", x[i], y[i], z[i]);
+      if(strlen(buffer) == 24)
+         memcpy(lines[lineOfCoord[i]]+30, buffer, 24);
+   }
+
+   for(i=0; i<nlines; i++)
+   {
+      if(fputs(lines[i], out) == EOF)
+         return(FALSE);
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL IsTranslation(REAL matrix[3][4])
+   --------------------------------------------
+*//**
+   \param[in]  matrix   Transformation
+   \return              Is the rotation part the identity?
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL IsTranslation(REAL matrix[3][4])
+{
+   int i, j;
+
+   for(i=0; i<3; i++)
+   {
+      for(j=0; j<3; j++)
+      {
+         if(matrix[i][j] != ((i==j) ? (REAL)1.0 : (REAL)0.0))
+            return(FALSE);
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddToCentroid(PDB *p, void *data)
+   ---------------------------------------------
+*//**
+   \param[in]     *p      Atom from btStreamPDB() (freed here)
+   \param[in,out] *data   CENTROIDSUM
+   \return                TRUE
+
+   Atoms with NULL coordinates are skipped as in blGetCofGPDB()
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL AddToCentroid(PDB *p, void *data)
+{
+   CENTROIDSUM *sum = (CENTROIDSUM *)data;
+
+   if((p->x != NULLCOORD) || (p->y != NULLCOORD) || (p->z != NULLCOORD))
+   {
+      sum->x += p->x;
+      sum->y += p->y;
+      sum->z += p->z;
+      sum->natoms++;
+   }
+   free(p);
+   return(TRUE);
+}
@@ -0,0 +1,69 @@
+/************************************************************************/
+/**
+
+   \file       pdbfilter.h
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Filter the records of a PDB file as a stream
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Line filter for programs that only decide whether to keep each
+   coordinate record, or that move every atom in the same way. Records
+   are copied from input to output as they are read, so memory use is
+   constant.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btTransformPDB() and btPDBCentroid()
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBFILTER_H
+#define _BIOPTOOLS_PDBFILTER_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef BOOL (*RECORDFUNC)(char *record, void *data);
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL btCanFilterPDB(FILE *fp);
+BOOL btFilterPDB(FILE *in, FILE *out, BOOL coordsOnly,
+                 RECORDFUNC keepFunc, void *data, int *natoms);
+REAL btRecordReal(char *record, int start, int width);
+BOOL btTransformPDB(FILE *in, FILE *out, REAL matrix[3][4], int *natoms);
+BOOL btPDBCentroid(FILE *fp, VEC3F *centroid);
+
+#endif
@@ -0,0 +1,907 @@
+/************************************************************************/
+/**
+
+   \file       pdbmlread.c
+
+   \version    V1.2
+   \date       19.10.26
+   \brief      Streaming PDBML reader
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Reads PDBML with the libxml2 SAX2 push parser rather than building a
+   document tree, so memory use does not depend on the size of the XML.
+   The file is fed to the parser in blocks with fread() and so may be a
+   pipe (e.g. decompressed input from btOpenStdFiles()).
+
+   The fields of each atom_site element are collected as they are
+   parsed and a PDB structure is built when the element closes. Atoms
+   are held back (in a RESBUFFER from pdbstream.c) only until the end of
+   their residue so that alternate positions can be resolved: as with
+   blReadPDB(), the alternate with the highest occupancy is kept (the
+   first if they are equal). Only the first model is read. The author
+   (auth_*) fields are used in preference to the label_* fields, as in
+   a PDB file.
+
+   btStreamPDBML() hands each atom to a callback as soon as its residue
+   is complete. btReadWholePDBML() uses this to build a WHOLEPDB and
+   also converts the key header information (classification, date,
+   PDB code, title and experimental method) into HEADER, TITLE and
+   EXPDTA records.
+
+   As with blReadPDB(), gPDBXML is set, gPDBMultiNMR is set to the
+   number of models if there is more than one and gPDBPartialOcc is set
+   if any atom has an occupancy below 1.0, so callers can tell what
+   was dropped.
+
+   If compiled without XML_SUPPORT, the functions report an error.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Uses the residue buffer from pdbstream.c
+-  V1.2  19.10.26 Counts the models and sets the gPDB... globals
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#ifdef XML_SUPPORT
+#include <libxml/parser.h>
+#endif
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "pdbstream.h"
+#include "pdbmlread.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define IOBUFFSIZE    65536
+#define MAXFIELD      32    /* Longest atom_site field we keep         */
+#define MAXTEXT       1024  /* Longest header field we keep            */
+#define MAXHEADERLINE 96
+#define TITLEWIDTH    70    /* Text on the first TITLE line            */
+#define TITLECONTWIDTH 69   /* Text on continuation TITLE lines        */
+
+/* Element depths in the PDBML tree                                     */
+#define DEPTH_DATABLOCK 1
+#define DEPTH_CATEGORY  2
+#define DEPTH_ROW       3
+#define DEPTH_FIELD     4
+
+/* Categories that we read                                              */
+#define CAT_NONE      0
+#define CAT_ATOMSITE  1
+#define CAT_KEYWORDS  2
+#define CAT_STRUCT    3
+#define CAT_EXPTL     4
+#define CAT_STATUS    5
+
+/* atom_site fields                                                     */
+#define F_GROUP       0
+#define F_X           1
+#define F_Y           2
+#define F_Z           3
+#define F_OCC         4
+#define F_BVAL        5
+#define F_AUTHATOM    6
+#define F_LABELATOM   7
+#define F_AUTHCOMP    8
+#define F_LABELCOMP   9
+#define F_AUTHASYM    10
+#define F_LABELASYM   11
+#define F_AUTHSEQ     12
+#define F_LABELSEQ    13
+#define F_INSERT      14
+#define F_ALTPOS      15
+#define F_MODEL       16
+#define F_ELEMENT     17
+#define F_CHARGE      18
+#define NFIELDS       19
+
+/* Header fields                                                        */
+#define H_KEYWORDS    (NFIELDS)
+#define H_TITLE       (NFIELDS+1)
+#define H_DATE        (NFIELDS+2)
+
+#define NONE          (-1)
+
+/* Value of the field, or the fallback if the field is empty            */
+#define FIELD(s, f, alt) ((s)->fields[(f)][0] ? (s)->fields[(f)] : \
+                                                (s)->fields[(alt)])
+
+typedef struct
+{
+   BOOL (*atomFunc)(PDB *p, void *data);
+   void *data,
+        *ctxt;                 /* libxml2 parser context                */
+   RESBUFFER resBuffer;        /* Atoms of the current residue          */
+   int  depth,
+        category,
+        field,
+        textLen,
+        modelNum,
+        lastModel,
+        nmodels,
+        atnum;
+   BOOL atomsOnly,
+        gotModel,
+        partialOcc,
+        nil,
+        ok;
+   char fields[NFIELDS][MAXFIELD],
+        text[MAXTEXT],
+        idcode[MAXFIELD],
+        keywords[MAXTEXT],
+        date[MAXFIELD],
+        title[MAXTEXT],
+        method[MAXTEXT];
+}  PDBMLSTATE;
+
+typedef struct
+{
+   PDB  *pdb,
+        *last;
+   int  natoms;
+}  ATOMLIST;
+
+/************************************************************************/
+/* Globals
+*/
+#ifdef XML_SUPPORT
+static char *sAtomFields[NFIELDS] =
+{
+   "group_PDB",          "Cartn_x",            "Cartn_y",
+   "Cartn_z",            "occupancy",          "B_iso_or_equiv",
+   "auth_atom_id",       "label_atom_id",      "auth_comp_id",
+   "label_comp_id",      "auth_asym_id",       "label_asym_id",
+   "auth_seq_id",        "label_seq_id",       "pdbx_PDB_ins_code",
+   "label_alt_id",       "pdbx_PDB_model_num", "type_symbol",
+   "pdbx_formal_charge"
+};
+#endif
+
+/************************************************************************/
+/* Prototypes
+*/
+#ifdef XML_SUPPORT
+static BOOL ParsePDBML(FILE *fp, PDBMLSTATE *state);
+static void StartElement(void *ctx, const xmlChar *localname,
+                         const xmlChar *prefix, const xmlChar *URI,
+                         int nNamespaces, const xmlChar **namespaces,
+                         int nAttributes, int nDefaulted,
+                         const xmlChar **attributes);
+static void EndElement(void *ctx, const xmlChar *localname,
+                       const xmlChar *prefix, const xmlChar *URI);
+static void Characters(void *ctx, const xmlChar *ch, int len);
+static void GetAttribute(const xmlChar **attributes, int nAttributes,
+                         char *name, char *value, int maxlen);
+static void InitState(PDBMLSTATE *state, BOOL atomsOnly,
+                      BOOL (*atomFunc)(PDB *p, void *data), void *data);
+static void EndAtomSite(PDBMLSTATE *state);
+static PDB  *BuildAtom(PDBMLSTATE *state);
+static BOOL AppendAtom(PDB *p, void *data);
+static STRINGLIST *BuildHeader(PDBMLSTATE *state);
+static void FormatDate(char *date, char *pdbDate);
+static void CopyField(char *out, char *in, int maxlen);
+#endif
+
+
+/************************************************************************/
+/*>BOOL btIsPDBML(FILE *fp)
+   ------------------------
+*//**
+   \param[in]  *fp    File pointer
+   \return            Does the file look like XML?
+
+   Peeks at the first non-blank character without consuming it.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btIsPDBML(FILE *fp)
+{
+   int c;
+
+   while(((c = getc(fp)) != EOF) && isspace(c));
+   if(c == EOF)
+      return(FALSE);
+   ungetc(c, fp);
+   return(c == '<');
+}
+
+
+/************************************************************************/
+/*>BOOL btStreamPDBML(FILE *fp, BOOL atomsOnly,
+                      BOOL (*atomFunc)(PDB *p, void *data), void *data)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]  *fp         PDBML file pointer
+   \param[in]  atomsOnly   Discard HETATM records
+   \param[in]  *atomFunc   Called with each atom and data. The function
+                           takes ownership of the PDB item and returns
+                           FALSE to stop the parse
+   \param[in]  *data       Passed to atomFunc
+   \return                 Success?
+
+   Parses a PDBML file, passing atoms to atomFunc in file order.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btStreamPDBML(FILE *fp, BOOL atomsOnly,
+                   BOOL (*atomFunc)(PDB *p, void *data), void *data)
+{
+#ifdef XML_SUPPORT
+   PDBMLSTATE *state;
+   BOOL       ok;
+
+   if((state = (PDBMLSTATE *)malloc(sizeof(PDBMLSTATE))) == NULL)
+      return(FALSE);
+   InitState(state, atomsOnly, atomFunc, data);
+   ok = ParsePDBML(fp, state);
+   free(state);
+   return(ok);
+#else
+   fprintf(stderr, "PDBML support was not compiled in\n");
+   return(FALSE);
+#endif
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadWholePDBML(FILE *fp, BOOL atomsOnly)
+   ----------------------------------------------------
+*//**
+   \param[in]  *fp         PDBML file pointer
+   \param[in]  atomsOnly   Discard HETATM records
+   \return                 WHOLEPDB structure (NULL on failure or if
+                           there were no atoms)
+
+   Reads a PDBML file into a WHOLEPDB structure with a header built
+   from the key header categories.
+
+-  19.10.26 Original   By: agent
+*/
+WHOLEPDB *btReadWholePDBML(FILE *fp, BOOL atomsOnly)
+{
+#ifdef XML_SUPPORT
+   PDBMLSTATE *state;
+   WHOLEPDB   *wpdb = NULL;
+   ATOMLIST   atoms;
+
+   atoms.pdb    = atoms.last = NULL;
+   atoms.natoms = 0;
+
+   if((state = (PDBMLSTATE *)malloc(sizeof(PDBMLSTATE))) == NULL)
+      return(NULL);
+   InitState(state, atomsOnly, AppendAtom, (void *)&atoms);
+
+   if(ParsePDBML(fp, state) && (atoms.pdb != NULL) &&
+      ((wpdb = (WHOLEPDB *)malloc(sizeof(WHOLEPDB))) != NULL))
+   {
+      memset(wpdb, 0, sizeof(WHOLEPDB));
+      wpdb->pdb     = atoms.pdb;
+      wpdb->natoms  = atoms.natoms;
+      wpdb->header  = BuildHeader(state);
+      wpdb->trailer = NULL;
+      blSetAtomTypes(wpdb->pdb);
+   }
+   else
+   {
+      FREELIST(atoms.pdb, PDB);
+   }
+
+   free(state);
+   return(wpdb);
+#else
+   fprintf(stderr, "PDBML support was not compiled in\n");
+   return(NULL);
+#endif
+}
+
+
+#ifdef XML_SUPPORT
+/************************************************************************/
+/*>static void InitState(PDBMLSTATE *state, BOOL atomsOnly,
+                         BOOL (*atomFunc)(PDB *p, void *data),
+                         void *data)
+   ---------------------------------------------------------------
+*//**
+   \param[out] *state      Parser state
+   \param[in]  atomsOnly   Discard HETATM records
+   \param[in]  *atomFunc   Atom callback
+   \param[in]  *data       Passed to atomFunc
+
+-  19.10.26 Original   By: agent
+*/
+static void InitState(PDBMLSTATE *state, BOOL atomsOnly,
+                      BOOL (*atomFunc)(PDB *p, void *data), void *data)
+{
+   memset(state, 0, sizeof(PDBMLSTATE));
+   state->atomFunc  = atomFunc;
+   state->data      = data;
+   state->atomsOnly = atomsOnly;
+   state->category  = CAT_NONE;
+   state->field     = NONE;
+   state->ok        = TRUE;
+}
+
+
+/************************************************************************/
+/*>static BOOL ParsePDBML(FILE *fp, PDBMLSTATE *state)
+   ---------------------------------------------------
+*//**
+   \param[in]     *fp       PDBML file pointer
+   \param[in,out] *state    Parser state
+   \return                  Success?
+
+   Feeds the file to the libxml2 push parser and sets the gPDB...
+   globals. Only errors in the XML itself are reported here.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Sets the gPDB... globals. Does not report a parse stopped by
+            the callback as a parse error
+*/
+static BOOL ParsePDBML(FILE *fp, PDBMLSTATE *state)
+{
+   xmlSAXHandler    sax;
+   xmlParserCtxtPtr ctxt;
+   char             *buffer;
+   size_t           nread;
+   BOOL             ok = TRUE;
+
+   memset(&sax, 0, sizeof(xmlSAXHandler));
+   sax.initialized    = XML_SAX2_MAGIC;
+   sax.startElementNs = StartElement;
+   sax.endElementNs   = EndElement;
+   sax.characters     = Characters;
+
+   if((buffer = (char *)malloc(IOBUFFSIZE)) == NULL)
+      return(FALSE);
+   if((ctxt = xmlCreatePushParserCtxt(&sax, state, NULL, 0, NULL)) == NULL)
+   {
+      free(buffer);
+      return(FALSE);
+   }
+   xmlCtxtUseOptions(ctxt, XML_PARSE_NONET);
+   state->ctxt = (void *)ctxt;
+
+   while(ok && state->ok &&
+         ((nread = fread(buffer, 1, IOBUFFSIZE, fp)) > 0))
+   {
+      if(xmlParseChunk(ctxt, buffer, (int)nread, 0))
+         ok = FALSE;
+   }
+   if(ok && state->ok)
+   {
+      if(xmlParseChunk(ctxt, NULL, 0, 1) || !ctxt->wellFormed)
+         ok = FALSE;
+   }
+
+   /* If the parser was stopped (by the callback or for lack of memory)
+      the caller reports it
+   */
+   if(!ok && state->ok)
+      fprintf(stderr, "Error parsing PDBML file\n");
+
+   /* Anything left from an unterminated file is discarded              */
+   btFreeResidueBuffer(&(state->resBuffer));
+
+   xmlFreeParserCtxt(ctxt);
+   free(buffer);
+
+   gPDBXML           = TRUE;
+   gPDBMultiNMR      = (state->nmodels > 1) ? state->nmodels : 0;
+   gPDBPartialOcc    = state->partialOcc;
+   gPDBModelNotFound = FALSE;
+
+   return(ok && state->ok);
+}
+
+
+/************************************************************************/
+/*>static void StartElement(void *ctx, const xmlChar *localname,
+                            const xmlChar *prefix, const xmlChar *URI,
+                            int nNamespaces, const xmlChar **namespaces,
+                            int nAttributes, int nDefaulted,
+                            const xmlChar **attributes)
+   --------------------------------------------------------------------
+*//**
+   SAX2 start element handler. Tracks the category and the field being
+   read and picks up the attributes that carry data.
+
+-  19.10.26 Original   By: agent
+*/
+static void StartElement(void *ctx, const xmlChar *localname,
+                         const xmlChar *prefix, const xmlChar *URI,
+                         int nNamespaces, const xmlChar **namespaces,
+                         int nAttributes, int nDefaulted,
+                         const xmlChar **attributes)
+{
+   PDBMLSTATE *state = (PDBMLSTATE *)ctx;
+   char       *name  = (char *)localname,
+              value[MAXFIELD];
+   int        i;
+
+   state->depth++;
+
+   switch(state->depth)
+   {
+   case DEPTH_DATABLOCK:
+      GetAttribute(attributes, nAttributes, "datablockName",
+                   state->idcode, MAXFIELD);
+      break;
+   case DEPTH_CATEGORY:
+      if(!strcmp(name, "atom_siteCategory"))
+         state->category = CAT_ATOMSITE;
+      else if(!strcmp(name, "struct_keywordsCategory"))
+         state->category = CAT_KEYWORDS;
+      else if(!strcmp(name, "structCategory"))
+         state->category = CAT_STRUCT;
+      else if(!strcmp(name, "exptlCategory"))
+         state->category = CAT_EXPTL;
+      else if(!strcmp(name, "pdbx_database_statusCategory"))
+         state->category = CAT_STATUS;
+      else
+         state->category = CAT_NONE;
+      break;
+   case DEPTH_ROW:
+      if(state->category == CAT_ATOMSITE)
+      {
+         for(i=0; i<NFIELDS; i++)
+            state->fields[i][0] = '\0';
+         GetAttribute(attributes, nAttributes, "id", value, MAXFIELD);
+         state->atnum = atoi(value);
+      }
+      else if((state->category == CAT_EXPTL) &&
+              (state->method[0] == '\0'))
+      {
+         GetAttribute(attributes, nAttributes, "method",
+                      state->method, MAXTEXT);
+      }
+      break;
+   case DEPTH_FIELD:
+      state->field = NONE;
+      switch(state->category)
+      {
+      case CAT_ATOMSITE:
+         for(i=0; i<NFIELDS; i++)
+         {
+            if(!strcmp(name, sAtomFields[i]))
+            {
+               state->field = i;
+               break;
+            }
+         }
+         break;
+      case CAT_KEYWORDS:
+         if(!strcmp(name, "pdbx_keywords"))
+            state->field = H_KEYWORDS;
+         break;
+      case CAT_STRUCT:
+         if(!strcmp(name, "title"))
+            state->field = H_TITLE;
+         break;
+      case CAT_STATUS:
+         if(!strcmp(name, "recvd_initial_deposition_date"))
+            state->field = H_DATE;
+         break;
+      default:
+         break;
+      }
+
+      if(state->field != NONE)
+      {
+         state->textLen = 0;
+         GetAttribute(attributes, nAttributes, "nil", value, MAXFIELD);
+         state->nil = !strcmp(value, "true");
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+
+/************************************************************************/
+/*>static void EndElement(void *ctx, const xmlChar *localname,
+                          const xmlChar *prefix, const xmlChar *URI)
+   -----------------------------------------------------------------
+*//**
+   SAX2 end element handler. Stores the text of a field, builds an atom
+   at the end of an atom_site row and flushes the last residue at the
+   end of the atom_site category.
+
+-  19.10.26 Original   By: agent
+*/
+static void EndElement(void *ctx, const xmlChar *localname,
+                       const xmlChar *prefix, const xmlChar *URI)
+{
+   PDBMLSTATE *state = (PDBMLSTATE *)ctx;
+
+   switch(state->depth)
+   {
+   case DEPTH_FIELD:
+      if(state->field != NONE)
+      {
+         state->text[state->nil ? 0 : state->textLen] = '\0';
+         if(state->field < NFIELDS)
+            CopyField(state->fields[state->field], state->text,
+                      MAXFIELD);
+         else if(state->field == H_KEYWORDS)
+            CopyField(state->keywords, state->text, MAXTEXT);
+         else if(state->field == H_TITLE)
+            CopyField(state->title, state->text, MAXTEXT);
+         else if((state->field == H_DATE) && (state->date[0] == '\0'))
+            CopyField(state->date, state->text, MAXFIELD);
+         state->field = NONE;
+      }
+      break;
+   case DEPTH_ROW:
+      if(state->category == CAT_ATOMSITE)
+         EndAtomSite(state);
+      break;
+   case DEPTH_CATEGORY:
+      if((state->category == CAT_ATOMSITE) && state->ok)
+         state->ok = btFlushResidue(&(state->resBuffer), state->atomFunc,
+                                    state->data);
+      state->category = CAT_NONE;
+      break;
+   default:
+      break;
+   }
+
+   if(!state->ok)
+      xmlStopParser((xmlParserCtxtPtr)state->ctxt);
+
+   state->depth--;
+}
+
+
+/************************************************************************/
+/*>static void Characters(void *ctx, const xmlChar *ch, int len)
+   -------------------------------------------------------------
+*//**
+   SAX2 character handler. Collects the text of the current field.
+
+-  19.10.26 Original   By: agent
+*/
+static void Characters(void *ctx, const xmlChar *ch, int len)
+{
+   PDBMLSTATE *state = (PDBMLSTATE *)ctx;
+
+   if(state->field == NONE)
+      return;
+   if(len > MAXTEXT - 1 - state->textLen)
+      len = MAXTEXT - 1 - state->textLen;
+   memcpy(state->text + state->textLen, ch, len);
+   state->textLen += len;
+}
+
+
+/************************************************************************/
+/*>static void GetAttribute(const xmlChar **attributes, int nAttributes,
+                            char *name, char *value, int maxlen)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]  **attributes   SAX2 attribute array (5 entries each)
+   \param[in]  nAttributes    Number of attributes
+   \param[in]  *name          Attribute local name
+   \param[out] *value         Value (blank if not found)
+   \param[in]  maxlen         Size of value
+
+-  19.10.26 Original   By: agent
+*/
+static void GetAttribute(const xmlChar **attributes, int nAttributes,
+                         char *name, char *value, int maxlen)
+{
+   int i,
+       len;
+
+   value[0] = '\0';
+   for(i=0; i<nAttributes; i++, attributes+=5)
+   {
+      if(!strcmp((char *)attributes[0], name))
+      {
+         len = (int)(attributes[4] - attributes[3]);
+         if(len > maxlen - 1)
+            len = maxlen - 1;
+         strncpy(value, (char *)attributes[3], len);
+         value[len] = '\0';
+         return;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void EndAtomSite(PDBMLSTATE *state)
+   ------------------------------------------
+*//**
+   \param[in,out] *state    Parser state
+
+   Called at the end of an atom_site row. Builds the atom and adds it to
+   the current residue, first flushing the previous residue if this
+   atom starts a new one. Atoms from models after the first are only
+   counted.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Counts the models
+*/
+static void EndAtomSite(PDBMLSTATE *state)
+{
+   PDB  *p;
+   int  model;
+
+   model = state->fields[F_MODEL][0] ? atoi(state->fields[F_MODEL]) : 1;
+   if(!state->gotModel)
+   {
+      state->modelNum = model;
+      state->gotModel = TRUE;
+   }
+   if((state->nmodels == 0) || (model != state->lastModel))
+   {
+      state->nmodels++;
+      state->lastModel = model;
+   }
+   if(model != state->modelNum)
+      return;
+   if(state->atomsOnly && !strcmp(state->fields[F_GROUP], "HETATM"))
+      return;
+
+   if((p = BuildAtom(state)) == NULL)
+   {
+      fprintf(stderr, "No memory for PDBML atom\n");
+      state->ok = FALSE;
+      return;
+   }
+
+   if(p->occ < 1.0)
+      state->partialOcc = TRUE;
+
+   state->ok = btAddResidueAtom(&(state->resBuffer), p, state->atomFunc,
+                                state->data);
+}
+
+
+/************************************************************************/
+/*>static PDB *BuildAtom(PDBMLSTATE *state)
+   ----------------------------------------
+*//**
+   \param[in]  *state    Parser state holding the atom_site fields
+   \return               New PDB item (NULL if out of memory)
+
+   Fills in the PDB item as BiopLib would from the equivalent ATOM or
+   HETATM record. The raw atom name is placed as it would be in
+   columns 13-16 of a PDB file and corrected with blFixAtomName().
+
+-  19.10.26 Original   By: agent
+*/
+static PDB *BuildAtom(PDBMLSTATE *state)
+{
+   PDB  *p;
+   char *atnam,
+        *resnam,
+        atnambuff[16];
+   int  i;
+
+   if((p = (PDB *)malloc(sizeof(PDB))) == NULL)
+      return(NULL);
+   CLEAR_PDB(p);
+   p->next    = NULL;
+   p->extras  = NULL;
+   p->nConect = 0;
+
+   sprintf(p->record_type, "%-6.6s", state->fields[F_GROUP]);
+   p->atnum  = state->atnum;
+   p->x      = (REAL)atof(state->fields[F_X]);
+   p->y      = (REAL)atof(state->fields[F_Y]);
+   p->z      = (REAL)atof(state->fields[F_Z]);
+   p->occ    = (REAL)atof(state->fields[F_OCC]);
+   p->bval   = (REAL)atof(state->fields[F_BVAL]);
+   p->resnum = atoi(FIELD(state, F_AUTHSEQ, F_LABELSEQ));
+   p->formal_charge = atoi(state->fields[F_CHARGE]);
+   p->altpos = state->fields[F_ALTPOS][0] ? state->fields[F_ALTPOS][0] :
+                                            ' ';
+
+   CopyField(p->element, state->fields[F_ELEMENT], 3);
+   for(i=0; p->element[i]; i++)
+      p->element[i] = toupper(p->element[i]);
+
+   CopyField(p->chain, FIELD(state, F_AUTHASYM, F_LABELASYM),
+             blMAXCHAINLABEL);
+   strcpy(p->insert, state->fields[F_INSERT][0] ?
+                     state->fields[F_INSERT] : " ");
+   p->insert[1] = '\0';
+
+   /* Residue names are right justified in 3 columns in a PDB file      */
+   resnam = FIELD(state, F_AUTHCOMP, F_LABELCOMP);
+   if(strlen(resnam) <= 3)
+      sprintf(p->resnam, "%3s ", resnam);
+   else
+      sprintf(p->resnam, "%-4.4s", resnam);
+
+   /* Atom names of single letter elements start in column 14           */
+   atnam = FIELD(state, F_AUTHATOM, F_LABELATOM);
+   if((strlen(atnam) < 4) && (strlen(p->element) < 2))
+      sprintf(p->atnam_raw, " %-3s", atnam);
+   else
+      sprintf(p->atnam_raw, "%-4.4s", atnam);
+   sprintf(atnambuff, "%s ", p->atnam_raw);
+   atnam = blFixAtomName(atnambuff, p->occ);
+   atnam[4] = '\0';
+   strcpy(p->atnam, atnam);
+
+   return(p);
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendAtom(PDB *p, void *data)
+   ------------------------------------------
+*//**
+   \param[in]     *p      PDB item
+   \param[in,out] *data   ATOMLIST to which it is added
+   \return                TRUE
+
+   Atom callback used by btReadWholePDBML()
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL AppendAtom(PDB *p, void *data)
+{
+   ATOMLIST *atoms = (ATOMLIST *)data;
+
+   if(atoms->pdb == NULL)
+      atoms->pdb = p;
+   else
+      atoms->last->next = p;
+   atoms->last = p;
+   atoms->natoms++;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static STRINGLIST *BuildHeader(PDBMLSTATE *state)
+   -------------------------------------------------
+*//**
+   \param[in]  *state    Parser state holding the header fields
+   \return               HEADER, TITLE and EXPDTA records
+
+-  19.10.26 Original   By: agent
+*/
+static STRINGLIST *BuildHeader(PDBMLSTATE *state)
+{
+   STRINGLIST *header = NULL;
+   char       line[MAXHEADERLINE],
+              chunk[TITLEWIDTH+1],
+              pdbDate[16],
+              *title,
+              *end;
+   int        width,
+              nLines = 0;
+
+   if(state->keywords[0] || state->date[0] || state->idcode[0])
+   {
+      FormatDate(state->date, pdbDate);
+      sprintf(line, "HEADER    %-40.40s%-9.9s   %-4.4s%14s\n",
+              state->keywords, pdbDate, state->idcode, "");
+      header = blStoreString(header, line);
+   }
+
+   /* Wrap the title at a space                                         */
+   for(title=state->title; *title; )
+   {
+      width = nLines ? TITLECONTWIDTH : TITLEWIDTH;
+      if((int)strlen(title) > width)
+      {
+         for(end=title+width; (end > title) && (*end != ' '); end--);
+         if(end == title)
+            end = title + width;
+      }
+      else
+      {
+         end = title + strlen(title);
+      }
+
+      strncpy(chunk, title, end - title);
+      chunk[end - title] = '\0';
+      if(nLines++)
+         sprintf(line, "TITLE   %2d %-69s\n", nLines, chunk);
+      else
+         sprintf(line, "TITLE     %-70s\n", chunk);
+      header = blStoreString(header, line);
+
+      for(title=end; *title == ' '; title++);
+   }
+
+   if(state->method[0])
+   {
+      sprintf(line, "EXPDTA    %-70.70s\n", state->method);
+      header = blStoreString(header, line);
+   }
+
+   return(header);
+}
+
+
+/************************************************************************/
+/*>static void FormatDate(char *date, char *pdbDate)
+   -------------------------------------------------
+*//**
+   \param[in]  *date      Date as YYYY-MM-DD
+   \param[out] *pdbDate   Date as DD-MON-YY (blank if not parsable)
+
+-  19.10.26 Original   By: agent
+*/
+static void FormatDate(char *date, char *pdbDate)
+{
+   static char *months[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                            "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+   int year, month, day;
+
+   pdbDate[0] = '\0';
+   if((sscanf(date, "%d-%d-%d", &year, &month, &day) == 3) &&
+      (month >= 1) && (month <= 12))
+      sprintf(pdbDate, "%02d-%s-%02d", day%100, months[month-1],
+              year%100);
+}
+
+
+/************************************************************************/
+/*>static void CopyField(char *out, char *in, int maxlen)
+   ------------------------------------------------------
+*//**
+   \param[out] *out     Output string
+   \param[in]  *in      Field text
+   \param[in]  maxlen   Size of out
+
+   Copies the text with leading and trailing white space removed and
+   internal newlines and tabs converted to spaces. The values '?' and
+   '.' mean missing or inapplicable and give a blank string.
+
+-  19.10.26 Original   By: agent
+*/
+static void CopyField(char *out, char *in, int maxlen)
+{
+   int i;
+
+   while(isspace(*in))
+      in++;
+   if(((in[0] == '?') || (in[0] == '.')) && (in[1] == '\0'))
+      in++;
+
+   for(i=0; (i < maxlen-1) && in[i]; i++)
+      out[i] = isspace(in[i]) ? ' ' : in[i];
+   out[i] = '\0';
+   KILLTRAILSPACES(out);
+}
+#endif
+
@@ -0,0 +1,60 @@
+/************************************************************************/
+/**
+
+   \file       pdbmlread.h
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Streaming PDBML reader
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Event-driven (SAX) PDBML reader. Atoms are built as each atom_site
+   element is closed, so no document tree is held in memory.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Uses the residue buffer from pdbstream.c
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBMLREAD_H
+#define _BIOPTOOLS_PDBMLREAD_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL     btIsPDBML(FILE *fp);
+WHOLEPDB *btReadWholePDBML(FILE *fp, BOOL atomsOnly);
+BOOL     btStreamPDBML(FILE *fp, BOOL atomsOnly,
+                       BOOL (*atomFunc)(PDB *p, void *data), void *data);
+
+#endif
@@ -0,0 +1,499 @@
+/************************************************************************/
+/**
+
+   \file       pdbmlwrite.c
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Streaming PDBML writer
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes PDBML with fprintf() rather than building a libxml2 document
+   and serialising it. Nothing is held in memory apart from the key
+   header information, so output starts with the first atom and can be
+   piped straight into another program.
+
+   A file is written with btWritePDBMLStart(), btWritePDBMLAtom() for
+   each atom and btWritePDBMLEnd(). btWritePDBML() does all three for a
+   WHOLEPDB. The PDBMLHEADER is filled in from the PDB header records
+   by btGetPDBMLHeader(); the classification, deposition date, PDB code,
+   title and experimental method are written in the entry, exptl,
+   pdbx_database_status, struct and struct_keywords categories after
+   the atom_site category (categories are in alphabetical order as in
+   files from the PDB). The streaming PDBML reader in pdbmlread.c turns
+   them back into HEADER, TITLE and EXPDTA records.
+
+   Output is through stdio, so giving the output file a large buffer
+   with setvbuf() makes the writes large.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 btWritePDBML() is timed as the write phase
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "pdbmlwrite.h"
+#include "timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define PDBML_NS     "http://pdbml.pdb.org/schema/pdbx-v50.xsd"
+#define XSI_NS       "http://www.w3.org/2001/XMLSchema-instance"
+#define MAXATOMFIELD 64     /* Escaped atom field                      */
+#define MAXNILFIELD  128    /* A complete element that may be nil      */
+#define RECLEN       80
+#define DEFAULTID    "XXXX"
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static void GetRecordText(char *record, char *text, int maxlen);
+static void AppendText(char *text, char *more, int maxlen);
+static void FormatDate(char *pdbDate, char *date);
+static void EscapeXML(char *in, char *out, int maxlen);
+static void NilElement(char *buffer, char *tag, char *value);
+static char *EntryID(PDBMLHEADER *info);
+
+
+/************************************************************************/
+/*>void btGetPDBMLHeader(STRINGLIST *header, PDBMLHEADER *info)
+   -------------------------------------------------------------
+*//**
+   \param[in]  *header   PDB header records
+   \param[out] *info     Key header information
+
+   Extracts the fields written by btWritePDBMLEnd() from the HEADER,
+   TITLE and EXPDTA records.
+
+-  19.10.26 Original   By: agent
+*/
+void btGetPDBMLHeader(STRINGLIST *header, PDBMLHEADER *info)
+{
+   STRINGLIST *s;
+   char       record[RECLEN+1],
+              text[RECLEN+1];
+   int        i;
+
+   memset(info, 0, sizeof(PDBMLHEADER));
+
+   for(s=header; s!=NULL; NEXT(s))
+   {
+      /* Pad to a full-length record                                    */
+      for(i=0; (i<RECLEN) && s->string[i] && (s->string[i] != '\n') &&
+               (s->string[i] != '\r'); i++)
+         record[i] = s->string[i];
+      for(; i<RECLEN; i++)
+         record[i] = ' ';
+      record[RECLEN] = '\0';
+
+      if(!strncmp(record, "HEADER", 6))
+      {
+         strncpy(text, record+10, 40);
+         text[40] = '\0';
+         GetRecordText(text, info->keywords, sizeof(info->keywords));
+         strncpy(text, record+50, 9);
+         text[9] = '\0';
+         FormatDate(text, info->date);
+         strncpy(text, record+62, 4);
+         text[4] = '\0';
+         GetRecordText(text, info->idcode, sizeof(info->idcode));
+      }
+      else if(!strncmp(record, "TITLE ", 6))
+      {
+         GetRecordText(record+10, text, RECLEN+1);
+         AppendText(info->title, text, MAXPDBMLTEXT);
+      }
+      else if(!strncmp(record, "EXPDTA", 6))
+      {
+         GetRecordText(record+10, text, RECLEN+1);
+         AppendText(info->method, text, MAXPDBMLTEXT);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>void btWritePDBMLStart(FILE *fp, PDBMLHEADER *info)
+   ---------------------------------------------------
+*//**
+   \param[in]  *fp      Output file
+   \param[in]  *info    Key header information
+
+   Writes the XML declaration and opens the datablock and the atom_site
+   category
+
+-  19.10.26 Original   By: agent
+*/
+void btWritePDBMLStart(FILE *fp, PDBMLHEADER *info)
+{
+   fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+   fprintf(fp, "<PDBx:datablock datablockName=\"%s\" \
+xmlns:PDBx=\"%s\" xmlns:xsi=\"%s\">\n", EntryID(info), PDBML_NS, XSI_NS);
+   fprintf(fp, "  <PDBx:atom_siteCategory>\n");
+}
+
+
+/************************************************************************/
+/*>void btWritePDBMLAtom(FILE *fp, PDB *p)
+   ---------------------------------------
+*//**
+   \param[in]  *fp      Output file
+   \param[in]  *p       Atom
+
+   Writes one atom_site element. The fields are formatted with a few
+   large fprintf() calls rather than one per element.
+
+-  19.10.26 Original   By: agent
+*/
+void btWritePDBMLAtom(FILE *fp, PDB *p)
+{
+   char atnam[MAXATOMFIELD],
+        resnam[MAXATOMFIELD],
+        chain[MAXATOMFIELD],
+        element[MAXATOMFIELD],
+        buffer[MAXATOMFIELD],
+        altpos[MAXNILFIELD],
+        insert[MAXNILFIELD],
+        charge[MAXNILFIELD],
+        typeSymbol[MAXNILFIELD];
+
+   GetRecordText(p->atnam_raw, buffer, MAXATOMFIELD);
+   EscapeXML(buffer, atnam, MAXATOMFIELD);
+   GetRecordText(p->resnam, buffer, MAXATOMFIELD);
+   EscapeXML(buffer, resnam, MAXATOMFIELD);
+   GetRecordText(p->chain, buffer, MAXATOMFIELD);
+   EscapeXML(buffer, chain, MAXATOMFIELD);
+   GetRecordText(p->element, buffer, MAXATOMFIELD);
+   EscapeXML(buffer, element, MAXATOMFIELD);
+
+   buffer[0] = p->altpos;
+   buffer[1] = '\0';
+   NilElement(altpos, "label_alt_id", buffer);
+   GetRecordText(p->insert, buffer, MAXATOMFIELD);
+   NilElement(insert, "pdbx_PDB_ins_code", buffer);
+   buffer[0] = '\0';
+   if(p->formal_charge)
+      sprintf(buffer, "%d", p->formal_charge);
+   NilElement(charge, "pdbx_formal_charge", buffer);
+   NilElement(typeSymbol, "type_symbol", element);
+
+   fprintf(fp, "    <PDBx:atom_site id=\"%d\">\n\
+      <PDBx:B_iso_or_equiv>%.2f</PDBx:B_iso_or_equiv>\n\
+      <PDBx:Cartn_x>%.3f</PDBx:Cartn_x>\n\
+      <PDBx:Cartn_y>%.3f</PDBx:Cartn_y>\n\
+      <PDBx:Cartn_z>%.3f</PDBx:Cartn_z>\n",
+           p->atnum, p->bval, p->x, p->y, p->z);
+   fprintf(fp, "      <PDBx:auth_asym_id>%s</PDBx:auth_asym_id>\n\
+      <PDBx:auth_atom_id>%s</PDBx:auth_atom_id>\n\
+      <PDBx:auth_comp_id>%s</PDBx:auth_comp_id>\n\
+      <PDBx:auth_seq_id>%d</PDBx:auth_seq_id>\n\
+      <PDBx:group_PDB>%s</PDBx:group_PDB>\n%s",
+           chain, atnam, resnam, p->resnum,
+           (strncmp(p->record_type, "HETATM", 6) ? "ATOM" : "HETATM"),
+           altpos);
+   fprintf(fp, "      <PDBx:label_asym_id>%s</PDBx:label_asym_id>\n\
+      <PDBx:label_atom_id>%s</PDBx:label_atom_id>\n\
+      <PDBx:label_comp_id>%s</PDBx:label_comp_id>\n\
+      <PDBx:label_seq_id>%d</PDBx:label_seq_id>\n\
+      <PDBx:occupancy>%.2f</PDBx:occupancy>\n%s",
+           chain, atnam, resnam, p->resnum, p->occ, insert);
+   fprintf(fp, "      <PDBx:pdbx_PDB_model_num>1</PDBx:pdbx_PDB_model_num>\n\
+%s%s    </PDBx:atom_site>\n",
+           charge, typeSymbol);
+}
+
+
+/************************************************************************/
+/*>void btWritePDBMLEnd(FILE *fp, PDBMLHEADER *info)
+   -------------------------------------------------
+*//**
+   \param[in]  *fp      Output file
+   \param[in]  *info    Key header information
+
+   Closes the atom_site category, writes the header categories that
+   have data and closes the datablock
+
+-  19.10.26 Original   By: agent
+*/
+void btWritePDBMLEnd(FILE *fp, PDBMLHEADER *info)
+{
+   char *id = EntryID(info),
+        text[MAXPDBMLTEXT*6];
+
+   fprintf(fp, "  </PDBx:atom_siteCategory>\n");
+
+   fprintf(fp, "  <PDBx:entryCategory>\n");
+   fprintf(fp, "    <PDBx:entry id=\"%s\"/>\n", id);
+   fprintf(fp, "  </PDBx:entryCategory>\n");
+
+   if(info->method[0])
+   {
+      EscapeXML(info->method, text, sizeof(text));
+      fprintf(fp, "  <PDBx:exptlCategory>\n");
+      fprintf(fp, "    <PDBx:exptl entry_id=\"%s\" method=\"%s\"/>\n",
+              id, text);
+      fprintf(fp, "  </PDBx:exptlCategory>\n");
+   }
+
+   if(info->date[0])
+   {
+      fprintf(fp, "  <PDBx:pdbx_database_statusCategory>\n");
+      fprintf(fp, "    <PDBx:pdbx_database_status entry_id=\"%s\">\n",
+              id);
+      fprintf(fp, "      <PDBx:recvd_initial_deposition_date>%s\
+</PDBx:recvd_initial_deposition_date>\n", info->date);
+      fprintf(fp, "    </PDBx:pdbx_database_status>\n");
+      fprintf(fp, "  </PDBx:pdbx_database_statusCategory>\n");
+   }
+
+   if(info->title[0])
+   {
+      EscapeXML(info->title, text, sizeof(text));
+      fprintf(fp, "  <PDBx:structCategory>\n");
+      fprintf(fp, "    <PDBx:struct entry_id=\"%s\">\n", id);
+      fprintf(fp, "      <PDBx:title>%s</PDBx:title>\n", text);
+      fprintf(fp, "    </PDBx:struct>\n");
+      fprintf(fp, "  </PDBx:structCategory>\n");
+   }
+
+   if(info->keywords[0])
+   {
+      EscapeXML(info->keywords, text, sizeof(text));
+      fprintf(fp, "  <PDBx:struct_keywordsCategory>\n");
+      fprintf(fp, "    <PDBx:struct_keywords entry_id=\"%s\">\n", id);
+      fprintf(fp, "      <PDBx:pdbx_keywords>%s</PDBx:pdbx_keywords>\n",
+              text);
+      fprintf(fp, "    </PDBx:struct_keywords>\n");
+      fprintf(fp, "  </PDBx:struct_keywordsCategory>\n");
+   }
+
+   fprintf(fp, "</PDBx:datablock>\n");
+}
+
+
+/************************************************************************/
+/*>void btWritePDBML(FILE *fp, WHOLEPDB *wpdb)
+   -------------------------------------------
+*//**
+   \param[in]  *fp      Output file
+   \param[in]  *wpdb    Structure to write
+
+   Writes a complete PDBML file
+
+-  19.10.26 Original   By: agent
+*/
+void btWritePDBML(FILE *fp, WHOLEPDB *wpdb)
+{
+   PDBMLHEADER info;
+   PDB         *p;
+   int         phase = btSetTimingPhase(BT_PHASE_WRITE);
+
+   btGetPDBMLHeader(wpdb->header, &info);
+   btWritePDBMLStart(fp, &info);
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+      btWritePDBMLAtom(fp, p);
+   btWritePDBMLEnd(fp, &info);
+
+   btSetTimingPhase(phase);
+}
+
+
+/************************************************************************/
+/*>static void GetRecordText(char *record, char *text, int maxlen)
+   ---------------------------------------------------------------
+*//**
+   \param[in]  *record   Text from a record
+   \param[out] *text     Text with leading and trailing spaces removed
+   \param[in]  maxlen    Size of text
+
+-  19.10.26 Original   By: agent
+*/
+static void GetRecordText(char *record, char *text, int maxlen)
+{
+   while(*record == ' ')
+      record++;
+   strncpy(text, record, maxlen-1);
+   text[maxlen-1] = '\0';
+   KILLTRAILSPACES(text);
+}
+
+
+/************************************************************************/
+/*>static void AppendText(char *text, char *more, int maxlen)
+   ----------------------------------------------------------
+*//**
+   \param[in,out] *text     Text so far
+   \param[in]     *more     Text from a continuation record
+   \param[in]     maxlen    Size of text
+
+   Appends continuation text separated by a space
+
+-  19.10.26 Original   By: agent
+*/
+static void AppendText(char *text, char *more, int maxlen)
+{
+   int len = strlen(text);
+
+   if(len && (len < maxlen-1))
+      text[len++] = ' ';
+   strncpy(text+len, more, maxlen-1-len);
+   text[maxlen-1] = '\0';
+}
+
+
+/************************************************************************/
+/*>static void FormatDate(char *pdbDate, char *date)
+   -------------------------------------------------
+*//**
+   \param[in]  *pdbDate   Date as DD-MON-YY
+   \param[out] *date      Date as YYYY-MM-DD (blank if not parsable)
+
+   Two-digit years before 50 are taken to be in this century.
+
+-  19.10.26 Original   By: agent
+*/
+static void FormatDate(char *pdbDate, char *date)
+{
+   static char *months = "JANFEBMARAPRMAYJUNJULAUGSEPOCTNOVDEC";
+   char        month[4],
+               *chp;
+   int         day,
+               year;
+
+   date[0] = '\0';
+   if(sscanf(pdbDate, "%d-%3s-%d", &day, month, &year) != 3)
+      return;
+   if((strlen(month) != 3) || ((chp = strstr(months, month)) == NULL) ||
+      ((chp - months) % 3) || (day < 1) || (day > 31) ||
+      (year < 0) || (year > 99))
+      return;
+
+   year += (year < 50) ? 2000 : 1900;
+   sprintf(date, "%04d-%02d-%02d", year, (int)((chp - months) / 3) + 1,
+           day);
+}
+
+
+/************************************************************************/
+/*>static void EscapeXML(char *in, char *out, int maxlen)
+   ------------------------------------------------------
+*//**
+   \param[in]  *in       Text
+   \param[out] *out      Text with XML special characters escaped
+   \param[in]  maxlen    Size of out
+
+   Escaping stops rather than writing a partial entity if out is full
+
+-  19.10.26 Original   By: agent
+*/
+static void EscapeXML(char *in, char *out, int maxlen)
+{
+   char *entity,
+        single[2];
+   int  len = 0,
+        entityLen;
+
+   single[1] = '\0';
+   for(; *in; in++)
+   {
+      switch(*in)
+      {
+      case '&':
+         entity = "&amp;";
+         break;
+      case '<':
+         entity = "&lt;";
+         break;
+      case '>':
+         entity = "&gt;";
+         break;
+      case '"':
+         entity = "&quot;";
+         break;
+      default:
+         single[0] = *in;
+         entity    = single;
+         break;
+      }
+
+      entityLen = strlen(entity);
+      if(len + entityLen > maxlen - 1)
+         break;
+      strcpy(out+len, entity);
+      len += entityLen;
+   }
+   out[len] = '\0';
+}
+
+
+/************************************************************************/
+/*>static void NilElement(char *buffer, char *tag, char *value)
+   ------------------------------------------------------------
+*//**
+   \param[out] *buffer   Complete element line (MAXNILFIELD)
+   \param[in]  *tag      Element name
+   \param[in]  *value    Escaped value
+
+   Formats an element, marking it as nil if the value is blank
+
+-  19.10.26 Original   By: agent
+*/
+static void NilElement(char *buffer, char *tag, char *value)
+{
+   if((value[0] == '\0') || (value[0] == ' '))
+      sprintf(buffer, "      <PDBx:%s xsi:nil=\"true\"/>\n", tag);
+   else
+      sprintf(buffer, "      <PDBx:%s>%s</PDBx:%s>\n", tag, value, tag);
+}
+
+
+/************************************************************************/
+/*>static char *EntryID(PDBMLHEADER *info)
+   ---------------------------------------
+*//**
+   \param[in]  *info    Key header information
+   \return              PDB code, or a placeholder if there is none
+
+-  19.10.26 Original   By: agent
+*/
+static char *EntryID(PDBMLHEADER *info)
+{
+   return(info->idcode[0] ? info->idcode : DEFAULTID);
+}
+
@@ -0,0 +1,75 @@
+/************************************************************************/
+/**
+
+   \file       pdbmlwrite.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Streaming PDBML writer
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes PDBML directly with stdio rather than building an XML tree,
+   so atoms can be written as they are read.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBMLWRITE_H
+#define _BIOPTOOLS_PDBMLWRITE_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXPDBMLTEXT 1024
+
+/* Key header information carried over to PDBML                         */
+typedef struct
+{
+   char idcode[8],
+        date[24],
+        keywords[48],
+        method[MAXPDBMLTEXT],
+        title[MAXPDBMLTEXT];
+}  PDBMLHEADER;
+
+/************************************************************************/
+/* Prototypes
+*/
+void btGetPDBMLHeader(STRINGLIST *header, PDBMLHEADER *info);
+void btWritePDBMLStart(FILE *fp, PDBMLHEADER *info);
+void btWritePDBMLAtom(FILE *fp, PDB *p);
+void btWritePDBMLEnd(FILE *fp, PDBMLHEADER *info);
+void btWritePDBML(FILE *fp, WHOLEPDB *wpdb);
+
+#endif
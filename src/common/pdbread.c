@@ -0,0 +1,1375 @@
+/************************************************************************/
+/**
+
+   \file       pdbread.c
+
+   \version    V1.8
+   \date       19.10.26
+   \brief      Fast-path PDB reader using a memory-mapped file
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   btReadWholePDB(), btReadWholePDBAtoms(), btReadPDB() and
+   btReadPDBAtoms() behave exactly as their BiopLib bl... equivalents
+   and return the same linked list of PDB structures.
+
+   When the input is a regular file, it is mapped into memory and the
+   ATOM/HETATM records are sliced by column position with hand-written
+   integer and real number conversion rather than going through
+   fsscanf().
+
+   A quick scan of the coordinate records first decides whether the
+   fast path can be used, so nothing is parsed for a file that BiopLib
+   must read. The code falls back to reading the whole file with
+   BiopLib if:
+   - the input is not a regular file (stdin, a pipe, gzipped input)
+   - there are MODEL or ENDMDL records
+   - any other record appears between the coordinate records
+   - an atom has an alternate position, an occupancy below 1.0, a
+     segment ID, a charge or no element
+   - a field cannot be converted cleanly (found while parsing)
+
+   So that the header and trailer are stored exactly as BiopLib stores
+   them, BiopLib reads the header, the first coordinate record and the
+   trailer straight from the mapped file through an fopencookie()
+   stream. Each following atom starts from CLEAR_PDB() with the fields
+   that the PDB format leaves blank here (segment ID, charges,
+   accessibility etc.) copied from that first atom. Nothing else is
+   carried over from one atom to the next. The atom types depend on
+   the residue, so they are set for the complete list with
+   blSetAtomTypes(). The fast parse is checked against BiopLib's in
+   the regression tests (test/regress) rather than at run time.
+
+   CONECT records in the trailer are applied to the complete atom list
+   with blAddConect() once all the atoms have been read.
+
+   BiopLib's read of the header and trailer sets gPDBPartialOcc,
+   gPDBMultiNMR etc. Since any file with partial occupancies or models
+   falls back to BiopLib, those values hold for the whole file. Where
+   BiopLib is not used at all (a structure from a pipeline or from the
+   header reader), the globals are set from the atoms; binary files
+   record them (see binpdb.c).
+
+   Setting the environment variable BIOPTOOLS_NOFASTREAD disables the
+   fast path.
+
+   btReadWholePDBInArena() places the atoms in an arena (see arena.h).
+   The fast path allocates the atoms from the arena as it parses them;
+   a list from anywhere else is copied into the arena and freed. If the
+   fast path has to give up, the atoms it had parsed stay in the arena
+   until it is released.
+
+   Before any of this, the input is checked for the binary PDB magic
+   number and the structure cache is consulted (see binpdb.c). First of
+   all, a structure passed from the previous program in an in-process
+   pipeline is taken as it is (see pipeline.c).
+
+   btReadWholePDBHeader() is for programs that only need the header. A
+   text file is read only up to the first ATOM, HETATM or MODEL record,
+   so the coordinates are never read at all. The header is stored line
+   by line as blReadWholePDB() stores it, so the BiopLib header
+   routines work on the result as normal. Optionally, the rest of the
+   first model is skimmed and only the first atom of each run of atoms
+   in the same chain is kept, which is all blGetPDBChainLabels() needs.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Accepts binary PDB files and uses the structure cache
+-  V1.2  19.10.26 Sets the atom types of atoms read by the fast path
+-  V1.3  19.10.26 Takes structures passed in an in-process pipeline
+-  V1.4  19.10.26 Reading is timed as the read phase and the atoms
+                  are counted
+-  V1.5  19.10.26 Added btReadWholePDBInArena() and
+                  btFreeWholePDBInArena()
+-  V1.6  19.10.26 Added btReadWholePDBHeader()
+-  V1.7  19.10.26 Atoms after the probe no longer start as a copy of
+                  the last probe atom. Falls back to BiopLib for
+                  partial occupancies. Sets the gPDB... globals for a
+                  structure from a pipeline or the header reader
+-  V1.8  19.10.26 Decides on the fast path with a scan of the records
+                  before parsing them. BiopLib reads the header and
+                  trailer from the mapped file through an fopencookie()
+                  stream rather than a temporary file, and the probe
+                  records are no longer checked against BiopLib
+
+*************************************************************************/
+/* Includes
+*/
+#define _GNU_SOURCE   /* fopencookie()                                   */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "arena.h"
+#include "binpdb.h"
+#include "pipeline.h"
+#include "pdbmlread.h"
+#include "pdbstream.h"
+#include "pdbread.h"
+#include "timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MINRECLEN     78     /* Must reach the end of the element field */
+#define MAXDIGITS     15     /* Digits that fit exactly in a double     */
+#define MAXCONECTREC  4      /* Bonded atoms in one CONECT record       */
+#define MAXATNUMRATIO 10     /* Limits on atom numbers for the CONECT   */
+#define MAXATNUMSLACK 100000 /* lookup array                            */
+#define ENV_NOFAST    "BIOPTOOLS_NOFASTREAD"
+#define MAXHEADLINE   512    /* Longest header record kept in full      */
+#define MAXSEGMENTS   4      /* Pieces of the mapped file given to
+                                BiopLib                                 */
+
+#define ISCOORD(l, len) ((len) >= 6 &&                                  \
+                         (!strncmp((l), "ATOM  ", 6) ||                 \
+                          !strncmp((l), "HETATM", 6)))
+#define ISTER(l, len)   ((len) >= 3 && !strncmp((l), "TER", 3))
+#define ISCONECT(l, len) ((len) >= 11 && !strncmp((l), "CONECT", 6))
+#define ISSPECIAL(l, len) (((len) >= 5 && !strncmp((l), "MODEL", 5)) ||\
+                           ((len) >= 6 && !strncmp((l), "ENDMDL", 6)))
+
+typedef struct
+{
+   char   *start[MAXSEGMENTS];
+   size_t size[MAXSEGMENTS];
+   int    nsegments,
+          segment;
+   size_t pos;
+}  SEGMENTS;
+
+/************************************************************************/
+/* Globals
+*/
+static REAL sPowersOfTen[MAXDIGITS+1] =
+{
+   1.0e0,  1.0e1,  1.0e2,  1.0e3,  1.0e4,  1.0e5,  1.0e6,  1.0e7,
+   1.0e8,  1.0e9,  1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static WHOLEPDB *ReadWholePDB(FILE *fp, BOOL atomsOnly, ARENA *arena);
+static PDB  *ReadPDBList(FILE *fp, int *natom, BOOL atomsOnly);
+static WHOLEPDB *FastReadWholePDB(FILE *fp, BOOL atomsOnly,
+                                  ARENA *arena);
+static BOOL MoveToArena(WHOLEPDB *wpdb, ARENA *arena);
+static BOOL ScanCoordinates(char *coordStart, char *trailer,
+                            BOOL atomsOnly, char **first);
+static WHOLEPDB *ReadHeaderTrailer(char *start, char *coordStart,
+                                   char *first, char *firstEnd,
+                                   char *trailer, char *end,
+                                   BOOL atomsOnly);
+static ssize_t ReadSegments(void *cookie, char *buffer, size_t size);
+static PDB  *ParseCoordinates(ARENA *arena, char *from, char *trailer,
+                              PDB *first, BOOL atomsOnly, int *nfast,
+                              BOOL *ok);
+static char *FindTrailer(char *coordStart, char *end, BOOL *ok);
+static BOOL ApplyConects(PDB *pdb, int natoms, char *trailer, char *end);
+static char *NextLine(char *line, char *end, int *len);
+static BOOL PlainAtomLine(char *line, int len);
+static BOOL ParseAtomLine(char *line, int len, PDB *p);
+static void SetDefaults(PDB *defaults, PDB *first);
+static void SetReadGlobals(PDB *pdb);
+static BOOL ParseInt(char *s, int width, int *value);
+static BOOL ParseReal(char *s, int width, REAL *value);
+static BOOL BlankField(char *s, int width);
+static void FreeWholePDB(WHOLEPDB *wpdb);
+static WHOLEPDB *ReadHeader(FILE *fp, BOOL chainAtoms);
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadWholePDB(FILE *fp)
+   ----------------------------------
+*//**
+   \param[in]  *fp    PDB file pointer
+   \return            WHOLEPDB structure (NULL on failure)
+
+   Equivalent to blReadWholePDB()
+
+-  19.10.26 Original   By: agent
+*/
+WHOLEPDB *btReadWholePDB(FILE *fp)
+{
+   return(ReadWholePDB(fp, FALSE, NULL));
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadWholePDBAtoms(FILE *fp)
+   ---------------------------------------
+*//**
+   \param[in]  *fp    PDB file pointer
+   \return            WHOLEPDB structure (NULL on failure)
+
+   Equivalent to blReadWholePDBAtoms()
+
+-  19.10.26 Original   By: agent
+*/
+WHOLEPDB *btReadWholePDBAtoms(FILE *fp)
+{
+   return(ReadWholePDB(fp, TRUE, NULL));
+}
+
+
+/************************************************************************/
+/*>PDB *btReadPDB(FILE *fp, int *natom)
+   ------------------------------------
+*//**
+   \param[in]  *fp    PDB file pointer
+   \param[out] *natom Number of atoms read
+   \return            PDB linked list (NULL on failure)
+
+   Equivalent to blReadPDB()
+
+-  19.10.26 Original   By: agent
+*/
+PDB *btReadPDB(FILE *fp, int *natom)
+{
+   return(ReadPDBList(fp, natom, FALSE));
+}
+
+
+/************************************************************************/
+/*>PDB *btReadPDBAtoms(FILE *fp, int *natom)
+   -----------------------------------------
+*//**
+   \param[in]  *fp    PDB file pointer
+   \param[out] *natom Number of atoms read
+   \return            PDB linked list (NULL on failure)
+
+   Equivalent to blReadPDBAtoms()
+
+-  19.10.26 Original   By: agent
+*/
+PDB *btReadPDBAtoms(FILE *fp, int *natom)
+{
+   return(ReadPDBList(fp, natom, TRUE));
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadWholePDBInArena(FILE *fp, ARENA *arena)
+   -------------------------------------------------------
+*//**
+   \param[in]  *fp     PDB file pointer
+   \param[in]  *arena  Arena for the atoms
+   \return             WHOLEPDB structure (NULL on failure)
+
+   As btReadWholePDB(), but the atoms are in the arena. Free the
+   result with btFreeWholePDBInArena() and the atoms by releasing the
+   arena.
+
+-  19.10.26 Original   By: agent
+*/
+WHOLEPDB *btReadWholePDBInArena(FILE *fp, ARENA *arena)
+{
+   return(ReadWholePDB(fp, FALSE, arena));
+}
+
+
+/************************************************************************/
+/*>void btFreeWholePDBInArena(WHOLEPDB *wpdb)
+   ------------------------------------------
+*//**
+   \param[in]  *wpdb   WHOLEPDB structure whose atoms are in an arena
+
+   Frees the header, trailer and structure but not the atoms
+
+-  19.10.26 Original   By: agent
+*/
+void btFreeWholePDBInArena(WHOLEPDB *wpdb)
+{
+   if(wpdb == NULL)
+      return;
+
+   wpdb->pdb = NULL;
+   FreeWholePDB(wpdb);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btReadWholePDBHeader(FILE *fp, BOOL chainAtoms)
+   ---------------------------------------------------------
+*//**
+   \param[in]  *fp         PDB file pointer
+   \param[in]  chainAtoms  Also keep the first atom of each chain
+   \return                 WHOLEPDB structure (NULL if no memory)
+
+   Reads the header of a PDB file, stopping at the first coordinate
+   record. wpdb->pdb is NULL unless chainAtoms is set. A structure
+   passed through a pipeline, binary PDB and PDBML are read in full.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Sets the gPDB... globals
+*/
+WHOLEPDB *btReadWholePDBHeader(FILE *fp, BOOL chainAtoms)
+{
+   WHOLEPDB *wpdb;
+   int      phase = btSetTimingPhase(BT_PHASE_READ);
+
+   if((wpdb = btTakePipeInput(fp, FALSE)) != NULL)
+   {
+      SetReadGlobals(wpdb->pdb);
+   }
+   else if((wpdb = btReadBinaryPDB(fp, FALSE)) == NULL)
+   {
+      if(btIsPDBML(fp))
+      {
+         wpdb = blReadWholePDB(fp);
+      }
+      else
+      {
+         wpdb = ReadHeader(fp, chainAtoms);
+         SetReadGlobals(NULL);
+      }
+   }
+
+   if(wpdb != NULL)
+      btAddCount("atoms_read", (long)wpdb->natoms);
+   btSetTimingPhase(phase);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static WHOLEPDB *ReadWholePDB(FILE *fp, BOOL atomsOnly, ARENA *arena)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]  *fp        PDB file pointer
+   \param[in]  atomsOnly  Discard HETATM records
+   \param[in]  *arena     Arena for the atoms (NULL to malloc() them)
+   \return                WHOLEPDB structure (NULL on failure)
+
+   Tries, in order, a structure passed through a pipeline, a binary PDB
+   file, the structure cache, the fast text reader and BiopLib. A text
+   file read from the start is added to the cache (if it is enabled).
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Checks for a structure passed through a pipeline
+-  19.10.26 Timed as the read phase
+-  19.10.26 Added arena parameter
+-  19.10.26 Sets the gPDB... globals for a structure from a pipeline
+*/
+static WHOLEPDB *ReadWholePDB(FILE *fp, BOOL atomsOnly, ARENA *arena)
+{
+   WHOLEPDB *wpdb;
+   BOOL     atStart,
+            inArena = FALSE;
+   int      phase = btSetTimingPhase(BT_PHASE_READ);
+
+   if((wpdb = btTakePipeInput(fp, atomsOnly)) != NULL)
+   {
+      SetReadGlobals(wpdb->pdb);
+   }
+   else if(((wpdb = btReadBinaryPDB(fp, atomsOnly)) == NULL) &&
+      ((wpdb = btReadCachedPDB(fp, atomsOnly)) == NULL))
+   {
+      atStart = (ftell(fp) == 0L);
+      if((wpdb = FastReadWholePDB(fp, atomsOnly, arena)) != NULL)
+         inArena = (arena != NULL);
+      else
+         wpdb = atomsOnly ? blReadWholePDBAtoms(fp) : blReadWholePDB(fp);
+
+      if(atStart)
+         btWriteCachedPDB(fp, wpdb, atomsOnly);
+   }
+
+   if((wpdb != NULL) && (arena != NULL) && !inArena &&
+      !MoveToArena(wpdb, arena))
+   {
+      FreeWholePDB(wpdb);
+      wpdb = NULL;
+   }
+
+   if(wpdb != NULL)
+      btAddCount("atoms_read", (long)wpdb->natoms);
+   btSetTimingPhase(phase);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static PDB *ReadPDBList(FILE *fp, int *natom, BOOL atomsOnly)
+   -------------------------------------------------------------
+*//**
+   \param[in]  *fp        PDB file pointer
+   \param[out] *natom     Number of atoms read
+   \param[in]  atomsOnly  Discard HETATM records
+   \return                PDB linked list (NULL on failure)
+
+   Reads the whole PDB file and discards the header and trailer
+
+-  19.10.26 Original   By: agent
+*/
+static PDB *ReadPDBList(FILE *fp, int *natom, BOOL atomsOnly)
+{
+   WHOLEPDB *wpdb;
+   PDB      *pdb;
+
+   *natom = 0;
+   if((wpdb = ReadWholePDB(fp, atomsOnly, NULL)) == NULL)
+      return(NULL);
+
+   pdb       = wpdb->pdb;
+   *natom    = wpdb->natoms;
+   wpdb->pdb = NULL;
+   FreeWholePDB(wpdb);
+   return(pdb);
+}
+
+
+/************************************************************************/
+/*>static BOOL MoveToArena(WHOLEPDB *wpdb, ARENA *arena)
+   -----------------------------------------------------
+*//**
+   \param[in,out] *wpdb   WHOLEPDB structure with malloc()ed atoms
+   \param[in]     *arena  Arena
+   \return                Success? (wpdb is unchanged on failure)
+
+   Replaces the atoms with a copy in the arena
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL MoveToArena(WHOLEPDB *wpdb, ARENA *arena)
+{
+   PDB *copy;
+   int natoms;
+
+   if(wpdb->pdb == NULL)
+      return(TRUE);
+   if((copy = btArenaCopyPDB(arena, wpdb->pdb, NULL, NULL, &natoms))
+      == NULL)
+      return(FALSE);
+
+   FREELIST(wpdb->pdb, PDB);
+   wpdb->pdb = copy;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static WHOLEPDB *FastReadWholePDB(FILE *fp, BOOL atomsOnly,
+                                     ARENA *arena)
+   -----------------------------------------------------------
+*//**
+   \param[in]  *fp        PDB file pointer
+   \param[in]  atomsOnly  Discard HETATM records
+   \param[in]  *arena     Arena for the atoms (or NULL)
+   \return                WHOLEPDB structure or NULL if the fast path
+                          could not be used
+
+   Maps the file and reads it as described in the file header. On
+   failure nothing has been read from fp, so the caller can simply
+   hand it to BiopLib. On success fp is left at end of file.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Calls blSetAtomTypes()   By: agent
+-  19.10.26 Added arena parameter. The probe atoms are moved into the
+            arena before the parsed atoms are joined on
+-  19.10.26 Scans the coordinates before parsing them. BiopLib only
+            reads the header, first record and trailer
+*/
+static WHOLEPDB *FastReadWholePDB(FILE *fp, BOOL atomsOnly,
+                                  ARENA *arena)
+{
+   struct stat sbuf;
+   long        offset;
+   size_t      size;
+   char        *data,
+               *start,
+               *end,
+               *coordStart,
+               *first,
+               *firstEnd,
+               *trailer,
+               *next;
+   int         len,
+               nfast  = 0;
+   BOOL        ok     = TRUE,
+               moved  = FALSE;
+   WHOLEPDB    *wpdb  = NULL;
+   PDB         *fast  = NULL,
+               *p;
+
+   if(getenv(ENV_NOFAST) != NULL)
+      return(NULL);
+   if(fstat(fileno(fp), &sbuf) || !S_ISREG(sbuf.st_mode))
+      return(NULL);
+   if(((offset = ftell(fp)) < 0) || (offset >= (long)sbuf.st_size))
+      return(NULL);
+
+   size = (size_t)sbuf.st_size;
+   if((data = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE,
+                           fileno(fp), 0)) == (char *)MAP_FAILED)
+      return(NULL);
+   start = data + offset;
+   end   = data + size;
+
+   /* Header runs up to the first coordinate record                     */
+   for(coordStart=start; coordStart<end; coordStart=next)
+   {
+      next = NextLine(coordStart, end, &len);
+      if(ISCOORD(coordStart, len) || ISTER(coordStart, len))
+         break;
+      if(ISSPECIAL(coordStart, len))
+      {
+         ok = FALSE;
+         break;
+      }
+   }
+
+   if(ok && (coordStart < end))
+   {
+      trailer = FindTrailer(coordStart, end, &ok);
+
+      /* Decide whether BiopLib is needed before parsing anything       */
+      if(ok)
+         ok = ScanCoordinates(coordStart, trailer, atomsOnly, &first);
+
+      if(ok)
+      {
+         firstEnd = NextLine(first, trailer, &len);
+         wpdb     = ReadHeaderTrailer(start, coordStart, first, firstEnd,
+                                      trailer, end, atomsOnly);
+      }
+
+      if(wpdb != NULL)
+      {
+         fast = ParseCoordinates(arena, firstEnd, trailer, wpdb->pdb,
+                                 atomsOnly, &nfast, &ok);
+         if(ok && (arena != NULL))
+            ok = moved = MoveToArena(wpdb, arena);
+         if(ok)
+         {
+            for(p=wpdb->pdb; p->next!=NULL; NEXT(p));
+            p->next = fast;
+            wpdb->natoms += nfast;
+            fast = NULL;
+            ok = ApplyConects(wpdb->pdb, wpdb->natoms, trailer, end);
+         }
+
+         /* Atoms after the first were not typed by BiopLib, so the
+            atom types must be set for the complete list
+         */
+         if(ok)
+            blSetAtomTypes(wpdb->pdb);
+
+         if(!ok)
+         {
+            if(arena == NULL)
+               FREELIST(fast, PDB);
+            else if(moved)
+               wpdb->pdb = NULL;
+            FreeWholePDB(wpdb);
+            wpdb = NULL;
+         }
+      }
+   }
+
+   munmap(data, size);
+
+   if(wpdb != NULL)
+      fseek(fp, 0L, SEEK_END);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static BOOL ScanCoordinates(char *coordStart, char *trailer,
+                               BOOL atomsOnly, char **first)
+   ------------------------------------------------------------
+*//**
+   \param[in]  *coordStart  First coordinate record
+   \param[in]  *trailer     Start of the trailer
+   \param[in]  atomsOnly    Discard HETATM records
+   \param[out] *first       The first record that BiopLib will keep
+   \return                  Can the fast path be used?
+
+   A quick pass over the coordinate block that only looks at the
+   columns that decide whether BiopLib is needed (see PlainAtomLine()).
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL ScanCoordinates(char *coordStart, char *trailer,
+                            BOOL atomsOnly, char **first)
+{
+   char *line,
+        *next;
+   int  len;
+
+   *first = NULL;
+   for(line=coordStart; line < trailer; line=next)
+   {
+      next = NextLine(line, trailer, &len);
+
+      if(ISTER(line, len))
+         continue;
+      if(!ISCOORD(line, len) || !PlainAtomLine(line, len))
+         return(FALSE);
+      if((*first == NULL) &&
+         !(atomsOnly && !strncmp(line, "HETATM", 6)))
+         *first = line;
+   }
+
+   return(*first != NULL);
+}
+
+
+/************************************************************************/
+/*>static WHOLEPDB *ReadHeaderTrailer(char *start, char *coordStart,
+                                      char *first, char *firstEnd,
+                                      char *trailer, char *end,
+                                      BOOL atomsOnly)
+   ------------------------------------------------------------------
+*//**
+   \param[in]  *start       Start of the data
+   \param[in]  *coordStart  First coordinate record
+   \param[in]  *first       First record that BiopLib will keep
+   \param[in]  *firstEnd    End of that record
+   \param[in]  *trailer     Start of the trailer
+   \param[in]  *end         End of the data
+   \param[in]  atomsOnly    Discard HETATM records
+   \return                  WHOLEPDB from BiopLib holding the one atom
+                            (NULL on failure)
+
+   Hands the header, the first record and the trailer to BiopLib
+   through an fopencookie() stream that reads them from the mapped
+   file. The record is needed so that BiopLib can tell the trailer
+   from the header.
+
+-  19.10.26 Original   By: agent
+*/
+static WHOLEPDB *ReadHeaderTrailer(char *start, char *coordStart,
+                                   char *first, char *firstEnd,
+                                   char *trailer, char *end,
+                                   BOOL atomsOnly)
+{
+   SEGMENTS              segments;
+   cookie_io_functions_t funcs;
+   FILE                  *stream;
+   WHOLEPDB              *wpdb;
+
+   segments.start[0] = start;
+   segments.size[0]  = (size_t)(coordStart - start);
+   segments.start[1] = first;
+   segments.size[1]  = (size_t)(firstEnd - first);
+   segments.nsegments = 2;
+   if(*(firstEnd-1) != '\n')
+   {
+      segments.start[2] = "\n";
+      segments.size[2]  = 1;
+      segments.nsegments++;
+   }
+   segments.start[segments.nsegments] = trailer;
+   segments.size[segments.nsegments]  = (size_t)(end - trailer);
+   segments.nsegments++;
+   segments.segment = 0;
+   segments.pos     = 0;
+
+   memset(&funcs, 0, sizeof(cookie_io_functions_t));
+   funcs.read = ReadSegments;
+   if((stream = fopencookie(&segments, "r", funcs)) == NULL)
+      return(NULL);
+
+   wpdb = atomsOnly ? blReadWholePDBAtoms(stream) : blReadWholePDB(stream);
+   fclose(stream);
+
+   /* We must have exactly the one atom                                 */
+   if((wpdb != NULL) && ((wpdb->pdb == NULL) || (wpdb->pdb->next != NULL)))
+   {
+      FreeWholePDB(wpdb);
+      wpdb = NULL;
+   }
+
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>static ssize_t ReadSegments(void *cookie, char *buffer, size_t size)
+   --------------------------------------------------------------------
+*//**
+   \param[in]  *cookie   SEGMENTS
+   \param[out] *buffer   Buffer to fill
+   \param[in]  size      Size of buffer
+   \return               Bytes read (0 at end of file)
+
+   fopencookie() read function. Reads the segments one after another.
+
+-  19.10.26 Original   By: agent
+*/
+static ssize_t ReadSegments(void *cookie, char *buffer, size_t size)
+{
+   SEGMENTS *segments = (SEGMENTS *)cookie;
+   size_t   nread     = 0,
+            n;
+
+   while((nread < size) && (segments->segment < segments->nsegments))
+   {
+      n = segments->size[segments->segment] - segments->pos;
+      if(n > size - nread)
+         n = size - nread;
+      memcpy(buffer + nread,
+             segments->start[segments->segment] + segments->pos, n);
+      nread         += n;
+      segments->pos += n;
+      if(segments->pos >= segments->size[segments->segment])
+      {
+         segments->segment++;
+         segments->pos = 0;
+      }
+   }
+
+   return((ssize_t)nread);
+}
+
+
+/************************************************************************/
+/*>static PDB *ParseCoordinates(ARENA *arena, char *from, char *trailer,
+                                PDB *first, BOOL atomsOnly, int *nfast,
+                                BOOL *ok)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]  *arena       Arena for the atoms (NULL to malloc() them)
+   \param[in]  *from        The record after the one BiopLib read
+   \param[in]  *trailer     Start of the trailer
+   \param[in]  *first       BiopLib's parse of the first record
+   \param[in]  atomsOnly    Discard HETATM records
+   \param[out] *nfast       Number of atoms parsed
+   \param[out] *ok          Set to FALSE if we must fall back to BiopLib
+   \return                  Linked list of atoms after the first
+
+   Parses the coordinate records after the first into atoms set up by
+   SetDefaults() from BiopLib's first atom. ScanCoordinates() has
+   already checked that these are all plain ATOM, HETATM or TER
+   records.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Added arena parameter
+-  19.10.26 No longer copies the last probe atom for later records
+-  19.10.26 Starts after the first record rather than checking the
+            probe records against BiopLib
+*/
+static PDB *ParseCoordinates(ARENA *arena, char *from, char *trailer,
+                             PDB *first, BOOL atomsOnly, int *nfast,
+                             BOOL *ok)
+{
+   char *line,
+        *next;
+   int  len;
+   PDB  *fast = NULL,
+        *last = NULL,
+        *p,
+        defaults;
+
+   *nfast = 0;
+   SetDefaults(&defaults, first);
+
+   for(line=from; (line < trailer) && *ok; line=next)
+   {
+      next = NextLine(line, trailer, &len);
+
+      if(ISTER(line, len))
+         continue;
+      if(atomsOnly && !strncmp(line, "HETATM", 6))
+         continue;
+
+      p = (arena != NULL) ? btArenaNewPDB(arena)
+                          : (PDB *)malloc(sizeof(PDB));
+      if(p == NULL)
+      {
+         *ok = FALSE;
+         break;
+      }
+
+      *p = defaults;
+      if(fast == NULL)
+         fast = p;
+      else
+         last->next = p;
+      last = p;
+
+      if(!ParseAtomLine(line, len, p))
+      {
+         *ok = FALSE;
+         break;
+      }
+      (*nfast)++;
+   }
+
+   return(fast);
+}
+
+
+/************************************************************************/
+/*>static char *FindTrailer(char *coordStart, char *end, BOOL *ok)
+   ---------------------------------------------------------------
+*//**
+   \param[in]  *coordStart  First coordinate record
+   \param[in]  *end         End of the data
+   \param[out] *ok          Set to FALSE if the trailer contains records
+                            that BiopLib interprets
+   \return                  Start of the first line after the last
+                            coordinate or TER record
+
+   Walks backwards from the end of the data.
+
+-  19.10.26 Original   By: agent
+*/
+static char *FindTrailer(char *coordStart, char *end, BOOL *ok)
+{
+   char *trailer = end,
+        *line;
+   int  len;
+
+   while(trailer > coordStart)
+   {
+      /* Find the start of the line before trailer                      */
+      line = trailer - 1;
+      if((line > coordStart) && (*line == '\n'))
+         line--;
+      while((line > coordStart) && (*(line-1) != '\n'))
+         line--;
+
+      NextLine(line, end, &len);
+      if(ISCOORD(line, len) || ISTER(line, len))
+         break;
+      if(ISSPECIAL(line, len))
+         *ok = FALSE;
+      trailer = line;
+   }
+
+   return(trailer);
+}
+
+
+/************************************************************************/
+/*>static BOOL ApplyConects(PDB *pdb, int natoms, char *trailer,
+                            char *end)
+   -------------------------------------------------------------
+*//**
+   \param[in,out] *pdb     Complete atom list
+   \param[in]     natoms   Number of atoms
+   \param[in]     *trailer Start of the trailer
+   \param[in]     *end     End of the data
+   \return                 Success (FALSE if we must fall back)
+
+   BiopLib only saw the first atom, so any connectivity it gave it is
+   cleared and the CONECT records are applied to the complete list.
+   Atoms are found through an array indexed by atom number; where a
+   number is duplicated the first atom is used.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL ApplyConects(PDB *pdb, int natoms, char *trailer, char *end)
+{
+   PDB  **byNumber,
+        *p,
+        *q;
+   char *line,
+        *next,
+        *field;
+   int  len,
+        i,
+        atnum,
+        partner,
+        maxAtnum  = 0;
+   BOOL gotConect = FALSE,
+        ok        = TRUE;
+
+   for(line=trailer; (line < end) && !gotConect; line=next)
+   {
+      next = NextLine(line, end, &len);
+      gotConect = ISCONECT(line, len);
+   }
+   if(!gotConect)
+      return(TRUE);
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      p->nConect = 0;
+      if(p->atnum < 0)
+         return(FALSE);
+      if(p->atnum > maxAtnum)
+         maxAtnum = p->atnum;
+   }
+   if(maxAtnum > (MAXATNUMRATIO * natoms) + MAXATNUMSLACK)
+      return(FALSE);
+   if((byNumber = (PDB **)calloc(maxAtnum+1, sizeof(PDB *))) == NULL)
+      return(FALSE);
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if(byNumber[p->atnum] == NULL)
+         byNumber[p->atnum] = p;
+   }
+
+   for(line=trailer; (line < end) && ok; line=next)
+   {
+      next = NextLine(line, end, &len);
+      if(!ISCONECT(line, len))
+         continue;
+
+      if(!ParseInt(line+6, 5, &atnum))
+      {
+         ok = FALSE;
+         break;
+      }
+      p = ((atnum >= 0) && (atnum <= maxAtnum)) ? byNumber[atnum] : NULL;
+
+      for(i=0; (i < MAXCONECTREC) && (16+5*i <= len); i++)
+      {
+         field = line + 11 + 5*i;
+         if(BlankField(field, 5))
+            continue;
+         if(!ParseInt(field, 5, &partner))
+         {
+            ok = FALSE;
+            break;
+         }
+         q = ((partner >= 0) && (partner <= maxAtnum)) ?
+             byNumber[partner] : NULL;
+         if((p != NULL) && (q != NULL))
+            blAddConect(p, q);
+      }
+   }
+
+   free(byNumber);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static char *NextLine(char *line, char *end, int *len)
+   ------------------------------------------------------
+*//**
+   \param[in]  *line  Start of a line
+   \param[in]  *end   End of the data
+   \param[out] *len   Length of the line without line terminators
+   \return            Start of the following line
+
+-  19.10.26 Original   By: agent
+*/
+static char *NextLine(char *line, char *end, int *len)
+{
+   char *eol;
+
+   if((eol = (char *)memchr(line, '\n', (size_t)(end - line))) == NULL)
+      eol = end;
+
+   *len = (int)(eol - line);
+   if((*len > 0) && (line[*len - 1] == '\r'))
+      (*len)--;
+
+   return((eol < end) ? eol + 1 : end);
+}
+
+
+/************************************************************************/
+/*>static BOOL PlainAtomLine(char *line, int len)
+   ----------------------------------------------
+*//**
+   \param[in]  *line  ATOM or HETATM record
+   \param[in]  len    Length of the record
+   \return            Can the record be read by ParseAtomLine()?
+
+   Rejects records that are too short to have an element, and those
+   with an alternate position, an occupancy below 1.0 (BiopLib may
+   have to choose between alternates), a segment ID, a charge or no
+   element.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL PlainAtomLine(char *line, int len)
+{
+   REAL occ;
+
+   if(len < MINRECLEN)
+      return(FALSE);
+   if((line[16] != ' ') || !BlankField(line+72, 4))
+      return(FALSE);
+   if((len >= 80) && !BlankField(line+78, 2))
+      return(FALSE);
+   if(BlankField(line+76, 2))
+      return(FALSE);
+
+   return(ParseReal(line+54, 6, &occ) && (occ >= 1.0));
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseAtomLine(char *line, int len, PDB *p)
+   ------------------------------------------------------
+*//**
+   \param[in]  *line  ATOM or HETATM record accepted by PlainAtomLine()
+   \param[in]  len    Length of the record
+   \param[out] *p     PDB structure to fill in
+   \return            Record parsed (FALSE if a field is not clean)
+
+   Fills in the fields read by BiopLib from the fixed columns. The
+   atom name is corrected with blFixAtomName() as BiopLib does.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Rejects partial occupancies
+-  19.10.26 The checks for unusual records are in PlainAtomLine()
+*/
+static BOOL ParseAtomLine(char *line, int len, PDB *p)
+{
+   char atnambuff[8],
+        *atnam;
+   int  i, j;
+
+   if(!ParseInt(line+6,    5, &(p->atnum))  ||
+      !ParseInt(line+22,   4, &(p->resnum)) ||
+      !ParseReal(line+30,  8, &(p->x))      ||
+      !ParseReal(line+38,  8, &(p->y))      ||
+      !ParseReal(line+46,  8, &(p->z))      ||
+      !ParseReal(line+54,  6, &(p->occ))    ||
+      !ParseReal(line+60,  6, &(p->bval)))
+      return(FALSE);
+
+   strncpy(p->record_type, line, 6);
+   p->record_type[6] = '\0';
+
+   strncpy(p->atnam_raw, line+12, 4);
+   p->atnam_raw[4] = '\0';
+   strncpy(atnambuff, line+12, 5);
+   atnambuff[5] = '\0';
+   atnam = blFixAtomName(atnambuff, p->occ);
+   atnam[4] = '\0';
+   strcpy(p->atnam, atnam);
+   p->altpos = ' ';
+
+   strncpy(p->resnam, line+17, 4);
+   p->resnam[4] = '\0';
+   p->chain[0]  = line[21];
+   p->chain[1]  = '\0';
+   p->insert[0] = line[26];
+   p->insert[1] = '\0';
+
+   for(i=76, j=0; i<78; i++)
+   {
+      if(line[i] != ' ')
+         p->element[j++] = line[i];
+   }
+   p->element[j] = '\0';
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void SetDefaults(PDB *defaults, PDB *first)
+   --------------------------------------------------
+*//**
+   \param[out] *defaults  Starting point for each atom we parse
+   \param[in]  *first     The atom read by BiopLib
+
+   Clears the atom and copies the fields that ParseAtomLine() does not
+   set, and which are blank in every record that it accepts, from the
+   BiopLib atom. The atom type is not copied as it depends on the
+   residue.
+
+-  19.10.26 Original   By: agent
+*/
+static void SetDefaults(PDB *defaults, PDB *first)
+{
+   CLEAR_PDB(defaults);
+   defaults->next           = NULL;
+   defaults->extras         = NULL;
+   defaults->nConect        = 0;
+   defaults->access         = first->access;
+   defaults->radius         = first->radius;
+   defaults->partial_charge = first->partial_charge;
+   defaults->formal_charge  = first->formal_charge;
+   defaults->entity_id      = first->entity_id;
+   defaults->secstr         = first->secstr;
+   strcpy(defaults->segid, first->segid);
+}
+
+
+/************************************************************************/
+/*>static void SetReadGlobals(PDB *pdb)
+   ------------------------------------
+*//**
+   \param[in]  *pdb   Atoms that were not read by BiopLib
+
+   Sets the globals that blReadPDB() sets, as far as they can be told
+   from the atoms. Only one model is ever passed on.
+
+-  19.10.26 Original   By: agent
+*/
+static void SetReadGlobals(PDB *pdb)
+{
+   PDB *p;
+
+   gPDBPartialOcc    = FALSE;
+   gPDBMultiNMR      = 0;
+   gPDBModelNotFound = FALSE;
+   gPDBXML           = FALSE;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      if((p->occ < 1.0) || (p->altpos != ' '))
+      {
+         gPDBPartialOcc = TRUE;
+         break;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseInt(char *s, int width, int *value)
+   ----------------------------------------------------
+*//**
+   \param[in]  *s      Start of field
+   \param[in]  width   Field width
+   \param[out] *value  Integer value
+   \return             Field was a clean integer
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL ParseInt(char *s, int width, int *value)
+{
+   int  i = 0,
+        v = 0,
+        ndigits = 0;
+   BOOL negative = FALSE;
+
+   while((i < width) && (s[i] == ' '))
+      i++;
+   if((i < width) && ((s[i] == '-') || (s[i] == '+')))
+      negative = (s[i++] == '-');
+   for(; (i < width) && (s[i] >= '0') && (s[i] <= '9'); i++, ndigits++)
+      v = 10 * v + (s[i] - '0');
+   for(; i < width; i++)
+   {
+      if(s[i] != ' ')
+         return(FALSE);
+   }
+
+   *value = negative ? -v : v;
+   return(ndigits > 0);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseReal(char *s, int width, REAL *value)
+   ------------------------------------------------------
+*//**
+   \param[in]  *s      Start of field
+   \param[in]  width   Field width
+   \param[out] *value  Real value
+   \return             Field was a clean fixed-point number
+
+   The digits are accumulated as an exact integer and divided once by
+   an exact power of ten, so the result is the correctly rounded value
+   that strtod() would give.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL ParseReal(char *s, int width, REAL *value)
+{
+   int  i = 0,
+        ndigits = 0,
+        nfrac   = 0;
+   REAL v = 0.0;
+   BOOL negative = FALSE,
+        gotPoint = FALSE;
+
+   while((i < width) && (s[i] == ' '))
+      i++;
+   if((i < width) && ((s[i] == '-') || (s[i] == '+')))
+      negative = (s[i++] == '-');
+   for(; i < width; i++)
+   {
+      if((s[i] >= '0') && (s[i] <= '9'))
+      {
+         v = 10.0 * v + (REAL)(s[i] - '0');
+         ndigits++;
+         if(gotPoint)
+            nfrac++;
+      }
+      else if((s[i] == '.') && !gotPoint)
+      {
+         gotPoint = TRUE;
+      }
+      else
+      {
+         break;
+      }
+   }
+   for(; i < width; i++)
+   {
+      if(s[i] != ' ')
+         return(FALSE);
+   }
+   if((ndigits == 0) || (ndigits > MAXDIGITS))
+      return(FALSE);
+
+   v /= sPowersOfTen[nfrac];
+   *value = negative ? -v : v;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL BlankField(char *s, int width)
+   ------------------------------------------
+*//**
+   \param[in]  *s      Start of field
+   \param[in]  width   Field width
+   \return             Field is all spaces
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL BlankField(char *s, int width)
+{
+   int i;
+
+   for(i=0; i<width; i++)
+   {
+      if(s[i] != ' ')
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FreeWholePDB(WHOLEPDB *wpdb)
+   ----------------------------------------
+*//**
+   \param[in]  *wpdb   WHOLEPDB structure to free
+
+-  19.10.26 Original   By: agent
+*/
+static void FreeWholePDB(WHOLEPDB *wpdb)
+{
+   FREELIST(wpdb->pdb, PDB);
+   blFreeStringList(wpdb->header);
+   blFreeStringList(wpdb->trailer);
+   free(wpdb);
+}
+
+
+
+/************************************************************************/
+/*>static WHOLEPDB *ReadHeader(FILE *fp, BOOL chainAtoms)
+   ------------------------------------------------------
+*//**
+   \param[in]  *fp         PDB file pointer
+   \param[in]  chainAtoms  Skim the first model for chain changes
+   \return                 WHOLEPDB structure (NULL if no memory)
+
+   Header records are those before the first ATOM, HETATM or MODEL
+   record, as in btStreamPDB().
+
+-  19.10.26 Original   By: agent
+*/
+static WHOLEPDB *ReadHeader(FILE *fp, BOOL chainAtoms)
+{
+   WHOLEPDB   *wpdb;
+   STRINGLIST *last     = NULL;
+   PDB        *lastAtom = NULL,
+              *p;
+   char       line[MAXHEADLINE],
+              chain;
+   int        len, c;
+   BOOL       inCoords  = FALSE,
+              ok        = TRUE;
+
+   if((wpdb = (WHOLEPDB *)calloc(1, sizeof(WHOLEPDB))) == NULL)
+      return(NULL);
+
+   while(ok && fgets(line, MAXHEADLINE, fp))
+   {
+      /* Discard the rest of an over-long line                          */
+      if(strchr(line, '\n') == NULL)
+      {
+         while(((c = getc(fp)) != EOF) && (c != '\n'));
+         strcat(line, "\n");
+      }
+      len = strlen(line);
+
+      if(!inCoords)
+      {
+         if(ISCOORD(line, len) || ((len >= 5) && 
+                                   !strncmp(line, "MODEL", 5)))
+         {
+            if(!chainAtoms)
+               break;
+            inCoords = TRUE;
+         }
+         else
+         {
+            if((last = blStoreString(last, line)) == NULL)
+               ok = FALSE;
+            else if(wpdb->header == NULL)
+               wpdb->header = last;
+            else
+               last = last->next;
+            continue;
+         }
+      }
+
+      if((len >= 6) && !strncmp(line, "ENDMDL", 6))
+         break;
+      if(!ISCOORD(line, len))
+         continue;
+
+      chain = ((len > 22) && (line[21] != '\r')) ? line[21] : ' ';
+      if((lastAtom == NULL) || (lastAtom->chain[0] != chain))
+      {
+         if((p = (PDB *)malloc(sizeof(PDB))) == NULL)
+         {
+            ok = FALSE;
+         }
+         else
+         {
+            btParseAtomRecord(line, p);
+            if(lastAtom == NULL)
+               wpdb->pdb = p;
+            else
+               lastAtom->next = p;
+            lastAtom = p;
+            (wpdb->natoms)++;
+         }
+      }
+   }
+
+   if(!ok)
+   {
+      FreeWholePDB(wpdb);
+      return(NULL);
+   }
+   return(wpdb);
+}
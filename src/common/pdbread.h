@@ -0,0 +1,71 @@
+/************************************************************************/
+/**
+
+   \file       pdbread.h
+
+   \version    V1.4
+   \date       19.10.26
+   \brief      Fast-path PDB reader using a memory-mapped file
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Drop-in replacements for the BiopLib blReadPDB() family. Regular
+   files are mapped into memory and the fixed columns of the coordinate
+   records are sliced directly; anything else is handed to BiopLib.
+   Binary PDB files (see binpdb.h) are recognised and loaded directly.
+   btReadWholePDBHeader() reads just the header of a text PDB file.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Accepts binary PDB files
+-  V1.2  19.10.26 Sets the atom types of atoms read by the fast path
+-  V1.3  19.10.26 Added btReadWholePDBInArena() and
+                  btFreeWholePDBInArena()
+-  V1.4  19.10.26 Added btReadWholePDBHeader()
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBREAD_H
+#define _BIOPTOOLS_PDBREAD_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+#include "arena.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+WHOLEPDB *btReadWholePDB(FILE *fp);
+WHOLEPDB *btReadWholePDBAtoms(FILE *fp);
+PDB      *btReadPDB(FILE *fp, int *natom);
+PDB      *btReadPDBAtoms(FILE *fp, int *natom);
+WHOLEPDB *btReadWholePDBInArena(FILE *fp, ARENA *arena);
+void     btFreeWholePDBInArena(WHOLEPDB *wpdb);
+WHOLEPDB *btReadWholePDBHeader(FILE *fp, BOOL chainAtoms);
+
+#endif
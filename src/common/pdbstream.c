@@ -0,0 +1,479 @@
+/************************************************************************/
+/**
+
+   \file       pdbstream.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Read PDB files one atom at a time
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   btStreamPDB() reads a PDB file line by line. The header (everything
+   before the first coordinate or MODEL record) is collected and passed
+   to a header callback, then each atom is passed to an atom callback
+   which takes ownership of it. This makes it possible to convert or
+   filter a PDB file of any size in constant memory and to start
+   writing output as soon as the first residue has been read.
+
+   The atoms passed on are those that blReadWholePDB() would have
+   stored: only the first model is read and, where there are alternate
+   positions, only the one with the highest occupancy is kept. To
+   resolve alternates, the atoms of each residue are held in a
+   RESBUFFER until the next residue starts. The RESBUFFER routines are
+   also used by the streaming PDBML reader.
+
+   Records after the coordinates (CONECT, MASTER, etc.) are skipped.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "pdbstream.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXLINE       512
+#define RECLEN        80
+#define RESBUFFINC    32    /* Growth step for a RESBUFFER             */
+
+#define ISRECORD(line, rec) (!strncmp((line), (rec), strlen(rec)))
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL SameResidue(PDB *p, PDB *q);
+static void SelectAltPositions(PDB **atoms, int natoms);
+static REAL ColumnReal(char *line, int start, int width);
+static int  ColumnInt(char *line, int start, int width);
+
+
+/************************************************************************/
+/*>BOOL btStreamPDB(FILE *fp, BOOL atomsOnly,
+                    BOOL (*headerFunc)(STRINGLIST *header, void *data),
+                    ATOMFUNC atomFunc, void *data)
+   ------------------------------------------------------------------
+*//**
+   \param[in]  *fp          PDB file pointer
+   \param[in]  atomsOnly    Discard HETATM records
+   \param[in]  *headerFunc  Called once with the header records (which
+                            are freed when it returns) before the first
+                            atom. May be NULL
+   \param[in]  atomFunc     Called with each atom. Takes ownership of
+                            the PDB item and returns FALSE to stop
+   \param[in]  *data        Passed to the callbacks
+   \return                  Success?
+
+   Reads the first model of a PDB file, passing the header and atoms to
+   the callbacks as described in the file header.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btStreamPDB(FILE *fp, BOOL atomsOnly,
+                 BOOL (*headerFunc)(STRINGLIST *header, void *data),
+                 ATOMFUNC atomFunc, void *data)
+{
+   STRINGLIST *header  = NULL,
+              *last    = NULL;
+   RESBUFFER  resBuffer;
+   PDB        *p;
+   char       line[MAXLINE];
+   int        c;
+   BOOL       inCoords = FALSE,
+              ok       = TRUE;
+
+   resBuffer.atoms    = NULL;
+   resBuffer.natoms   = 0;
+   resBuffer.maxAtoms = 0;
+
+   while(ok && fgets(line, MAXLINE, fp))
+   {
+      /* Discard the rest of an over-long line                          */
+      if(strchr(line, '\n') == NULL)
+      {
+         while(((c = getc(fp)) != EOF) && (c != '\n'));
+         strcat(line, "\n");
+      }
+
+      if(!inCoords)
+      {
+         if(ISRECORD(line, "ATOM  ") || ISRECORD(line, "HETATM") ||
+            ISRECORD(line, "MODEL "))
+         {
+            inCoords = TRUE;
+            if(headerFunc != NULL)
+               ok = (*headerFunc)(header, data);
+            FREELIST(header, STRINGLIST);
+         }
+         else
+         {
+            /* Appending at the tail keeps this linear                  */
+            if((last = blStoreString(last, line)) == NULL)
+               ok = FALSE;
+            else if(header == NULL)
+               header = last;
+            else
+               last = last->next;
+            continue;
+         }
+      }
+
+      if(ISRECORD(line, "ENDMDL"))
+      {
+         break;
+      }
+      else if(ISRECORD(line, "ATOM  ") ||
+              (ISRECORD(line, "HETATM") && !atomsOnly))
+      {
+         if((p = (PDB *)malloc(sizeof(PDB))) == NULL)
+         {
+            ok = FALSE;
+         }
+         else
+         {
+            btParseAtomRecord(line, p);
+            ok = btAddResidueAtom(&resBuffer, p, atomFunc, data);
+         }
+      }
+   }
+
+   if(ok)
+   {
+      if(!inCoords && (headerFunc != NULL))
+         ok = (*headerFunc)(header, data);
+      if(ok)
+         ok = btFlushResidue(&resBuffer, atomFunc, data);
+   }
+
+   FREELIST(header, STRINGLIST);
+   btFreeResidueBuffer(&resBuffer);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void btParseAtomRecord(char *line, PDB *p)
+   ------------------------------------------
+*//**
+   \param[in]  *line   ATOM or HETATM record
+   \param[out] *p      PDB item to fill in
+
+   Fills in a PDB item from the fixed columns of a coordinate record as
+   blReadPDB() does. Missing columns at the end of a short record are
+   treated as blank. The atom name is corrected with blFixAtomName().
+
+-  19.10.26 Original   By: agent
+*/
+void btParseAtomRecord(char *line, PDB *p)
+{
+   char record[RECLEN+1],
+        atnambuff[8],
+        *atnam;
+   int  i, j;
+
+   /* Pad to a full-length record                                       */
+   for(i=0; (i<RECLEN) && line[i] && (line[i] != '\n') &&
+            (line[i] != '\r'); i++)
+      record[i] = line[i];
+   for(; i<RECLEN; i++)
+      record[i] = ' ';
+   record[RECLEN] = '\0';
+
+   CLEAR_PDB(p);
+   p->next    = NULL;
+   p->extras  = NULL;
+   p->nConect = 0;
+
+   strncpy(p->record_type, record, 6);
+   p->record_type[6] = '\0';
+   p->atnum  = ColumnInt(record,   6, 5);
+   p->resnum = ColumnInt(record,  22, 4);
+   p->x      = ColumnReal(record, 30, 8);
+   p->y      = ColumnReal(record, 38, 8);
+   p->z      = ColumnReal(record, 46, 8);
+   p->occ    = ColumnReal(record, 54, 6);
+   p->bval   = ColumnReal(record, 60, 6);
+
+   strncpy(p->atnam_raw, record+12, 4);
+   p->atnam_raw[4] = '\0';
+   strncpy(atnambuff, record+12, 5);
+   atnambuff[5] = '\0';
+   atnam = blFixAtomName(atnambuff, p->occ);
+   atnam[4] = '\0';
+   strcpy(p->atnam, atnam);
+   p->altpos = record[16];
+
+   strncpy(p->resnam, record+17, 4);
+   p->resnam[4] = '\0';
+   p->chain[0]  = record[21];
+   p->chain[1]  = '\0';
+   p->insert[0] = record[26];
+   p->insert[1] = '\0';
+   strncpy(p->segid, record+72, 4);
+   p->segid[4]  = '\0';
+
+   for(i=76, j=0; i<78; i++)
+   {
+      if(record[i] != ' ')
+         p->element[j++] = record[i];
+   }
+   p->element[j] = '\0';
+
+   /* Charge is written as 2+ or 1-                                     */
+   p->formal_charge = 0;
+   if(isdigit(record[78]))
+   {
+      p->formal_charge = record[78] - '0';
+      if(record[79] == '-')
+         p->formal_charge = -p->formal_charge;
+   }}
+
+
+/************************************************************************/
+/*>BOOL btAddResidueAtom(RESBUFFER *resBuffer, PDB *p, ATOMFUNC atomFunc,
+                         void *data)
+   ----------------------------------------------------------------------
+*//**
+   \param[in,out] *resBuffer   Atoms of the current residue
+   \param[in]     *p           New atom (owned by the buffer from now)
+   \param[in]     atomFunc     Atom callback
+   \param[in]     *data        Passed to atomFunc
+   \return                     Success?
+
+   Adds an atom to the current residue. If the atom starts a new
+   residue, the previous one is flushed first.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btAddResidueAtom(RESBUFFER *resBuffer, PDB *p, ATOMFUNC atomFunc,
+                      void *data)
+{
+   PDB **atoms;
+
+   if(resBuffer->natoms && !SameResidue(resBuffer->atoms[0], p))
+   {
+      if(!btFlushResidue(resBuffer, atomFunc, data))
+      {
+         free(p);
+         return(FALSE);
+      }
+   }
+
+   if(resBuffer->natoms == resBuffer->maxAtoms)
+   {
+      if((atoms = (PDB **)realloc(resBuffer->atoms,
+                                  (resBuffer->maxAtoms + RESBUFFINC) *
+                                  sizeof(PDB *))) == NULL)
+      {
+         free(p);
+         return(FALSE);
+      }
+      resBuffer->atoms     = atoms;
+      resBuffer->maxAtoms += RESBUFFINC;
+   }
+
+   resBuffer->atoms[resBuffer->natoms++] = p;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL btFlushResidue(RESBUFFER *resBuffer, ATOMFUNC atomFunc,
+                       void *data)
+   ------------------------------------------------------------
+*//**
+   \param[in,out] *resBuffer   Atoms of the current residue
+   \param[in]     atomFunc     Atom callback
+   \param[in]     *data        Passed to atomFunc
+   \return                     Success? (FALSE if atomFunc failed)
+
+   Resolves alternate positions and passes the atoms of the residue to
+   atomFunc. The buffer is empty on return.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btFlushResidue(RESBUFFER *resBuffer, ATOMFUNC atomFunc, void *data)
+{
+   int  i;
+   BOOL ok = TRUE;
+
+   SelectAltPositions(resBuffer->atoms, resBuffer->natoms);
+
+   for(i=0; i<resBuffer->natoms; i++)
+   {
+      if(resBuffer->atoms[i] == NULL)
+         continue;
+      if(ok)
+         ok = (*atomFunc)(resBuffer->atoms[i], data);
+      else
+         free(resBuffer->atoms[i]);
+   }
+   resBuffer->natoms = 0;
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void btFreeResidueBuffer(RESBUFFER *resBuffer)
+   ----------------------------------------------
+*//**
+   \param[in,out] *resBuffer   Residue buffer
+
+   Frees any atoms that have not been passed on and the buffer itself
+
+-  19.10.26 Original   By: agent
+*/
+void btFreeResidueBuffer(RESBUFFER *resBuffer)
+{
+   int i;
+
+   for(i=0; i<resBuffer->natoms; i++)
+   {
+      FREE(resBuffer->atoms[i]);
+   }
+   FREE(resBuffer->atoms);
+   resBuffer->natoms   = 0;
+   resBuffer->maxAtoms = 0;
+}
+
+
+/************************************************************************/
+/*>static BOOL SameResidue(PDB *p, PDB *q)
+   ---------------------------------------
+*//**
+   \param[in]  *p    PDB item
+   \param[in]  *q    PDB item
+   \return           Are they in the same residue?
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL SameResidue(PDB *p, PDB *q)
+{
+   return((p->resnum == q->resnum) &&
+          !strcmp(p->chain,  q->chain) &&
+          !strcmp(p->insert, q->insert) &&
+          !strcmp(p->resnam, q->resnam));
+}
+
+
+/************************************************************************/
+/*>static void SelectAltPositions(PDB **atoms, int natoms)
+   -------------------------------------------------------
+*//**
+   \param[in,out] **atoms   Atoms of one residue
+   \param[in]     natoms    Number of atoms
+
+   Keeps the highest occupancy alternate of each atom (the first if
+   they are equal) in the position of the first alternate. The others
+   are freed and their entries set to NULL.
+
+-  19.10.26 Original   By: agent
+*/
+static void SelectAltPositions(PDB **atoms, int natoms)
+{
+   int i, j;
+
+   for(i=1; i<natoms; i++)
+   {
+      if(atoms[i]->altpos == ' ')
+         continue;
+      for(j=0; j<i; j++)
+      {
+         if((atoms[j] != NULL) && (atoms[j]->altpos != ' ') &&
+            !strcmp(atoms[j]->atnam, atoms[i]->atnam))
+         {
+            if(atoms[i]->occ > atoms[j]->occ)
+            {
+               free(atoms[j]);
+               atoms[j] = atoms[i];
+            }
+            else
+            {
+               free(atoms[i]);
+            }
+            atoms[i] = NULL;
+            break;
+         }
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static REAL ColumnReal(char *line, int start, int width)
+   --------------------------------------------------------
+*//**
+   \param[in]  *line    Record padded to full length
+   \param[in]  start    Offset of the field
+   \param[in]  width    Width of the field
+   \return              Value (0.0 if blank)
+
+-  19.10.26 Original   By: agent
+*/
+static REAL ColumnReal(char *line, int start, int width)
+{
+   char buffer[16];
+
+   strncpy(buffer, line+start, width);
+   buffer[width] = '\0';
+   return((REAL)atof(buffer));
+}
+
+
+/************************************************************************/
+/*>static int ColumnInt(char *line, int start, int width)
+   ------------------------------------------------------
+*//**
+   \param[in]  *line    Record padded to full length
+   \param[in]  start    Offset of the field
+   \param[in]  width    Width of the field
+   \return              Value (0 if blank)
+
+-  19.10.26 Original   By: agent
+*/
+static int ColumnInt(char *line, int start, int width)
+{
+   char buffer[16];
+
+   strncpy(buffer, line+start, width);
+   buffer[width] = '\0';
+   return(atoi(buffer));
+}
+
@@ -0,0 +1,79 @@
+/************************************************************************/
+/**
+
+   \file       pdbstream.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Read PDB files one atom at a time
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Streaming PDB reader. Atoms are passed to a callback a residue at a
+   time rather than being read into a linked list, so memory use does
+   not depend on the size of the file.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBSTREAM_H
+#define _BIOPTOOLS_PDBSTREAM_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef BOOL (*ATOMFUNC)(PDB *p, void *data);
+
+/* The atoms of one residue, held so that alternate positions can be
+   resolved before the atoms are passed on
+*/
+typedef struct
+{
+   PDB  **atoms;
+   int  natoms,
+        maxAtoms;
+}  RESBUFFER;
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL btStreamPDB(FILE *fp, BOOL atomsOnly,
+                 BOOL (*headerFunc)(STRINGLIST *header, void *data),
+                 ATOMFUNC atomFunc, void *data);
+void btParseAtomRecord(char *line, PDB *p);
+BOOL btAddResidueAtom(RESBUFFER *resBuffer, PDB *p, ATOMFUNC atomFunc,
+                      void *data);
+BOOL btFlushResidue(RESBUFFER *resBuffer, ATOMFUNC atomFunc, void *data);
+void btFreeResidueBuffer(RESBUFFER *resBuffer);
+
+#endif
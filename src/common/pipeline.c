@@ -0,0 +1,916 @@
+/************************************************************************/
+/**
+
+   \file       pipeline.c
+
+   \version    V1.3
+   \date       19.10.26
+   \brief      Pass structures between programs run in one process
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The multi-call program (multi/bioptools.c) runs a pipeline such as
+      pdbhstrip in.pdb | pdbrenum | pdbsolv
+   by calling each program's main() in turn. Between stages, stdin and
+   stdout (and so the default files from btOpenStdFiles()) are memory
+   streams made with fopencookie(), so nothing goes through the file
+   system or another process. This relies on the GNU C library, where
+   stdin and stdout can be assigned.
+
+   A program that writes its structure with btWriteWholePDB() (or
+   btPassWholePDB()) to the stage output does not format it. A copy
+   of the WHOLEPDB is kept instead. If the next program reads its input
+   with btReadWholePDB() (or any of the pdbread.c readers) it is given
+   that copy directly. A copy is taken because most programs free or
+   keep using their structure after writing it.
+
+   Text is the fallback in both directions, so every program works in a
+   pipeline:
+   - anything written to the stage output in the normal way is kept as
+     text and becomes the next program's input.
+   - a program that reads its input other than with the shared reader
+     gets the structure written out as text on its first read.
+
+   When no pipeline is running, btPipeInput() and btPipeOutput() return
+   NULL and btWriteWholePDB() just calls blWriteWholePDB().
+
+   Each stage is run with btRunPipeStage(). The programs are compiled
+   for the multi-call program with exit() renamed to btPipeExit() (see
+   makemake.pl), which returns to btRunPipeStage() rather than ending
+   the process, so the pipeline is stopped and cleaned up normally.
+   Anything the program had open or allocated when it called exit() is
+   not freed. btStartPipeStage() also clears the BiopLib globals that a
+   previous stage may have set (FORCEPDB / FORCEXML and the flags set
+   by the readers); each program resets its own globals.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 btWriteWholePDB() is timed as the write phase
+-  V1.2  19.10.26 Added btRunPipeStage() and btPipeExit(). Clears the
+                  BiopLib reader globals for each stage
+-  V1.3  19.10.26 CONECTs to atoms that are not in the list are dropped
+                  when it is copied
+
+*************************************************************************/
+/* Includes
+*/
+#define _GNU_SOURCE   /* fopencookie() and open_memstream()             */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <sys/types.h>
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "pipeline.h"
+#include "timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MINTEXTALLOC 65536
+
+typedef struct
+{
+   FILE     *fp;
+   WHOLEPDB *wpdb;       /* Structure not yet taken or read as text     */
+   char     *text;
+   size_t   size,
+            pos;
+   BOOL     started;     /* Input has been read or taken                */
+}  PIPEINPUT;
+
+typedef struct
+{
+   FILE     *fp;
+   WHOLEPDB *wpdb;       /* Structure passed with btPassWholePDB()      */
+   char     *text;
+   size_t   size,
+            alloc;
+}  PIPEOUTPUT;
+
+typedef struct
+{
+   PDB *atom;
+   int index;
+}  ATOMREF;
+
+/************************************************************************/
+/* Globals
+*/
+static PIPEINPUT  sInput;
+static PIPEOUTPUT sOutput;
+static WHOLEPDB   *sCarryPDB   = NULL;   /* Passed to the next stage    */
+static char       *sCarryText  = NULL;
+static size_t     sCarrySize   = 0;
+static FILE       *sRealStdin  = NULL,
+                  *sRealStdout = NULL;
+static jmp_buf    sExitJump;              /* Return from btPipeExit()    */
+static int        sExitStatus  = 0;
+static BOOL       sInStage     = FALSE;
+
+/************************************************************************/
+/* Prototypes
+*/
+static ssize_t ReadInput(void *cookie, char *buffer, size_t size);
+static int     CloseInput(void *cookie);
+static ssize_t WriteOutput(void *cookie, const char *buffer,
+                           size_t size);
+static int     CloseOutput(void *cookie);
+static BOOL    FormatWholePDB(WHOLEPDB *wpdb, char **text,
+                              size_t *size);
+static WHOLEPDB *CopyWholePDB(WHOLEPDB *wpdb);
+static PDB     *CopyPDBList(PDB *pdb, int *natoms);
+static STRINGLIST *CopyStrings(STRINGLIST *strings);
+static STRINGLIST *HeaderNoRes(WHOLEPDB *wpdb);
+static void    StripHetatoms(WHOLEPDB *wpdb);
+static void    FreeWholePDB(WHOLEPDB *wpdb);
+static int     CompareAtomRefs(const void *a, const void *b);
+static int     FindAtomIndex(ATOMREF *refs, int natoms, PDB *atom);
+
+
+/************************************************************************/
+/*>BOOL btStartPipeStage(BOOL pipeIn, BOOL pipeOut)
+   ------------------------------------------------
+*//**
+   \param[in]  pipeIn    Read from the previous stage
+   \param[in]  pipeOut   Write to the next stage
+   \return               Success?
+
+   Sets up the memory streams for the next program in a pipeline and
+   makes them stdin and stdout. The input is whatever the previous
+   stage left.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btStartPipeStage(BOOL pipeIn, BOOL pipeOut)
+{
+   cookie_io_functions_t inFuncs,
+                         outFuncs;
+
+   memset(&inFuncs,  0, sizeof(cookie_io_functions_t));
+   memset(&outFuncs, 0, sizeof(cookie_io_functions_t));
+   inFuncs.read   = ReadInput;
+   inFuncs.close  = CloseInput;
+   outFuncs.write = WriteOutput;
+   outFuncs.close = CloseOutput;
+
+   memset(&sInput,  0, sizeof(PIPEINPUT));
+   memset(&sOutput, 0, sizeof(PIPEOUTPUT));
+   sRealStdin  = stdin;
+   sRealStdout = stdout;
+
+   /* Clear anything a previous stage left in the BiopLib globals       */
+   gPDBXMLForce      = 0;            /* Neither FORCEPDB nor FORCEXML   */
+   gPDBXML           = FALSE;
+   gPDBPartialOcc    = FALSE;
+   gPDBMultiNMR      = 0;
+   gPDBModelNotFound = FALSE;
+
+   if(pipeIn)
+   {
+      sInput.wpdb = sCarryPDB;
+      sInput.text = sCarryText;
+      sInput.size = sCarrySize;
+      sCarryPDB   = NULL;
+      sCarryText  = NULL;
+      sCarrySize  = 0;
+
+      if((sInput.fp = fopencookie(&sInput, "r", inFuncs)) == NULL)
+         return(FALSE);
+      stdin = sInput.fp;
+   }
+
+   if(pipeOut)
+   {
+      if((sOutput.fp = fopencookie(&sOutput, "w", outFuncs)) == NULL)
+         return(FALSE);
+      stdout = sOutput.fp;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void btEndPipeStage(void)
+   -------------------------
+*//**
+   Closes the streams of the program that has just run and restores
+   stdin and stdout. Whatever it wrote is kept for the next stage: the
+   structure if it passed one and wrote nothing else, otherwise text.
+
+-  19.10.26 Original   By: agent
+*/
+void btEndPipeStage(void)
+{
+   char   *text,
+          *joined;
+   size_t size;
+
+   stdin  = sRealStdin;
+   stdout = sRealStdout;
+
+   if(sInput.fp != NULL)
+      fclose(sInput.fp);
+   if(sInput.wpdb != NULL)
+      FreeWholePDB(sInput.wpdb);
+   FREE(sInput.text);
+
+   if(sOutput.fp != NULL)
+      fclose(sOutput.fp);
+
+   /* Something else was written after the structure, so write the
+      structure as text in front of it
+   */
+   if((sOutput.wpdb != NULL) && (sOutput.size != 0))
+   {
+      if(FormatWholePDB(sOutput.wpdb, &text, &size))
+      {
+         if((joined = (char *)realloc(text, size + sOutput.size)) != NULL)
+         {
+            memcpy(joined + size, sOutput.text, sOutput.size);
+            free(sOutput.text);
+            sOutput.text = joined;
+            sOutput.size += size;
+         }
+         else
+         {
+            free(text);
+         }
+      }
+      FreeWholePDB(sOutput.wpdb);
+      sOutput.wpdb = NULL;
+   }
+
+   sCarryPDB  = sOutput.wpdb;
+   sCarryText = sOutput.text;
+   sCarrySize = sOutput.size;
+
+   memset(&sInput,  0, sizeof(PIPEINPUT));
+   memset(&sOutput, 0, sizeof(PIPEOUTPUT));
+}
+
+
+/************************************************************************/
+/*>void btEndPipeline(void)
+   ------------------------
+*//**
+   Frees anything left by the last stage
+
+-  19.10.26 Original   By: agent
+*/
+void btEndPipeline(void)
+{
+   if(sCarryPDB != NULL)
+      FreeWholePDB(sCarryPDB);
+   FREE(sCarryText);
+   sCarryPDB  = NULL;
+   sCarrySize = 0;
+}
+
+
+/************************************************************************/
+/*>int btRunPipeStage(int (*stageMain)(int argc, char **argv),
+                      int argc, char **argv)
+   -----------------------------------------------------------
+*//**
+   \param[in]  stageMain  The program's main()
+   \param[in]  argc       Argument count
+   \param[in]  **argv     Arguments
+   \return                Exit status of the program
+
+   Runs one stage of a pipeline between btStartPipeStage() and
+   btEndPipeStage(). If the program calls exit() (btPipeExit()) this
+   returns with the status it gave.
+
+-  19.10.26 Original   By: agent
+*/
+int btRunPipeStage(int (*stageMain)(int argc, char **argv),
+                   int argc, char **argv)
+{
+   sExitStatus = 0;
+   if(setjmp(sExitJump) == 0)
+   {
+      sInStage    = TRUE;
+      sExitStatus = (*stageMain)(argc, argv);
+   }
+   sInStage = FALSE;
+
+   return(sExitStatus);
+}
+
+
+/************************************************************************/
+/*>void btPipeExit(int status)
+   ---------------------------
+*//**
+   \param[in]  status   Exit status
+
+   Replaces exit() in the programs built into the multi-call program.
+   Inside btRunPipeStage() it returns to there; otherwise it exits.
+
+-  19.10.26 Original   By: agent
+*/
+void btPipeExit(int status)
+{
+   if(sInStage)
+   {
+      sExitStatus = status;
+      longjmp(sExitJump, 1);
+   }
+   exit(status);
+}
+
+
+/************************************************************************/
+/*>FILE *btPipeInput(void)
+   -----------------------
+*//**
+   \return    Input stream from the previous stage (NULL if none)
+
+   Used by btOpenStdFiles() so that it does not look for compression
+
+-  19.10.26 Original   By: agent
+*/
+FILE *btPipeInput(void)
+{
+   return(sInput.fp);
+}
+
+
+/************************************************************************/
+/*>FILE *btPipeOutput(void)
+   ------------------------
+*//**
+   \return    Output stream to the next stage (NULL if none)
+
+   Used by btOpenStdFiles() in place of stdout
+
+-  19.10.26 Original   By: agent
+*/
+FILE *btPipeOutput(void)
+{
+   return(sOutput.fp);
+}
+
+
+/************************************************************************/
+/*>WHOLEPDB *btTakePipeInput(FILE *fp, BOOL atomsOnly)
+   ---------------------------------------------------
+*//**
+   \param[in]  *fp        File being read
+   \param[in]  atomsOnly  Discard HETATM records
+   \return                Structure passed by the previous stage (NULL
+                          if fp is not a pipeline input with an unread
+                          structure)
+
+   Called by the shared PDB reader before it reads anything. The
+   structure now belongs to the caller.
+
+-  19.10.26 Original   By: agent
+*/
+WHOLEPDB *btTakePipeInput(FILE *fp, BOOL atomsOnly)
+{
+   WHOLEPDB *wpdb;
+
+   if((fp == NULL) || (fp != sInput.fp) || sInput.started ||
+      (sInput.wpdb == NULL))
+      return(NULL);
+
+   wpdb           = sInput.wpdb;
+   sInput.wpdb    = NULL;
+   sInput.started = TRUE;
+
+   if(atomsOnly)
+      StripHetatoms(wpdb);
+   return(wpdb);
+}
+
+
+/************************************************************************/
+/*>BOOL btPassWholePDB(FILE *fp, WHOLEPDB *wpdb, BOOL noResHeader)
+   ---------------------------------------------------------------
+*//**
+   \param[in]  *fp           Output file
+   \param[in]  *wpdb         Structure to write
+   \param[in]  noResHeader   Leave out header records that refer to
+                             residue numbers (as
+                             blWriteWholePDBHeaderNoRes())
+   \return                   Was the structure passed on?
+
+   If fp is the output of a pipeline stage and nothing has been written
+   to it yet, a copy of the structure is kept for the next stage and
+   nothing is written. Otherwise the caller must write the structure.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btPassWholePDB(FILE *fp, WHOLEPDB *wpdb, BOOL noResHeader)
+{
+   WHOLEPDB *copy;
+
+   if((fp == NULL) || (fp != sOutput.fp) || (sOutput.wpdb != NULL))
+      return(FALSE);
+
+   fflush(fp);
+   if(sOutput.size != 0)
+      return(FALSE);
+
+   if((copy = CopyWholePDB(wpdb)) == NULL)
+      return(FALSE);
+
+   if(noResHeader)
+   {
+      blFreeStringList(copy->header);
+      copy->header = HeaderNoRes(wpdb);
+   }
+
+   sOutput.wpdb = copy;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void btWriteWholePDB(FILE *fp, WHOLEPDB *wpdb)
+   ----------------------------------------------
+*//**
+   \param[in]  *fp      Output file
+   \param[in]  *wpdb    Structure to write
+
+   Equivalent to blWriteWholePDB(), but passes the structure on without
+   formatting it when fp is the output of a pipeline stage
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Timed as the write phase
+*/
+void btWriteWholePDB(FILE *fp, WHOLEPDB *wpdb)
+{
+   int phase = btSetTimingPhase(BT_PHASE_WRITE);
+
+   if(!btPassWholePDB(fp, wpdb, FALSE))
+      blWriteWholePDB(fp, wpdb);
+
+   btSetTimingPhase(phase);
+}
+
+
+/************************************************************************/
+/*>static ssize_t ReadInput(void *cookie, char *buffer, size_t size)
+   -----------------------------------------------------------------
+*//**
+   \param[in]  *cookie   PIPEINPUT
+   \param[out] *buffer   Buffer to fill
+   \param[in]  size      Size of buffer
+   \return               Bytes read (0 at end of file, -1 on error)
+
+   fopencookie() read function. A structure that has not been taken
+   is formatted as text on the first read.
+
+-  19.10.26 Original   By: agent
+*/
+static ssize_t ReadInput(void *cookie, char *buffer, size_t size)
+{
+   PIPEINPUT *input = (PIPEINPUT *)cookie;
+
+   if(!input->started)
+   {
+      input->started = TRUE;
+      if(input->wpdb != NULL)
+      {
+         FREE(input->text);
+         if(!FormatWholePDB(input->wpdb, &(input->text), &(input->size)))
+            return(-1);
+         FreeWholePDB(input->wpdb);
+         input->wpdb = NULL;
+      }
+   }
+
+   if(input->pos >= input->size)
+      return(0);
+   if(size > input->size - input->pos)
+      size = input->size - input->pos;
+   memcpy(buffer, input->text + input->pos, size);
+   input->pos += size;
+   return((ssize_t)size);
+}
+
+
+/************************************************************************/
+/*>static int CloseInput(void *cookie)
+   -----------------------------------
+*//**
+   \param[in]  *cookie   PIPEINPUT
+   \return               0
+
+   fopencookie() close function. The data are freed at the end of the
+   stage.
+
+-  19.10.26 Original   By: agent
+*/
+static int CloseInput(void *cookie)
+{
+   ((PIPEINPUT *)cookie)->fp = NULL;
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static ssize_t WriteOutput(void *cookie, const char *buffer,
+                              size_t size)
+   ------------------------------------------------------------
+*//**
+   \param[in]  *cookie   PIPEOUTPUT
+   \param[in]  *buffer   Data to write
+   \param[in]  size      Bytes to write
+   \return               Bytes written (0 on error)
+
+   fopencookie() write function. Appends to the text buffer.
+
+-  19.10.26 Original   By: agent
+*/
+static ssize_t WriteOutput(void *cookie, const char *buffer, size_t size)
+{
+   PIPEOUTPUT *output = (PIPEOUTPUT *)cookie;
+   char       *text;
+   size_t     alloc;
+
+   if(output->size + size > output->alloc)
+   {
+      alloc = (output->alloc < MINTEXTALLOC) ? MINTEXTALLOC :
+                                               output->alloc;
+      while(alloc < output->size + size)
+         alloc *= 2;
+      if((text = (char *)realloc(output->text, alloc)) == NULL)
+         return(0);
+      output->text  = text;
+      output->alloc = alloc;
+   }
+
+   memcpy(output->text + output->size, buffer, size);
+   output->size += size;
+   return((ssize_t)size);
+}
+
+
+/************************************************************************/
+/*>static int CloseOutput(void *cookie)
+   ------------------------------------
+*//**
+   \param[in]  *cookie   PIPEOUTPUT
+   \return               0
+
+   fopencookie() close function. The text is kept for the next stage.
+
+-  19.10.26 Original   By: agent
+*/
+static int CloseOutput(void *cookie)
+{
+   ((PIPEOUTPUT *)cookie)->fp = NULL;
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static BOOL FormatWholePDB(WHOLEPDB *wpdb, char **text, size_t *size)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]  *wpdb    Structure
+   \param[out] **text   Malloc'd text written by blWriteWholePDB()
+   \param[out] *size    Length of the text
+   \return              Success?
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL FormatWholePDB(WHOLEPDB *wpdb, char **text, size_t *size)
+{
+   FILE *fp;
+
+   *text = NULL;
+   *size = 0;
+   if((fp = open_memstream(text, size)) == NULL)
+      return(FALSE);
+   blWriteWholePDB(fp, wpdb);
+   fclose(fp);
+   return(*text != NULL);
+}
+
+
+/************************************************************************/
+/*>static WHOLEPDB *CopyWholePDB(WHOLEPDB *wpdb)
+   ---------------------------------------------
+*//**
+   \param[in]  *wpdb    Structure
+   \return              Copy of the structure (NULL if out of memory)
+
+-  19.10.26 Original   By: agent
+*/
+static WHOLEPDB *CopyWholePDB(WHOLEPDB *wpdb)
+{
+   WHOLEPDB *copy;
+
+   if((copy = (WHOLEPDB *)malloc(sizeof(WHOLEPDB))) == NULL)
+      return(NULL);
+   *copy = *wpdb;
+   copy->header  = CopyStrings(wpdb->header);
+   copy->trailer = CopyStrings(wpdb->trailer);
+
+   if(((copy->pdb = CopyPDBList(wpdb->pdb, &(copy->natoms))) == NULL) &&
+      (wpdb->pdb != NULL))
+   {
+      FreeWholePDB(copy);
+      return(NULL);
+   }
+
+   return(copy);
+}
+
+
+/************************************************************************/
+/*>static PDB *CopyPDBList(PDB *pdb, int *natoms)
+   ----------------------------------------------
+*//**
+   \param[in]  *pdb      PDB linked list
+   \param[out] *natoms   Number of atoms
+   \return               Copy of the list (NULL if out of memory)
+
+   Each atom is copied into its own allocation so the list can be freed
+   with FREELIST(). CONECT pointers are moved to the new atoms. A
+   program that removes atoms from its list (e.g. pdbgetchain) may
+   leave CONECTs to them; these are dropped.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Drops CONECTs to atoms that are not in the list
+*/
+static PDB *CopyPDBList(PDB *pdb, int *natoms)
+{
+   PDB     *p,
+           **copies;
+   ATOMREF *refs;
+   int     i, j, k, n = 0,
+           index;
+
+   *natoms = 0;
+   for(p=pdb; p!=NULL; NEXT(p))
+      n++;
+   if(n == 0)
+      return(NULL);
+
+   copies = (PDB **)malloc(n * sizeof(PDB *));
+   refs   = (ATOMREF *)malloc(n * sizeof(ATOMREF));
+   if((copies == NULL) || (refs == NULL))
+   {
+      FREE(copies);
+      FREE(refs);
+      return(NULL);
+   }
+
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      if((copies[i] = (PDB *)malloc(sizeof(PDB))) == NULL)
+      {
+         while(--i >= 0)
+            free(copies[i]);
+         free(copies);
+         free(refs);
+         return(NULL);
+      }
+      *(copies[i])  = *p;
+      refs[i].atom  = p;
+      refs[i].index = i;
+   }
+
+   qsort(refs, n, sizeof(ATOMREF), CompareAtomRefs);
+   for(i=0; i<n; i++)
+   {
+      copies[i]->next = (i < n-1) ? copies[i+1] : NULL;
+      for(j=0, k=0; j<copies[i]->nConect; j++)
+      {
+         index = FindAtomIndex(refs, n, copies[i]->conect[j]);
+         if(index >= 0)
+            copies[i]->conect[k++] = copies[index];
+      }
+      copies[i]->nConect = k;
+   }
+
+   p = copies[0];
+   free(copies);
+   free(refs);
+   *natoms = n;
+   return(p);
+}
+
+
+/************************************************************************/
+/*>static STRINGLIST *CopyStrings(STRINGLIST *strings)
+   ---------------------------------------------------
+*//**
+   \param[in]  *strings   String list
+   \return                Copy of the list
+
+-  19.10.26 Original   By: agent
+*/
+static STRINGLIST *CopyStrings(STRINGLIST *strings)
+{
+   STRINGLIST *copy = NULL,
+              *last = NULL,
+              *s;
+
+   for(s=strings; s!=NULL; NEXT(s))
+   {
+      if((last = blStoreString(last, s->string)) == NULL)
+         break;
+      if(copy == NULL)
+         copy = last;
+      else
+         last = last->next;
+   }
+   return(copy);
+}
+
+
+/************************************************************************/
+/*>static STRINGLIST *HeaderNoRes(WHOLEPDB *wpdb)
+   ----------------------------------------------
+*//**
+   \param[in]  *wpdb    Structure
+   \return              Header lines written by
+                        blWriteWholePDBHeaderNoRes()
+
+-  19.10.26 Original   By: agent
+*/
+static STRINGLIST *HeaderNoRes(WHOLEPDB *wpdb)
+{
+   STRINGLIST *header = NULL,
+              *last   = NULL;
+   FILE       *fp;
+   char       *text   = NULL,
+              *line,
+              *end,
+              save;
+   size_t     size    = 0;
+
+   if((fp = open_memstream(&text, &size)) == NULL)
+      return(NULL);
+   blWriteWholePDBHeaderNoRes(fp, wpdb);
+   fclose(fp);
+   if(text == NULL)
+      return(NULL);
+
+   for(line=text; *line; line=end)
+   {
+      if((end = strchr(line, '\n')) == NULL)
+         end = line + strlen(line);
+      else
+         end++;
+      save = *end;
+      *end = '\0';
+      if((last = blStoreString(last, line)) != NULL)
+      {
+         if(header == NULL)
+            header = last;
+         else
+            last = last->next;
+      }
+      *end = save;
+   }
+
+   free(text);
+   return(header);
+}
+
+
+/************************************************************************/
+/*>static void StripHetatoms(WHOLEPDB *wpdb)
+   -----------------------------------------
+*//**
+   \param[in,out]  *wpdb   Structure
+
+   Removes HETATM records, and CONECTs to them, as
+   blReadWholePDBAtoms() would not have read them
+
+-  19.10.26 Original   By: agent
+*/
+static void StripHetatoms(WHOLEPDB *wpdb)
+{
+   PDB *p,
+       *prev = NULL,
+       *next;
+   int i, j;
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      if(!strncmp(p->record_type, "HETATM", 6))
+         continue;
+      for(i=0, j=0; i<p->nConect; i++)
+      {
+         if((p->conect[i] != NULL) &&
+            strncmp(p->conect[i]->record_type, "HETATM", 6))
+            p->conect[j++] = p->conect[i];
+      }
+      p->nConect = j;
+   }
+
+   wpdb->natoms = 0;
+   for(p=wpdb->pdb; p!=NULL; p=next)
+   {
+      next = p->next;
+      if(!strncmp(p->record_type, "HETATM", 6))
+      {
+         if(prev == NULL)
+            wpdb->pdb = next;
+         else
+            prev->next = next;
+         free(p);
+      }
+      else
+      {
+         prev = p;
+         wpdb->natoms++;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void FreeWholePDB(WHOLEPDB *wpdb)
+   ----------------------------------------
+*//**
+   \param[in]  *wpdb   WHOLEPDB structure to free
+
+-  19.10.26 Original   By: agent
+*/
+static void FreeWholePDB(WHOLEPDB *wpdb)
+{
+   FREELIST(wpdb->pdb, PDB);
+   blFreeStringList(wpdb->header);
+   blFreeStringList(wpdb->trailer);
+   free(wpdb);
+}
+
+
+/************************************************************************/
+/*>static int CompareAtomRefs(const void *a, const void *b)
+   --------------------------------------------------------
+*//**
+   qsort() comparison of ATOMREFs by atom address
+
+-  19.10.26 Original   By: agent
+*/
+static int CompareAtomRefs(const void *a, const void *b)
+{
+   const char *pa = (const char *)((const ATOMREF *)a)->atom,
+              *pb = (const char *)((const ATOMREF *)b)->atom;
+
+   if(pa < pb)
+      return(-1);
+   if(pa > pb)
+      return(1);
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static int FindAtomIndex(ATOMREF *refs, int natoms, PDB *atom)
+   --------------------------------------------------------------
+*//**
+   \param[in]  *refs    ATOMREFs sorted by address
+   \param[in]  natoms   Number of ATOMREFs
+   \param[in]  *atom    Atom to find
+   \return              Index of the atom in the list (-1 if absent)
+
+-  19.10.26 Original   By: agent
+*/
+static int FindAtomIndex(ATOMREF *refs, int natoms, PDB *atom)
+{
+   ATOMREF key,
+           *found;
+
+   key.atom  = atom;
+   key.index = 0;
+   found = (ATOMREF *)bsearch(&key, refs, natoms, sizeof(ATOMREF),
+                              CompareAtomRefs);
+   return((found == NULL) ? -1 : found->index);
+}
+
@@ -0,0 +1,68 @@
+/************************************************************************/
+/**
+
+   \file       pipeline.h
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Pass structures between programs run in one process
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btRunPipeStage() and btPipeExit()
+
+*************************************************************************/
+#ifndef _BT_PIPELINE_H
+#define _BT_PIPELINE_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+/* Used by the multi-call program to connect the stages                 */
+BOOL     btStartPipeStage(BOOL pipeIn, BOOL pipeOut);
+void     btEndPipeStage(void);
+void     btEndPipeline(void);
+int      btRunPipeStage(int (*stageMain)(int argc, char **argv),
+                        int argc, char **argv);
+void     btPipeExit(int status);
+
+/* Used by the shared I/O code and the programs                         */
+FILE     *btPipeInput(void);
+FILE     *btPipeOutput(void);
+WHOLEPDB *btTakePipeInput(FILE *fp, BOOL atomsOnly);
+BOOL     btPassWholePDB(FILE *fp, WHOLEPDB *wpdb, BOOL noResHeader);
+void     btWriteWholePDB(FILE *fp, WHOLEPDB *wpdb);
+
+#endif
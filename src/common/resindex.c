@@ -0,0 +1,306 @@
+/************************************************************************/
+/**
+
+   \file       resindex.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Residue and chain index over a PDB linked list
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Residues are split as blFindNextResidue() splits them. A new chain
+   starts wherever the chain label changes, as in blAllocPDBStructure(),
+   so a label may be used by more than one chain (e.g. a block of
+   HETATMs after the other chains).
+
+   The hash holds a key for each chain label (the first chain with the
+   label) and three keys for each residue: one for any residue, one
+   for residues that start with an ATOM record and one for those that
+   start with a HETATM record. The first residue matching a key wins,
+   as with blFindResidue(). Since the first chain with a label comes
+   before any other chain with that label, a residue found by
+   btFindIndexedResidue() is in that first chain if it is there at all.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "bioplib/hash.h"
+#include "resindex.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXKEY      32
+#define CHAIN_KEY   'C'
+#define ANY_KEY     ' '
+#define ATOM_KEY    'A'
+#define HETATM_KEY  'H'
+
+/************************************************************************/
+/* Prototypes
+*/
+static void MakeResidueKey(char *key, char *chain, int resnum,
+                           char *insert, char recType);
+static BOOL AddKey(HASHTABLE *hash, char *key, int value);
+
+
+/************************************************************************/
+/*>RESINDEX *btBuildResIndex(PDB *pdb)
+   -----------------------------------
+*//**
+   \param[in]  *pdb    PDB linked list
+   \return             The index (NULL if no memory)
+
+-  19.10.26 Original   By: agent
+*/
+RESINDEX *btBuildResIndex(PDB *pdb)
+{
+   RESINDEX *index;
+   PDB      *p,
+            *res,
+            *nextRes;
+   char     key[MAXKEY],
+            recType;
+   int      atom = 0;
+   BOOL     ok   = TRUE;
+
+   if((index = (RESINDEX *)calloc(1, sizeof(RESINDEX))) == NULL)
+      return(NULL);
+
+   for(res=pdb; res!=NULL; res=blFindNextResidue(res))
+      index->nres++;
+
+   if((index->atoms = blIndexPDB(pdb, &(index->natoms))) == NULL &&
+      (pdb != NULL))
+   {
+      btFreeResIndex(index);
+      return(NULL);
+   }
+
+   index->resStart   = (PDB **)malloc((index->nres+1) * sizeof(PDB *));
+   index->resOfAtom  = (int *)malloc((index->natoms+1) * sizeof(int));
+   index->chainOfRes = (int *)malloc((index->nres+1) * sizeof(int));
+   index->chainStart = (int *)malloc((index->nres+1) * sizeof(int));
+   index->resHash    = blInitializeHash((ULONG)(4*index->nres+1));
+   if((index->resStart   == NULL) || (index->resOfAtom  == NULL) ||
+      (index->chainOfRes == NULL) || (index->chainStart == NULL) ||
+      (index->resHash    == NULL))
+   {
+      btFreeResIndex(index);
+      return(NULL);
+   }
+
+   index->nres = 0;
+   for(res=pdb; res!=NULL; res=nextRes)
+   {
+      nextRes = blFindNextResidue(res);
+      index->resStart[index->nres] = res;
+      for(p=res; p!=nextRes; NEXT(p))
+         index->resOfAtom[atom++] = index->nres;
+
+      if((index->nres == 0) ||
+         !CHAINMATCH(res->chain, index->resStart[index->nres-1]->chain))
+      {
+         sprintf(key, "%c|%.8s", CHAIN_KEY, res->chain);
+         ok = ok && AddKey(index->resHash, key, index->nchains);
+         index->chainStart[index->nchains++] = index->nres;
+      }
+      index->chainOfRes[index->nres] = index->nchains - 1;
+
+      recType = (char)(strncmp(res->record_type, "HETATM", 6) ?
+                       ATOM_KEY : HETATM_KEY);
+      MakeResidueKey(key, res->chain, res->resnum, res->insert, ANY_KEY);
+      ok = ok && AddKey(index->resHash, key, index->nres);
+      MakeResidueKey(key, res->chain, res->resnum, res->insert, recType);
+      ok = ok && AddKey(index->resHash, key, index->nres);
+
+      index->nres++;
+   }
+   index->resStart[index->nres]      = NULL;
+   index->chainStart[index->nchains] = index->nres;
+
+   if(!ok)
+   {
+      btFreeResIndex(index);
+      return(NULL);
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>void btFreeResIndex(RESINDEX *index)
+   ------------------------------------
+*//**
+   \param[in]  *index   Index to free (the PDB list is not touched)
+
+-  19.10.26 Original   By: agent
+*/
+void btFreeResIndex(RESINDEX *index)
+{
+   if(index == NULL)
+      return;
+
+   if(index->resHash != NULL)
+      blFreeHash(index->resHash);
+   FREE(index->atoms);
+   FREE(index->resStart);
+   FREE(index->resOfAtom);
+   FREE(index->chainOfRes);
+   FREE(index->chainStart);
+   free(index);
+}
+
+
+/************************************************************************/
+/*>int btFindIndexedChain(RESINDEX *index, char *chain)
+   ----------------------------------------------------
+*//**
+   \param[in]  *index   Residue index
+   \param[in]  *chain   Chain label
+   \return              Number of the first chain with this label, or -1
+
+-  19.10.26 Original   By: agent
+*/
+int btFindIndexedChain(RESINDEX *index, char *chain)
+{
+   char key[MAXKEY];
+
+   sprintf(key, "%c|%.8s", CHAIN_KEY, chain);
+   if(!blHashKeyDefined(index->resHash, key))
+      return(-1);
+   return(blGetHashValueInt(index->resHash, key));
+}
+
+
+/************************************************************************/
+/*>int btFindIndexedResidue(RESINDEX *index, char *chain, int resnum,
+                            char *insert, char recType)
+   ------------------------------------------------------------------
+*//**
+   \param[in]  *index    Residue index
+   \param[in]  *chain    Chain label
+   \param[in]  resnum    Residue number
+   \param[in]  *insert   Insert code (blank or empty for none)
+   \param[in]  recType   'A' to find only residues starting with an
+                         ATOM record, 'H' for HETATM, ' ' for either
+   \return               Number of the first matching residue, or -1
+
+   Hashed equivalent of blFindResidue()
+
+-  19.10.26 Original   By: agent
+*/
+int btFindIndexedResidue(RESINDEX *index, char *chain, int resnum,
+                         char *insert, char recType)
+{
+   char key[MAXKEY];
+
+   MakeResidueKey(key, chain, resnum, insert, recType);
+   if(!blHashKeyDefined(index->resHash, key))
+      return(-1);
+   return(blGetHashValueInt(index->resHash, key));
+}
+
+
+/************************************************************************/
+/*>int btFindIndexedResSpec(RESINDEX *index, char *resspec, char recType)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]  *index    Residue index
+   \param[in]  *resspec  Residue specification (e.g. L24A)
+   \param[in]  recType   As for btFindIndexedResidue()
+   \return               Number of the first matching residue, -1 if not
+                         found, -2 if the specification is not valid
+
+   Hashed equivalent of blFindResidueSpec()
+
+-  19.10.26 Original   By: agent
+*/
+int btFindIndexedResSpec(RESINDEX *index, char *resspec, char recType)
+{
+   char chain[blMAXCHAINLABEL],
+        insert[8];
+   int  resnum;
+
+   if((strlen(resspec) >= MAXKEY) ||
+      !blParseResSpec(resspec, chain, &resnum, insert))
+      return(-2);
+
+   return(btFindIndexedResidue(index, chain, resnum, insert, recType));
+}
+
+
+/************************************************************************/
+/*>static void MakeResidueKey(char *key, char *chain, int resnum,
+                              char *insert, char recType)
+   --------------------------------------------------------------
+*//**
+   \param[out] *key      Hash key (MAXKEY)
+   \param[in]  *chain    Chain label
+   \param[in]  resnum    Residue number
+   \param[in]  *insert   Insert code
+   \param[in]  recType   Record type (see btFindIndexedResidue())
+
+   Blank and missing insert codes are treated as the same
+
+-  19.10.26 Original   By: agent
+*/
+static void MakeResidueKey(char *key, char *chain, int resnum,
+                           char *insert, char recType)
+{
+   sprintf(key, "%c|%.8s|%d|%c", recType, chain, resnum,
+           ((insert[0]=='\0') ? ' ' : insert[0]));
+}
+
+
+/************************************************************************/
+/*>static BOOL AddKey(HASHTABLE *hash, char *key, int value)
+   ---------------------------------------------------------
+*//**
+   \param[in]  *hash    Hash table
+   \param[in]  *key     Key
+   \param[in]  value    Value
+   \return              FALSE if there was no memory
+
+   Stores a key unless it is already there, so the first value wins
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL AddKey(HASHTABLE *hash, char *key, int value)
+{
+   if(blHashKeyDefined(hash, key))
+      return(TRUE);
+   return(blSetHashValueInt(hash, key, value));
+}
@@ -0,0 +1,87 @@
+/************************************************************************/
+/**
+
+   \file       resindex.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Residue and chain index over a PDB linked list
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Built once after a structure has been read (and after anything that
+   adds or removes atoms), the index numbers the atoms, residues and
+   chains in list order so that a program can step between them and
+   look residues up by specification without walking the list.
+
+   Residue r runs from BTRESSTART(index, r) up to, but not including,
+   BTRESEND(index, r), as with blFindNextResidue(). Chain c contains
+   residues index->chainStart[c] to index->chainStart[c+1]-1.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_RESINDEX_H
+#define _BIOPTOOLS_RESINDEX_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+#include "bioplib/hash.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef struct
+{
+   PDB       **atoms,       /* All atoms in list order                  */
+             **resStart;    /* First atom of each residue, then NULL    */
+   int       *resOfAtom,    /* Residue of each atom                     */
+             *chainOfRes,   /* Chain of each residue                    */
+             *chainStart;   /* First residue of each chain, then nres   */
+   HASHTABLE *resHash;      /* Residue and chain specs to numbers       */
+   int       natoms,
+             nres,
+             nchains;
+}  RESINDEX;
+
+#define BTRESSTART(index, r) ((index)->resStart[(r)])
+#define BTRESEND(index, r)   ((index)->resStart[(r)+1])
+
+/************************************************************************/
+/* Prototypes
+*/
+RESINDEX *btBuildResIndex(PDB *pdb);
+void     btFreeResIndex(RESINDEX *index);
+int      btFindIndexedChain(RESINDEX *index, char *chain);
+int      btFindIndexedResidue(RESINDEX *index, char *chain, int resnum,
+                              char *insert, char recType);
+int      btFindIndexedResSpec(RESINDEX *index, char *resspec,
+                              char recType);
+
+#endif
@@ -0,0 +1,459 @@
+/************************************************************************/
+/**
+
+   \file       spatial.c
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Uniform grid spatial index over PDB atoms
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Builds a uniform grid over an array of PDB atom pointers (as
+   returned by blIndexPDB() or collected by hand) with a counting sort
+   so that the atoms of each cell are contiguous. Coordinates are
+   copied into packed arrays in the same order so that a neighbour
+   query does not need to touch the PDB nodes at all.
+
+   Typical use:
+
+      grid = btBuildSpatialGrid(atoms, natoms, radius);
+      btStartGridQuery(&query, grid, p->x, p->y, p->z, radius*radius);
+      while((i = btNextGridNeighbour(&query, &distSq)) >= 0)
+      {
+         ... atoms[i] is within radius of p ...
+      }
+      btFreeSpatialGrid(grid);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btBuildSpatialGridXYZ() for points that are not
+                  PDB atoms
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <math.h>
+#include "bioplib/macros.h"
+#include "spatial.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MINCELLSIZE      0.5   /* Smallest cell edge we will use        */
+#define MAXCELLSPERATOM  4     /* Cap on grid size relative to natoms   */
+#define MINCELLS         64
+
+/************************************************************************/
+/* Prototypes
+*/
+static void SizeGrid(SPATIALGRID *grid, REAL xmax, REAL ymax,
+                     REAL zmax);
+static int  CellCoord(REAL value, REAL min, REAL cellSize, int n);
+static BOOL NextCell(GRIDQUERY *query);
+
+
+/************************************************************************/
+/*>SPATIALGRID *btBuildSpatialGrid(PDB **atoms, int natoms,
+                                   REAL cellSize)
+   ----------------------------------------------------------------
+*//**
+   \param[in]    atoms      Array of PDB pointers
+   \param[in]    natoms     Number of atoms in the array
+   \param[in]    cellSize   Requested cell edge (normally the largest
+                            distance that will be queried)
+   \return                  Spatial grid or NULL if out of memory
+
+   Bins the atoms into a uniform grid. The cell edge may be increased
+   for very sparse structures so that the number of cells never
+   exceeds a small multiple of the number of atoms. Indexes returned
+   by btNextGridNeighbour() are indexes into the atoms[] array.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Now a wrapper to btBuildSpatialGridXYZ()
+*/
+SPATIALGRID *btBuildSpatialGrid(PDB **atoms, int natoms, REAL cellSize)
+{
+   SPATIALGRID *grid = NULL;
+   REAL        *x, *y, *z;
+   int         i;
+
+   x = (REAL *)malloc((natoms+1) * sizeof(REAL));
+   y = (REAL *)malloc((natoms+1) * sizeof(REAL));
+   z = (REAL *)malloc((natoms+1) * sizeof(REAL));
+
+   if((x != NULL) && (y != NULL) && (z != NULL))
+   {
+      for(i=0; i<natoms; i++)
+      {
+         x[i] = atoms[i]->x;
+         y[i] = atoms[i]->y;
+         z[i] = atoms[i]->z;
+      }
+      grid = btBuildSpatialGridXYZ(x, y, z, natoms, cellSize);
+   }
+
+   FREE(x);
+   FREE(y);
+   FREE(z);
+
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>SPATIALGRID *btBuildSpatialGridXYZ(REAL *x, REAL *y, REAL *z, 
+                                      int npoints, REAL cellSize)
+   ------------------------------------------------------------------
+*//**
+   \param[in]    x          Array of x coordinates
+   \param[in]    y          Array of y coordinates
+   \param[in]    z          Array of z coordinates
+   \param[in]    npoints    Number of points
+   \param[in]    cellSize   Requested cell edge
+   \return                  Spatial grid or NULL if out of memory
+
+   As btBuildSpatialGrid() but for points that are not PDB atoms (e.g.
+   residue centroids). The coordinates are copied so the arrays may
+   be freed afterwards.
+
+-  19.10.26 Original    By: agent
+*/
+SPATIALGRID *btBuildSpatialGridXYZ(REAL *x, REAL *y, REAL *z,
+                                   int npoints, REAL cellSize)
+{
+   SPATIALGRID *grid;
+   REAL        xmax, ymax, zmax;
+   int         *cellOf = NULL,
+               *fill   = NULL,
+               ncells,
+               i;
+
+   if((grid = (SPATIALGRID *)malloc(sizeof(SPATIALGRID)))==NULL)
+      return(NULL);
+
+   grid->natoms    = npoints;
+   grid->cellSize  = (cellSize < MINCELLSIZE) ? MINCELLSIZE : cellSize;
+   grid->x         = grid->y = grid->z = NULL;
+   grid->cellStart = grid->atomIndex = NULL;
+   grid->xmin      = grid->ymin = grid->zmin = 0.0;
+   xmax            = ymax = zmax = 0.0;
+
+   /* Find the bounding box                                             */
+   for(i=0; i<npoints; i++)
+   {
+      if(i==0)
+      {
+         grid->xmin = xmax = x[i];
+         grid->ymin = ymax = y[i];
+         grid->zmin = zmax = z[i];
+      }
+      else
+      {
+         grid->xmin = MIN(grid->xmin, x[i]);
+         grid->ymin = MIN(grid->ymin, y[i]);
+         grid->zmin = MIN(grid->zmin, z[i]);
+         xmax       = MAX(xmax,       x[i]);
+         ymax       = MAX(ymax,       y[i]);
+         zmax       = MAX(zmax,       z[i]);
+      }
+   }
+
+   SizeGrid(grid, xmax, ymax, zmax);
+   ncells = grid->nx * grid->ny * grid->nz;
+
+   grid->cellStart = (int *)calloc(ncells+1, sizeof(int));
+   grid->atomIndex = (int *)malloc((npoints+1) * sizeof(int));
+   grid->x         = (REAL *)malloc((npoints+1) * sizeof(REAL));
+   grid->y         = (REAL *)malloc((npoints+1) * sizeof(REAL));
+   grid->z         = (REAL *)malloc((npoints+1) * sizeof(REAL));
+   cellOf          = (int *)malloc((npoints+1) * sizeof(int));
+   fill            = (int *)malloc((ncells+1) * sizeof(int));
+
+   if((grid->cellStart == NULL) || (grid->atomIndex == NULL) ||
+      (grid->x == NULL) || (grid->y == NULL) || (grid->z == NULL) ||
+      (cellOf == NULL) || (fill == NULL))
+   {
+      FREE(cellOf);
+      FREE(fill);
+      btFreeSpatialGrid(grid);
+      return(NULL);
+   }
+
+   /* Counting sort of the points by cell                               */
+   for(i=0; i<npoints; i++)
+   {
+      cellOf[i] =
+         (CellCoord(x[i], grid->xmin, grid->cellSize, grid->nx) *
+          grid->ny +
+          CellCoord(y[i], grid->ymin, grid->cellSize, grid->ny)) *
+         grid->nz +
+         CellCoord(z[i], grid->zmin, grid->cellSize, grid->nz);
+      grid->cellStart[cellOf[i]+1]++;
+   }
+   for(i=0; i<ncells; i++)
+   {
+      grid->cellStart[i+1] += grid->cellStart[i];
+      fill[i]               = grid->cellStart[i];
+   }
+   for(i=0; i<npoints; i++)
+   {
+      int slot = fill[cellOf[i]]++;
+      grid->atomIndex[slot] = i;
+      grid->x[slot]         = x[i];
+      grid->y[slot]         = y[i];
+      grid->z[slot]         = z[i];
+   }
+
+   free(cellOf);
+   free(fill);
+
+   return(grid);
+}
+
+
+/************************************************************************/
+/*>void btFreeSpatialGrid(SPATIALGRID *grid)
+   -----------------------------------------
+*//**
+   \param[in]    grid   Spatial grid
+
+   Frees a grid built by btBuildSpatialGrid(). The atoms themselves are
+   owned by the caller and are not touched.
+
+-  19.10.26 Original    By: agent
+*/
+void btFreeSpatialGrid(SPATIALGRID *grid)
+{
+   if(grid != NULL)
+   {
+      FREE(grid->x);
+      FREE(grid->y);
+      FREE(grid->z);
+      FREE(grid->cellStart);
+      FREE(grid->atomIndex);
+      free(grid);
+   }
+}
+
+
+/************************************************************************/
+/*>void btStartGridQuery(GRIDQUERY *query, SPATIALGRID *grid,
+                         REAL x, REAL y, REAL z, REAL radiusSq)
+   ------------------------------------------------------------
+*//**
+   \param[out]   query      Query state to initialize
+   \param[in]    grid       Spatial grid
+   \param[in]    x          Query point x
+   \param[in]    y          Query point y
+   \param[in]    z          Query point z
+   \param[in]    radiusSq   Squared query distance
+
+   Sets up a query for all atoms within sqrt(radiusSq) of (x,y,z). The
+   atoms are then obtained by calling btNextGridNeighbour(). The radius
+   may be larger than the cell size, in which case more cells are
+   visited.
+
+-  19.10.26 Original    By: agent
+*/
+void btStartGridQuery(GRIDQUERY *query, SPATIALGRID *grid,
+                      REAL x, REAL y, REAL z, REAL radiusSq)
+{
+   REAL radius = sqrt(radiusSq);
+
+   query->grid     = grid;
+   query->x        = x;
+   query->y        = y;
+   query->z        = z;
+   query->radiusSq = radiusSq;
+
+   query->xlo = (int)floor((x - radius - grid->xmin) / grid->cellSize);
+   query->xhi = (int)floor((x + radius - grid->xmin) / grid->cellSize);
+   query->ylo = (int)floor((y - radius - grid->ymin) / grid->cellSize);
+   query->yhi = (int)floor((y + radius - grid->ymin) / grid->cellSize);
+   query->zlo = (int)floor((z - radius - grid->zmin) / grid->cellSize);
+   query->zhi = (int)floor((z + radius - grid->zmin) / grid->cellSize);
+
+   query->xlo = MAX(query->xlo, 0);
+   query->ylo = MAX(query->ylo, 0);
+   query->zlo = MAX(query->zlo, 0);
+   query->xhi = MIN(query->xhi, grid->nx-1);
+   query->yhi = MIN(query->yhi, grid->ny-1);
+   query->zhi = MIN(query->zhi, grid->nz-1);
+
+   /* Position just before the first cell; an empty box leaves ix past
+      the end so that the first call to NextCell() fails
+   */
+   query->ix      = query->xlo;
+   query->iy      = query->ylo;
+   query->iz      = query->zlo - 1;
+   query->slot    = query->slotEnd = 0;
+
+   if((query->xlo > query->xhi) || (query->ylo > query->yhi) ||
+      (query->zlo > query->zhi))
+   {
+      query->ix = query->xhi + 1;
+   }
+}
+
+
+/************************************************************************/
+/*>int btNextGridNeighbour(GRIDQUERY *query, REAL *distSq)
+   -------------------------------------------------------
+*//**
+   \param[in,out] query    Query state from btStartGridQuery()
+   \param[out]    distSq   Squared distance to the atom (may be NULL)
+   \return                 Index of the next atom in range, or -1 when
+                           there are no more
+
+   Returns the next atom within the query distance. Atoms are returned
+   in cell order, not in the order of the original array.
+
+-  19.10.26 Original    By: agent
+*/
+int btNextGridNeighbour(GRIDQUERY *query, REAL *distSq)
+{
+   SPATIALGRID *grid = query->grid;
+
+   for(;;)
+   {
+      while(query->slot < query->slotEnd)
+      {
+         int  slot = query->slot++;
+         REAL dx   = grid->x[slot] - query->x,
+              dy   = grid->y[slot] - query->y,
+              dz   = grid->z[slot] - query->z,
+              d    = dx*dx + dy*dy + dz*dz;
+
+         if(d <= query->radiusSq)
+         {
+            if(distSq != NULL)
+               *distSq = d;
+            return(grid->atomIndex[slot]);
+         }
+      }
+
+      if(!NextCell(query))
+         return(-1);
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL NextCell(GRIDQUERY *query)
+   --------------------------------------
+*//**
+   \param[in,out] query    Query state
+   \return                 Was there another cell?
+
+   Steps to the next cell in the query box and sets the slot range to
+   the atoms it contains.
+
+-  19.10.26 Original    By: agent
+*/
+static BOOL NextCell(GRIDQUERY *query)
+{
+   SPATIALGRID *grid = query->grid;
+   int         cell;
+
+   if(query->ix > query->xhi)
+      return(FALSE);
+
+   if(++query->iz > query->zhi)
+   {
+      query->iz = query->zlo;
+      if(++query->iy > query->yhi)
+      {
+         query->iy = query->ylo;
+         if(++query->ix > query->xhi)
+            return(FALSE);
+      }
+   }
+
+   cell           = (query->ix * grid->ny + query->iy) * grid->nz +
+                    query->iz;
+   query->slot    = grid->cellStart[cell];
+   query->slotEnd = grid->cellStart[cell+1];
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void SizeGrid(SPATIALGRID *grid, REAL xmax, REAL ymax,
+                        REAL zmax)
+   -------------------------------------------------------------
+*//**
+   \param[in,out] grid    Grid with minima and requested cell size set
+   \param[in]     xmax    Maximum x coordinate
+   \param[in]     ymax    Maximum y coordinate
+   \param[in]     zmax    Maximum z coordinate
+
+   Sets the number of cells in each direction, growing the cell size
+   until the total is no more than MAXCELLSPERATOM cells per atom.
+
+-  19.10.26 Original    By: agent
+*/
+static void SizeGrid(SPATIALGRID *grid, REAL xmax, REAL ymax, REAL zmax)
+{
+   double maxCells = (double)MAXCELLSPERATOM * grid->natoms + MINCELLS,
+          ncells;
+
+   for(;;)
+   {
+      grid->nx = 1 + (int)((xmax - grid->xmin) / grid->cellSize);
+      grid->ny = 1 + (int)((ymax - grid->ymin) / grid->cellSize);
+      grid->nz = 1 + (int)((zmax - grid->zmin) / grid->cellSize);
+
+      ncells = (double)grid->nx * (double)grid->ny * (double)grid->nz;
+      if(ncells <= maxCells)
+         break;
+
+      grid->cellSize *= pow(ncells / maxCells, 1.0/3.0) * 1.01;
+   }
+}
+
+
+/************************************************************************/
+/*>static int CellCoord(REAL value, REAL min, REAL cellSize, int n)
+   ----------------------------------------------------------------
+*//**
+   \param[in]    value      Coordinate
+   \param[in]    min        Grid minimum in this direction
+   \param[in]    cellSize   Cell edge
+   \param[in]    n          Number of cells in this direction
+   \return                  Cell coordinate clamped to the grid
+
+-  19.10.26 Original    By: agent
+*/
+static int CellCoord(REAL value, REAL min, REAL cellSize, int n)
+{
+   int c = (int)((value - min) / cellSize);
+
+   if(c < 0)  return(0);
+   if(c >= n) return(n-1);
+   return(c);
+}
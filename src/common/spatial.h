@@ -0,0 +1,89 @@
+/************************************************************************/
+/**
+
+   \file       spatial.h
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Uniform grid spatial index over PDB atoms
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Atoms are binned into cubic cells and stored (with a packed copy of
+   their coordinates) in cell order. A query visits only the cells
+   that can contain atoms within the requested distance of a point.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Added btBuildSpatialGridXYZ() for points that are not
+                  PDB atoms
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_SPATIAL_H
+#define _BIOPTOOLS_SPATIAL_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef struct
+{
+   REAL cellSize,
+        xmin, ymin, zmin;
+   REAL *x, *y, *z;         /* Packed coordinates in cell order         */
+   int  *cellStart,         /* Offset of the first atom in each cell    */
+        *atomIndex;         /* Input array index of each packed atom    */
+   int  nx, ny, nz,
+        natoms;
+}  SPATIALGRID;
+
+typedef struct
+{
+   SPATIALGRID *grid;
+   REAL x, y, z,
+        radiusSq;
+   int  xlo, xhi, ylo, yhi, zlo, zhi,
+        ix, iy, iz,
+        slot, slotEnd;
+}  GRIDQUERY;
+
+/************************************************************************/
+/* Prototypes
+*/
+SPATIALGRID *btBuildSpatialGrid(PDB **atoms, int natoms, REAL cellSize);
+SPATIALGRID *btBuildSpatialGridXYZ(REAL *x, REAL *y, REAL *z,
+                                   int npoints, REAL cellSize);
+void btFreeSpatialGrid(SPATIALGRID *grid);
+void btStartGridQuery(GRIDQUERY *query, SPATIALGRID *grid,
+                      REAL x, REAL y, REAL z, REAL radiusSq);
+int  btNextGridNeighbour(GRIDQUERY *query, REAL *distSq);
+
+#endif
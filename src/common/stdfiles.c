@@ -0,0 +1,875 @@
+/************************************************************************/
+/**
+
+   \file       stdfiles.c
+
+   \version    V1.3
+   \date       19.10.26
+   \brief      Open input and output files with transparent compression
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   btOpenStdFiles() opens files like blOpenStdFiles(), but handles
+   compression itself rather than running gzip/gunzip as separate
+   processes.
+
+   Input (a named file or stdin) is recognised as compressed from its
+   magic number (1f 8b for gzip, 28 b5 2f fd for zstd). A reader
+   thread then decompresses it into a pipe and the caller gets the read
+   end of the pipe, so decompression overlaps with parsing. Concatenated
+   gzip members are handled as gunzip does. Only input whose first
+   byte could start a magic number is looked at further; if the rest
+   does not match, a regular file is rewound and any other input is
+   passed through a thread unchanged so nothing is lost.
+
+   A named output file ending in .gz (or .zst) is written through a
+   pipe to a compressing thread. An atexit() handler flushes all
+   output, closes the pipe and waits for the thread so that the
+   compressed file is complete when the program exits.
+
+   zstd is only available if compiled with -DZSTD_SUPPORT and linked
+   with -lzstd.
+
+   In an in-process pipeline (see pipeline.c) a blank input or output
+   filename gives the pipeline's memory stream rather than stdin or
+   stdout.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Uses the pipeline streams for stdin and stdout
+-  V1.2  19.10.26 Checks the complete magic numbers. No longer warns 
+                  that gzip input ended unexpectedly when it ended on a
+                  buffer boundary. zstd output is flushed when a frame
+                  ends on an input buffer boundary
+-  V1.3  19.10.26 btOpenStdFiles() no longer crashes when a pipeline
+                  stage has no output file pointer
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <zlib.h>
+#ifdef ZSTD_SUPPORT
+#include <zstd.h>
+#endif
+#include "bioplib/macros.h"
+#include "pipeline.h"
+#include "stdfiles.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define COMP_NONE     0
+#define COMP_GZIP     1
+#define COMP_ZSTD     2
+#define GZIP_MAGIC    "\037\213"
+#define GZIP_MAGICLEN 2
+#define ZSTD_MAGIC    "\050\265\057\375"
+#define ZSTD_MAGICLEN 4
+#define MAXMAGICLEN   4
+#define IOBUFFSIZE    131072
+#define MAXOUTJOBS    8
+#define GZIP_WBITS    (15+16)   /* zlib window bits for gzip format    */
+#define AUTO_WBITS    (15+32)   /* Detect gzip or zlib header          */
+
+typedef struct
+{
+   FILE      *fp;         /* Compressed file                          */
+   int       fd,          /* Our end of the pipe                      */
+             userFd,      /* Caller's end of the pipe (output only)   */
+             type;
+   ino_t     pipeIno;     /* Identifies the pipe at exit              */
+   pthread_t thread;
+   unsigned char prefix[MAXMAGICLEN];
+   int       nprefix;     /* Bytes already read from fp (input only)  */
+}  STREAMJOB;
+
+/************************************************************************/
+/* Globals
+*/
+static STREAMJOB sOutJobs[MAXOUTJOBS];
+static int       sNOutJobs = 0;
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL OpenCompressedInput(FILE **in);
+static BOOL OpenOutput(char *outfile, FILE **out);
+static int  CompressionFromName(char *filename);
+static int  CompressionFromMagic(unsigned char *magic, int nmagic);
+static size_t ReadInput(STREAMJOB *job, unsigned char *buffer,
+                        size_t size);
+static BOOL StartThread(STREAMJOB *job, void *(*func)(void *));
+static void FinishOutput(void);
+static BOOL WriteAll(int fd, unsigned char *buffer, size_t nbytes);
+static void *InflateThread(void *arg);
+static void *DeflateThread(void *arg);
+static void *CopyThread(void *arg);
+#ifdef ZSTD_SUPPORT
+static void *ZstdDecompressThread(void *arg);
+static void *ZstdCompressThread(void *arg);
+#endif
+
+
+/************************************************************************/
+/*>BOOL btOpenStdFiles(char *infile, char *outfile, FILE **in,
+                       FILE **out)
+   -----------------------------------------------------------
+*//**
+   \param[in]     *infile    Input filename (blank for stdin)
+   \param[in]     *outfile   Output filename (blank for stdout)
+   \param[in,out] **in       Input file pointer
+   \param[in,out] **out      Output file pointer (may be NULL if no
+                             output file is needed)
+   \return                   Success?
+
+   Equivalent to blOpenStdFiles() with in-process decompression of the
+   input and compression of the output. When the program is a stage of
+   an in-process pipeline, the pipeline's memory streams are used in
+   place of stdin and stdout.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Uses the pipeline streams   By: agent
+-  19.10.26 out may be NULL in a pipeline
+*/
+BOOL btOpenStdFiles(char *infile, char *outfile, FILE **in, FILE **out)
+{
+   if((infile != NULL) && (infile[0] != '\0'))
+   {
+      if((*in = fopen(infile, "r")) == NULL)
+      {
+         fprintf(stderr, "Unable to open input file: %s\n", infile);
+         return(FALSE);
+      }
+      if(!OpenCompressedInput(in))
+         return(FALSE);
+   }
+   else if(btPipeInput() != NULL)
+   {
+      *in = btPipeInput();
+   }
+   else if(!OpenCompressedInput(in))
+   {
+      return(FALSE);
+   }
+
+   if((outfile != NULL) && (outfile[0] != '\0'))
+   {
+      if(!OpenOutput(outfile, out))
+         return(FALSE);
+   }
+   else if((out != NULL) && (btPipeOutput() != NULL))
+   {
+      *out = btPipeOutput();
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL OpenCompressedInput(FILE **in)
+   ------------------------------------------
+*//**
+   \param[in,out] **in   Input file pointer. Replaced by the read end of
+                         a pipe if the input is compressed
+   \return               Success?
+
+   Peeks at the first byte (a terminal is left alone so that we do not
+   block before the program needs input). Only if that could start a
+   magic number are the next bytes read to check the whole magic 
+   number. If they do not match, a regular file is simply repositioned;
+   otherwise the bytes we have read can't be put back, so CopyThread()
+   passes them and the rest of the input through a pipe.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Checks the complete magic number
+*/
+static BOOL OpenCompressedInput(FILE **in)
+{
+   STREAMJOB *job;
+   void      *(*func)(void *);
+   long      offset;
+   int       c,
+             fds[2],
+             type;
+
+   if(isatty(fileno(*in)))
+      return(TRUE);
+   if((c = getc(*in)) == EOF)
+      return(TRUE);
+   ungetc(c, *in);
+   if((c != (GZIP_MAGIC[0] & 0xff)) && (c != (ZSTD_MAGIC[0] & 0xff)))
+      return(TRUE);
+
+   if((job = (STREAMJOB *)malloc(sizeof(STREAMJOB))) == NULL)
+      return(FALSE);
+   offset       = ftell(*in);
+   job->nprefix = (int)fread(job->prefix, 1, MAXMAGICLEN, *in);
+   type         = CompressionFromMagic(job->prefix, job->nprefix);
+
+   if((type == COMP_NONE) && (offset >= 0) &&
+      !fseek(*in, offset, SEEK_SET))
+   {
+      free(job);
+      return(TRUE);
+   }
+
+#ifdef ZSTD_SUPPORT
+   func = (type == COMP_ZSTD) ? ZstdDecompressThread :
+          (type == COMP_GZIP) ? InflateThread : CopyThread;
+#else
+   if(type == COMP_ZSTD)
+   {
+      fprintf(stderr, "Input is zstd compressed, but zstd support was \
+not compiled in\n");
+      free(job);
+      return(FALSE);
+   }
+   func = (type == COMP_GZIP) ? InflateThread : CopyThread;
+#endif
+
+   if(pipe(fds))
+   {
+      free(job);
+      return(FALSE);
+   }
+
+   job->fp     = *in;
+   job->fd     = fds[1];
+   job->userFd = fds[0];
+   job->type   = type;
+
+   if(!StartThread(job, func))
+   {
+      close(fds[0]);
+      close(fds[1]);
+      free(job);
+      return(FALSE);
+   }
+   pthread_detach(job->thread);
+
+   /* From here on, job belongs to the thread                           */
+   if((*in = fdopen(fds[0], "r")) == NULL)
+      return(FALSE);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL OpenOutput(char *outfile, FILE **out)
+   -------------------------------------------------
+*//**
+   \param[in]  *outfile   Output filename
+   \param[out] **out      Output file pointer
+   \return                Success?
+
+   Opens the output file, inserting a compressing thread if the
+   extension calls for it.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL OpenOutput(char *outfile, FILE **out)
+{
+   STREAMJOB   *job;
+   FILE        *fp;
+   struct stat st;
+   int         fds[2],
+               type;
+
+   if((type = CompressionFromName(outfile)) == COMP_NONE)
+   {
+      if((*out = fopen(outfile, "w")) == NULL)
+      {
+         fprintf(stderr, "Unable to open output file: %s\n", outfile);
+         return(FALSE);
+      }
+      return(TRUE);
+   }
+
+#ifndef ZSTD_SUPPORT
+   if(type == COMP_ZSTD)
+   {
+      fprintf(stderr, "zstd support was not compiled in: %s\n", outfile);
+      return(FALSE);
+   }
+#endif
+   if(sNOutJobs >= MAXOUTJOBS)
+   {
+      fprintf(stderr, "Too many compressed output files: %s\n", outfile);
+      return(FALSE);
+   }
+   if((fp = fopen(outfile, "wb")) == NULL)
+   {
+      fprintf(stderr, "Unable to open output file: %s\n", outfile);
+      return(FALSE);
+   }
+   if(pipe(fds))
+   {
+      fclose(fp);
+      return(FALSE);
+   }
+
+   job          = &(sOutJobs[sNOutJobs]);
+   job->fp      = fp;
+   job->fd      = fds[0];
+   job->userFd  = fds[1];
+   job->type    = type;
+   job->pipeIno = 0;
+   if(!fstat(fds[1], &st))
+      job->pipeIno = st.st_ino;
+
+#ifdef ZSTD_SUPPORT
+   if(!StartThread(job, (type == COMP_ZSTD) ? ZstdCompressThread :
+                                             DeflateThread))
+#else
+   if(!StartThread(job, DeflateThread))
+#endif
+   {
+      close(fds[0]);
+      close(fds[1]);
+      fclose(fp);
+      return(FALSE);
+   }
+
+   if(sNOutJobs++ == 0)
+      atexit(FinishOutput);
+
+   if((*out = fdopen(fds[1], "w")) == NULL)
+      return(FALSE);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int CompressionFromName(char *filename)
+   ----------------------------------------------
+*//**
+   \param[in]  *filename   Filename
+   \return                 COMP_GZIP, COMP_ZSTD or COMP_NONE from the
+                           extension
+
+-  19.10.26 Original   By: agent
+*/
+static int CompressionFromName(char *filename)
+{
+   size_t len = strlen(filename);
+
+   if((len > 3) && !strcmp(filename + len - 3, ".gz"))
+      return(COMP_GZIP);
+   if((len > 4) && !strcmp(filename + len - 4, ".zst"))
+      return(COMP_ZSTD);
+   return(COMP_NONE);
+}
+
+
+/************************************************************************/
+/*>static int CompressionFromMagic(unsigned char *magic, int nmagic)
+   -----------------------------------------------------------------
+*//**
+   \param[in]  *magic   First bytes of the input
+   \param[in]  nmagic   Number of bytes
+   \return              COMP_GZIP, COMP_ZSTD or COMP_NONE
+
+-  19.10.26 Original   By: agent
+*/
+static int CompressionFromMagic(unsigned char *magic, int nmagic)
+{
+   if((nmagic >= GZIP_MAGICLEN) &&
+      !memcmp(magic, GZIP_MAGIC, GZIP_MAGICLEN))
+      return(COMP_GZIP);
+   if((nmagic >= ZSTD_MAGICLEN) &&
+      !memcmp(magic, ZSTD_MAGIC, ZSTD_MAGICLEN))
+      return(COMP_ZSTD);
+   return(COMP_NONE);
+}
+
+
+/************************************************************************/
+/*>static BOOL StartThread(STREAMJOB *job, void *(*func)(void *))
+   --------------------------------------------------------------
+*//**
+   \param[in,out] *job    Job description; job->thread is set
+   \param[in]     *func   Thread function
+   \return                Success?
+
+   SIGPIPE is blocked in the new thread so that a program which stops
+   reading early gets EPIPE in the reader thread rather than being
+   killed.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL StartThread(STREAMJOB *job, void *(*func)(void *))
+{
+   sigset_t block,
+            old;
+   int      ret;
+
+   sigemptyset(&block);
+   sigaddset(&block, SIGPIPE);
+   pthread_sigmask(SIG_BLOCK, &block, &old);
+   ret = pthread_create(&(job->thread), NULL, func, job);
+   pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+   if(ret)
+   {
+      fprintf(stderr, "Unable to start compression thread\n");
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void FinishOutput(void)
+   ------------------------------
+*//**
+   atexit() handler. Flushes all output streams, then closes the
+   caller's end of each compressed output pipe and waits for its thread
+   to finish writing the file. The descriptor is only closed if it is
+   still our pipe: the program may have closed the output file itself
+   and the number been reused.
+
+-  19.10.26 Original   By: agent
+*/
+static void FinishOutput(void)
+{
+   struct stat st;
+   int         i;
+
+   fflush(NULL);
+   for(i=0; i<sNOutJobs; i++)
+   {
+      if(!fstat(sOutJobs[i].userFd, &st) && S_ISFIFO(st.st_mode) &&
+         (st.st_ino == sOutJobs[i].pipeIno))
+         close(sOutJobs[i].userFd);
+      pthread_join(sOutJobs[i].thread, NULL);
+   }
+   sNOutJobs = 0;
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteAll(int fd, unsigned char *buffer, size_t nbytes)
+   ------------------------------------------------------------------
+*//**
+   \param[in]  fd        File descriptor
+   \param[in]  *buffer   Data
+   \param[in]  nbytes    Number of bytes
+   \return               Success? (FALSE if the reader has gone away)
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL WriteAll(int fd, unsigned char *buffer, size_t nbytes)
+{
+   ssize_t nwritten;
+
+   while(nbytes > 0)
+   {
+      if((nwritten = write(fd, buffer, nbytes)) < 0)
+      {
+         if(errno == EINTR)
+            continue;
+         return(FALSE);
+      }
+      buffer += nwritten;
+      nbytes -= (size_t)nwritten;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static size_t ReadInput(STREAMJOB *job, unsigned char *buffer,
+                           size_t size)
+   ---------------------------------------------------------------
+*//**
+   \param[in,out] *job     Input job
+   \param[out]    *buffer  Buffer
+   \param[in]     size     Size of the buffer
+   \return                 Bytes read (0 at end of file)
+
+   fread() for a reader thread. The bytes read while checking the
+   magic number come first.
+
+-  19.10.26 Original   By: agent
+*/
+static size_t ReadInput(STREAMJOB *job, unsigned char *buffer,
+                        size_t size)
+{
+   size_t nprefix = 0;
+
+   if(job->nprefix > 0)
+   {
+      nprefix = MIN((size_t)job->nprefix, size);
+      memcpy(buffer, job->prefix, nprefix);
+      memmove(job->prefix, job->prefix + nprefix,
+              job->nprefix - nprefix);
+      job->nprefix -= (int)nprefix;
+   }
+
+   return(nprefix + fread(buffer + nprefix, 1, size - nprefix, job->fp));
+}
+
+
+/************************************************************************/
+/*>static void *CopyThread(void *arg)
+   ----------------------------------
+*//**
+   \param[in]  *arg   STREAMJOB (freed here)
+
+   Reader thread: copies uncompressed input into the pipe after the
+   bytes read while checking for a magic number
+
+-  19.10.26 Original   By: agent
+*/
+static void *CopyThread(void *arg)
+{
+   STREAMJOB     *job = (STREAMJOB *)arg;
+   unsigned char *buffer;
+   size_t        nread;
+
+   if((buffer = (unsigned char *)malloc(IOBUFFSIZE)) != NULL)
+   {
+      while((nread = ReadInput(job, buffer, IOBUFFSIZE)) > 0)
+      {
+         if(!WriteAll(job->fd, buffer, nread))
+            break;
+      }
+      free(buffer);
+   }
+
+   fclose(job->fp);
+   close(job->fd);
+   free(job);
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *InflateThread(void *arg)
+   -------------------------------------
+*//**
+   \param[in]  *arg   STREAMJOB (freed here)
+
+   Reader thread: gunzips job->fp into the pipe. The input is only 
+   complete if the last member ended and nothing was decompressed
+   after it, however the data fell across the buffers.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Tracks the end of the last member rather than relying on
+            the last return from inflate()
+*/
+static void *InflateThread(void *arg)
+{
+   STREAMJOB     *job = (STREAMJOB *)arg;
+   z_stream      strm;
+   unsigned char *inBuff,
+                 *outBuff;
+   size_t        nread;
+   int           ret     = Z_OK;
+   BOOL          ok      = TRUE,
+                 gotData = FALSE,
+                 ended   = FALSE;
+
+   memset(&strm, 0, sizeof(z_stream));
+   inBuff  = (unsigned char *)malloc(IOBUFFSIZE);
+   outBuff = (unsigned char *)malloc(IOBUFFSIZE);
+   if((inBuff == NULL) || (outBuff == NULL) ||
+      (inflateInit2(&strm, AUTO_WBITS) != Z_OK))
+      ok = FALSE;
+
+   while(ok && ((nread = ReadInput(job, inBuff, IOBUFFSIZE)) > 0))
+   {
+      gotData       = TRUE;
+      strm.next_in  = inBuff;
+      strm.avail_in = (uInt)nread;
+      while(ok && ((strm.avail_in > 0) || (strm.avail_out == 0)))
+      {
+         strm.next_out  = outBuff;
+         strm.avail_out = IOBUFFSIZE;
+         ret = inflate(&strm, Z_NO_FLUSH);
+         if((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR))
+         {
+            fprintf(stderr, "Error in compressed input: %s\n",
+                    (strm.msg != NULL) ? strm.msg : "corrupt data");
+            ok = FALSE;
+         }
+         else if(!WriteAll(job->fd, outBuff, IOBUFFSIZE - strm.avail_out))
+         {
+            ok = FALSE;
+         }
+         else if(ret == Z_STREAM_END)
+         {
+            /* Another gzip member may follow                           */
+            inflateReset(&strm);
+            ended = TRUE;
+         }
+         else if(ret == Z_OK)
+         {
+            /* Progress was made, so we are inside a member             */
+            ended = FALSE;
+         }
+         else if((ret == Z_BUF_ERROR) && (strm.avail_out != 0))
+         {
+            break;
+         }
+      }
+   }
+
+   if(ok && gotData && !ended)
+      fprintf(stderr, "Compressed input ended unexpectedly\n");
+
+   inflateEnd(&strm);
+   FREE(inBuff);
+   FREE(outBuff);
+   fclose(job->fp);
+   close(job->fd);
+   free(job);
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *DeflateThread(void *arg)
+   -------------------------------------
+*//**
+   \param[in]  *arg   STREAMJOB (one of sOutJobs[])
+
+   Writer thread: gzips everything from the pipe into job->fp
+
+-  19.10.26 Original   By: agent
+*/
+static void *DeflateThread(void *arg)
+{
+   STREAMJOB     *job = (STREAMJOB *)arg;
+   z_stream      strm;
+   unsigned char *inBuff,
+                 *outBuff;
+   ssize_t       nread;
+   int           flush = Z_NO_FLUSH;
+   BOOL          ok    = TRUE;
+
+   memset(&strm, 0, sizeof(z_stream));
+   inBuff  = (unsigned char *)malloc(IOBUFFSIZE);
+   outBuff = (unsigned char *)malloc(IOBUFFSIZE);
+   if((inBuff == NULL) || (outBuff == NULL) ||
+      (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WBITS,
+                    8, Z_DEFAULT_STRATEGY) != Z_OK))
+      ok = FALSE;
+
+   while(ok && (flush != Z_FINISH))
+   {
+      if((nread = read(job->fd, inBuff, IOBUFFSIZE)) < 0)
+      {
+         if(errno == EINTR)
+            continue;
+         nread = 0;
+      }
+      flush         = (nread == 0) ? Z_FINISH : Z_NO_FLUSH;
+      strm.next_in  = inBuff;
+      strm.avail_in = (uInt)nread;
+      do
+      {
+         strm.next_out  = outBuff;
+         strm.avail_out = IOBUFFSIZE;
+         deflate(&strm, flush);
+         if(fwrite(outBuff, 1, IOBUFFSIZE - strm.avail_out, job->fp) !=
+            IOBUFFSIZE - strm.avail_out)
+            ok = FALSE;
+      }  while(ok && (strm.avail_out == 0));
+   }
+
+   if(!ok)
+      fprintf(stderr, "Error writing compressed output\n");
+
+   deflateEnd(&strm);
+   FREE(inBuff);
+   FREE(outBuff);
+   fclose(job->fp);
+   close(job->fd);
+   return(NULL);
+}
+
+
+#ifdef ZSTD_SUPPORT
+/************************************************************************/
+/*>static void *ZstdDecompressThread(void *arg)
+   --------------------------------------------
+*//**
+   \param[in]  *arg   STREAMJOB (freed here)
+
+   Reader thread: decompresses zstd input from job->fp into the pipe
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Keeps calling ZSTD_decompressStream() while it fills the
+            output buffer so a frame ending at the end of an input
+            buffer is flushed
+*/
+static void *ZstdDecompressThread(void *arg)
+{
+   STREAMJOB      *job = (STREAMJOB *)arg;
+   ZSTD_DStream   *dstream;
+   ZSTD_inBuffer  input;
+   ZSTD_outBuffer output;
+   unsigned char  *inBuff,
+                  *outBuff;
+   size_t         nread,
+                  ret = 0;
+   BOOL           ok  = TRUE;
+
+   inBuff  = (unsigned char *)malloc(IOBUFFSIZE);
+   outBuff = (unsigned char *)malloc(IOBUFFSIZE);
+   if(((dstream = ZSTD_createDStream()) == NULL) ||
+      (inBuff == NULL) || (outBuff == NULL) ||
+      ZSTD_isError(ZSTD_initDStream(dstream)))
+      ok = FALSE;
+
+   while(ok && ((nread = ReadInput(job, inBuff, IOBUFFSIZE)) > 0))
+   {
+      input.src  = inBuff;
+      input.size = nread;
+      input.pos  = 0;
+      do
+      {
+         output.dst  = outBuff;
+         output.size = IOBUFFSIZE;
+         output.pos  = 0;
+         ret = ZSTD_decompressStream(dstream, &output, &input);
+         if(ZSTD_isError(ret))
+         {
+            fprintf(stderr, "Error in compressed input: %s\n",
+                    ZSTD_getErrorName(ret));
+            ok = FALSE;
+         }
+         else if(!WriteAll(job->fd, outBuff, output.pos))
+         {
+            ok = FALSE;
+         }
+      }  while(ok && ((input.pos < input.size) ||
+                      (output.pos == output.size)));
+   }
+
+   if(ok && (ret != 0))
+      fprintf(stderr, "Compressed input ended unexpectedly\n");
+
+   if(dstream != NULL)
+      ZSTD_freeDStream(dstream);
+   FREE(inBuff);
+   FREE(outBuff);
+   fclose(job->fp);
+   close(job->fd);
+   free(job);
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static void *ZstdCompressThread(void *arg)
+   ------------------------------------------
+*//**
+   \param[in]  *arg   STREAMJOB (one of sOutJobs[])
+
+   Writer thread: zstd compresses everything from the pipe into job->fp
+
+-  19.10.26 Original   By: agent
+*/
+static void *ZstdCompressThread(void *arg)
+{
+   STREAMJOB      *job = (STREAMJOB *)arg;
+   ZSTD_CStream   *cstream;
+   ZSTD_inBuffer  input;
+   ZSTD_outBuffer output;
+   unsigned char  *inBuff,
+                  *outBuff;
+   ssize_t        nread;
+   size_t         remaining;
+   BOOL           ok = TRUE;
+
+   inBuff  = (unsigned char *)malloc(IOBUFFSIZE);
+   outBuff = (unsigned char *)malloc(IOBUFFSIZE);
+   if(((cstream = ZSTD_createCStream()) == NULL) ||
+      (inBuff == NULL) || (outBuff == NULL) ||
+      ZSTD_isError(ZSTD_initCStream(cstream, 3)))
+      ok = FALSE;
+
+   while(ok)
+   {
+      if((nread = read(job->fd, inBuff, IOBUFFSIZE)) < 0)
+      {
+         if(errno == EINTR)
+            continue;
+         nread = 0;
+      }
+      if(nread == 0)
+         break;
+
+      input.src  = inBuff;
+      input.size = (size_t)nread;
+      input.pos  = 0;
+      while(ok && (input.pos < input.size))
+      {
+         output.dst  = outBuff;
+         output.size = IOBUFFSIZE;
+         output.pos  = 0;
+         if(ZSTD_isError(ZSTD_compressStream(cstream, &output, &input)) ||
+            (fwrite(outBuff, 1, output.pos, job->fp) != output.pos))
+            ok = FALSE;
+      }
+   }
+
+   do
+   {
+      output.dst  = outBuff;
+      output.size = IOBUFFSIZE;
+      output.pos  = 0;
+      remaining   = ok ? ZSTD_endStream(cstream, &output) : 0;
+      if(ZSTD_isError(remaining) ||
+         (fwrite(outBuff, 1, output.pos, job->fp) != output.pos))
+         ok = FALSE;
+   }  while(ok && (remaining > 0));
+
+   if(!ok)
+      fprintf(stderr, "Error writing compressed output\n");
+
+   if(cstream != NULL)
+      ZSTD_freeCStream(cstream);
+   FREE(inBuff);
+   FREE(outBuff);
+   fclose(job->fp);
+   close(job->fd);
+   return(NULL);
+}
+#endif
+
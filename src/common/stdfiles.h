@@ -0,0 +1,56 @@
+/************************************************************************/
+/**
+
+   \file       stdfiles.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Open input and output files with transparent compression
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Drop-in replacement for blOpenStdFiles() that decompresses gzipped
+   (and, with ZSTD_SUPPORT, zstd) input in-process and compresses
+   output according to the file extension.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_STDFILES_H
+#define _BIOPTOOLS_STDFILES_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL btOpenStdFiles(char *infile, char *outfile, FILE **in, FILE **out);
+
+#endif
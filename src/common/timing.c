@@ -0,0 +1,483 @@
+/************************************************************************/
+/**
+
+   \file       timing.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Phase timers, named timers, counters and peak memory
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Every program calls btInitTiming() first thing in main(). Timing is
+   switched on if the environment variable BIOPTOOLS_TIMING is set to
+   anything other than an empty string or 0, or if the first argument
+   of the program is -T (which is then removed so that the program
+   never sees it). If BIOPTOOLS_TIMING is 1 or 'stderr' (or only -T is
+   given) the report goes to standard error; otherwise the variable is
+   the name of a file to which the report is appended.
+
+   Time is split between three phases: read, compute and write. A
+   program starts in the compute phase. The shared readers (pdbread.c)
+   switch to the read phase while they run and the shared writers
+   (pipeline.c, pdbmlwrite.c) to the write phase, so most programs get
+   all three without doing anything. A program may switch phase
+   itself with btSetTimingPhase(), which returns the previous phase so
+   that it can be restored.
+
+   Named timers (btStartTimer()/btStopTimer()) time any stretch of code
+   and may be started and stopped any number of times. Counters
+   (btAddCount()) accumulate a number such as atoms read. The peak
+   resident set size is sampled at the end of each phase.
+
+   The report is written when the program exits, one line per item,
+   so that it can be picked out with grep by a job scheduler:
+      TIMING program=pdbsolv pid=1234 phase=read seconds=0.041237 peak_rss_kb=10488
+      TIMING program=pdbsolv pid=1234 phase=compute seconds=0.386410 peak_rss_kb=11320
+      TIMING program=pdbsolv pid=1234 phase=write seconds=0.020112 peak_rss_kb=11320
+      TIMING program=pdbsolv pid=1234 phase=total seconds=0.447759 user_seconds=0.43 system_seconds=0.01 peak_rss_kb=11320
+      TIMING program=pdbsolv pid=1234 timer=accessibility calls=1 seconds=0.383112
+      TIMING program=pdbsolv pid=1234 counter=atoms value=9234
+
+   When programs are run as a pipeline in one process by the
+   multi-call program, there is one report under the name of the first
+   program.
+
+   When timing is off, every call returns after checking one flag.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "bioplib/SysDefs.h"
+#include "timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ENV_TIMING    "BIOPTOOLS_TIMING"
+#define TIMING_FLAG   "-T"
+#define REPORT_TAG    "TIMING"
+#define MAXNAME       40
+#define MAXTIMERS     32
+#define MAXCOUNTERS   32
+
+typedef struct
+{
+   char   name[MAXNAME];
+   double seconds,
+          start;
+   long   calls;
+   int    depth;
+}  TIMER;
+
+typedef struct
+{
+   char name[MAXNAME];
+   long value;
+}  COUNTER;
+
+/************************************************************************/
+/* Globals
+*/
+static BOOL    sInitialised = FALSE,
+               sEnabled     = FALSE,
+               sReported    = FALSE;
+static char    sProgram[MAXNAME],
+               *sReportFile = NULL;
+static int     sPhase       = BT_PHASE_COMPUTE,
+               sNTimers     = 0,
+               sNCounters   = 0;
+static double  sStart,
+               sPhaseStart,
+               sPhaseSeconds[BT_NPHASES];
+static long    sPhaseRSS[BT_NPHASES];
+static TIMER   sTimers[MAXTIMERS];
+static COUNTER sCounters[MAXCOUNTERS];
+static char    *sPhaseNames[BT_NPHASES] = {"read", "compute", "write"};
+
+/************************************************************************/
+/* Prototypes
+*/
+static double Now(void);
+static long   PeakRSS(void);
+static TIMER  *FindTimer(char *name, BOOL create);
+
+
+/************************************************************************/
+/*>void btInitTiming(int *argc, char **argv)
+   -----------------------------------------
+*//**
+   \param[in,out]  *argc   Argument count (NULL if -T is used by the
+                           program for something else)
+   \param[in,out]  **argv  Arguments
+
+   Called at the start of main(). Removes a -T first argument and
+   switches timing on if it was given or if BIOPTOOLS_TIMING is set.
+   Only the first call names the program and starts the clock.
+
+-  19.10.26 Original   By: agent
+*/
+void btInitTiming(int *argc, char **argv)
+{
+   char *env,
+        *name;
+   BOOL flag = FALSE;
+   int  i;
+
+   if((argc != NULL) && (*argc > 1) && !strcmp(argv[1], TIMING_FLAG))
+   {
+      for(i=1; i<*argc; i++)
+         argv[i] = argv[i+1];
+      (*argc)--;
+      flag = TRUE;
+   }
+
+   if(!sInitialised)
+   {
+      sInitialised = TRUE;
+
+      if((name = strrchr(argv[0], '/')) == NULL)
+         name = argv[0];
+      else
+         name++;
+      strncpy(sProgram, name, MAXNAME-1);
+      sProgram[MAXNAME-1] = '\0';
+
+      env = getenv(ENV_TIMING);
+      if((env != NULL) && (env[0] != '\0') && strcmp(env, "0"))
+      {
+         flag = TRUE;
+         if(strcmp(env, "1") && strcmp(env, "stderr"))
+            sReportFile = env;
+      }
+   }
+
+   if(flag && !sEnabled)
+   {
+      sEnabled    = TRUE;
+      sStart      = sPhaseStart = Now();
+      atexit(btReportTiming);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL btTimingEnabled(void)
+   --------------------------
+*//**
+   \return   Is timing switched on?
+
+   For a program that wants to count something that takes work to find
+
+-  19.10.26 Original   By: agent
+*/
+BOOL btTimingEnabled(void)
+{
+   return(sEnabled);
+}
+
+
+/************************************************************************/
+/*>int btSetTimingPhase(int phase)
+   -------------------------------
+*//**
+   \param[in]  phase   BT_PHASE_READ, BT_PHASE_COMPUTE or BT_PHASE_WRITE
+   \return             The previous phase
+
+   Ends the current phase and starts another
+
+-  19.10.26 Original   By: agent
+*/
+int btSetTimingPhase(int phase)
+{
+   int    previous = sPhase;
+   double now;
+
+   if(!sEnabled || (phase < 0) || (phase >= BT_NPHASES) ||
+      (phase == sPhase))
+      return(previous);
+
+   now = Now();
+   sPhaseSeconds[sPhase] += now - sPhaseStart;
+   btSampleMemory();
+   sPhaseStart = now;
+   sPhase      = phase;
+
+   return(previous);
+}
+
+
+/************************************************************************/
+/*>void btStartTimer(char *name)
+   -----------------------------
+*//**
+   \param[in]  *name   Timer name
+
+   Starts a named timer. Starting a timer that is already running
+   (e.g. in a recursive function) only counts the outermost call.
+
+-  19.10.26 Original   By: agent
+*/
+void btStartTimer(char *name)
+{
+   TIMER *timer;
+
+   if(!sEnabled || ((timer = FindTimer(name, TRUE)) == NULL))
+      return;
+
+   if(timer->depth++ == 0)
+      timer->start = Now();
+}
+
+
+/************************************************************************/
+/*>void btStopTimer(char *name)
+   ----------------------------
+*//**
+   \param[in]  *name   Timer name
+
+   Stops a named timer and adds the elapsed time to its total
+
+-  19.10.26 Original   By: agent
+*/
+void btStopTimer(char *name)
+{
+   TIMER *timer;
+
+   if(!sEnabled || ((timer = FindTimer(name, FALSE)) == NULL) ||
+      (timer->depth == 0))
+      return;
+
+   if(--timer->depth == 0)
+   {
+      timer->seconds += Now() - timer->start;
+      timer->calls++;
+   }
+}
+
+
+/************************************************************************/
+/*>void btAddCount(char *name, long count)
+   ---------------------------------------
+*//**
+   \param[in]  *name   Counter name
+   \param[in]  count   Amount to add
+
+-  19.10.26 Original   By: agent
+*/
+void btAddCount(char *name, long count)
+{
+   int i;
+
+   if(!sEnabled)
+      return;
+
+   for(i=0; i<sNCounters; i++)
+   {
+      if(!strcmp(sCounters[i].name, name))
+      {
+         sCounters[i].value += count;
+         return;
+      }
+   }
+
+   if(sNCounters < MAXCOUNTERS)
+   {
+      strncpy(sCounters[sNCounters].name, name, MAXNAME-1);
+      sCounters[sNCounters].name[MAXNAME-1] = '\0';
+      sCounters[sNCounters].value = count;
+      sNCounters++;
+   }
+}
+
+
+/************************************************************************/
+/*>void btSampleMemory(void)
+   -------------------------
+*//**
+   Records the peak memory use so far against the current phase. This
+   is done at the end of each phase, but a program may call it at any
+   point where memory use is likely to be at its highest before it
+   frees something.
+
+-  19.10.26 Original   By: agent
+*/
+void btSampleMemory(void)
+{
+   long rss;
+
+   if(!sEnabled)
+      return;
+
+   if((rss = PeakRSS()) > sPhaseRSS[sPhase])
+      sPhaseRSS[sPhase] = rss;
+}
+
+
+/************************************************************************/
+/*>void btReportTiming(void)
+   -------------------------
+*//**
+   Writes the report described at the top of this file. Registered
+   with atexit() so a program does not normally call it. Only the
+   first call writes anything.
+
+-  19.10.26 Original   By: agent
+*/
+void btReportTiming(void)
+{
+   struct rusage usage;
+   FILE          *fp = stderr;
+   double        now,
+                 total;
+   long          pid;
+   int           i;
+
+   if(!sEnabled || sReported)
+      return;
+   sReported = TRUE;
+
+   now = Now();
+   sPhaseSeconds[sPhase] += now - sPhaseStart;
+   sPhaseStart = now;
+   btSampleMemory();
+   total = now - sStart;
+
+   if((sReportFile != NULL) && ((fp = fopen(sReportFile, "a")) == NULL))
+      fp = stderr;
+   fflush(stdout);
+   pid = (long)getpid();
+
+   for(i=0; i<BT_NPHASES; i++)
+   {
+      fprintf(fp, "%s program=%s pid=%ld phase=%s seconds=%.6f \
+peak_rss_kb=%ld\n", REPORT_TAG, sProgram, pid, sPhaseNames[i],
+              sPhaseSeconds[i], sPhaseRSS[i]);
+   }
+
+   getrusage(RUSAGE_SELF, &usage);
+   fprintf(fp, "%s program=%s pid=%ld phase=total seconds=%.6f \
+user_seconds=%.2f system_seconds=%.2f peak_rss_kb=%ld\n",
+           REPORT_TAG, sProgram, pid, total,
+           usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1.0e6,
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1.0e6,
+           (long)usage.ru_maxrss);
+
+   for(i=0; i<sNTimers; i++)
+   {
+      fprintf(fp, "%s program=%s pid=%ld timer=%s calls=%ld \
+seconds=%.6f\n", REPORT_TAG, sProgram, pid, sTimers[i].name,
+              sTimers[i].calls, sTimers[i].seconds);
+   }
+
+   for(i=0; i<sNCounters; i++)
+   {
+      fprintf(fp, "%s program=%s pid=%ld counter=%s value=%ld\n",
+              REPORT_TAG, sProgram, pid, sCounters[i].name,
+              sCounters[i].value);
+   }
+
+   if(fp != stderr)
+      fclose(fp);
+}
+
+
+/************************************************************************/
+/*>static double Now(void)
+   -----------------------
+*//**
+   \return   Seconds from an arbitrary point, not affected by changes to
+             the system clock
+
+-  19.10.26 Original   By: agent
+*/
+static double Now(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double)ts.tv_sec + (double)ts.tv_nsec / 1.0e9);
+}
+
+
+/************************************************************************/
+/*>static long PeakRSS(void)
+   -------------------------
+*//**
+   \return   Peak resident set size of the process so far (Kb)
+
+-  19.10.26 Original   By: agent
+*/
+static long PeakRSS(void)
+{
+   struct rusage usage;
+
+   if(getrusage(RUSAGE_SELF, &usage))
+      return(0L);
+   return((long)usage.ru_maxrss);
+}
+
+
+/************************************************************************/
+/*>static TIMER *FindTimer(char *name, BOOL create)
+   ------------------------------------------------
+*//**
+   \param[in]  *name     Timer name
+   \param[in]  create    Create the timer if it does not exist
+   \return               The timer (NULL if not found or no room)
+
+-  19.10.26 Original   By: agent
+*/
+static TIMER *FindTimer(char *name, BOOL create)
+{
+   int i;
+
+   for(i=0; i<sNTimers; i++)
+   {
+      if(!strcmp(sTimers[i].name, name))
+         return(&(sTimers[i]));
+   }
+
+   if(!create || (sNTimers == MAXTIMERS))
+      return(NULL);
+
+   strncpy(sTimers[sNTimers].name, name, MAXNAME-1);
+   sTimers[sNTimers].name[MAXNAME-1] = '\0';
+   sTimers[sNTimers].seconds = 0.0;
+   sTimers[sNTimers].calls   = 0L;
+   sTimers[sNTimers].depth   = 0;
+   return(&(sTimers[sNTimers++]));
+}
@@ -0,0 +1,71 @@
+/************************************************************************/
+/**
+
+   \file       timing.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Phase timers, named timers, counters and peak memory
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Instrumentation shared by all the programs. Nothing is measured
+   unless it is switched on with the BIOPTOOLS_TIMING environment
+   variable or a -T given as the first argument of a program. See
+   timing.c for the report format.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_TIMING_H
+#define _BIOPTOOLS_TIMING_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BT_PHASE_READ    0
+#define BT_PHASE_COMPUTE 1
+#define BT_PHASE_WRITE   2
+#define BT_NPHASES       3
+
+/************************************************************************/
+/* Prototypes
+*/
+void btInitTiming(int *argc, char **argv);
+BOOL btTimingEnabled(void);
+int  btSetTimingPhase(int phase);
+void btStartTimer(char *name);
+void btStopTimer(char *name);
+void btAddCount(char *name, long count);
+void btSampleMemory(void);
+void btReportTiming(void);
+
+#endif
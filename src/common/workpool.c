@@ -0,0 +1,313 @@
+/************************************************************************/
+/**
+
+   \file       workpool.c
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Work-stealing thread pool
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The items of each worker are a range of item numbers, first up to
+   (but not including) last. The owner takes items from the front of
+   its range; a thief takes the back half of the largest remaining
+   range. Each range has its own lock, so workers only contend when one
+   of them is stealing.
+
+   The calling thread is worker 0. If a thread cannot be started, its
+   items are simply stolen by the workers that are running, so the
+   work is always completed - in the calling thread alone if need be.
+
+   workFunc() is called from several threads at once, so it must not
+   use BiopLib routines that keep static state (e.g. the PDB readers).
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "bioplib/macros.h"
+#include "bioplib/SysDefs.h"
+#include "workpool.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXTHREADS 256
+
+typedef struct
+{
+   pthread_mutex_t lock;
+   int             first,
+                   last;
+}  WORKRANGE;
+
+typedef struct
+{
+   WORKRANGE *ranges;
+   WORKFUNC  workFunc;
+   void      *data;
+   int       nworkers;
+}  WORKPOOL;
+
+typedef struct
+{
+   WORKPOOL  *pool;
+   pthread_t thread;
+   int       worker;
+}  WORKER;
+
+/************************************************************************/
+/* Prototypes
+*/
+static void *RunWorker(void *arg);
+static BOOL TakeItem(WORKRANGE *range, int *item);
+static BOOL StealItems(WORKPOOL *pool, int worker);
+
+
+/************************************************************************/
+/*>int btDefaultThreads(void)
+   --------------------------
+*//**
+   \return    Number of processors online (1 if it cannot be found)
+
+-  19.10.26 Original   By: agent
+*/
+int btDefaultThreads(void)
+{
+   long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+   if(n < 1)
+      return(1);
+   return((n > MAXTHREADS) ? MAXTHREADS : (int)n);
+}
+
+
+/************************************************************************/
+/*>void btRunWorkPool(int nitems, int nthreads, WORKFUNC workFunc,
+                      void *data)
+   ---------------------------------------------------------------
+*//**
+   \param[in]  nitems     Number of work items
+   \param[in]  nthreads   Number of threads (including this one)
+   \param[in]  workFunc   Called with each item number from 0 to
+                          nitems-1 and data
+   \param[in]  *data      Passed to workFunc
+
+   Returns when every item has been done. With one thread (or if there
+   is no memory for the pool) the items are done in order in the
+   calling thread.
+
+-  19.10.26 Original   By: agent
+*/
+void btRunWorkPool(int nitems, int nthreads, WORKFUNC workFunc,
+                   void *data)
+{
+   WORKPOOL pool;
+   WORKER   *workers;
+   sigset_t block,
+            old;
+   int      i;
+
+   if(nthreads > nitems)
+      nthreads = nitems;
+   if(nthreads > MAXTHREADS)
+      nthreads = MAXTHREADS;
+
+   workers     = NULL;
+   pool.ranges = NULL;
+   if(nthreads > 1)
+   {
+      workers     = (WORKER *)malloc(nthreads * sizeof(WORKER));
+      pool.ranges = (WORKRANGE *)malloc(nthreads * sizeof(WORKRANGE));
+   }
+   if((workers == NULL) || (pool.ranges == NULL))
+   {
+      FREE(workers);
+      FREE(pool.ranges);
+      for(i=0; i<nitems; i++)
+         (*workFunc)(i, data);
+      return;
+   }
+
+   pool.workFunc = workFunc;
+   pool.data     = data;
+   pool.nworkers = nthreads;
+   for(i=0; i<nthreads; i++)
+   {
+      pthread_mutex_init(&(pool.ranges[i].lock), NULL);
+      pool.ranges[i].first = (int)(((long)nitems * i) / nthreads);
+      pool.ranges[i].last  = (int)(((long)nitems * (i+1)) / nthreads);
+      workers[i].pool      = &pool;
+      workers[i].worker    = i;
+   }
+
+   /* As in stdfiles.c, the workers do not take SIGPIPE                 */
+   sigemptyset(&block);
+   sigaddset(&block, SIGPIPE);
+   pthread_sigmask(SIG_BLOCK, &block, &old);
+   for(i=1; i<nthreads; i++)
+   {
+      if(pthread_create(&(workers[i].thread), NULL, RunWorker,
+                        &(workers[i])))
+         workers[i].pool = NULL;
+   }
+   pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+   RunWorker(&(workers[0]));
+
+   for(i=1; i<nthreads; i++)
+   {
+      if(workers[i].pool != NULL)
+         pthread_join(workers[i].thread, NULL);
+   }
+   for(i=0; i<nthreads; i++)
+      pthread_mutex_destroy(&(pool.ranges[i].lock));
+
+   free(workers);
+   free(pool.ranges);
+}
+
+
+/************************************************************************/
+/*>static void *RunWorker(void *arg)
+   ---------------------------------
+*//**
+   \param[in]  *arg    The WORKER
+   \return             NULL
+
+   Does the worker's own items, then steals until there are none left
+   anywhere.
+
+-  19.10.26 Original   By: agent
+*/
+static void *RunWorker(void *arg)
+{
+   WORKER    *worker = (WORKER *)arg;
+   WORKPOOL  *pool   = worker->pool;
+   WORKRANGE *range  = &(pool->ranges[worker->worker]);
+   int       item;
+
+   do
+   {
+      while(TakeItem(range, &item))
+         (*pool->workFunc)(item, pool->data);
+   }  while(StealItems(pool, worker->worker));
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static BOOL TakeItem(WORKRANGE *range, int *item)
+   -------------------------------------------------
+*//**
+   \param[in,out] *range   Worker's own range
+   \param[out]    *item    Item to do
+   \return                 Was there an item?
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL TakeItem(WORKRANGE *range, int *item)
+{
+   BOOL gotItem = FALSE;
+
+   pthread_mutex_lock(&(range->lock));
+   if(range->first < range->last)
+   {
+      *item   = range->first++;
+      gotItem = TRUE;
+   }
+   pthread_mutex_unlock(&(range->lock));
+
+   return(gotItem);
+}
+
+
+/************************************************************************/
+/*>static BOOL StealItems(WORKPOOL *pool, int worker)
+   --------------------------------------------------
+*//**
+   \param[in,out] *pool    The pool
+   \param[in]     worker   Worker that has run out of items
+   \return                 Were any items stolen?
+
+   Finds the worker with most items left and moves the back half of
+   its range (at least one item) to this worker. The victim may finish
+   its items between being chosen and being locked, so the choice is
+   checked again once the lock is held.
+
+-  19.10.26 Original   By: agent
+*/
+static BOOL StealItems(WORKPOOL *pool, int worker)
+{
+   WORKRANGE *victim,
+             *own = &(pool->ranges[worker]);
+   int       i, left, most, mid,
+             best;
+
+   for(;;)
+   {
+      best = -1;
+      most = 0;
+      for(i=0; i<pool->nworkers; i++)
+      {
+         pthread_mutex_lock(&(pool->ranges[i].lock));
+         left = pool->ranges[i].last - pool->ranges[i].first;
+         pthread_mutex_unlock(&(pool->ranges[i].lock));
+         if((i != worker) && (left > most))
+         {
+            most = left;
+            best = i;
+         }
+      }
+      if(best < 0)
+         return(FALSE);
+
+      victim = &(pool->ranges[best]);
+      pthread_mutex_lock(&(victim->lock));
+      left = victim->last - victim->first;
+      if(left > 0)
+      {
+         mid          = victim->last - (left + 1) / 2;
+         pthread_mutex_lock(&(own->lock));
+         own->first   = mid;
+         own->last    = victim->last;
+         pthread_mutex_unlock(&(own->lock));
+         victim->last = mid;
+         pthread_mutex_unlock(&(victim->lock));
+         return(TRUE);
+      }
+      pthread_mutex_unlock(&(victim->lock));
+   }
+}
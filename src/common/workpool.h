@@ -0,0 +1,59 @@
+/************************************************************************/
+/**
+
+   \file       workpool.h
+
+   \version    V1.0
+   \date       19.10.26
+   \brief      Work-stealing thread pool
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   btRunWorkPool() calls a function for each of a number of work items
+   using a pool of threads. Each thread starts with an equal share of
+   the items and, when it has finished its own, steals half of what is
+   left from the busiest thread. Items may take very different times
+   (e.g. files of very different sizes) without leaving threads idle.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_WORKPOOL_H
+#define _BIOPTOOLS_WORKPOOL_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef void (*WORKFUNC)(int item, void *data);
+
+/************************************************************************/
+/* Prototypes
+*/
+int  btDefaultThreads(void);
+void btRunWorkPool(int nitems, int nthreads, WORKFUNC workFunc,
+                   void *data);
+
+#endif
@@ -3,8 +3,8 @@
    Program:    distmat
    File:       distmat.c
    
-   Version:    V2.1
-   Date:       13.03.19
+   Version:    V2.5
+   Date:       19.10.26
    Function:   Calculate inter-CA distances on a set of common-labelled
                PDB files
    
@@ -60,6 +60,15 @@
                     are't needed any more - everything is dynamically
                     allocated.
    V2.1   13.03.19  Increased some buffer sizes
+   V2.2   19.10.26  Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c   By: agent
+   V2.3   19.10.26  Opens files with btOpenStdFiles() so compressed
+                    input and output are handled in-process
+   V2.4   19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
+   V2.5   19.10.26  Minimum distances between residues are found from
+                    packed coordinate arrays with the batch distance
+                    routines
 
 *************************************************************************/
 /* #define DEBUG 1 */
@@ -76,6 +85,10 @@
 #include "bioplib/macros.h"
 #include "bioplib/MathUtil.h"
 #include "bioplib/hash.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/coords.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -115,7 +128,7 @@ void HandleInput(FILE *in, FILE *out, BOOL singleFile,
                  HASHTABLE *hashTable, int atomTypes, char *chains);
 void ProcessFile(FILE *fp, HASHTABLE *hashTable, int atomTypes,
                  char **chainList);
-void ProcessPDB(PDB *pdb, HASHTABLE *hashTable);
+BOOL ProcessPDB(PDB *pdb, HASHTABLE *hashTable);
 void StoreData(HASHTABLE *hashTable, PDB *res1, PDB *res2, REAL dist);
 PDB *ReduceAtomList(PDB *pdb, int atomTypes);
 void DisplayResults(FILE *out, HASHTABLE *hashTable);
@@ -145,12 +158,14 @@ int main(int argc, char **argv)
    HASHTABLE *hashTable = NULL;
    char      chains[MAXBUFF];
 
+   btInitTiming(&argc, argv);
+
    chains[0] = '\0';
 
    if(ParseCmdLine(argc, argv, infile, outfile, &singleFile, &atomTypes,
                    chains))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          if((hashTable = blInitializeHash(hashSize))!=NULL)
          {
@@ -345,15 +360,18 @@ void ProcessFile(FILE *fp, HASHTABLE *hashTable, int atomTypes,
    PDB *pdb;
    int natoms;
    
-   if((pdb = blReadPDBAtoms(fp, &natoms))!=NULL)
+   if((pdb = btReadPDBAtoms(fp, &natoms))!=NULL)
    {
       pdb = ReduceAtomList(pdb, atomTypes);
       if(chainList)
       {
          pdb = SelectPDBChains(pdb, chainList);
       }
-      if(pdb!=NULL)
-         ProcessPDB(pdb, hashTable);
+      if((pdb!=NULL) && !ProcessPDB(pdb, hashTable))
+      {
+         fprintf(stderr,"Error: No memory to analyse PDB file\n");
+         exit(1);
+      }
       FREELIST(pdb, PDB);
    }
    else
@@ -365,61 +383,74 @@ void ProcessFile(FILE *fp, HASHTABLE *hashTable, int atomTypes,
 
 
 /************************************************************************/
-/*>void ProcessPDB(PDB *pdb, HASHTABLE *hashTable)
+/*>BOOL ProcessPDB(PDB *pdb, HASHTABLE *hashTable)
    -----------------------------------------------
 *//**
    \input[in]      pdb        PDB linked list
    \input[in,out]  hashTable  Analysis data for each residue pair
+   \return                    Success? (FALSE if no memory)
 
    Does the actual analysis of a PDB linked list
 
 -  01.12.16 Original - Complete new version   By: ACRM  
+-  19.10.26 Takes the minimum distance between residues from a packed
+            coordinate view with the batch distance routines. Returns
+            BOOL   By: agent
 */
-void ProcessPDB(PDB *pdb, HASHTABLE *hashTable)
+BOOL ProcessPDB(PDB *pdb, HASHTABLE *hashTable)
 {
-   PDB *atom1, *atom2, 
-       *res1,  *res1Next, 
-       *res2,  *res2Next;
-   REAL minDistSq = (REAL)0.0;
+   COORDVIEW *view;
+   PDB       *res;
+   int       *resStart,
+             nres = 0,
+             r1, r2, i;
+   REAL      minDistSq,
+             dSq;
+
+   if((view = btBuildCoordView(pdb, FALSE))==NULL)
+      return(FALSE);
+   if((resStart = (int *)malloc((view->natoms+1) * sizeof(int)))==NULL)
+   {
+      btFreeCoordView(view);
+      return(FALSE);
+   }
 
-   /* Step through a residue at a time                                  */
-   for(res1=pdb; res1!=NULL; res1=res1Next)
+   /* Find where each residue starts in the view                        */
+   for(i=0, res=pdb; i<view->natoms; i++)
    {
-      /* Find the start of the next residue                             */
-      res1Next = blFindNextResidue(res1);
-      
-      /* Step through again a residue at a time                         */
-      for(res2=pdb; res2!=NULL; res2=res2Next)
+      if(view->atoms[i] == res)
       {
-         /* Find the start of the next residue                          */
-         res2Next = blFindNextResidue(res2);
-
-         /* Initialize minimum distance between the residues            */
-         minDistSq = DISTSQ(res1, res2);
+         resStart[nres++] = i;
+         res = blFindNextResidue(res);
+      }
+   }
+   resStart[nres] = view->natoms;
 
-         /* Step through atoms in first residue                         */
-         for(atom1=res1;
-             ((atom1!=NULL)&&(atom1!=res1Next));
-             NEXT(atom1))
+   /* Step through each pair of residues                                */
+   for(r1=0; r1<nres; r1++)
+   {
+      for(r2=0; r2<nres; r2++)
+      {
+         /* Minimum distance from any atom in the first residue to the
+            atoms of the second
+         */
+         minDistSq = (REAL)(-1.0);
+         for(i=resStart[r1]; i<resStart[r1+1]; i++)
          {
-            /* Step through atoms in second residue to find 
-               the minimum distance between the two residues
-            */
-            for(atom2=res2; 
-                ((atom2!=NULL)&&(atom2!=res2Next));
-                 NEXT(atom2))
-            {
-               REAL dSq = DISTSQ(atom1, atom2);
-               if(dSq < minDistSq)
-               {
-                  minDistSq = dSq;
-               }
-            }
+            dSq = btMinDistSqToPoint(view, resStart[r2], resStart[r2+1],
+                                     view->x[i], view->y[i], view->z[i]);
+            if((minDistSq < (REAL)0.0) || (dSq < minDistSq))
+               minDistSq = dSq;
          }
 
-         StoreData(hashTable, res1, res2, sqrt(minDistSq));
+         StoreData(hashTable, view->atoms[resStart[r1]],
+                   view->atoms[resStart[r2]], sqrt(minDistSq));
       }
    }
+
+   free(resStart);
+   btFreeCoordView(view);
+   return(TRUE);
 }
 
 
@@ -717,7 +748,7 @@ PDB *FindEndOfChain(PDB *chain)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nDistMat V2.1 (c) 2009-2019, Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\nDistMat V2.5 (c) 2009-2019, Dr. Andrew C.R. Martin, \
 UCL\n");
 
    fprintf(stderr,"\nUsage: distmat [-p][-c chains][-a | -s] [input [output]]\n");
@@ -4,8 +4,8 @@
 #   Program:    makemake
 #   File:       makemake.pl
 #   
-#   Version:    V1.9
-#   Date:       13.03.19
+#   Version:    V1.15
+#   Date:       19.10.26
 #   Function:   Build the Makefile for BiopTools
 #   
 #   Copyright:  (c) Dr. Andrew C. R. Martin, UCL, 2014-2019
@@ -33,9 +33,10 @@
 #
 #   Usage:
 #   ======
-#   ./makemake.pl [-bioplib] [-prefix=xxx] [-bindir=xxx] [-datadir=xxx]
-#                 [-libdir=xxx] [-incdir=xxx]
+#   ./makemake.pl [-bioplib] [-zstd] [-prefix=xxx] [-bindir=xxx]
+#                 [-datadir=xxx] [-libdir=xxx] [-incdir=xxx]
 #   -bioplib     - Build a local version of BiopLib
+#   -zstd        - Support zstd compressed files (needs libzstd)
 #   -prefix=xxx  - Change the prefix in front of all directories from
 #                  $HOME to xxx
 #   -bindir=xxx  - Change the installation binary directory to xxx
@@ -69,6 +70,20 @@
 #                     Bumped to require BiopLib V3.8.1
 #   V1.8    14.08.18  Bumped to require BiopLib V3.10
 #   V1.9    13.03.19  Added -Wno-stringop-truncation
+#   V1.10   19.10.26  Builds the shared code in common/ into
+#                     libbioptools.a and links every program with it
+#                     By: agent
+#   V1.11   19.10.26  Links with zlib and pthreads for compressed I/O.
+#                     Added -zstd
+#   V1.12   19.10.26  Compiles common/ with XML_SUPPORT and the libxml2
+#                     include path from xml2-config
+#   V1.13   19.10.26  Adds the bioptools multi-call program and the
+#                     installmulti rule. Writes multi/applets.h
+#   V1.14   19.10.26  Adds the bench rule to build and run the
+#                     benchmark programs in bench/
+#   V1.15   19.10.26  Writes applets.h in the build directory rather
+#                     than in multi/. The programs in bioptools are
+#                     compiled with exit() renamed to btPipeExit()
 #
 #*************************************************************************
 $::biopversion = "3.10";
@@ -79,6 +94,7 @@ $::biopext     = ".tar.gz";
 # Deal with the command line
 UsageDie() if(defined($::h) || defined($::help));
 $::bioplib = 0                 if(!defined($::bioplib));
+$::zstd    = 0                 if(!defined($::zstd));
 $::prefix  = $ENV{'HOME'}      if(!defined($::prefix));
 $::install = $::prefix         if(!defined($::install));
 $::bindir  = "$::install/bin"  if(!defined($::bindir));
@@ -98,19 +114,28 @@ else
 GetBiopLib()        if($::bioplib);
 my @cFiles = GetCFileList('.');
 my @exeFiles = StripExtension(@cFiles);
+my @libFiles = GetCFileList('common');
 open(my $makefp, ">Makefile") || die "Can't open Makefile for writing";
-WriteFlags($makefp, $::libdir, $::incdir, $::bindir, $::datadir);
+WriteFlags($makefp, $::libdir, $::incdir, $::bindir, $::datadir,
+           $::zstd);
 WriteTargets($makefp, @exeFiles);
+WriteLibObjects($makefp, @libFiles);
+WriteMultiObjects($makefp, @exeFiles);
 WriteDummyRule($makefp, $::bioplib);
 WriteInstallRule($makefp, @exeFiles);
 WriteCleanRules($makefp, $::bioplib, @exeFiles);
 WriteLinksRule($makefp);
+WriteLibRules($makefp, @libFiles);
+WriteMultiRules($makefp, @exeFiles);
+WriteInstallMultiRule($makefp);
+WriteBenchRules($makefp);
 foreach my $cFile (@cFiles)
 {
     WriteRule($makefp, $cFile);
 }
 
 close $makefp;
+WriteAppletList(@exeFiles);
 
 #*************************************************************************
 # Uses git submodule to obtain the BiopLib code if you have downloaded
@@ -205,6 +230,9 @@ __EOF
 #
 # 06.11.14 Original   By: ACRM
 # 13.02.15 Added distclean
+# 19.10.26 Removes bioptools and its objects   By: agent
+# 19.10.26 Removes the benchmark programs
+# 19.10.26 distclean removes applets.h
 sub WriteCleanRules
 {
     my($makefp, $bioplib, @exeFiles) = @_;
@@ -213,12 +241,12 @@ sub WriteCleanRules
         print $makefp <<__EOF;
 
 distclean : clean
-\t\\rm Makefile
+\t\\rm -f Makefile applets.h
 
 clean : 
 \t\\rm -rf bioplib
 \t(cd libsrc/bioplib/src; make clean)
-\t\\rm -f \$(TARGETS)
+\t\\rm -f \$(TARGETS) \$(BTOBJS) \$(BTLIB) bioptools \$(MULTIOBJS) \$(BENCHPROGS)
 
 __EOF
     }
@@ -227,10 +255,10 @@ __EOF
         print $makefp <<__EOF;
 
 distclean : clean
-\t\\rm Makefile
+\t\\rm -f Makefile applets.h
 
 clean : 
-\t\\rm -f \$(TARGETS)
+\t\\rm -f \$(TARGETS) \$(BTOBJS) \$(BTLIB) bioptools \$(MULTIOBJS) \$(BENCHPROGS)
 
 __EOF
     }
@@ -240,6 +268,7 @@ __EOF
 # Writes a rule to build an executable from a C file
 #
 # 06.11.14 Original   By: ACRM
+# 19.10.26 Depends on and links with libbioptools.a   By: agent
 sub WriteRule
 {
     my($makefp, $cFile) = @_;
@@ -247,12 +276,135 @@ sub WriteRule
     $exeFile =~ s/\.c$//;
     print $makefp <<__EOF;
 
-$exeFile : $cFile
+$exeFile : $cFile \$(BTLIB)
 \t\$(CC) \$(CFLAGS) -o \$@ \$< \$(LFLAGS)
 __EOF
 
 }
 
+#*************************************************************************
+# Writes the rules to build libbioptools.a from the C files in common/
+#
+# 19.10.26 Original   By: agent
+# 19.10.26 Compiles with XMLFLAGS
+sub WriteLibRules
+{
+    my($makefp, @libFiles) = @_;
+    print $makefp <<__EOF;
+
+\$(BTLIB) : \$(BTOBJS)
+\t\\rm -f \$@
+\tar rcs \$@ \$(BTOBJS)
+__EOF
+
+    foreach my $libFile (@libFiles)
+    {
+        my $stem = $libFile;
+        $stem =~ s/\.c$//;
+        my $deps = "common/$libFile";
+        $deps .= " common/$stem.h" if(-e "common/$stem.h");
+        print $makefp <<__EOF;
+
+common/$stem.o : $deps
+\t\$(CC) \$(CFLAGS) \$(XMLFLAGS) -I. -c -o \$@ \$<
+__EOF
+    }
+}
+
+#*************************************************************************
+# Writes the rules to build the bioptools multi-call program. Each
+# program is compiled again with main() renamed to <program>_main() and
+# then every other global symbol is made local so that the programs can
+# be linked together. exit() is renamed to btPipeExit() so that it ends
+# only the program's stage of a pipeline (see common/pipeline.c).
+#
+# 19.10.26 Original   By: agent
+# 19.10.26 Renames exit() and uses applets.h from the build directory
+sub WriteMultiRules
+{
+    my($makefp, @exeFiles) = @_;
+    print $makefp <<__EOF;
+
+bioptools : multi/bioptools.c applets.h \$(MULTIOBJS) \$(BTLIB)
+\t\$(CC) \$(CFLAGS) -I. -o \$@ multi/bioptools.c \$(MULTIOBJS) \$(LFLAGS)
+__EOF
+
+    foreach my $exe (@exeFiles)
+    {
+        print $makefp <<__EOF;
+
+multi/$exe.o : $exe.c \$(BTLIB)
+\t\$(CC) \$(CFLAGS) -Dmain=${exe}_main -Dexit=btPipeExit -c -o \$@ \$<
+\tobjcopy --keep-global-symbol=${exe}_main \$@
+__EOF
+    }
+}
+
+#*************************************************************************
+# Writes the rule for installing bioptools in $BINDIR with a link for
+# each program
+#
+# 19.10.26 Original   By: agent
+sub WriteInstallMultiRule
+{
+    my($makefp) = @_;
+    print $makefp <<__EOF;
+
+installmulti : bioptools
+\tmkdir -p \$(BINDIR)
+\tcp bioptools \$(BINDIR)
+\t(cd \$(BINDIR); for prog in \$(TARGETS); do \\rm -f \$\$prog; ln -s bioptools \$\$prog; done)
+\tmkdir -p \$(DATADIR)
+\t./installdata.sh \$(DATADIR)
+
+__EOF
+}
+
+#*************************************************************************
+# Writes the rules to build the benchmark programs and to run them on
+# the programs in this directory. The results go to bench/results.json
+# Extra options for pdbbench may be given with BENCHFLAGS, e.g.
+#    make bench BENCHFLAGS="-s 1000,1000000 -r 5"
+#
+# 19.10.26 Original   By: agent
+sub WriteBenchRules
+{
+    my($makefp) = @_;
+    print $makefp <<__EOF;
+
+bench : \$(TARGETS) \$(BENCHPROGS)
+\tDATADIR=\$(DATADIR) bench/pdbbench \$(BENCHFLAGS) -o bench/results.json
+\t\@echo " "
+\t\@echo "Benchmark results written to bench/results.json"
+
+bench/pdbgen : bench/pdbgen.c
+\t\$(CC) \$(CFLAGS) -o \$\@ \$< -lm
+
+bench/pdbbench : bench/pdbbench.c
+\t\$(CC) \$(CFLAGS) -o \$\@ \$<
+__EOF
+}
+
+#*************************************************************************
+# Writes applets.h which lists the programs in bioptools. Like the
+# Makefile, this is written in the build directory; multi/bioptools.c
+# finds it with -I.
+#
+# 19.10.26 Original   By: agent
+# 19.10.26 Written in the build directory rather than multi/
+sub WriteAppletList
+{
+    my(@exeFiles) = @_;
+    open(my $fp, ">applets.h") ||
+        die "Can't open applets.h for writing";
+    print $fp "/* Written by makemake.pl */\n";
+    foreach my $exe (sort @exeFiles)
+    {
+        print $fp "APPLET($exe)\n";
+    }
+    close $fp;
+}
+
 #*************************************************************************
 # Writes the dummy rule for building everything
 #
@@ -301,15 +453,28 @@ __EOF
 # Write the flags for the compiler and directories
 #
 # 06.11.14 Original   By: ACRM
+# 19.10.26 Added BTLIB and links with it   By: agent
+# 19.10.26 Links with zlib and pthreads. Added $zstd
+# 19.10.26 Added XMLFLAGS
+# 19.10.26 Added BENCHPROGS and BENCHFLAGS
 sub WriteFlags
 {
-    my($makefp, $libdir, $incdir, $bindir, $datadir) = @_;
+    my($makefp, $libdir, $incdir, $bindir, $datadir, $zstd) = @_;
+    my $zcflags = ($zstd ? " -DZSTD_SUPPORT" : "");
+    my $zlflags = ($zstd ? " -lzstd" : "");
+    my $xmlflags = `xml2-config --cflags 2>/dev/null`;
+    chomp $xmlflags;
+    $xmlflags = "-DXML_SUPPORT $xmlflags" if($? == 0);
     print $makefp <<__EOF;
 CC      = gcc
 BINDIR  = $bindir
 DATADIR = $datadir
-CFLAGS  = -O3 -ansi -Wall -pedantic -Wno-stringop-truncation -I$incdir -L$libdir
-LFLAGS  = -lbiop -lgen -lm -lxml2
+BTLIB   = common/libbioptools.a
+CFLAGS  = -O3 -ansi -Wall -pedantic -Wno-stringop-truncation$zcflags -I$incdir -L$libdir
+LFLAGS  = -Lcommon -lbioptools -lbiop -lgen -lm -lxml2 -lz -lpthread$zlflags
+XMLFLAGS = $xmlflags
+BENCHPROGS = bench/pdbgen bench/pdbbench
+BENCHFLAGS =
 __EOF
 }
 
@@ -328,6 +493,38 @@ sub WriteTargets
     print $makefp "\n";
 }
 
+#*************************************************************************
+# Write the list of objects that make up libbioptools.a
+#
+# 19.10.26 Original   By: agent
+sub WriteLibObjects
+{
+    my ($makefp, @libFiles) = @_;
+    print $makefp "BTOBJS  = ";
+    foreach my $libFile (@libFiles)
+    {
+        my $obj = $libFile;
+        $obj =~ s/\.c$/.o/;
+        print $makefp "common/$obj ";
+    }
+    print $makefp "\n";
+}
+
+#*************************************************************************
+# Write the list of objects that make up bioptools
+#
+# 19.10.26 Original   By: agent
+sub WriteMultiObjects
+{
+    my ($makefp, @exeFiles) = @_;
+    print $makefp "MULTIOBJS = ";
+    foreach my $exe (@exeFiles)
+    {
+        print $makefp "multi/$exe.o ";
+    }
+    print $makefp "\n";
+}
+
 #*************************************************************************
 # Build a list of target excutables by remove the extensions from the
 # C source files
@@ -381,10 +578,11 @@ sub UsageDie
 
 makemake.pl (c) 2014-2015 UCL, Dr. Andrew C.R. Martin
 
-Usage: ./makemake.pl [-bioplib] [-prefix=xxx] [-bindir=xxx] [-datadir=xxx]
-                     [-libdir=xxx] [-incdir=xxx]
+Usage: ./makemake.pl [-bioplib] [-zstd] [-prefix=xxx] [-bindir=xxx]
+                     [-datadir=xxx] [-libdir=xxx] [-incdir=xxx]
                      
        -bioplib     - Build a local version of BiopLib
+       -zstd        - Support zstd compressed files (needs libzstd)
 
     The following options are shown in reverse order of priority - in
     other words the more specific options (such as -bindir) will take
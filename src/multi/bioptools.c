@@ -0,0 +1,295 @@
+/************************************************************************/
+/**
+
+   \file       bioptools.c
+
+   \version    V1.1
+   \date       19.10.26
+   \brief      Multi-call program providing all of BiopTools
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Every program is compiled a second time with its main() renamed to
+   <program>_main() and all its other symbols made local (see
+   makemake.pl). This links them together. The program to run is taken
+   from the name this was invoked as (so a link called pdbhstrip runs
+   pdbhstrip) or from the first argument.
+
+   Programs separated by a '|' argument are run in turn in this process
+   as a pipeline. Structures are passed from one to the next in memory
+   (see common/pipeline.c).
+
+   Each program is run with btRunPipeStage(). The programs are
+   compiled with exit() renamed to btPipeExit() so a program that
+   calls exit() stops the pipeline rather than the whole process.
+
+   applets.h is written by makemake.pl in the build directory and has
+   an APPLET(name) line for each program.
+
+**************************************************************************
+
+   Usage:
+   ======
+   bioptools program [args] ['|' program [args]]...
+   program [args]         (through a link to bioptools)
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Runs each stage with btRunPipeStage() so exit() in a
+                  program is caught
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "common/pipeline.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define PIPESEP   "|"
+#define MULTINAME "bioptools"
+
+typedef int (*MAINFUNC)(int argc, char **argv);
+
+typedef struct
+{
+   char     *name;
+   MAINFUNC main;
+}  APPLETINFO;
+
+/************************************************************************/
+/* Globals
+*/
+#define APPLET(name) int name##_main(int argc, char **argv);
+#include "applets.h"
+#undef APPLET
+
+#define APPLET(name) {#name, name##_main},
+static APPLETINFO sApplets[] =
+{
+#include "applets.h"
+   {NULL, NULL}
+};
+#undef APPLET
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+MAINFUNC FindApplet(char *name);
+int RunPipeline(int argc, char **argv);
+void ListApplets(void);
+void Usage(void);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+   Main program
+
+-  19.10.26 Original   By: agent
+*/
+int main(int argc, char **argv)
+{
+   MAINFUNC appletMain;
+   char     *name;
+
+   /* Invoked through a link with the name of a program                 */
+   if((name = strrchr(argv[0], '/')) == NULL)
+      name = argv[0];
+   else
+      name++;
+   if(strcmp(name, MULTINAME) &&
+      ((appletMain = FindApplet(name)) != NULL))
+      return((*appletMain)(argc, argv));
+
+   if(argc < 2)
+   {
+      Usage();
+      return(0);
+   }
+
+   if(!strcmp(argv[1], "-l"))
+   {
+      ListApplets();
+      return(0);
+   }
+   if(argv[1][0] == '-')
+   {
+      Usage();
+      return(0);
+   }
+
+   return(RunPipeline(argc-1, argv+1));
+}
+
+
+/************************************************************************/
+/*>int RunPipeline(int argc, char **argv)
+   --------------------------------------
+*//**
+   \param[in]  argc    Argument count starting with the first program
+   \param[in]  **argv  Arguments
+   \return             Exit status of the first program to fail, or 0
+
+   Splits the arguments at each '|' and runs each program with its own
+   arguments. The first program reads the real input and the last one
+   writes the real output. The pipeline stops at the first program
+   that returns (or exits with) a non-zero status.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Uses btRunPipeStage()
+*/
+int RunPipeline(int argc, char **argv)
+{
+   int  start,
+        end,
+        status = 0;
+   BOOL first  = TRUE,
+        last;
+
+   /* Check all the programs before running anything                   */
+   for(start=0; start<argc; start=end+1)
+   {
+      for(end=start; (end<argc) && strcmp(argv[end], PIPESEP); end++);
+      if(end == start)
+      {
+         fprintf(stderr, "Error: Empty pipeline stage\n");
+         return(1);
+      }
+      if(FindApplet(argv[start]) == NULL)
+      {
+         fprintf(stderr, "Error: Unknown program: %s\n", argv[start]);
+         return(1);
+      }
+   }
+
+   for(start=0; start<argc; start=end+1)
+   {
+      for(end=start; (end<argc) && strcmp(argv[end], PIPESEP); end++);
+      last = (end >= argc);
+      argv[end] = NULL;
+
+      if(!btStartPipeStage(!first, !last))
+      {
+         fprintf(stderr, "Error: No memory for pipeline\n");
+         status = 1;
+      }
+      else
+      {
+         status = btRunPipeStage(FindApplet(argv[start]),
+                                 end-start, argv+start);
+      }
+      btEndPipeStage();
+      fflush(stdout);
+
+      if(status)
+         break;
+      first = FALSE;
+   }
+
+   btEndPipeline();
+   return(status);
+}
+
+
+/************************************************************************/
+/*>MAINFUNC FindApplet(char *name)
+   -------------------------------
+*//**
+   \param[in]  *name   Program name
+   \return             The program's main() (NULL if not found)
+
+-  19.10.26 Original   By: agent
+*/
+MAINFUNC FindApplet(char *name)
+{
+   int i;
+
+   for(i=0; sApplets[i].name != NULL; i++)
+   {
+      if(!strcmp(sApplets[i].name, name))
+         return(sApplets[i].main);
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>void ListApplets(void)
+   ----------------------
+*//**
+   Lists the programs that are available
+
+-  19.10.26 Original   By: agent
+*/
+void ListApplets(void)
+{
+   int i;
+
+   for(i=0; sApplets[i].name != NULL; i++)
+      printf("%s\n", sApplets[i].name);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+   Prints a usage message
+
+-  19.10.26 Original   By: agent
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\nbioptools V1.1 (c) 2026 UCL\n");
+   fprintf(stderr,"\nUsage: bioptools program [args] ['|' program \
+[args]]...\n");
+   fprintf(stderr,"       bioptools -l\n");
+   fprintf(stderr,"       -l List the programs\n");
+   fprintf(stderr,"\nRuns any of the BiopTools programs. A link to \
+bioptools with the name\n");
+   fprintf(stderr,"of a program runs that program.\n");
+   fprintf(stderr,"\nPrograms separated by '|' (quoted so that the \
+shell does not see it)\n");
+   fprintf(stderr,"are run as a pipeline in this process. Structures \
+are passed from one\n");
+   fprintf(stderr,"program to the next in memory rather than being \
+written out and read\n");
+   fprintf(stderr,"back in. Each program reads the output of the one \
+before it, so only\n");
+   fprintf(stderr,"the first may name an input file; the last writes \
+to standard output.\n");
+   fprintf(stderr,"e.g.\n");
+   fprintf(stderr,"   bioptools pdbhstrip in.pdb '|' pdbrenum '|' \
+pdbsolv > out.pdb\n\n");
+}
+
@@ -3,8 +3,8 @@
 
    \file       naccess2bval.c
    
-   \version    V1.9
-   \date       25.11.14
+   \version    V1.11
+   \date       19.10.26
    \brief      Sum B-vals over each residue and replace with the
                summed or average value
    
@@ -60,6 +60,9 @@
 -  V1.7  15.08.14 Updated ReadSolv() to use CLEAR_PDB(). By: CTP
 -  V1.8  06.11.14 Renamed as naccess2bval  By: ACRM
 -  V1.9  25.11.14 Initialized a variable
+-  V1.10 19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process   By: agent
+-  V1.11 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -76,6 +79,8 @@
 #include "bioplib/MathUtil.h"
 #include "bioplib/general.h"
 #include "bioplib/fsscanf.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -115,9 +120,11 @@ int main(int argc, char **argv)
    PDB  *pdb, 
         *p;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          if((pdb = ReadSolv(in,&natoms)) != NULL)
          {
@@ -223,7 +230,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nnaccess2bval V1.9 (c) 1994-2014, Andrew C.R. Martin, \
+   fprintf(stderr,"\nnaccess2bval V1.11 (c) 1994-2014, Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"Usage: naccess2bval [in.pdb [out.pdb]]\n");
    fprintf(stderr,"Rewrites the output from naccess solvent accessibility \
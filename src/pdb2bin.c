@@ -0,0 +1,227 @@
+/************************************************************************/
+/**
+
+   \file       pdb2bin.c
+
+   \version    V1.2
+   \date       19.10.26
+   \brief      Convert a PDB file to a binary PDB file
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Reads a PDB (or PDBML) file and writes it as a binary PDB file (see
+   common/binpdb.c). Any program that reads its input with the shared
+   reader in common/pdbread.c recognises a binary PDB file by its
+   magic number and loads it without parsing, so a structure that is
+   going through several programs only needs to be parsed once.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.2  19.10.26 Updated for the changed arguments of
+                  btWriteBinaryPDB()
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/binpdb.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF 256
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+void Usage(void);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *atomsOnly);
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program
+
+-  19.10.26 Original    By: agent
+*/
+int main(int argc, char **argv)
+{
+   FILE     *in      = stdin,
+            *out     = stdout;
+   WHOLEPDB *wpdb;
+   char     infile[MAXBUFF],
+            outfile[MAXBUFF];
+   BOOL     atomsOnly = FALSE;
+
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &atomsOnly))
+   {
+      if(btOpenStdFiles(infile, outfile, &in, &out))
+      {
+         if(atomsOnly)
+            wpdb = btReadWholePDBAtoms(in);
+         else
+            wpdb = btReadWholePDB(in);
+
+         if(wpdb == NULL)
+         {
+            fprintf(stderr,"No atoms read from PDB file\n");
+            return(1);
+         }
+
+         if(!btWriteBinaryPDB(out, wpdb, atomsOnly, NULL))
+         {
+            fprintf(stderr,"Error writing binary PDB file\n");
+            return(1);
+         }
+      }
+   }
+   else
+   {
+      Usage();
+   }
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+-  19.10.26 Original    By: agent
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\npdb2bin V1.2  (c) 2026 UCL\n");
+   fprintf(stderr,"Usage: pdb2bin [-a] [<input.pdb> \
+[<output.bpdb>]]\n");
+   fprintf(stderr,"       -a Discard HETATM records\n");
+
+   fprintf(stderr,"\nConverts a PDB or PDBML file to a binary PDB file \
+holding the atoms,\n");
+   fprintf(stderr,"CONECT data, header and trailer exactly as read. \
+Programs that read a\n");
+   fprintf(stderr,"whole PDB file recognise binary PDB files \
+automatically and load them\n");
+   fprintf(stderr,"without parsing. The file can only be read by \
+programs built against the\n");
+   fprintf(stderr,"same version of BiopLib.\n");
+   fprintf(stderr,"\nIf the environment variable %s names a \
+directory, binary\n", ENV_CACHEDIR);
+   fprintf(stderr,"images of PDB files are also cached there \
+automatically when they are\n");
+   fprintf(stderr,"first read.\n");
+   fprintf(stderr,"\nI/O is to stdin/stdout if not specified\n\n");
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *atomsOnly)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]      argc         Argument count
+   \param[in]      **argv       Argument array
+   \param[out]     *infile      Input file (or blank string)
+   \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *atomsOnly   Discard HETATMs
+   \return                      Success?
+
+   Parse the command line
+
+-  19.10.26 Original    By: agent
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *atomsOnly)
+{
+   argc--;
+   argv++;
+
+   infile[0] = outfile[0] = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         switch(argv[0][1])
+         {
+         case 'a':
+            *atomsOnly = TRUE;
+            break;
+         default:
+            return(FALSE);
+            break;
+         }
+      }
+      else
+      {
+         /* Check that there are only 1 or 2 arguments left             */
+         if(argc > 2)
+            return(FALSE);
+
+         /* Copy the first to infile                                    */
+         strcpy(infile, argv[0]);
+
+         /* If there's another, copy it to outfile                      */
+         argc--;
+         argv++;
+         if(argc)
+            strcpy(outfile, argv[0]);
+
+         return(TRUE);
+      }
+      argc--;
+      argv++;
+   }
+
+   return(TRUE);
+}
+
@@ -3,8 +3,8 @@
 
    \file       pdb2ms.c
    
-   \version    V1.3
-   \date       22.07.14
+   \version    V1.6
+   \date       19.10.26
    \brief      Create input file for Connoly MS program
    
    \copyright  (c) Dr. Andrew C. R. Martin 1996-2014
@@ -62,6 +62,11 @@
                   Can take atom types or radii from the PDB file
 -  V1.3  22.07.14 Renamed deprecated functions with bl prefix.
                   Added doxygen annotation. By: CTP
+-  V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.6  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -73,6 +78,9 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -130,12 +138,14 @@ int main(int argc, char **argv)
    int  natoms;
    BOOL DoStd, Quiet, Alt, GotRad, GotType;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, InFile, OutFile, &DoStd, &Quiet, &Alt,
                    &GotRad, &GotType))
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
-         if((pdb = blReadPDB(in, &natoms))==NULL)
+         if((pdb = btReadPDB(in, &natoms))==NULL)
          {
             fprintf(stderr,"No atoms read from PDB file\n");
             return(1);
@@ -260,7 +270,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2ms V1.3 (c)1996-2014, Dr. Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\npdb2ms V1.6 (c)1996-2014, Dr. Andrew C.R. Martin, UCL\n");
    fprintf(stderr,"\nUsage: pdb2ms [-s] [-a] [-q] [in.pdb [out.ms]]\n");
    fprintf(stderr,"       -s Write standard data files as well\n");
    fprintf(stderr,"       -a Use alternate atom type radii (as used by \
@@ -3,8 +3,8 @@
 
    \file       pdb2pdbml.c
    
-   \version    V1.0
-   \date       26.02.15
+   \version    V1.4
+   \date       19.10.26
    \brief      Convert PDB format to PDBML
    
    \copyright  (c) Dr. Andrew C. R. Martin 2015
@@ -36,6 +36,12 @@
 
    Description:
    ============
+   A PDB file is read as a stream with btStreamPDB() and each atom is
+   written as PDBML as soon as its residue has been read (see
+   common/pdbmlwrite.c). No XML document is built, so output starts
+   immediately and memory use does not grow with the size of the
+   structure. Binary PDB and PDBML input are read into memory with
+   btReadWholePDB() and written with the same writer.
 
 **************************************************************************
 
@@ -47,19 +53,44 @@
    Revision History:
    =================
 -  V1.0  26.02.15 Original
+-  V1.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.2  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.3  19.10.26 Streams PDB input straight to PDBML with the writer
+                  in common/pdbmlwrite.c rather than building an XML
+                  tree
+-  V1.4  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/pdbread.h"
+#include "common/pdbstream.h"
+#include "common/pdbmlread.h"
+#include "common/pdbmlwrite.h"
+#include "common/binpdb.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 256
+#define OUTBUFF (1024*1024)   /* stdio buffer for the output file       */
+
+typedef struct
+{
+   FILE        *out;
+   PDBMLHEADER info;
+   int         natoms;
+}  STREAMOUT;
 
 /************************************************************************/
 /* Globals
@@ -71,6 +102,9 @@
 int main(int argc, char **argv);
 void Usage(void);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL WriteStart(STRINGLIST *header, void *data);
+BOOL WriteAtom(PDB *p, void *data);
+BOOL ConvertPDB(FILE *in, FILE *out);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -80,6 +114,8 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
    Main program
 
 -  26.02.15 Original    By: ACRM
+-  19.10.26 Output is given a large buffer and PDB files are streamed
+            with ConvertPDB()   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -88,19 +124,33 @@ int main(int argc, char **argv)
    WHOLEPDB *wpdb;
    char     infile[MAXBUFF],
             outfile[MAXBUFF];
+   int      c;
+
+   btInitTiming(&argc, argv);
 
    if(ParseCmdLine(argc, argv, infile, outfile))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))!=NULL)
+         setvbuf(out, NULL, _IOFBF, OUTBUFF);
+
+         /* Binary PDB and PDBML files are read in one go              */
+         c = getc(in);
+         ungetc(c, in);
+         if((c == (BPDB_MAGIC[0] & 0xff)) || btIsPDBML(in))
          {
-            FORCEXML;
-            blWriteWholePDB(out, wpdb);
+            if((wpdb=btReadWholePDB(in))!=NULL)
+            {
+               btWritePDBML(out, wpdb);
+            }
+            else
+            {
+               fprintf(stderr,"No atoms read from PDB file\n");
+               return(1);
+            }
          }
-         else
+         else if(!ConvertPDB(in, out))
          {
-            fprintf(stderr,"No atoms read from PDB file\n");
             return(1);
          }
       }
@@ -124,13 +174,18 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2pdbml V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdb2pdbml V1.4  (c) 2015 UCL, Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Usage: pdb2pdbml [<input.pdb> [<output.pdb>]]\n");
    fprintf(stderr,"I/O is to stdin/stdout if not specified\n\n");
    fprintf(stderr,"Converts a PDB file to PDBML format\n\n");
    fprintf(stderr,"Note that only key header information is retained \
-at present\n\n");
+at present\n");
+   fprintf(stderr,"and only the first model is converted.\n");
+   fprintf(stderr,"\nAtoms are written as they are read, so output \
+starts immediately and\n");
+   fprintf(stderr,"memory use does not grow with the size of the \
+structure.\n\n");
 }
 
 
@@ -191,3 +246,86 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
    return(TRUE);
 }
 
+
+/************************************************************************/
+/*>BOOL ConvertPDB(FILE *in, FILE *out)
+   ------------------------------------
+*//**
+
+   \param[in]      *in          Input PDB file
+   \param[in]      *out         Output PDBML file
+   \return                      Success?
+
+   Streams a PDB file to PDBML. The header categories are written at
+   the end from the information saved by WriteStart().
+
+-  19.10.26 Original    By: agent
+*/
+BOOL ConvertPDB(FILE *in, FILE *out)
+{
+   STREAMOUT streamOut;
+
+   streamOut.out    = out;
+   streamOut.natoms = 0;
+
+   if(!btStreamPDB(in, FALSE, WriteStart, WriteAtom, (void *)&streamOut))
+      return(FALSE);
+
+   if(streamOut.natoms == 0)
+   {
+      fprintf(stderr,"No atoms read from PDB file\n");
+      return(FALSE);
+   }
+
+   btWritePDBMLEnd(out, &(streamOut.info));
+   return(!ferror(out));
+}
+
+
+/************************************************************************/
+/*>BOOL WriteStart(STRINGLIST *header, void *data)
+   -----------------------------------------------
+*//**
+
+   \param[in]      *header      PDB header records
+   \param[in,out]  *data        STREAMOUT output details
+   \return                      Success?
+
+   Header callback for btStreamPDB(). Saves the key header information
+   and starts the PDBML file.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL WriteStart(STRINGLIST *header, void *data)
+{
+   STREAMOUT *streamOut = (STREAMOUT *)data;
+
+   btGetPDBMLHeader(header, &(streamOut->info));
+   btWritePDBMLStart(streamOut->out, &(streamOut->info));
+   return(!ferror(streamOut->out));
+}
+
+
+/************************************************************************/
+/*>BOOL WriteAtom(PDB *p, void *data)
+   ----------------------------------
+*//**
+
+   \param[in]      *p           Atom from the PDB file
+   \param[in,out]  *data        STREAMOUT output details
+   \return                      Success?
+
+   Atom callback for btStreamPDB(). Writes and frees the atom.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL WriteAtom(PDB *p, void *data)
+{
+   STREAMOUT *streamOut = (STREAMOUT *)data;
+
+   btWritePDBMLAtom(streamOut->out, p);
+   free(p);
+   streamOut->natoms++;
+   return(!ferror(streamOut->out));
+}
+
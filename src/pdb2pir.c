@@ -3,8 +3,8 @@
 
    \file       pdb2pir.c
    
-   \version    V2.15
-   \date       13.03.19
+   \version    V2.18
+   \date       19.10.26
    \brief      Convert PDB to PIR sequence file
    
    \copyright  (c) Dr. Andrew C. R. Martin, UCL 1994-2019
@@ -75,6 +75,11 @@
 -  V2.13 10.03.15 Improved multi-character chain support
 -  V2.14 11.06.15 Moved generally useful code into Bioplib
 -  V2.15 13.03.19 Now valgrind clean
+-  V2.16 19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V2.17 19.10.26 Reports timings if BIOPTOOLS_TIMING is set
+-  V2.18 19.10.26 Resets its global flags so it can run more than once
+                  in a bioptools pipeline
 
 *************************************************************************/
 /* Includes
@@ -90,6 +95,8 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbread.h"
+#include "common/timing.h"
 
 
 /************************************************************************/
@@ -149,6 +156,7 @@ char *strdup(const char *s);
             By: ACRM
 -  13.03.19 Adds 2 rather than 1 to the length of the sequence in
             realloc()
+-  19.10.26 Resets the global flags   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -174,6 +182,8 @@ int main(int argc, char **argv)
         DoNumbering  = FALSE;
    MODRES *modres = NULL;
    
+   btInitTiming(NULL, argv);
+
    if((outchains = (char **)blArray2D(sizeof(char), MAXCHAINS, blMAXCHAINLABEL))==NULL)
    {
       fprintf(stderr,"Error: No memory for outchains array\n");
@@ -185,6 +195,8 @@ int main(int argc, char **argv)
       return(1);
    }
    
+   /* Reset the flags as this may be run more than once in a pipeline   */
+   gQuiet    = gUpper = gFASTA = FALSE;
    gLabel[0] = gLabel[blMAXPIRLABEL-1]  = '\0';
    title[0]  = title[MAXTITLE-1] = '\0';
    
@@ -288,7 +300,7 @@ int main(int argc, char **argv)
    }
 
    /* Read PDB file                                                     */
-   if(((wpdb = blReadWholePDBAtoms(in)) == NULL)||(wpdb->pdb==NULL))
+   if(((wpdb = btReadWholePDBAtoms(in)) == NULL)||(wpdb->pdb==NULL))
    {
       fprintf(stderr,"Error: Unable to read atoms from input file%s%s\n",
               ((gLabel[0])?" Label: ":""),
@@ -420,7 +432,7 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2pir V2.15 (c) 1994-2019 Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\npdb2pir V2.18 (c) 1994-2019 Dr. Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"\nUsage: pdb2pir [-h][-l label][-t title][-s][-c][-x]\
 [-u][-p][-q]\n");
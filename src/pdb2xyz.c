@@ -3,8 +3,8 @@
 
    \file       pdb2xyz.c
    
-   \version    V1.1
-   \date       22.07.14
+   \version    V1.4
+   \date       19.10.26
    \brief      Convert PDB to Gromos XYZ
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2014
@@ -49,6 +49,11 @@
 -  V1.0  23.08.94 Original   By: ACRM
 -  V1.1  22.07.14 Renamed deprecated functions with bl prefix.
                   Added doxygen annotation. By: CTP
+-  V1.2  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.3  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.4  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -61,6 +66,9 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -101,11 +109,13 @@ int main(int argc, char **argv)
    PDB  *pdb;
    int  natoms;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, title))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDB(in,&natoms)) != NULL)
+         if((pdb = btReadPDB(in,&natoms)) != NULL)
          {
             WriteXYZ(out, pdb, natoms, title);
          }
@@ -202,7 +212,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2xyz V1.1 (c) 1994-2014, Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\npdb2xyz V1.4 (c) 1994-2014, Andrew C.R. Martin, UCL\n");
    fprintf(stderr,"Usage: pdb2xyz [-t title] [<in.pdb>] [<out.pdb>]\n\n");
    fprintf(stderr,"Convert PDB format to GROMOS XYZ. N.B. Does NOT \
 correct atom order.\n\n");
@@ -3,8 +3,8 @@
 
    \file       pdbaddhet.c
    
-   \version    V2.4
-   \date       12.02.15
+   \version    V2.6
+   \date       19.10.26
    \brief      Add HETATMs back into a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 2002-2015
@@ -52,6 +52,10 @@
 -  V2.2  06.11.14    Changed name from addhet to pdbaddhet
 -  V2.3  25.11.14    Initialized a variable  By: ACRM
 -  V2.4  12.02.15    Updated usage message
+-  V2.5  19.10.26    Reads the PDB file with the shared memory-mapped
+                     reader in common/pdbread.c   By: agent
+-  V2.6  19.10.26    Reports timings with -T or if BIOPTOOLS_TIMING is
+                     set
 
 *************************************************************************/
 /* Includes */
@@ -60,6 +64,8 @@
 #include <stdlib.h>
 #include "bioplib/macros.h"
 #include "bioplib/pdb.h"
+#include "common/pdbread.h"
+#include "common/timing.h"
 
 /***********************************************************************/
 /* Prototypes */
@@ -93,10 +99,12 @@ int main (int argc, char *argv[])
    
    REAL xmin, xmax, ymin, ymax, zmin, zmax;
    
+   btInitTiming(&argc, argv);
+
    /* check correct number of files are specified on command line */
    if(argc !=4)
    {
-      fprintf(stderr, "\npdbaddhet V2.4 (c) 2002-2015, UCL, \
+      fprintf(stderr, "\npdbaddhet V2.6 (c) 2002-2015, UCL, \
 Dr. Andrew C.R. Martin\n\n");
       fprintf(stderr, "Usage: pdbaddhet whole.pdb part.pdb \
 out.pdb\n");
@@ -134,7 +142,7 @@ SCOP\n\n");
    }
    
    
-   if((pdbDomain =  blReadPDB(fp2, &natoms))!=NULL)
+   if((pdbDomain =  btReadPDB(fp2, &natoms))!=NULL)
    {
       DetermineBoundingBox(pdbDomain, &xmin, &xmax, &ymin, &ymax,  
                            &zmin, &zmax);
@@ -212,7 +220,7 @@ PDB *ReadPDBHetAtoms(FILE *fp1, int *natoms)
    int natoms2;
        *natoms = 0;
    
-   if((pdb = blReadPDB(fp1, &natoms2))!=NULL)
+   if((pdb = btReadPDB(fp1, &natoms2))!=NULL)
    {
       for(p=pdb; p!=NULL; NEXT(p))
       {
@@ -3,8 +3,8 @@
 
    \file       pdbatomcount.c
    
-   \version    V1.8
-   \date       12.03.15
+   \version    V1.15
+   \date       19.10.26
    \brief      Count atoms neighbouring each atom in a PDB file
                Results output in B-val column
    
@@ -58,6 +58,20 @@
 -  V1.6  06.11.14 Renamed from atomcount
 -  V1.7  12.02.15 Uses WholePDB
 -  V1.8  12.03.15 Changed to use CHAINMATCH()
+-  V1.9  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.10 19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.11 19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.12 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.13 19.10.26 Residue contacts (-c, -n) step through the residues
+                  with the shared residue index rather than walking the
+                  list
+-  V1.14 19.10.26 Atoms are read and copied into arenas and released in
+                  one go rather than one at a time
+-  V1.15 19.10.26 Atom counts (default, -d and -b) use packed
+                  coordinate arrays and batch distance routines
 
 
 *************************************************************************/
@@ -72,6 +86,13 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/resindex.h"
+#include "common/arena.h"
+#include "common/coords.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -96,10 +117,10 @@
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                   REAL *radius, int *CountType, BOOL *StripWater);
-void CountNeighbours(PDB *pdb, REAL radius, int CountType);
+BOOL CountNeighbours(PDB *pdb, REAL radius, int CountType);
 void Usage(void);
-void doResidueContacts(PDB *pdb, REAL RadSq, int CountType);
-BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr);
+BOOL doResidueContacts(PDB *pdb, REAL RadSq, int CountType);
+BOOL ResSep(RESINDEX *index, int pr, int qr);
 
 
 /************************************************************************/
@@ -115,6 +136,7 @@ BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  19.08.14 Fixed call to renamed function blStripWatersPDBAsCopy() 
             By: CTP
+-  19.10.26 Reads the atoms and strips the waters into arenas   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -127,34 +149,60 @@ int main(int argc, char **argv)
    int  CountType;
    BOOL StripWater = TRUE;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &radius, &CountType,
                    &StripWater))
    {
       /* Square the radius to save on distance sqrt()s                  */
       radius *= radius;
       
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          WHOLEPDB *wpdb;
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         ARENA    *arena;
+
+         if((arena = btNewArena(0)) == NULL)
+         {
+            fprintf(stderr,"Error: (pdbatomcount) No memory for \
+atoms\n");
+            return(1);
+         }
+         
+         if((wpdb = btReadWholePDBInArena(in, arena)) != NULL)
          {
             pdb = wpdb->pdb;
             if(StripWater)
             {
-               PDB *pdb2;
-               int natoms;
+               ARENA *waterless;
+               int   natoms;
                
-               pdb2 = blStripWatersPDBAsCopy(pdb, &natoms);
-               FREELIST(pdb, PDB);
-               wpdb->pdb = pdb = pdb2;
+               if((waterless = btNewArena(0)) == NULL)
+               {
+                  fprintf(stderr,"Error: (pdbatomcount) No memory for \
+atoms\n");
+                  return(1);
+               }
+               pdb = btArenaCopyPDB(waterless, pdb, btSelectNonWater,
+                                    NULL, &natoms);
+               btFreeArena(arena);
+               arena = waterless;
+               wpdb->pdb = pdb;
+            }
+            if(!CountNeighbours(pdb, radius, CountType))
+            {
+               fprintf(stderr,"Error: (pdbatomcount) No memory for \
+residue index\n");
+               return(1);
             }
-            CountNeighbours(pdb, radius, CountType);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
+            btFreeWholePDBInArena(wpdb);
          }
          else
          {
             fprintf(stderr,"No atoms read from PDB file\n");
          }
+         btFreeArena(arena);
       }
    }
    else
@@ -264,13 +312,14 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 }
 
 /************************************************************************/
-/*>void CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
+/*>BOOL CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
    ---------------------------------------------------------
 *//**
 
    \param[in,out]  *pdb       PDB linked list
    \param[in]      RadSq      Radius squared for neighbour search
    \param[in]      CountType  Counting scheme
+   \return                    Success?
 
    Does the actual work of counting the neighbours. 5 schemes are allowed:
    TYP_ALL         All atoms counted
@@ -283,59 +332,87 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  05.07.94 Original    By: ACRM
 -  29.04.08 Added TYP_CONTACT / TYP_NORMCONTACT
 -  12.03.15 Changed to use CHAINMATCH()
+-  19.10.26 Returns BOOL   By: agent
+-  19.10.26 Counts from a packed coordinate view with the batch
+            distance routines
 */
-void CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
+BOOL CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
 {
-   PDB *p,
-       *q;
-   int count;
+   COORDVIEW *view;
+   PDB       *p,
+             *q;
+   REAL      *distSq = NULL;
+   int       i, j,
+             count;
 
    if((CountType == TYP_CONTACT) || (CountType == TYP_NORMCONTACT))
    {
-      doResidueContacts(pdb, RadSq, CountType);
+      return(doResidueContacts(pdb, RadSq, CountType));
    }
-   else
+
+   if((view = btBuildCoordView(pdb, FALSE))==NULL)
+      return(FALSE);
+   if((CountType == TYP_DIFFRES) &&
+      ((distSq = (REAL *)malloc((view->natoms+1) * sizeof(REAL)))==NULL))
    {
-      for(p=pdb; p!=NULL; NEXT(p))
+      btFreeCoordView(view);
+      return(FALSE);
+   }
+
+   for(i=0; i<view->natoms; i++)
+   {
+      p = view->atoms[i];
+      switch(CountType)
       {
+      case TYP_ALL:
+         /* Everything but the atom itself                              */
+         count = btCountInRange(view, 0, i, p->x, p->y, p->z,
+                                (REAL)(-1.0), RadSq) +
+                 btCountInRange(view, i+1, view->natoms, p->x, p->y, p->z,
+                                (REAL)(-1.0), RadSq);
+         break;
+      case TYP_NONBOND:
+         /* 29.04.08 Corrected to <4.0 rather than >4.0 !!!
+            The atom itself is at 0.0 so is skipped too
+         */
+         count = btCountInRange(view, 0, view->natoms, p->x, p->y, p->z,
+                                (REAL)4.0, RadSq);
+         break;
+      default:
+         /* TYP_DIFFRES - only check the residue of atoms in range      */
+         btDistSqToPoint(view, 0, view->natoms, p->x, p->y, p->z,
+                         distSq);
          count = 0;
-         for(q=pdb; q!=NULL; NEXT(q))
+         for(j=0; j<view->natoms; j++)
          {
-            /* Skip this comparison if the appropriate conditions apply */
-            switch(CountType)
+            if(distSq[j] < RadSq)
             {
-            case TYP_ALL:
-               if(p==q) continue;
-               break;
-            case TYP_DIFFRES:
-               if(p->resnum    == q->resnum    &&
-                  p->insert[0] == q->insert[0] &&
-                  CHAINMATCH(p->chain, q->chain))
-                  continue;
-               break;
-            case TYP_NONBOND:
-               /* 29.04.08 Corrected to <4.0 rather than >4.0 !!!       */
-               if((p==q) || (DISTSQ(p,q) < (REAL)4.0))
-                  continue;
-               break;
+               q = view->atoms[j];
+               if(p->resnum    != q->resnum    ||
+                  p->insert[0] != q->insert[0] ||
+                  !CHAINMATCH(p->chain, q->chain))
+                  count++;
             }
-            
-            if(DISTSQ(p,q) < RadSq)
-               count++;
          }
-         p->bval = (REAL)count;
+         break;
       }
+      p->bval = (REAL)count;
    }
+
+   FREE(distSq);
+   btFreeCoordView(view);
+   return(TRUE);
 }
 
 /************************************************************************/
-/*>void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
+/*>BOOL doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
    -----------------------------------------------------------
 *//**
 
    \param[in]      *pdb        PDB linked list
    \param[in]      RadSq       Squared cutoff distance
    \param[in]      CountType   Counting scheme
+   \return                     Success? (FALSE if no memory)
 
    Does residue-by-residue contacts rather than atom-atom contacts
    Allowed counting schemes are
@@ -346,22 +423,23 @@ void CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
    TYP_CONTACT)
 
 -  29.04.08  Original   By: ACRM
+-  19.10.26  Steps through the residues with a residue index   By: agent
 */
 
-void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
+BOOL doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
 {
-   PDB *p, *q,
-       *res_p, *res_q,
-       *next_res_p = NULL,
-       *next_res_q = NULL;
-   
-   int atomcount = 0,
-       contacts = 0;
+   RESINDEX *index;
+   PDB      *p, *q;
+   int      res_p, res_q,
+            atomcount = 0,
+            contacts = 0;
+
+   if((index = btBuildResIndex(pdb))==NULL)
+      return(FALSE);
 
    /* Step through each residue                                         */
-   for(res_p=pdb; res_p!=NULL; res_p = next_res_p)
+   for(res_p=0; res_p<index->nres; res_p++)
    {
-      next_res_p=blFindNextResidue(res_p);
       /* Using the occupancy as a flag, clear the contact list          */
       for(p=pdb; p!=NULL; NEXT(p))
       {
@@ -373,20 +451,20 @@ void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
          
       
       /* Step through atoms in this residue                             */
-      for(p=res_p; p!=next_res_p; NEXT(p))
+      for(p=BTRESSTART(index, res_p); p!=BTRESEND(index, res_p); NEXT(p))
       {
          atomcount++;   /* Increment atoms in this residue              */
 
          /* Step through the other residues                             */
-         for(res_q=pdb; res_q!=NULL; res_q = next_res_q)
+         for(res_q=0; res_q<index->nres; res_q++)
          {
-            next_res_q=blFindNextResidue(res_q);
-
             /* Check it's a different and not-bonded residue            */
-            if(ResSep(pdb, res_p, res_q))
+            if(ResSep(index, res_p, res_q))
             {
                /* Run through the atoms in this residue                 */
-               for(q=res_q; q!=next_res_q; NEXT(q))
+               for(q=BTRESSTART(index, res_q);
+                   q!=BTRESEND(index, res_q);
+                   NEXT(q))
                {
                   REAL distsq;
                   distsq = DISTSQ(p,q);
@@ -402,12 +480,10 @@ void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
       /* Step through the other residues again and count how many
          residues make contact
       */
-      for(res_q=pdb; res_q!=NULL; res_q = next_res_q)
+      for(res_q=0; res_q<index->nres; res_q++)
       {
-         next_res_q=blFindNextResidue(res_q);
-
          /* Run through the atoms in this residue                       */
-         for(q=res_q; q!=next_res_q; NEXT(q))
+         for(q=BTRESSTART(index, res_q); q!=BTRESEND(index, res_q); NEXT(q))
          {
             /* As soon as we find one atom flagged in this residue,
                bump the counter and jump out of the loop
@@ -421,7 +497,7 @@ void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
       }  /* res_q                                                       */
 
       /* Step through atoms in this residue and update the b-value      */
-      for(p=res_p; p!=next_res_p; NEXT(p))
+      for(p=BTRESSTART(index, res_p); p!=BTRESEND(index, res_p); NEXT(p))
       {
          if(CountType == TYP_NORMCONTACT)
          {
@@ -439,69 +515,43 @@ void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
    {
       p->occ = 1.0;
    }
+
+   btFreeResIndex(index);
+   return(TRUE);
 }
 
 
 /************************************************************************/
-/*>BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr)
-   ---------------------------------------
+/*>BOOL ResSep(RESINDEX *index, int pr, int qr)
+   --------------------------------------------
 *//**
 
-   \param[in]      *pdb       PDB linked list
-   \param[in]      *pr        Pointer to first residue of interest
-   \param[in]      *qr        Pointer to second residue of interest
+   \param[in]      *index     Residue index
+   \param[in]      pr         First residue of interest
+   \param[in]      qr         Second residue of interest
    \return                     Are the residues separated?
 
+   Residues are separated if their numbers differ by more than one or
+   if there is at least one other residue between them in the list
+
 -  29.04.08  Original   By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Takes residue numbers from a residue index rather than
+            counting residues through the linked list   By: agent
 */
-BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr)
+BOOL ResSep(RESINDEX *index, int pr, int qr)
 {
-   int sep;
-   PDB *p, *q;
-   BOOL GotPR = FALSE,
-        GotQR = FALSE;
+   PDB *p = BTRESSTART(index, pr),
+       *q = BTRESSTART(index, qr);
    
    /* If they are more than 1 resnum apart immediately return TRUE      */
-   if(pr->resnum < (qr->resnum - 1))
+   if(p->resnum < (q->resnum - 1))
       return(TRUE);
-   if(pr->resnum > (qr->resnum + 1))
+   if(p->resnum > (q->resnum + 1))
       return(TRUE);
 
-   /* Otherwise count through the PDB linked list and see how far 
-      apart they are
-   */
-   sep = 0;
-   for(p=pdb; p!=NULL; p = q)
-   {
-      q = blFindNextResidue(p);
-      if(p == pr)
-      {
-         if(!GotQR)
-         {
-            sep = 0;
-         }
-         GotPR = TRUE;
-         if(sep > 1)
-         {
-            return(TRUE);
-         }
-      }
-      if(p == qr)
-      {
-         if(!GotPR)
-         {
-            sep = 0;
-         }
-         GotQR = TRUE;
-         if(sep > 1)
-         {
-            return(TRUE);
-         }
-      }
-      sep++;
-   }
-   return(FALSE);
+   /* Otherwise see how far apart they are in the linked list           */
+   return(ABS(pr - qr) > 1);
 }
 
 /************************************************************************/
@@ -521,7 +571,7 @@ BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbatomcount V1.8 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbatomcount V1.15 (c) 1994-2015, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbatomcount [-r <rad>] [-d|-b|-c|-n] [-w] \
 [<in.pdb> [<out.pdb>]]\n");
@@ -3,8 +3,8 @@
 
    \file       pdbatoms.c
    
-   \version    V1.0
-   \date       26.02.15
+   \version    V1.4
+   \date       19.10.26
    \brief      Discard header and footer records from PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 2015
@@ -47,6 +47,13 @@
    Revision History:
    =================
 -  V1.0  26.02.15 Original
+-  V1.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.2  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.3  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.4  19.10.26 Added -s to copy the coordinate records as a stream in
+                  constant memory
 
 *************************************************************************/
 /* Includes
@@ -55,6 +62,10 @@
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -70,7 +81,9 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
+BOOL KeepAll(char *record, void *data);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -80,6 +93,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
    Main program
 
 -  26.02.15 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -89,12 +103,29 @@ int main(int argc, char **argv)
    int      natoms;
    char     infile[MAXBUFF],
             outfile[MAXBUFF];
+   BOOL     stream   = FALSE;
 
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natoms))!=NULL)
+         if(stream && btCanFilterPDB(in))
+         {
+            if(!btFilterPDB(in, out, TRUE, KeepAll, NULL, &natoms))
+            {
+               fprintf(stderr,"Error: Failed while filtering the PDB \
+file\n");
+               return(1);
+            }
+            if(natoms == 0)
+            {
+               fprintf(stderr,"No atoms read from PDB file\n");
+               return(1);
+            }
+         }
+         else if((pdb=btReadPDB(in, &natoms))!=NULL)
          {
             blWritePDB(out, pdb);
          }
@@ -123,20 +154,29 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbatoms V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdbatoms V1.4  (c) 2015 UCL, Andrew C.R. \
 Martin\n");
-   fprintf(stderr,"Usage: pdbatoms [<input.pdb> [<output.pdb>]]\n");
+   fprintf(stderr,"Usage: pdbatoms [-s] [<input.pdb> [<output.pdb>]]\n");
+   fprintf(stderr,"       -s Stream the file, copying the records \
+unchanged\n");
 
    fprintf(stderr,"\nExtracts only the coordinate records from a PDB \
 or PDBML file (i.e. the\n");
    fprintf(stderr,"\nATOM and HETATM records), discarding all header \
 and footer information.\n");
    fprintf(stderr,"I/O is to stdin/stdout if not specified\n\n");
+   fprintf(stderr,"With -s, memory use does not depend on the size of \
+the file and the\n");
+   fprintf(stderr,"ATOM, HETATM and TER records of the first model are \
+written exactly as\n");
+   fprintf(stderr,"they appear in the input. Binary PDB or PDBML input \
+is read as normal.\n\n");
 }
 
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *stream)
    ---------------------------------------------------------------------
 *//**
 
@@ -144,13 +184,16 @@ and footer information.\n");
    \param[in]      **argv       Argument array
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *stream      Filter the file as a stream
    \return                      Success?
 
    Parse the command line
    
 -  26.02.15 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
@@ -163,6 +206,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       {
          switch(argv[0][1])
          {
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -192,3 +238,21 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
    return(TRUE);
 }
 
+
+/************************************************************************/
+/*>BOOL KeepAll(char *record, void *data)
+   --------------------------------------
+*//**
+
+   \param[in]  *record   ATOM or HETATM record
+   \param[in]  *data     Unused
+   \return               TRUE
+
+   Record filter for -s
+
+-  19.10.26 Original    By: agent
+*/
+BOOL KeepAll(char *record, void *data)
+{
+   return(TRUE);
+}
@@ -3,8 +3,8 @@
 
    \file       pdbatomselect.c
    
-   \version    V2.1
-   \date       13.03.19
+   \version    V2.5
+   \date       19.10.26
    \brief      Select atoms from a PDB file. Acts as filter
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2019
@@ -59,6 +59,13 @@
                   if called with that name. Otherwise now expects
                   -atoms X,Y,Z and takes -h for help
 -  V2.1  13.03.19 Terminate string ofter strncpy()
+-  V2.2  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V2.3  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V2.4  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V2.5  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -75,6 +82,10 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -132,11 +143,12 @@ int main(int argc, char **argv)
    int      nSelected,
             parseResult;
 
+   btInitTiming(&argc, argv);
    
    parseResult = ParseCmdLine(argc, argv, &atoms, infile, outfile);
    if(!parseResult)
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          /* If no atoms specified, assume CA                            */
          if(atoms == NULL)
@@ -160,7 +172,7 @@ list.\n");
          FREELIST(atoms, ATOMTYPE);
 
          /* Read in the PDB file                                        */
-         if((wpdb=blReadWholePDB(in))!=NULL)
+         if((wpdb=btReadWholePDB(in))!=NULL)
          {
             PDB *pdb = NULL;
             int natoms;
@@ -171,7 +183,7 @@ list.\n");
             wpdb->pdb    = pdb;
             wpdb->natoms = natoms;
 
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -252,7 +264,7 @@ void Usage(int style)
 {
    if(style == STYLE_PDBATOMSEL)
    {
-      fprintf(stderr,"\npdbatomsel V2.1 (c) 1994-2019, Andrew C.R. \
+      fprintf(stderr,"\npdbatomsel V2.5 (c) 1994-2019, Andrew C.R. \
 Martin, UCL\n");
 
       fprintf(stderr,"\n*** USE pdbatomselect INSTEAD. THIS FORM IS \
@@ -271,7 +283,7 @@ PDBML output\n\n");
    }
    else
    {
-      fprintf(stderr,"\npdbatomselect V2.1 (c) 1994-2019, Andrew C.R. \
+      fprintf(stderr,"\npdbatomselect V2.5 (c) 1994-2019, Andrew C.R. \
 Martin, UCL\n");
       fprintf(stderr,"Usage: pdbatomselect [-a atom,atom,atom[,...]] \
 [in.pdb [out.pdb]]\n");
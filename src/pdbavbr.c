@@ -3,8 +3,8 @@
 
    \file       pdbavbr.c
    
-   \version    V1.4
-   \date       25.06.15
+   \version    V1.8
+   \date       19.10.26
    \brief      Calc means and SDs of BValues by residue type
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
@@ -52,6 +52,14 @@
 -  V1.2  06.11.14 Renamed from avbr  By: ACRM
 -  V1.3  12.02.15 Some minor fixes and more usage info
 -  V1.4  25.06.15 Only prints bars for observed residues
+-  V1.5  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.6  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.8  19.10.26 The barchart bins are kept at file scope and freed on
+                  entry so it can run more than once in a bioptools
+                  pipeline
 
 *************************************************************************/
 /* Includes
@@ -66,6 +74,9 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/MathUtil.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -83,6 +94,7 @@ static char *sTypes[] =
    "THR ", "VAL ", "TRP ", "TYR ", "UNK ", "GLX ", "ASX ", "PCA ",
    NULL
 } ;
+static int *sBins = NULL;
 
 /************************************************************************/
 /* Prototypes
@@ -109,6 +121,7 @@ BOOL DoBarsForRes(FILE *out, PDB *pdb, char *resnam, BOOL FindMax,
 -  07.10.94 Original    By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  12.02.15 WholePDB support  By: ACRM
+-  19.10.26 Frees the bins from a previous run   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -123,12 +136,19 @@ int main(int argc, char **argv)
    BOOL     FindMax   = TRUE,
             Normalise = FALSE;
    
+   btInitTiming(&argc, argv);
+
+   /* Free the bins as this may be run more than once in a pipeline
+      with a different number of bins
+   */
+   FREE(sBins);
+
    if(ParseCmdLine(argc, argv, InFile, OutFile, &FindMax, &MaxVal, 
                    &Normalise, &NBin))
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
-         if((pdb = blReadPDBAtoms(in, &natoms)) != NULL)
+         if((pdb = btReadPDBAtoms(in, &natoms)) != NULL)
          {
             DoMeanSD(out, pdb);
             if(!DoBarchart(out, pdb, FindMax, MaxVal, Normalise, NBin))
@@ -169,10 +189,11 @@ int main(int argc, char **argv)
 -  06.11.14 V1.2 By: ACRM
 -  12.02.15 V1.3 By: ACRM
 -  25.06.15 V1.4 By: ACRM
+-  19.10.26 V1.8 By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbavbr V1.4 (c) 1994-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbavbr V1.8 (c) 1994-2015, Dr. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbavbr [-n] [-m maxval] [-b nbin] [in.pdb \
 [output.txt]]\n");
@@ -366,12 +387,11 @@ BOOL DoBarsForRes(FILE *out, PDB *pdb, char *resnam, BOOL FindMax,
    PDB *p;
    int  nvalues = 0,
         i;
-   static int *bins = NULL;
 
-   if(bins==NULL)
+   if(sBins==NULL)
    {
       /* Allocate memory for bins                                       */
-      if((bins = (int *)malloc(NBin * sizeof(int)))==NULL)
+      if((sBins = (int *)malloc(NBin * sizeof(int)))==NULL)
       {
          fprintf(stderr,"abvr: No memory for barchart bins\n");
          return(FALSE);
@@ -380,7 +400,7 @@ BOOL DoBarsForRes(FILE *out, PDB *pdb, char *resnam, BOOL FindMax,
    
    /* Zero the bins                                                     */
    for(i=0; i<NBin; i++)
-      bins[i] = 0;
+      sBins[i] = 0;
    
    if(FindMax)
    {
@@ -402,7 +422,7 @@ BOOL DoBarsForRes(FILE *out, PDB *pdb, char *resnam, BOOL FindMax,
          i = (int)(NBin * p->bval / MaxVal);
          if(i==NBin) i--;
          
-         (bins[i])++;
+         (sBins[i])++;
          nvalues++;
       }
    }
@@ -414,9 +434,9 @@ BOOL DoBarsForRes(FILE *out, PDB *pdb, char *resnam, BOOL FindMax,
       for(i=0; i<NBin; i++)
       {
          if(Normalise)
-            fprintf(out,"%5.4f ",(REAL)bins[i]/(REAL)nvalues);
+            fprintf(out,"%5.4f ",(REAL)sBins[i]/(REAL)nvalues);
          else
-            fprintf(out,"%5d ",bins[i]);
+            fprintf(out,"%5d ",sBins[i]);
       }
       fprintf(out,"\n");
    }
@@ -3,8 +3,8 @@
 
    \file       pdbcalcrms.c
    
-   \version    V1.3
-   \date       06.11.14
+   \version    V1.5
+   \date       19.10.26
    \brief      Calculate RMS between 2 PDB files. Does no fitting.
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2014
@@ -52,6 +52,9 @@
 -  V1.2  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() and 
                   blStripHPDBAsCopy By: CTP
 -  V1.3  06.11.14 Renamed from rmspdb
+-  V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.5  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -63,6 +66,8 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -110,6 +115,8 @@ int main(int argc, char **argv)
    PDB  *pdb1,
         *pdb2;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, file1, file2, &atoms))
    {
       /* Open the two PDB files                                         */
@@ -125,12 +132,12 @@ int main(int argc, char **argv)
       }
       
       /* Read the two PDB files                                         */
-      if((pdb1 = blReadPDB(fp1,&natoms))==NULL)
+      if((pdb1 = btReadPDB(fp1,&natoms))==NULL)
       {
          fprintf(stderr,"No atoms read from file: %s\n",file1);
          return(1);
       }
-      if((pdb2 = blReadPDB(fp2,&natoms))==NULL)
+      if((pdb2 = btReadPDB(fp2,&natoms))==NULL)
       {
          fprintf(stderr,"No atoms read from file: %s\n",file2);
          return(1);
@@ -347,7 +354,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *file1, char *file2,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcalcrms V1.3 (c) 1994-2014, Andrew C.R. \
+   fprintf(stderr,"\npdbcalcrms V1.5 (c) 1994-2014, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbcalcrms [-h] [-c] [-b] [-m] <in1.pdb> \
 <in2.pdb>\n");
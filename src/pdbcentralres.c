@@ -3,8 +3,8 @@
 
    \file       pdbcentralres.c
    
-   \version    V1.4
-   \date       12.03.15
+   \version    V1.7
+   \date       19.10.26
    \brief      Find the residue nearest the centroid of a protein
    
    \copyright  (c) Dr. Andrew C. R. Martin 2012-2015
@@ -52,6 +52,11 @@
 -  V1.2  06.11.14 Renamed as pdbcentralres By: ACRM
 -  V1.3  07.11.14 Initialized a variable
 -  V1.4  12.03.15 Changed to allow multi-character chain names
+-  V1.5  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.6  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -61,6 +66,9 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -99,11 +107,13 @@ int main(int argc, char **argv)
    PDB  *pdb;
    int  natoms;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDB(in,&natoms)) != NULL)
+         if((pdb = btReadPDB(in,&natoms)) != NULL)
          {
             VEC3F cg;
             PDB   *p, *closest = NULL;
@@ -213,7 +223,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcentralres V1.4 (c) 2012-2015 UCL, \
+   fprintf(stderr,"\npdbcentralres V1.7 (c) 2012-2015 UCL, \
 Dr. Andrew C.R. Martin\n");
    fprintf(stderr,"\nUsage: pdbcentralres [in.pdb [out.pdb]]\n");
 
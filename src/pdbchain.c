@@ -3,8 +3,8 @@
 
    \file       pdbchain.c
    
-   \version    V2.3
-   \date       09.08.19
+   \version    V2.7
+   \date       19.10.26
    \brief      Insert chain labels into a PDB file
    
    \copyright  (c) UCL, Prof. Andrew C. R. Martin 1994-2019
@@ -71,6 +71,13 @@
                   called as chainpdb
 -  V2.2  28.01.18 Increased MAXCHAINLABEL from 8 to 16
 -  V2.3  09.08.19 Added -v flag
+-  V2.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V2.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V2.6  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V2.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -87,6 +94,10 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -137,13 +148,14 @@ int main(int argc, char **argv)
                                         residue                         */
    BOOL     verbose = FALSE;         /* Flag to print CA-CA distances   */
 
+   btInitTiming(&argc, argv);
 
    if(ParseCmdLine(argc, argv, infile, outfile, &chains, &BumpChainOnHet,
                    &verbose))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))==NULL)
+         if((wpdb=btReadWholePDB(in))==NULL)
          {
             fprintf(stderr,"No atoms read from input file\n");
          }
@@ -151,7 +163,7 @@ int main(int argc, char **argv)
          {
             pdb = wpdb->pdb;
             DoChain(pdb, chains, BumpChainOnHet, verbose);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
       }
       else
@@ -299,7 +311,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbchain V2.3 (c) 1994-2019 Prof. Andrew C.R. \
+   fprintf(stderr,"\npdbchain V2.7 (c) 1994-2019 Prof. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbchain [-c chain[,chain[...]]][-b][-v] \
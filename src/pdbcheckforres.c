@@ -3,8 +3,8 @@
 
    \file       pdbcheckforres.c
    
-   \version    V1.5
-   \date       10.03.15
+   \version    V1.9
+   \date       19.10.26
    \brief      Checks whether a specified residue exists in a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 2011-2015
@@ -36,6 +36,11 @@
 
    Description:
    ============
+   With -s or -b, the residues asked for are placed in a hash and the
+   file is streamed, looking up each residue as it is read. Reading
+   stops as soon as every residue has been found. Binary PDB, PDBML and
+   input from an in-process pipeline are read as a whole and the same
+   lookup is made on each residue of the list.
 
 **************************************************************************
 
@@ -56,18 +61,49 @@
 -  V1.4   06.11.14  Renamed from checkforres
 -  V1.5   10.03.15  Removed -l option as we no longer support upcasing
                     chain labels
+-  V1.6   19.10.26  Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c   By: agent
+-  V1.7   19.10.26  Opens files with btOpenStdFiles() so compressed
+                    input and output are handled in-process
+-  V1.8   19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
+-  V1.9   19.10.26  Added -s to stop reading once the residue is found
+                    and -b to check a list of residues in one pass
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "bioplib/hash.h"
+#include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/pdbstream.h"
+#include "common/pdbfilter.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
+#define MAXKEY  32
+
+typedef struct
+{
+   HASHTABLE *hash;         /* Residue key to number of the key         */
+   BOOL      *found;        /* Has the residue with each key been seen? */
+   int       nkeys,
+             nfound,
+             natoms,
+             lastResnum;
+   char      lastChain[blMAXCHAINLABEL],
+             lastInsert;
+   BOOL      gotLast;
+}  QUERYSET;
 
 /************************************************************************/
 /* Globals
@@ -78,8 +114,18 @@
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *resid,
-                  char *infile, char *outfile, BOOL *readHet);
+                  char *infile, char *outfile, BOOL *readHet,
+                  BOOL *stream, BOOL *batch);
 void Usage(void);
+int  DoQueries(FILE *in, FILE *out, char **resspecs, int nspecs,
+               BOOL readHet, BOOL batch);
+char **ReadResSpecs(char *filename, int *nspecs);
+BOOL BuildQuerySet(QUERYSET *set, char **resspecs, int nspecs,
+                   int *keyOf);
+void MakeResKey(char *key, char *chain, int resnum, char *insert);
+BOOL RunQueries(FILE *in, BOOL readHet, QUERYSET *set);
+BOOL CheckAtom(PDB *p, void *data);
+void CheckResidue(QUERYSET *set, PDB *p);
 
 
 /************************************************************************/
@@ -93,6 +139,7 @@ void Usage(void);
 -  29.09.05 Modified for -l By: TL
 -  28.08.13 Modified for new ParseResSpec()
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Added -s and -b   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -104,24 +151,43 @@ int main(int argc, char **argv)
         chain[8],
         insert[8];
    int  res,
-        natom;
+        natom,
+        nspecs;
    PDB  *pdb;
-   BOOL readHet;
+   BOOL readHet,
+        stream,
+        batch;
+   char **resspecs,
+        *residPtr = resid;
    
+   btInitTiming(&argc, argv);
 
-   if(ParseCmdLine(argc, argv, resid, InFile, OutFile, &readHet))
+   if(ParseCmdLine(argc, argv, resid, InFile, OutFile, &readHet,
+                   &stream, &batch))
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(batch)
+      {
+         if((resspecs = ReadResSpecs(resid, &nspecs)) == NULL)
+            return(1);
+         if(!btOpenStdFiles(InFile, OutFile, &in, &out))
+            return(1);
+         return(DoQueries(in, out, resspecs, nspecs, readHet, TRUE));
+      }
+
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
          BOOL ParseResSpecResult;
 
+         if(stream)
+            return(DoQueries(in, out, &residPtr, 1, readHet, FALSE));
+
          if(readHet)
          {
-            pdb=blReadPDB(in, &natom);
+            pdb=btReadPDB(in, &natom);
          }
          else
          {
-            pdb=blReadPDBAtoms(in, &natom);
+            pdb=btReadPDBAtoms(in, &natom);
          }
          
          if(pdb==NULL)
@@ -159,16 +225,19 @@ specification (%s)\n", resid);
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *resid,
-                     char *infile, char *outfile, BOOL *readHet)
+                     char *infile, char *outfile, BOOL *readHet,
+                     BOOL *stream, BOOL *batch)
    ----------------------------------------------------------------------
 *//**
 
    \param[in]      argc         Argument count
    \param[in]      **argv       Argument array
-   \param[out]     *resid       Residue specifier
+   \param[out]     *resid       Residue specifier (or file of them)
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
    \param[out]     *readHet     Should we read hetatoms (Default: no)
+   \param[out]     *stream      Stop reading once the residue is found
+   \param[out]     *batch       resid is a file of residue specifiers
    \param[out]     Success?
 
    Parse the command line
@@ -176,9 +245,11 @@ specification (%s)\n", resid);
 -  12.01.11 Original    By: ACRM
 -  07.03.12 Added -H and *readHet
 -  10.03.15 Removed -l support
+-  19.10.26 Added -s, -b, *stream and *batch   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *resid,
-                  char *infile, char *outfile, BOOL *readHet)
+                  char *infile, char *outfile, BOOL *readHet,
+                  BOOL *stream, BOOL *batch)
 {
    argc--;
    argv++;
@@ -186,6 +257,8 @@ BOOL ParseCmdLine(int argc, char **argv, char *resid,
    infile[0] = outfile[0] = '\0';
    resid[0]               = '\0';
    *readHet          = FALSE;
+   *stream           = FALSE;
+   *batch            = FALSE;
 
    if(!argc)               /* 05.11.07 Added this                       */
    {
@@ -207,6 +280,12 @@ BOOL ParseCmdLine(int argc, char **argv, char *resid,
          case 'H':
             *readHet = TRUE;
             break;
+         case 's':
+            *stream  = TRUE;
+            break;
+         case 'b':
+            *batch   = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -262,17 +341,388 @@ BOOL ParseCmdLine(int argc, char **argv, char *resid,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcheckforres V1.5 (c) 2011-2015, UCL, Dr. \
+   fprintf(stderr,"\npdbcheckforres V1.9 (c) 2011-2015, UCL, Dr. \
 Andrew C.R. Martin\n");
-   fprintf(stderr,"Usage: pdbcheckforres [-H] resspec [in.pdb \
+   fprintf(stderr,"Usage: pdbcheckforres [-H] [-s] resspec [in.pdb \
+[out.txt]]\n");
+   fprintf(stderr,"       pdbcheckforres [-H] -b resspecs.txt [in.pdb \
 [out.txt]]\n");
    fprintf(stderr,"       -H  Read HETATM records = i.e. allow residues \
 that are HETATMs only\n");
+   fprintf(stderr,"       -s  Stop reading the file as soon as the \
+residue is found\n");
+   fprintf(stderr,"       -b  Check each of the residues listed (one \
+per line) in a file\n");
 
    fprintf(stderr,"\nChecks whether a specified residue exists in a PDB \
-file.\n\n");
+file.\n");
+   fprintf(stderr,"With -b, each residue specification is printed \
+followed by YES or NO\n");
+   fprintf(stderr,"(or ERROR if it is not valid). All the residues are \
+checked in a single\n");
+   fprintf(stderr,"pass which, as with -s, stops once they have all \
+been found.\n\n");
    blPrintResSpecHelp(stderr);
-   fprintf(stderr,"\nThe -l option is deprecated from V1.5 - chain \
+   fprintf(stderr,"\nThe -l option is deprecated from V1.8 - chain \
 labels are never upcased\n\n");
 
 }
+
+
+/************************************************************************/
+/*>int DoQueries(FILE *in, FILE *out, char **resspecs, int nspecs,
+                 BOOL readHet, BOOL batch)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]      *in          Input PDB file
+   \param[in]      *out         Output file
+   \param[in]      **resspecs   Residue specifications
+   \param[in]      nspecs       Number of residue specifications
+   \param[in]      readHet      Read HETATM records
+   \param[in]      batch        Print each residue spec with the answer
+   \return                      Exit status
+
+   Checks for all the residues in one pass of the file
+
+-  19.10.26 Original    By: agent
+*/
+int DoQueries(FILE *in, FILE *out, char **resspecs, int nspecs,
+              BOOL readHet, BOOL batch)
+{
+   QUERYSET set;
+   int      *keyOf,
+            i,
+            status = 0;
+
+   if((keyOf = (int *)malloc((nspecs+1) * sizeof(int))) == NULL)
+   {
+      fprintf(stderr,"pdbcheckforres: No memory for residue list\n");
+      return(1);
+   }
+   if(!BuildQuerySet(&set, resspecs, nspecs, keyOf))
+   {
+      fprintf(stderr,"pdbcheckforres: No memory for residue list\n");
+      free(keyOf);
+      return(1);
+   }
+
+   if(!batch && (keyOf[0] < 0))
+   {
+      fprintf(stderr,"pdbcheckforres: Illegal residue \
+specification (%s)\n", resspecs[0]);
+      status = 1;
+   }
+   else if(!RunQueries(in, readHet, &set))
+   {
+      status = 1;
+   }
+   else
+   {
+      for(i=0; i<nspecs; i++)
+      {
+         if(batch)
+            fprintf(out, "%s ", resspecs[i]);
+         if(keyOf[i] < 0)
+         {
+            fprintf(stderr,"pdbcheckforres: Illegal residue \
+specification (%s)\n", resspecs[i]);
+            fprintf(out, "ERROR\n");
+            status = 1;
+         }
+         else
+         {
+            fprintf(out, "%s\n", (set.found[keyOf[i]] ? "YES" : "NO"));
+         }
+      }
+   }
+
+   blFreeHash(set.hash);
+   free(set.found);
+   free(keyOf);
+   return(status);
+}
+
+
+/************************************************************************/
+/*>char **ReadResSpecs(char *filename, int *nspecs)
+   ------------------------------------------------
+*//**
+
+   \param[in]      *filename    File of residue specifications
+   \param[out]     *nspecs      Number of residue specifications
+   \return                      Array of residue specifications (NULL
+                                on error)
+
+   Reads residue specifications, one per line. Blank lines are skipped.
+
+-  19.10.26 Original    By: agent
+*/
+char **ReadResSpecs(char *filename, int *nspecs)
+{
+   FILE *fp;
+   char buffer[MAXBUFF],
+        **resspecs = NULL,
+        **newSpecs;
+   int  maxSpecs   = 0;
+
+   *nspecs = 0;
+   if((fp = fopen(filename, "r")) == NULL)
+   {
+      fprintf(stderr,"pdbcheckforres: Unable to open residue list: \
+%s\n", filename);
+      return(NULL);
+   }
+
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      TERMINATE(buffer);
+      KILLTRAILSPACES(buffer);
+      if(buffer[0] == '\0')
+         continue;
+
+      if(*nspecs == maxSpecs)
+      {
+         maxSpecs += 64;
+         if((newSpecs = (char **)realloc(resspecs, 
+                                         maxSpecs * sizeof(char *)))
+            == NULL)
+            break;
+         resspecs = newSpecs;
+      }
+      if((resspecs[*nspecs] = (char *)malloc(strlen(buffer)+1)) == NULL)
+         break;
+      strcpy(resspecs[(*nspecs)++], buffer);
+   }
+
+   if(!feof(fp))
+   {
+      fprintf(stderr,"pdbcheckforres: No memory for residue list\n");
+      fclose(fp);
+      return(NULL);
+   }
+   fclose(fp);
+
+   if(*nspecs == 0)
+   {
+      fprintf(stderr,"pdbcheckforres: No residues in residue list: \
+%s\n", filename);
+      return(NULL);
+   }
+   return(resspecs);
+}
+
+
+/************************************************************************/
+/*>BOOL BuildQuerySet(QUERYSET *set, char **resspecs, int nspecs,
+                      int *keyOf)
+   -------------------------------------------------------------
+*//**
+
+   \param[out]     *set         Query set
+   \param[in]      **resspecs   Residue specifications
+   \param[in]      nspecs       Number of residue specifications
+   \param[out]     *keyOf       Number of the key for each residue
+                                specification (-1 if not valid)
+   \return                      Success?
+
+   Places the residues in a hash. A residue asked for more than once
+   has one key.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL BuildQuerySet(QUERYSET *set, char **resspecs, int nspecs,
+                   int *keyOf)
+{
+   char key[MAXKEY],
+        chain[blMAXCHAINLABEL],
+        insert[8];
+   int  resnum,
+        i;
+
+   set->nkeys   = 0;
+   set->nfound  = 0;
+   set->natoms  = 0;
+   set->gotLast = FALSE;
+   set->hash    = blInitializeHash((ULONG)(2*nspecs+1));
+   set->found   = (BOOL *)calloc(nspecs+1, sizeof(BOOL));
+   if((set->hash == NULL) || (set->found == NULL))
+   {
+      if(set->hash != NULL)
+         blFreeHash(set->hash);
+      FREE(set->found);
+      return(FALSE);
+   }
+
+   for(i=0; i<nspecs; i++)
+   {
+      keyOf[i] = -1;
+      if((strlen(resspecs[i]) >= MAXBUFF) ||
+         !blParseResSpec(resspecs[i], chain, &resnum, insert))
+         continue;
+
+      MakeResKey(key, chain, resnum, insert);
+      if(blHashKeyDefined(set->hash, key))
+      {
+         keyOf[i] = blGetHashValueInt(set->hash, key);
+      }
+      else
+      {
+         if(!blSetHashValueInt(set->hash, key, set->nkeys))
+         {
+            blFreeHash(set->hash);
+            free(set->found);
+            return(FALSE);
+         }
+         keyOf[i] = set->nkeys++;
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void MakeResKey(char *key, char *chain, int resnum, char *insert)
+   -----------------------------------------------------------------
+*//**
+
+   \param[out]     *key         Hash key (MAXKEY)
+   \param[in]      *chain       Chain label
+   \param[in]      resnum       Residue number
+   \param[in]      *insert      Insert code
+
+   Blank and missing insert codes are treated as the same, as in
+   common/resindex.c
+
+-  19.10.26 Original    By: agent
+*/
+void MakeResKey(char *key, char *chain, int resnum, char *insert)
+{
+   sprintf(key, "%.8s|%d|%c", chain, resnum,
+           ((insert[0]=='\0') ? ' ' : insert[0]));
+}
+
+
+/************************************************************************/
+/*>BOOL RunQueries(FILE *in, BOOL readHet, QUERYSET *set)
+   ------------------------------------------------------
+*//**
+
+   \param[in]      *in          Input PDB file
+   \param[in]      readHet      Read HETATM records
+   \param[in,out]  *set         Query set
+   \return                      Were any atoms read?
+
+   Streams the file through CheckAtom() if it is a text PDB file.
+   Otherwise reads it as normal and checks each atom of the list.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL RunQueries(FILE *in, BOOL readHet, QUERYSET *set)
+{
+   PDB  *pdb,
+        *p;
+   int  natom;
+   BOOL ok = TRUE;
+
+   if((set->nkeys == 0) || !btCanFilterPDB(in))
+   {
+      if(readHet)
+         pdb = btReadPDB(in, &natom);
+      else
+         pdb = btReadPDBAtoms(in, &natom);
+
+      for(p=pdb; (p!=NULL) && (set->nfound < set->nkeys); NEXT(p))
+         CheckResidue(set, p);
+      if(pdb != NULL)
+         set->natoms = natom;
+      FREELIST(pdb, PDB);
+   }
+   else
+   {
+      ok = btStreamPDB(in, !readHet, NULL, CheckAtom, (void *)set) ||
+           (set->nfound == set->nkeys);
+   }
+
+   if(!ok)
+   {
+      fprintf(stderr,"pdbcheckforres: No memory to read PDB file\n");
+      return(FALSE);
+   }
+   if(set->natoms == 0)
+   {
+      fprintf(stderr,"pdbcheckforres: No atoms read from PDB \
+file\n");
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL CheckAtom(PDB *p, void *data)
+   ----------------------------------
+*//**
+
+   \param[in]      *p           Atom from btStreamPDB()
+   \param[in,out]  *data        Query set
+   \return                      Carry on reading?
+
+   Streaming callback. Stops the read once all the residues have been
+   found.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL CheckAtom(PDB *p, void *data)
+{
+   QUERYSET *set = (QUERYSET *)data;
+
+   CheckResidue(set, p);
+   (set->natoms)++;
+   free(p);
+
+   return(set->nfound < set->nkeys);
+}
+
+
+/************************************************************************/
+/*>void CheckResidue(QUERYSET *set, PDB *p)
+   ----------------------------------------
+*//**
+
+   \param[in,out]  *set         Query set
+   \param[in]      *p           Atom
+
+   Looks up the residue of the atom if it differs from that of the
+   previous atom
+
+-  19.10.26 Original    By: agent
+*/
+void CheckResidue(QUERYSET *set, PDB *p)
+{
+   char key[MAXKEY];
+   int  keyNum;
+
+   if(set->gotLast && (p->resnum == set->lastResnum) &&
+      (p->insert[0] == set->lastInsert) &&
+      CHAINMATCH(p->chain, set->lastChain))
+      return;
+
+   set->gotLast    = TRUE;
+   set->lastResnum = p->resnum;
+   set->lastInsert = p->insert[0];
+   strncpy(set->lastChain, p->chain, blMAXCHAINLABEL-1);
+   set->lastChain[blMAXCHAINLABEL-1] = '\0';
+
+   MakeResKey(key, p->chain, p->resnum, p->insert);
+   if(blHashKeyDefined(set->hash, key))
+   {
+      keyNum = blGetHashValueInt(set->hash, key);
+      if(!set->found[keyNum])
+      {
+         set->found[keyNum] = TRUE;
+         (set->nfound)++;
+      }
+   }
+}
@@ -3,8 +3,8 @@
 
    \file       pdbconect.c
    
-   \version    V1.0
-   \date       26.02.15
+   \version    V1.7
+   \date       19.10.26
    \brief      Rebuild CONECT records for a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 2015
@@ -36,6 +36,23 @@
 
    Description:
    ============
+   Rebuilds the CONECT data from covalent radii. Rather than testing
+   every pair of atoms (as blBuildConectData() does), the atoms are
+   binned into a spatial grid whose cell edge is the longest possible
+   bond length (the largest covalent radius present doubled, plus the
+   tolerance). blIsBonded() is then only called for atoms in the
+   neighbouring cells. Bonds are added in the same order as the
+   all-pairs scan so the output is identical.
+
+   BiopLib does not make its covalent radii available, so the grid is
+   only used between atoms of the common organic elements (H, D, C, N,
+   O, S). For these, the radius used for the cell size is no smaller
+   than in any of the usual tables (Cordero et al., Dalton Trans.
+   (2008) 2832-2838; the CSD; Pyykko & Atsumi, Chem. Eur. J. (2009)
+   186-197) and a margin is added. Any other atom (metals, phosphorus,
+   halogens, blank elements...) is tested against every other atom as
+   in blBuildConectData(). blIsBonded() makes the final decision for
+   every pair.
 
 **************************************************************************
 
@@ -47,24 +64,65 @@
    Revision History:
    =================
 -  V1.0  26.02.15 Original
+-  V1.1  19.10.26 Uses a spatial grid rather than testing all pairs.
+                  Added -b to use blBuildConectData() instead   By: agent
+-  V1.2  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c
+-  V1.3  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.4  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.5  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.6  19.10.26 The grid cell size comes from a table of covalent 
+                  radii rather than probing blIsBonded() with copies
+                  of an atom
+-  V1.7  19.10.26 The grid is only used between atoms of the common
+                  organic elements; other atoms are tested against all
+                  atoms as BiopLib's radii for them are not known
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 #include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
 #include "bioplib/pdb.h"
+#include "common/spatial.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 256
 #define DEF_TOL 0.2
+#define COVRADMARGIN  0.10     /* Added to each radius from the table   */
+
+typedef struct
+{
+   char *element;
+   REAL radius;
+}  COVRAD;
 
 /************************************************************************/
 /* Globals
 */
+/* The elements for which the grid is used. Each radius is no smaller
+   than those of Cordero et al. (2008), the CSD and Pyykko & Atsumi
+   (2009). COVRADMARGIN is added to these.
+*/
+static COVRAD sCovalentRadii[] =
+{
+   {"H",  0.37}, {"D",  0.37}, {"C",  0.77}, {"N",  0.75},
+   {"O",  0.73}, {"S",  1.05},
+   {NULL, 0.0}
+};
 
 /************************************************************************/
 /* Prototypes
@@ -72,7 +130,11 @@
 int main(int argc, char **argv);
 void Usage(void);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
-                  REAL *tol);
+                  REAL *tol, BOOL *allPairs);
+BOOL BuildConectDataGrid(PDB *pdb, REAL tol);
+REAL MaxBondLength(PDB **atoms, int natoms, BOOL *onGrid, REAL tol);
+REAL CovalentRadius(char *element);
+int  CompareInts(const void *a, const void *b);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -82,6 +144,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    Main program
 
 -  26.02.15 Original    By: ACRM
+-  19.10.26 Uses BuildConectDataGrid() unless -b is given   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -90,16 +153,28 @@ int main(int argc, char **argv)
    WHOLEPDB *wpdb;
    char     infile[MAXBUFF],
             outfile[MAXBUFF];
-   REAL     tol = DEF_TOL;
+   REAL     tol      = DEF_TOL;
+   BOOL     allPairs = FALSE;
+
+   btInitTiming(&argc, argv);
 
-   if(ParseCmdLine(argc, argv, infile, outfile, &tol))
+   if(ParseCmdLine(argc, argv, infile, outfile, &tol, &allPairs))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))!=NULL)
+         if((wpdb=btReadWholePDB(in))!=NULL)
          {
-            blBuildConectData(wpdb->pdb, tol);
-            blWriteWholePDB(out, wpdb);
+            if(allPairs)
+            {
+               blBuildConectData(wpdb->pdb, tol);
+            }
+            else if(!BuildConectDataGrid(wpdb->pdb, tol))
+            {
+               fprintf(stderr,"Warning: Not all CONECTs could be \
+stored\n");
+            }
+            
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -123,15 +198,19 @@ int main(int argc, char **argv)
 *//**
 
 -  26.02.15 Original    By: ACRM
+-  19.10.26 V1.1   By: agent
+-  19.10.26 V1.7
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbconect V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdbconect V1.7  (c) 2015-2026 UCL, Andrew C.R. \
 Martin\n");
-   fprintf(stderr,"Usage: pdbconect [-t x] [<input.pdb> \
+   fprintf(stderr,"Usage: pdbconect [-t x] [-b] [<input.pdb> \
 [<output.pdb>]]\n");
    fprintf(stderr,"       -t specify tolerance [Default: %.1f]\n", 
            DEF_TOL);
+   fprintf(stderr,"       -b use the (slower) all-pairs BiopLib \
+routine\n");
 
    fprintf(stderr,"\nGenerates CONECT records for a PDB file from the \
 covalent radii of the\n");
@@ -152,14 +231,16 @@ discarded first\n");
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
    \param[out]     *tol         Covalent bond tolerance
+   \param[out]     *allPairs    Use blBuildConectData()
    \return                      Success?
 
    Parse the command line
    
 -  26.02.15 Original    By: ACRM
+-  19.10.26 Added -b   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  REAL *tol)
+                  REAL *tol, BOOL *allPairs)
 {
    argc--;
    argv++;
@@ -182,6 +263,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   return(FALSE);
             }
             break;
+         case 'b':
+            *allPairs = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -211,3 +295,219 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    return(TRUE);
 }
 
+
+/************************************************************************/
+/*>BOOL BuildConectDataGrid(PDB *pdb, REAL tol)
+   --------------------------------------------
+*//**
+
+   \param[in,out]  *pdb     PDB linked list
+   \param[in]      tol      Covalent bond tolerance
+   \return                  Success (FALSE if an atom had too many
+                            CONECTs or we ran out of memory)
+
+   Equivalent of blBuildConectData() using a spatial grid. Existing
+   CONECT data are discarded. The grid gives the later atoms in range
+   of an atom when both are of an element in sCovalentRadii[]; any
+   other pair involving a later atom is always a candidate. The
+   candidates for each atom are sorted into file order before
+   blIsBonded() and blAddConect() are called so that the CONECTs are
+   stored in the same order as from an all-pairs scan.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Only uses the grid between atoms of the elements in 
+            sCovalentRadii[]
+*/
+BOOL BuildConectDataGrid(PDB *pdb, REAL tol)
+{
+   PDB         *p,
+               **atoms;
+   SPATIALGRID *grid;
+   GRIDQUERY   query;
+   REAL        maxBond,
+               maxBondSq;
+   BOOL        *onGrid;
+   int         natoms,
+               *others,
+               nothers = 0,
+               firstOther,
+               *candidates = NULL,
+               ncandidates,
+               i, j, k;
+   BOOL        retval = TRUE;
+
+   /* Discard existing CONECT data                                      */
+   for(p=pdb; p!=NULL; NEXT(p))
+      p->nConect = 0;
+
+   if((atoms = blIndexPDB(pdb, &natoms))==NULL)
+      return(FALSE);
+
+   /* Flag the atoms that the grid can be used for and list the rest in
+      file order
+   */
+   onGrid     = (BOOL *)malloc(natoms * sizeof(BOOL));
+   others     = (int *)malloc(natoms * sizeof(int));
+   candidates = (int *)malloc(natoms * sizeof(int));
+   if((onGrid == NULL) || (others == NULL) || (candidates == NULL))
+   {
+      FREE(onGrid);
+      FREE(others);
+      FREE(candidates);
+      free(atoms);
+      return(FALSE);
+   }
+   for(i=0; i<natoms; i++)
+   {
+      onGrid[i] = (CovalentRadius(atoms[i]->element) > 0.0);
+      if(!onGrid[i])
+         others[nothers++] = i;
+   }
+
+   maxBond   = MaxBondLength(atoms, natoms, onGrid, tol);
+   maxBondSq = maxBond * maxBond;
+   
+   if((grid = btBuildSpatialGrid(atoms, natoms, maxBond))==NULL)
+   {
+      free(onGrid);
+      free(others);
+      free(candidates);
+      free(atoms);
+      return(FALSE);
+   }
+
+   for(i=0, firstOther=0; i<natoms; i++)
+   {
+      ncandidates = 0;
+
+      /* Step past the other atoms that are not after this one         */
+      while((firstOther < nothers) && (others[firstOther] <= i))
+         firstOther++;
+
+      if(onGrid[i])
+      {
+         btStartGridQuery(&query, grid, atoms[i]->x, atoms[i]->y, 
+                          atoms[i]->z, maxBondSq);
+         while((j = btNextGridNeighbour(&query, NULL)) >= 0)
+         {
+            if((j > i) && onGrid[j])
+               candidates[ncandidates++] = j;
+         }
+         for(k=firstOther; k<nothers; k++)
+            candidates[ncandidates++] = others[k];
+
+         qsort(candidates, ncandidates, sizeof(int), CompareInts);
+      }
+      else
+      {
+         /* Every later atom, already in file order                     */
+         for(j=i+1; j<natoms; j++)
+            candidates[ncandidates++] = j;
+      }
+      
+      for(k=0; k<ncandidates; k++)
+      {
+         if(blIsBonded(atoms[i], atoms[candidates[k]], tol))
+         {
+            if(!blAddConect(atoms[i], atoms[candidates[k]]))
+               retval = FALSE;
+         }
+      }
+   }
+
+   free(candidates);
+   free(others);
+   free(onGrid);
+   btFreeSpatialGrid(grid);
+   free(atoms);
+   
+   return(retval);
+}
+
+
+/************************************************************************/
+/*>REAL MaxBondLength(PDB **atoms, int natoms, BOOL *onGrid, REAL tol)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]      **atoms  Array of atoms
+   \param[in]      natoms   Number of atoms
+   \param[in]      *onGrid  Flags for the atoms that use the grid
+   \param[in]      tol      Covalent bond tolerance
+   \return                  Longest bond possible between any two 
+                            atoms that use the grid
+
+   The longest bond between elements A and B is rA + rB + tol, which 
+   is never more than the longest A-A bond (2rA + tol) for the element
+   with the largest radius.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Uses CovalentRadius() rather than ElementBondLength()
+-  19.10.26 Only considers the atoms that use the grid
+*/
+REAL MaxBondLength(PDB **atoms, int natoms, BOOL *onGrid, REAL tol)
+{
+   REAL maxRadius = 0.0,
+        radius;
+   int  i;
+
+   for(i=0; i<natoms; i++)
+   {
+      if(onGrid[i] && 
+         ((radius = CovalentRadius(atoms[i]->element)) > maxRadius))
+         maxRadius = radius;
+   }
+
+   return(2.0 * maxRadius + tol);
+}
+
+
+/************************************************************************/
+/*>REAL CovalentRadius(char *element)
+   ----------------------------------
+*//**
+
+   \param[in]      *element  Element symbol (any case and spacing)
+   \return                   Covalent radius to allow for the element
+                             (0.0 if it is not in the table)
+
+   Looks the element up in sCovalentRadii[] and adds COVRADMARGIN.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Returns 0.0 for elements not in the table
+*/
+REAL CovalentRadius(char *element)
+{
+   char symbol[8];
+   int  i, j;
+
+   for(i=0, j=0; (element[i] != '\0') && (j < 7); i++)
+   {
+      if(!isspace((int)element[i]))
+         symbol[j++] = toupper((int)element[i]);
+   }
+   symbol[j] = '\0';
+
+   for(i=0; sCovalentRadii[i].element != NULL; i++)
+   {
+      if(!strcmp(sCovalentRadii[i].element, symbol))
+         return(sCovalentRadii[i].radius + COVRADMARGIN);
+   }
+
+   return(0.0);
+}
+
+
+/************************************************************************/
+/*>int CompareInts(const void *a, const void *b)
+   ---------------------------------------------
+*//**
+
+   qsort() comparison for integers
+
+-  19.10.26 Original    By: agent
+*/
+int CompareInts(const void *a, const void *b)
+{
+   return(*(const int *)a - *(const int *)b);
+}
@@ -3,8 +3,8 @@
 
    \file       pdbcount.c
    
-   \version    V1.5
-   \date       12.03.15
+   \version    V1.9
+   \date       19.10.26
    \brief      Count residues and atoms in a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
@@ -36,6 +36,15 @@
 
    Description:
    ============
+   With -s (or -l), the counts are taken directly from the text of the
+   file without building the PDB linked list. A large file is mapped
+   into memory and split into chunks which are counted in parallel;
+   the splits are placed between residues so that alternate positions
+   are resolved within a chunk, and the chain and residue counts are
+   corrected where a chain runs across a split. With -l the input is a
+   list of files which are shared out between the threads. Files that
+   cannot be mapped (compressed files, binary PDB, PDBML and pipes) are
+   read as normal.
 
 **************************************************************************
 
@@ -53,24 +62,81 @@
                   Added doxygen annotation. By: CTP
 -  V1.4  06.11.14 Renamed from countpdb  By: ACRM
 -  V1.5  12.03.15 Changed to allow multi-character chain names
+-  V1.6  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.7  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.8  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.9  19.10.26 Added -s to count from the text of the file in
+                  parallel and -l to count a list of files with a pool
+                  of threads
 
 *************************************************************************/
 /* Includes
 */
+#define _POSIX_C_SOURCE 200112L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include "bioplib/macros.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/workpool.h"
 
 /************************************************************************/
 /* Defines and macros
 */
-#define MAXBUFF 160
+#define MAXBUFF         160
+#define MAXSCANCOL      60     /* Columns of a record used by the scan */
+#define RESKEYCOL       17     /* Residue name, chain, number, insert  */
+#define RESKEYLEN       10
+#define MINCHUNK        (4L * 1024L * 1024L)
+#define CHUNKSPERTHREAD 4      /* Spare chunks to balance the threads  */
+
+#define SCAN_OK         0
+#define SCAN_FALLBACK   1      /* Read the file with btReadPDB()       */
+#define SCAN_ERROR      2
+
+#define ISCOORD(l, len) ((len) >= 6 &&                                  \
+                         (!strncmp((l), "ATOM  ", 6) ||                 \
+                          !strncmp((l), "HETATM", 6)))
+
+typedef struct
+{
+   int nchain, nres, natom, nhyd, nhet;
+}  COUNTS;
+
+typedef struct
+{
+   char   *start,
+          *end;
+   COUNTS counts;
+   int    firstRes,        /* First and last atoms counted, to join    */
+          lastRes;         /* this chunk onto the previous one         */
+   char   firstChain,
+          lastChain,
+          firstIns,
+          lastIns;
+   BOOL   gotAtom,
+          firstIsAtom,
+          endModel;        /* Chunk stopped at the end of model 1      */
+}  CHUNK;
+
+typedef struct
+{
+   char   *filename;
+   COUNTS counts;
+   int    status;
+}  FILEJOB;
 
 /************************************************************************/
 /* Globals
@@ -80,10 +146,23 @@
 /* Prototypes
 */
 int  main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *scan, BOOL *fileList, int *nthreads);
 void Usage(void);
 void DoCount(PDB *pdb, int *nchain, int *nres, int *natom, int *nhyd,
              int *nhet);
+BOOL CountPDB(FILE *in, COUNTS *counts);
+void PrintCounts(FILE *out, char *filename, COUNTS *counts);
+BOOL CountFileList(FILE *in, FILE *out, int nthreads);
+char **ReadFileList(FILE *in, int *nfiles);
+void CountListItem(int item, void *data);
+int  ScanFile(FILE *fp, int nthreads, COUNTS *counts);
+int  PlanChunks(char *data, size_t size, int nwanted, CHUNK *chunks);
+char *FindSplit(char *data, char *point, char *end);
+void ScanChunkItem(int item, void *data);
+void ScanChunk(CHUNK *chunk);
+void MergeChunks(CHUNK *chunks, int nchunks, COUNTS *counts);
+void GetResKey(char *line, int len, char *key);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -95,29 +174,50 @@ void DoCount(PDB *pdb, int *nchain, int *nres, int *natom, int *nhyd,
 -  16.08.94 Original    By: ACRM
 -  24.08.94 Changed to call OpenStdFiles()
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Added -s, -l and -t   By: agent
 */
 int main(int argc, char **argv)
 {
-   FILE *in  = stdin,
-        *out = stdout;
-   char infile[MAXBUFF],
-        outfile[MAXBUFF];
-   PDB  *pdb;
-   int  nchain, nres, natom, nhyd, nhet;
+   FILE   *in      = stdin,
+          *out     = stdout;
+   char   infile[MAXBUFF],
+          outfile[MAXBUFF];
+   BOOL   scan     = FALSE,
+          fileList = FALSE;
+   int    nthreads = btDefaultThreads(),
+          status   = SCAN_FALLBACK,
+          phase;
+   COUNTS counts;
         
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &scan, &fileList,
+                   &nthreads))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natom))==NULL)
+         if(fileList)
+            return(CountFileList(in, out, nthreads) ? 0 : 1);
+
+         if(scan)
+         {
+            phase  = btSetTimingPhase(BT_PHASE_READ);
+            status = ScanFile(in, nthreads, &counts);
+            btSetTimingPhase(phase);
+            if(status == SCAN_OK)
+               btAddCount("atoms_read",
+                          (long)(counts.natom + counts.nhet));
+         }
+
+         if(((status == SCAN_OK) &&
+             ((counts.natom + counts.nhet) == 0)) ||
+            ((status != SCAN_OK) && !CountPDB(in, &counts)))
          {
             fprintf(stderr,"No atoms read from input file\n");
          }
          else
          {
-            DoCount(pdb, &nchain, &nres, &natom, &nhyd, &nhet);
-            fprintf(out,"Chains: %d Residues: %d Atoms: %d Het Atoms: %d \
-Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
+            PrintCounts(out, NULL, &counts);
          }
       }
       else
@@ -136,7 +236,8 @@ Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
 }
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *scan, BOOL *fileList, int *nthreads)
    ----------------------------------------------------------------------
 *//**
 
@@ -144,13 +245,18 @@ Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
    \param[in]      **argv      Argument array
    \param[out]     *infile     Input filename (or blank string)
    \param[out]     *outfile    Output filename (or blank string)
+   \param[out]     *scan       Count from the text of the file
+   \param[out]     *fileList   Input is a list of files
+   \param[out]     *nthreads   Number of threads
    \return                     Success
 
    Parse the command line
 
 -  16.08.94 Original    By: ACRM
+-  19.10.26 Added -s, -l and -t   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *scan, BOOL *fileList, int *nthreads)
 {
    argc--;
    argv++;
@@ -163,6 +269,19 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       {
          switch(argv[0][1])
          {
+         case 's':
+            *scan = TRUE;
+            break;
+         case 'l':
+            *fileList = TRUE;
+            break;
+         case 't':
+            argc--;
+            argv++;
+            if(!argc || !sscanf(argv[0], "%d", nthreads) ||
+               (*nthreads < 1))
+               return(FALSE);
+            break;
          case 'h':
             return(FALSE);
             break;
@@ -209,12 +328,30 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcount V1.5 (c) 1994-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbcount V1.9 (c) 1994-2015 Dr. Andrew C.R. \
 Martin, UCL\n");
-   fprintf(stderr,"\nUsage: pdbcount [in.pdb [out.txt]]\n\n");
+   fprintf(stderr,"\nUsage: pdbcount [-s] [-t nthreads] [in.pdb \
+[out.txt]]\n");
+   fprintf(stderr,"       pdbcount -l [-t nthreads] [files.lst \
+[out.txt]]\n");
+   fprintf(stderr,"       -s  Count from the text of the file using \
+several threads\n");
+   fprintf(stderr,"       -l  Input is a list of PDB files, one per \
+line\n");
+   fprintf(stderr,"       -t  Number of threads (Default: number of \
+processors)\n\n");
    fprintf(stderr,"If files are not specified, stdin and stdout are \
 used.\n");
    fprintf(stderr,"Counts chains, residues & atoms in a PDB file.\n\n");
+   fprintf(stderr,"With -s, the file is scanned as text rather than \
+being read into memory\n");
+   fprintf(stderr,"as a structure. A large file is split into chunks \
+that are counted in\n");
+   fprintf(stderr,"parallel. With -l, the files in the list are \
+scanned in parallel and the\n");
+   fprintf(stderr,"counts for each file are printed after its name. \
+Compressed files, binary\n");
+   fprintf(stderr,"PDB and PDBML are read as normal.\n\n");
 }
 
 /************************************************************************/
@@ -280,3 +417,664 @@ void DoCount(PDB *pdb, int *nchain, int *nres, int *natom, int *nhyd,
       }
    }
 }
+
+
+/************************************************************************/
+/*>BOOL CountPDB(FILE *in, COUNTS *counts)
+   ---------------------------------------
+*//**
+
+   \param[in]      *in         Input file
+   \param[out]     *counts     Counts
+   \return                     Were any atoms read?
+
+   Reads the file into a PDB linked list and counts it with DoCount()
+
+-  19.10.26 Original    By: agent
+*/
+BOOL CountPDB(FILE *in, COUNTS *counts)
+{
+   PDB *pdb;
+   int natom;
+
+   if((pdb=btReadPDB(in, &natom))==NULL)
+      return(FALSE);
+
+   DoCount(pdb, &(counts->nchain), &(counts->nres), &(counts->natom),
+           &(counts->nhyd), &(counts->nhet));
+   FREELIST(pdb, PDB);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void PrintCounts(FILE *out, char *filename, COUNTS *counts)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]      *out        Output file
+   \param[in]      *filename   Name to print first (or NULL)
+   \param[in]      *counts     Counts
+
+   Prints the counts for a file
+
+-  19.10.26 Original    By: agent
+*/
+void PrintCounts(FILE *out, char *filename, COUNTS *counts)
+{
+   if(filename != NULL)
+      fprintf(out, "%s: ", filename);
+   fprintf(out,"Chains: %d Residues: %d Atoms: %d Het Atoms: %d \
+Total Hydrogens: %d\n", counts->nchain, counts->nres, counts->natom, 
+           counts->nhet, counts->nhyd);
+}
+
+
+/************************************************************************/
+/*>BOOL CountFileList(FILE *in, FILE *out, int nthreads)
+   -----------------------------------------------------
+*//**
+
+   \param[in]      *in         List of PDB files
+   \param[in]      *out        Output file
+   \param[in]      nthreads    Number of threads
+   \return                     Were all the files counted?
+
+   Scans the files in parallel, then reads any that could not be
+   scanned in this thread (BiopLib's readers are not thread safe) and
+   prints the counts in the order of the list.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL CountFileList(FILE *in, FILE *out, int nthreads)
+{
+   FILEJOB *jobs;
+   FILE    *fp;
+   char    **filenames;
+   int     nfiles, i,
+           phase;
+   long    natoms = 0;
+   BOOL    ok     = TRUE;
+
+   if((filenames = ReadFileList(in, &nfiles)) == NULL)
+   {
+      fprintf(stderr,"No memory for list of files\n");
+      return(FALSE);
+   }
+   if((jobs = (FILEJOB *)malloc((nfiles+1) * sizeof(FILEJOB))) == NULL)
+   {
+      fprintf(stderr,"No memory for list of files\n");
+      for(i=0; i<nfiles; i++)
+         free(filenames[i]);
+      free(filenames);
+      return(FALSE);
+   }
+   for(i=0; i<nfiles; i++)
+      jobs[i].filename = filenames[i];
+
+   phase = btSetTimingPhase(BT_PHASE_READ);
+   btRunWorkPool(nfiles, nthreads, CountListItem, jobs);
+
+   for(i=0; i<nfiles; i++)
+   {
+      if(jobs[i].status == SCAN_FALLBACK)
+      {
+         jobs[i].status = SCAN_ERROR;
+         if(btOpenStdFiles(jobs[i].filename, NULL, &fp, NULL))
+         {
+            if(!CountPDB(fp, &(jobs[i].counts)))
+               jobs[i].counts.natom = jobs[i].counts.nhet = 0;
+            jobs[i].status = SCAN_OK;
+            fclose(fp);
+         }
+      }
+   }
+   btSetTimingPhase(phase);
+
+   for(i=0; i<nfiles; i++)
+   {
+      if(jobs[i].status != SCAN_OK)
+      {
+         fprintf(stderr,"Unable to read file: %s\n", jobs[i].filename);
+         ok = FALSE;
+      }
+      else if((jobs[i].counts.natom + jobs[i].counts.nhet) == 0)
+      {
+         fprintf(stderr,"No atoms read from file: %s\n", 
+                 jobs[i].filename);
+         ok = FALSE;
+      }
+      else
+      {
+         PrintCounts(out, jobs[i].filename, &(jobs[i].counts));
+         natoms += jobs[i].counts.natom + jobs[i].counts.nhet;
+      }
+      free(jobs[i].filename);
+   }
+   btAddCount("atoms_read", natoms);
+
+   free(jobs);
+   free(filenames);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>char **ReadFileList(FILE *in, int *nfiles)
+   ------------------------------------------
+*//**
+
+   \param[in]      *in         List of files, one per line
+   \param[out]     *nfiles     Number of files
+   \return                     Array of filenames (NULL if no memory)
+
+   Blank lines are skipped.
+
+-  19.10.26 Original    By: agent
+*/
+char **ReadFileList(FILE *in, int *nfiles)
+{
+   char buffer[MAXBUFF],
+        **filenames = NULL,
+        **newNames;
+   int  maxFiles    = 0,
+        i;
+
+   *nfiles = 0;
+   while(fgets(buffer, MAXBUFF, in))
+   {
+      TERMINATE(buffer);
+      if(buffer[0] == '\0')
+         continue;
+
+      if(*nfiles == maxFiles)
+      {
+         maxFiles = maxFiles ? 2 * maxFiles : 64;
+         if((newNames = (char **)realloc(filenames, 
+                                         maxFiles * sizeof(char *)))
+            == NULL)
+            break;
+         filenames = newNames;
+      }
+      if((filenames[*nfiles] = (char *)malloc(strlen(buffer)+1)) == NULL)
+         break;
+      strcpy(filenames[(*nfiles)++], buffer);
+   }
+
+   if(!feof(in) || (filenames == NULL))
+   {
+      for(i=0; i<*nfiles; i++)
+         free(filenames[i]);
+      FREE(filenames);
+      if(feof(in))
+         filenames = (char **)malloc(sizeof(char *));
+   }
+   return(filenames);
+}
+
+
+/************************************************************************/
+/*>void CountListItem(int item, void *data)
+   ----------------------------------------
+*//**
+
+   \param[in]      item        Index of the file
+   \param[in,out]  *data       The FILEJOB array
+
+   Work pool function to scan one file of the list
+
+-  19.10.26 Original    By: agent
+*/
+void CountListItem(int item, void *data)
+{
+   FILEJOB *job = (FILEJOB *)data + item;
+   FILE    *fp;
+
+   if((fp = fopen(job->filename, "r")) == NULL)
+   {
+      job->status = SCAN_ERROR;
+   }
+   else
+   {
+      job->status = ScanFile(fp, 1, &(job->counts));
+      fclose(fp);
+   }
+}
+
+
+/************************************************************************/
+/*>int ScanFile(FILE *fp, int nthreads, COUNTS *counts)
+   ----------------------------------------------------
+*//**
+
+   \param[in]      *fp         Input file
+   \param[in]      nthreads    Number of threads
+   \param[out]     *counts     Counts
+   \return                     SCAN_OK or SCAN_FALLBACK if the file
+                               must be read with btReadPDB()
+
+   Maps the file into memory and counts it in chunks. Only a regular
+   file that has not been read from and starts with a printable
+   character other than '<' (i.e. not compressed, binary PDB or PDBML)
+   is scanned.
+
+-  19.10.26 Original    By: agent
+*/
+int ScanFile(FILE *fp, int nthreads, COUNTS *counts)
+{
+   struct stat sbuf;
+   CHUNK       *chunks;
+   char        *data;
+   size_t      size;
+   int         nwanted = 1,
+               nchunks;
+
+   if((fileno(fp) < 0) || fstat(fileno(fp), &sbuf) || 
+      !S_ISREG(sbuf.st_mode) || (ftell(fp) != 0L))
+      return(SCAN_FALLBACK);
+
+   size = (size_t)sbuf.st_size;
+   if(size == 0)
+   {
+      counts->nchain = counts->nres = counts->natom = 
+         counts->nhyd = counts->nhet = 0;
+      return(SCAN_OK);
+   }
+
+   if((data = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE,
+                           fileno(fp), 0)) == (char *)MAP_FAILED)
+      return(SCAN_FALLBACK);
+   if(!isprint((int)((unsigned char)data[0])) || (data[0] == ' ') ||
+      (data[0] == '<'))
+   {
+      munmap(data, size);
+      return(SCAN_FALLBACK);
+   }
+
+   if((nthreads > 1) && (size > 2 * MINCHUNK))
+   {
+      nwanted = nthreads * CHUNKSPERTHREAD;
+      if(size / MINCHUNK < (size_t)nwanted)
+         nwanted = (int)(size / MINCHUNK);
+   }
+   if((chunks = (CHUNK *)malloc(nwanted * sizeof(CHUNK))) == NULL)
+   {
+      munmap(data, size);
+      return(SCAN_FALLBACK);
+   }
+
+   nchunks = PlanChunks(data, size, nwanted, chunks);
+   btRunWorkPool(nchunks, nthreads, ScanChunkItem, chunks);
+   MergeChunks(chunks, nchunks, counts);
+
+   free(chunks);
+   munmap(data, size);
+   return(SCAN_OK);
+}
+
+
+/************************************************************************/
+/*>int PlanChunks(char *data, size_t size, int nwanted, CHUNK *chunks)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]      *data       Mapped file
+   \param[in]      size        Size of the file
+   \param[in]      nwanted     Number of chunks wanted
+   \param[out]     *chunks     Chunks (start and end set)
+   \return                     Number of chunks
+
+   Splits the file into roughly equal chunks at residue boundaries
+
+-  19.10.26 Original    By: agent
+*/
+int PlanChunks(char *data, size_t size, int nwanted, CHUNK *chunks)
+{
+   char *start = data,
+        *end   = data + size,
+        *split;
+   int  i,
+        nchunks = 0;
+
+   for(i=1; i<nwanted; i++)
+   {
+      split = FindSplit(data, data + (size / nwanted) * i, end);
+      if(split > start)
+      {
+         chunks[nchunks].start = start;
+         chunks[nchunks].end   = split;
+         nchunks++;
+         start = split;
+      }
+   }
+   chunks[nchunks].start = start;
+   chunks[nchunks].end   = end;
+
+   return(nchunks + 1);
+}
+
+
+/************************************************************************/
+/*>char *FindSplit(char *data, char *point, char *end)
+   ---------------------------------------------------
+*//**
+
+   \param[in]      *data       Start of the file
+   \param[in]      *point      Where we would like to split
+   \param[in]      *end        End of the file
+   \return                     Where to split
+
+   Moves on from point to the start of a line, then to the start of
+   the first coordinate record of the next residue. Since the atoms of
+   a residue are never split between chunks, alternate positions can
+   be resolved within a chunk.
+
+-  19.10.26 Original    By: agent
+*/
+char *FindSplit(char *data, char *point, char *end)
+{
+   char *line,
+        *next,
+        key[RESKEYLEN],
+        lastKey[RESKEYLEN];
+   int  len;
+   BOOL gotKey = FALSE;
+
+   if((point > data) && (point[-1] != '\n'))
+   {
+      if((point = (char *)memchr(point, '\n', end - point)) == NULL)
+         return(end);
+      point++;
+   }
+
+   for(line=point; line<end; line=next)
+   {
+      if((next = (char *)memchr(line, '\n', end - line)) == NULL)
+         next = end;
+      else
+         next++;
+      len = (int)(next - line);
+
+      if(ISCOORD(line, len))
+      {
+         GetResKey(line, len, key);
+         if(!gotKey)
+         {
+            memcpy(lastKey, key, RESKEYLEN);
+            gotKey = TRUE;
+         }
+         else if(memcmp(key, lastKey, RESKEYLEN))
+         {
+            return(line);
+         }
+      }
+   }
+
+   return(end);
+}
+
+
+/************************************************************************/
+/*>void ScanChunkItem(int item, void *data)
+   ----------------------------------------
+*//**
+
+   \param[in]      item        Index of the chunk
+   \param[in,out]  *data       The CHUNK array
+
+   Work pool function to count one chunk
+
+-  19.10.26 Original    By: agent
+*/
+void ScanChunkItem(int item, void *data)
+{
+   ScanChunk((CHUNK *)data + item);
+}
+
+
+/************************************************************************/
+/*>void ScanChunk(CHUNK *chunk)
+   ----------------------------
+*//**
+
+   \param[in,out]  *chunk      Chunk to count
+
+   Counts the coordinate records of a chunk following DoCount(). The
+   first atom is taken to start a new chain; MergeChunks() corrects
+   this using the last atom of the previous chunk. Only the first
+   model is counted and, where an atom has alternate positions, only
+   one is counted, as blReadPDB() keeps only one.
+
+-  19.10.26 Original    By: agent
+*/
+void ScanChunk(CHUNK *chunk)
+{
+   char   record[MAXSCANCOL+1],
+          atnambuff[8],
+          numbuff[8],
+          key[RESKEYLEN],
+          resKey[RESKEYLEN],
+          (*altNames)[4] = NULL,
+          (*newNames)[4],
+          *line,
+          *next,
+          *eol,
+          *atnam,
+          chain,
+          insert;
+   int    len, resnum, i,
+          nalt    = 0,
+          maxAlt  = 0;
+   BOOL   gotKey  = FALSE,
+          isAtom,
+          skip;
+   COUNTS *counts = &(chunk->counts);
+
+   counts->nchain = counts->nres = counts->natom = 
+      counts->nhyd = counts->nhet = 0;
+   chunk->gotAtom  = FALSE;
+   chunk->endModel = FALSE;
+   record[MAXSCANCOL] = '\0';
+
+   for(line=chunk->start; line<chunk->end; line=next)
+   {
+      if((next = (char *)memchr(line, '\n', chunk->end - line)) == NULL)
+         next = chunk->end;
+      else
+         next++;
+      len = (int)(next - line);
+
+      if((len >= 6) && !strncmp(line, "ENDMDL", 6))
+      {
+         chunk->endModel = TRUE;
+         break;
+      }
+      if(!ISCOORD(line, len))
+         continue;
+
+      /* Pad the columns we need with spaces                            */
+      if(len > MAXSCANCOL)
+         len = MAXSCANCOL;
+      memcpy(record, line, len);
+      memset(record + len, ' ', MAXSCANCOL - len);
+      if((eol = strchr(record, '\n')) != NULL)
+         *eol = ' ';
+
+      /* Atom name as BiopLib stores it                                 */
+      strncpy(atnambuff, record+12, 5);
+      atnambuff[5] = '\0';
+      strncpy(numbuff, record+54, 6);
+      numbuff[6] = '\0';
+      atnam = blFixAtomName(atnambuff, (REAL)atof(numbuff));
+      atnam[4] = '\0';
+
+      /* Skip repeated alternate positions of an atom in this residue.
+         The raw names are compared since the name stored by BiopLib
+         may take account of the alternate position
+      */
+      GetResKey(record, MAXSCANCOL, key);
+      if(!gotKey || memcmp(key, resKey, RESKEYLEN))
+      {
+         memcpy(resKey, key, RESKEYLEN);
+         gotKey = TRUE;
+         nalt   = 0;
+      }
+      if(record[16] != ' ')
+      {
+         for(i=0, skip=FALSE; i<nalt; i++)
+         {
+            if(!memcmp(altNames[i], record+12, 4))
+            {
+               skip = TRUE;
+               break;
+            }
+         }
+         if(skip)
+            continue;
+
+         if(nalt == maxAlt)
+         {
+            maxAlt += 16;
+            if((newNames = (char (*)[4])realloc(altNames,
+                                                maxAlt * 4)) == NULL)
+            {
+               maxAlt -= 16;
+               nalt    = 0;
+            }
+            else
+            {
+               altNames = newNames;
+            }
+         }
+         if(nalt < maxAlt)
+            memcpy(altNames[nalt++], record+12, 4);
+      }
+
+      isAtom = !strncmp(record, "ATOM  ", 6);
+      if(isAtom)
+         (counts->natom)++;
+      else
+         (counts->nhet)++;
+
+      if(atnam[0] == 'H') 
+         (counts->nhyd)++;
+
+      strncpy(numbuff, record+22, 4);
+      numbuff[4] = '\0';
+      resnum = atoi(numbuff);
+      chain  = record[21];
+      insert = record[26];
+
+      if(!chunk->gotAtom || (chain != chunk->lastChain))
+      {
+         if(!chunk->gotAtom)
+         {
+            chunk->gotAtom     = TRUE;
+            chunk->firstIsAtom = isAtom;
+            chunk->firstChain  = chain;
+            chunk->firstRes    = resnum;
+            chunk->firstIns    = insert;
+         }
+         if(isAtom)
+         {
+            (counts->nchain)++;
+            (counts->nres)++;
+         }
+         chunk->lastChain = chain;
+         chunk->lastRes   = resnum;
+         chunk->lastIns   = insert;
+      }
+      else if((insert != chunk->lastIns) ||
+              (resnum != chunk->lastRes))
+      {
+         if(isAtom)
+            (counts->nres)++;
+         chunk->lastRes   = resnum;
+         chunk->lastIns   = insert;
+      }
+   }
+
+   FREE(altNames);
+}
+
+
+/************************************************************************/
+/*>void MergeChunks(CHUNK *chunks, int nchunks, COUNTS *counts)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]      *chunks     Counted chunks
+   \param[in]      nchunks     Number of chunks
+   \param[out]     *counts     Counts for the file
+
+   Adds up the chunks. Where the first atom of a chunk is in the same
+   chain (or residue) as the last atom before it, the new chain (and
+   residue) that ScanChunk() counted is removed. The initial chain,
+   residue and insert are those used by DoCount(). Chunks after the
+   end of the first model are ignored.
+
+-  19.10.26 Original    By: agent
+*/
+void MergeChunks(CHUNK *chunks, int nchunks, COUNTS *counts)
+{
+   CHUNK *c;
+   char  lastChain = '-',
+         lastIns   = '-';
+   int   lastRes   = -999,
+         i;
+
+   counts->nchain = counts->nres = counts->natom = 
+      counts->nhyd = counts->nhet = 0;
+
+   for(i=0; i<nchunks; i++)
+   {
+      c = chunks + i;
+      counts->nchain += c->counts.nchain;
+      counts->nres   += c->counts.nres;
+      counts->natom  += c->counts.natom;
+      counts->nhyd   += c->counts.nhyd;
+      counts->nhet   += c->counts.nhet;
+
+      if(c->gotAtom)
+      {
+         if(c->firstIsAtom && (c->firstChain == lastChain))
+         {
+            (counts->nchain)--;
+            if((c->firstRes == lastRes) && (c->firstIns == lastIns))
+               (counts->nres)--;
+         }
+         lastChain = c->lastChain;
+         lastRes   = c->lastRes;
+         lastIns   = c->lastIns;
+      }
+
+      if(c->endModel)
+         break;
+   }
+}
+
+
+/************************************************************************/
+/*>void GetResKey(char *line, int len, char *key)
+   ----------------------------------------------
+*//**
+
+   \param[in]      *line       Coordinate record
+   \param[in]      len         Length of the record
+   \param[out]     *key        Residue name, chain, number and insert
+                               code columns (padded with spaces, not
+                               terminated)
+
+-  19.10.26 Original    By: agent
+*/
+void GetResKey(char *line, int len, char *key)
+{
+   int i;
+
+   for(i=0; i<RESKEYLEN; i++)
+   {
+      key[i] = ((RESKEYCOL + i < len) && 
+                (line[RESKEYCOL + i] != '\n') &&
+                (line[RESKEYCOL + i] != '\r')) ? line[RESKEYCOL + i] : ' ';
+   }
+}
@@ -3,8 +3,8 @@
 
    \file       pdbcter.c
    
-   \version    V1.2
-   \date       25.02.15
+   \version    V1.6
+   \date       19.10.26
    \brief      Set naming for c-terminal oxygens and generate
                coordinates if required.
    
@@ -52,6 +52,13 @@
                   Added doxygen annotation. By: CTP
 -  V1.2  25.02.15 Modified for new blRenumAtomsPDB()
                   Supports whole PDB
+-  V1.3  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.4  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.5  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.6  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -65,6 +72,10 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -107,18 +118,20 @@ int main(int argc, char **argv)
    PDB      *pdb;
    int      style = STYLE_STD;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &style))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
             
             blFixCterPDB(pdb, style);
             blRenumAtomsPDB(pdb, 1);
                
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -214,7 +227,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nPDBCTer V1.2 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\nPDBCTer V1.6 (c) 1994-2015, Andrew C.R. Martin, \
 UCL\n\n");
    fprintf(stderr,"Usage: pdbcter [-g] [-c] [in.pdb [out.pdb]]\n");
    fprintf(stderr,"               -g Gromos style C-terminii\n");
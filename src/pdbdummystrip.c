@@ -3,8 +3,8 @@
 
    \file       pdbdummystrip.c
    
-   \version    V1.3
-   \date       13.02.15
+   \version    V1.8
+   \date       19.10.26
    \brief      Strips atoms with NULL coordinates
    
    \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
@@ -52,6 +52,15 @@
 -  V1.2  06.11.14 Renamed from nullstrip. This replaces an older program
                   called pdbstrip.   By: ACRM
 -  V1.3  13.02.15 Added whole PDB support
+-  V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.6  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.8  19.10.26 Added -s to filter the file as a stream in constant
+                  memory
 
 *************************************************************************/
 /* Includes
@@ -65,6 +74,11 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -79,8 +93,10 @@
 /* Prototypes
 */
 int main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
 PDB *StripNulls(PDB *pdb);
+BOOL KeepNonNull(char *record, void *data);
 void Usage(void);
 
 /************************************************************************/
@@ -92,6 +108,7 @@ void Usage(void);
 
 -  03.11.96 Original    By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -101,16 +118,29 @@ int main(int argc, char **argv)
             outfile[MAXBUFF];
    WHOLEPDB *wpdb;
    PDB      *pdb;
+   int      natoms;
+   BOOL     stream = FALSE;
    
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         if(stream && btCanFilterPDB(in))
+         {
+            if(!btFilterPDB(in, out, FALSE, KeepNonNull, NULL, &natoms))
+            {
+               fprintf(stderr,"Error: Failed while filtering the PDB \
+file\n");
+               return(1);
+            }
+         }
+         else if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
             pdb = StripNulls(pdb);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -127,7 +157,8 @@ int main(int argc, char **argv)
 }
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *stream)
    ---------------------------------------------------------------------
 *//**
 
@@ -135,13 +166,16 @@ int main(int argc, char **argv)
    \param[in]      **argv       Argument array
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *stream      Filter the file as a stream
    \return                     Success?
 
    Parse the command line
    
 -  13.11.96 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
@@ -154,6 +188,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       {
          switch(argv[0][1])
          {
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -231,6 +268,27 @@ PDB *StripNulls(PDB *pdb)
    return(pdb);
 }
 
+/************************************************************************/
+/*>BOOL KeepNonNull(char *record, void *data)
+   ------------------------------------------
+*//**
+
+   \param[in]  *record   ATOM or HETATM record
+   \param[in]  *data     Unused
+   \return               Does the atom have real coordinates?
+
+   Record filter for -s
+
+-  19.10.26 Original   By: agent
+*/
+BOOL KeepNonNull(char *record, void *data)
+{
+   return(!((btRecordReal(record, 30, 8) == (REAL)9999.0) &&
+            (btRecordReal(record, 38, 8) == (REAL)9999.0) &&
+            (btRecordReal(record, 46, 8) == (REAL)9999.0)));
+}
+
+
 /************************************************************************/
 /*>void Usage(void)
    ----------------
@@ -245,12 +303,19 @@ PDB *StripNulls(PDB *pdb)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbdummystrip V1.3 (c) 1996-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbdummystrip V1.8 (c) 1996-2015, Dr. Andrew C.R. \
 Martin, UCL\n");
 
-   fprintf(stderr,"\nUsage: pdbdummystrip [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"\nUsage: pdbdummystrip [-s] [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"       -s Stream the file, copying the records that \
+are kept unchanged\n");
 
    fprintf(stderr,"\nRemoves atoms from a PDB file which have NULL \
 coordinates (i.e.\n");
    fprintf(stderr,"x = y = z = 9999.0)\n");
+   fprintf(stderr,"\nWith -s, memory use does not depend on the size of \
+the file. All models\n");
+   fprintf(stderr,"are filtered, the header and trailer are copied \
+verbatim and binary PDB\n");
+   fprintf(stderr,"or PDBML input is read as normal.\n\n");
 }
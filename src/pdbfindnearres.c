@@ -4,8 +4,8 @@
    Program:    pdbfindnearres
    \file       pdbfindnearres.c
    
-   \version    V1.0.2
-   \date       29.06.19       
+   \version    V1.5
+   \date       19.10.26       
    \brief      Finds residues of a specified type near to the given
                zones   
    
@@ -50,6 +50,19 @@
    V1.0   05.06.19  Original
    V1.0.1 18.06.19  Fixed buffer size for fussy compiler
    V1.0.2 19.06.19  Fully documented and default radius in help message
+   V1.1   19.10.26  Builds a residue table (centroid, bounding radius,
+                    zone membership and type) once. Candidate residues
+                    are found from a spatial grid of their centroids
+                    and rejected on bounding spheres before the atom
+                    pairs are checked   By: agent
+   V1.2   19.10.26  Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c
+   V1.3   19.10.26  Opens files with btOpenStdFiles() so compressed
+                    input and output are handled in-process
+   V1.4   19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
+   V1.5   19.10.26  Exits with status 1 if memory runs out while
+                    flagging residues
 
 *************************************************************************/
 /* Includes
@@ -60,6 +73,10 @@
 #include "bioplib/macros.h"
 #include "bioplib/pdb.h"
 #include "bioplib/array.h"
+#include "common/spatial.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 
 /************************************************************************/
@@ -86,6 +103,15 @@ do {  strncpy(a,b,c);  \
                         !strncmp((z)->atnam,"O   ",4))
 #define ISSIDECHAIN(z) !ISBACKBONE(z)
 
+typedef struct
+{
+   PDB  *start,
+        *stop;
+   REAL cx, cy, cz,         /* Centroid of all atoms                    */
+        radius;             /* Distance from centroid to furthest atom  */
+   BOOL inZone,
+        isType;
+}  RESINFO;
 
 
 /************************************************************************/
@@ -100,7 +126,9 @@ void WriteFlaggedAtoms(FILE *out, PDB *pdb);
 void ListFlaggedResidues(FILE *out, PDB *pdb);
 BOOL ResInZone(PDB *res, ZONE *zones);
 void ClearOccup(PDB *pdb);
-void FlagNearRes(PDB *pdb, ZONE *zones, char *restype, REAL radiusSq);
+BOOL FlagNearRes(PDB *pdb, ZONE *zones, char *restype, REAL radiusSq);
+RESINFO *BuildResidueTable(PDB *pdb, ZONE *zones, char *restype, 
+                           int *nres);
 void SetOccup(PDB *start, PDB *stop);
 BOOL CheckInRange(PDB *res1, PDB *nextRes1, PDB *res2, PDB *nextRes2, 
                   REAL radiusSq);
@@ -127,6 +155,7 @@ int main(int argc, char **argv)
         zonespec[MAXBUFF],
         restype[MAXBUFF];
    
+   btInitTiming(&argc, argv);
    
    if(ParseCmdLine(argc, argv, infile, outfile, &radius, zonespec, 
                    restype, &listOnly))
@@ -144,13 +173,14 @@ int main(int argc, char **argv)
          /* Square the radius to save on distance sqrt()s               */
          radius *= radius;
          
-         if(blOpenStdFiles(infile, outfile, &in, &out))
+         if(btOpenStdFiles(infile, outfile, &in, &out))
          {
             WHOLEPDB *wpdb;
-            if((wpdb = blReadWholePDB(in)) != NULL)
+            if((wpdb = btReadWholePDB(in)) != NULL)
             {
                pdb = wpdb->pdb;
-               FlagNearRes(pdb, zones, restype, radius);
+               if(!FlagNearRes(pdb, zones, restype, radius))
+                  return(1);
                if(listOnly)
                {
                   ListFlaggedResidues(out, pdb);
@@ -284,58 +314,219 @@ void ClearOccup(PDB *pdb)
 
 
 /************************************************************************/
-/*>void FlagNearRes(PDB *pdb, ZONE *zones, char *restype, REAL radiusSq)
+/*>BOOL FlagNearRes(PDB *pdb, ZONE *zones, char *restype, REAL radiusSq)
    ---------------------------------------------------------------------
 *//**
    \param[in]    pdb       PDB linked list
    \param[in]    zones     Linked list of zone specifications
    \param[in]    restype   Amino acid type we are looking for
    \param[in]    radiusSq  Squared distance for a residue to be in range
+   \return                 Success? (FALSE if no memory)
 
    Uses occupancy as a flag - first clears this for all atoms, then
    looks for residues of the specified type (restype) within the given
    distance of any of the given zones. If a residue has any s/c atom in
    range then the occupancy for the residue is set to 1
 
+   The zone membership, type, centroid and bounding radius of each 
+   residue are calculated once. The candidate residues (of the right 
+   type and not in a zone) are placed in a spatial grid by centroid so
+   that each zone residue only looks at candidates whose bounding 
+   spheres could be in range before the atoms are checked.
+
 -  05.06.19 Original    By: ACRM
+-  19.10.26 Uses the residue table, a grid of candidate centroids and
+            bounding sphere rejection   By: agent
+-  19.10.26 Returns FALSE if memory runs out
 */
-void FlagNearRes(PDB *pdb, ZONE *zones, char *restype, REAL radiusSq)
+BOOL FlagNearRes(PDB *pdb, ZONE *zones, char *restype, REAL radiusSq)
 {
-   PDB  *nextRes1, *nextRes2, *res1, *res2;
+   RESINFO     *resTable;
+   SPATIALGRID *grid      = NULL;
+   GRIDQUERY   query;
+   REAL        radius     = sqrt(radiusSq),
+               maxRadius  = 0.0,
+               *x         = NULL,
+               *y         = NULL,
+               *z         = NULL;
+   int         *candidate = NULL,
+               nres       = 0,
+               ncand      = 0,
+               i, j;
+   BOOL        ok         = TRUE;
 
    /* Set occupancies to zero - we will use this as a flag              */
    ClearOccup(pdb);
+
+   if((resTable = BuildResidueTable(pdb, zones, restype, &nres))==NULL)
+   {
+      fprintf(stderr,"Error: (pdbfindnearres) No memory for residue \
+table\n");
+      return(FALSE);
+   }
    
-   /* First step through the residues                                   */
-   for(res1=pdb; res1!=NULL; res1=nextRes1)
+   /* Collect the candidate residues - of the correct type, but not in
+      any zones
+   */
+   candidate = (int *)malloc((nres+1) * sizeof(int));
+   x         = (REAL *)malloc((nres+1) * sizeof(REAL));
+   y         = (REAL *)malloc((nres+1) * sizeof(REAL));
+   z         = (REAL *)malloc((nres+1) * sizeof(REAL));
+   if((candidate == NULL) || (x == NULL) || (y == NULL) || (z == NULL))
    {
-      nextRes1 = blFindNextResidue(res1);
-
-      /* If this residue is in a zone                                   */
-      if(ResInZone(res1, zones))
+      fprintf(stderr,"Error: (pdbfindnearres) No memory for candidate \
+residues\n");
+      ok = FALSE;
+   }
+   else
+   {
+      for(i=0; i<nres; i++)
       {
-         /* Second step through the residues                            */
-         for(res2=pdb; res2!=NULL; res2=nextRes2)
+         if(resTable[i].isType && !resTable[i].inZone)
          {
-            nextRes2 = blFindNextResidue(res2);
+            candidate[ncand] = i;
+            x[ncand]         = resTable[i].cx;
+            y[ncand]         = resTable[i].cy;
+            z[ncand]         = resTable[i].cz;
+            ncand++;
+            if(resTable[i].radius > maxRadius)
+               maxRadius = resTable[i].radius;
+         }
+      }
 
-            /* If this residue is of the correct type, but not in any
-               zones
-            */
-            if(!strncmp(res2->resnam, restype, 3) &&
-               !ResInZone(res2, zones))
-            {
-               /* See if any atoms in res1 are within distance of any
-                  atoms in res2
-               */
-               if(CheckInRange(res1, nextRes1, res2, nextRes2, radiusSq))
-               {
-                  SetOccup(res2, nextRes2);
-               }
-            }
+      if(ncand &&
+         ((grid = btBuildSpatialGridXYZ(x, y, z, ncand, 
+                                        radius + 2.0*maxRadius))==NULL))
+      {
+         fprintf(stderr,"Error: (pdbfindnearres) No memory for spatial \
+grid\n");
+         ok = FALSE;
+      }
+   }
+
+   /* Step through the residues in the zones                            */
+   for(i=0; (grid != NULL) && (i < nres); i++)
+   {
+      RESINFO *res1 = &(resTable[i]);
+      REAL    reach;
+
+      if(!res1->inZone)
+         continue;
+
+      /* Any candidate that could be in range has its centroid within
+         this distance
+      */
+      reach = res1->radius + maxRadius + radius;
+      btStartGridQuery(&query, grid, res1->cx, res1->cy, res1->cz, 
+                       reach * reach);
+      while((j = btNextGridNeighbour(&query, NULL)) >= 0)
+      {
+         RESINFO *res2 = &(resTable[candidate[j]]);
+         REAL    dx, dy, dz;
+
+         /* Already found from another zone residue                     */
+         if(res2->start->occ > 0.001)
+            continue;
+
+         /* Bounding sphere rejection                                   */
+         reach = res1->radius + res2->radius + radius;
+         dx    = res1->cx - res2->cx;
+         dy    = res1->cy - res2->cy;
+         dz    = res1->cz - res2->cz;
+         if((dx*dx + dy*dy + dz*dz) > (reach * reach))
+            continue;
+
+         /* See if any atoms in res1 are within distance of any
+            atoms in res2
+         */
+         if(CheckInRange(res1->start, res1->stop, 
+                         res2->start, res2->stop, radiusSq))
+         {
+            SetOccup(res2->start, res2->stop);
          }
       }
    }
+
+   btFreeSpatialGrid(grid);
+   FREE(candidate);
+   FREE(x);
+   FREE(y);
+   FREE(z);
+   free(resTable);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>RESINFO *BuildResidueTable(PDB *pdb, ZONE *zones, char *restype, 
+                              int *nres)
+   -------------------------------------------------------------------
+*//**
+   \param[in]    pdb       PDB linked list
+   \param[in]    zones     Linked list of zone specifications
+   \param[in]    restype   Amino acid type we are looking for
+   \param[out]   nres      Number of residues
+   \return                 Array of residue information (NULL if no
+                           memory)
+
+   Builds an array with the start and end, centroid, bounding radius,
+   zone membership and type match of every residue so that none of
+   these need be recalculated within the pairwise search
+
+-  19.10.26 Original    By: agent
+*/
+RESINFO *BuildResidueTable(PDB *pdb, ZONE *zones, char *restype, 
+                           int *nres)
+{
+   RESINFO *resTable;
+   PDB     *res, 
+           *nextRes,
+           *p;
+   int     i;
+
+   *nres = 0;
+   for(res=pdb; res!=NULL; res=blFindNextResidue(res))
+      (*nres)++;
+   
+   if((resTable = (RESINFO *)malloc((*nres+1) * sizeof(RESINFO)))==NULL)
+      return(NULL);
+
+   for(res=pdb, i=0; res!=NULL; res=nextRes, i++)
+   {
+      RESINFO *r = &(resTable[i]);
+      int     natoms = 0;
+
+      nextRes   = blFindNextResidue(res);
+      r->start  = res;
+      r->stop   = nextRes;
+      r->inZone = ResInZone(res, zones);
+      r->isType = !strncmp(res->resnam, restype, 3);
+      r->cx     = r->cy = r->cz = r->radius = 0.0;
+
+      for(p=res; p!=nextRes; NEXT(p))
+      {
+         r->cx += p->x;
+         r->cy += p->y;
+         r->cz += p->z;
+         natoms++;
+      }
+      r->cx /= natoms;
+      r->cy /= natoms;
+      r->cz /= natoms;
+
+      for(p=res; p!=nextRes; NEXT(p))
+      {
+         REAL dx = p->x - r->cx,
+              dy = p->y - r->cy,
+              dz = p->z - r->cz,
+              d  = dx*dx + dy*dy + dz*dz;
+         if(d > r->radius)
+            r->radius = d;
+      }
+      r->radius = sqrt(r->radius);
+   }
+
+   return(resTable);
 }
 
 
@@ -645,11 +836,16 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  05.06.19 Original    By: ACRM
 -  18.06.19 V1.0.1
 -  19.06.19 V1.0.2
+-  19.10.26 V1.1   By: agent
+-  19.10.26 V1.2
+-  19.10.26 V1.3
+-  19.10.26 V1.4
+-  19.10.26 V1.5
 
 */
 void Usage(void)
 {
-   printf("\npdbfindneares V1.0.2 (c) 2019 UCL, Prof. Andrew C.R. \
+   printf("\npdbfindneares V1.5 (c) 2019-2026 UCL, Prof. Andrew C.R. \
 Martin\n");
 
    printf("\nUsage: pdbfindnearres [-r nnn][-l] zone[,zone...] resnam \
@@ -3,8 +3,8 @@
 
    \file       pdbfindresrange.c
    
-   \version    V1.5
-   \date       12.03.15
+   \version    V1.9
+   \date       19.10.26
    \brief      Find a residue range given a key residue and a number
                of residues on either side
    
@@ -54,6 +54,12 @@
 -  V1.3   06.11.14  Renamed from findresrange
 -  V1.4   07.11.14  Removed an unused variable
 -  V1.5   12.03.15 Changed to allow multi-character chain names
+-  V1.6   19.10.26 Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+-  V1.7   19.10.26 Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-  V1.8   19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.9   19.10.26 Uses the shared residue index rather than a PDBSTRUCT
 
 *************************************************************************/
 /* Includes
@@ -63,6 +69,10 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/resindex.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -104,11 +114,13 @@ int main(int argc, char **argv)
         *out = stdout;
    PDB  *pdb;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, keyres, &width))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDB(in, &natoms)) == NULL)
+         if((pdb = btReadPDB(in, &natoms)) == NULL)
          {
             fprintf(stderr, "Unable to read PDB file\n");
             return(1);
@@ -125,7 +137,7 @@ int main(int argc, char **argv)
             switch(error)
             {
             case NO_MEMORY:
-               fprintf(out, "Error: No memory for PDB structure\n");
+               fprintf(out, "Error: No memory for residue index\n");
                break;
             case NO_KEYRESPARSE:
                fprintf(out, "Error: Illegal key residue specification: %s\n",
@@ -166,57 +178,44 @@ int main(int argc, char **argv)
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  07.11.14 Removed an unused variable
 -  12.03.15 Changed to allow multi-character chain names
+-  19.10.26 Finds the residues with the shared residue index rather than
+            building a PDBSTRUCT. As before, only the first chain with
+            the key residue's chain label is searched   By: agent
 */
 int GetResidueRange(PDB *pdb, char *keyres, int width, char *startres, 
                     char *endres)
 {
-   PDBSTRUCT  *pdbs;
-   PDBCHAIN   *pdbc;
-   PDBRESIDUE *pdbr, *endr, *startr;
-   char       chain[8], insert[8];
-   int        resnum, i;
+   RESINDEX *index;
+   char     chain[8], insert[8];
+   int      resnum, chainNum, res,
+            retval = 0;
    
    
-   if((pdbs = blAllocPDBStructure(pdb))==NULL)
-      return(NO_MEMORY);
+   if(!blParseResSpec(keyres, chain, &resnum, insert))
+      return(NO_KEYRESPARSE);
 
-   if(blParseResSpec(keyres, chain, &resnum, insert))
-   {
-      for(pdbc = pdbs->chains; pdbc!=NULL; NEXT(pdbc))
-      {
-         if(CHAINMATCH(pdbc->chain, chain))
-         {
-            for(pdbr = pdbc->residues; pdbr!=NULL; NEXT(pdbr))
-            {
-               if((pdbr->resnum == resnum) && 
-                  (pdbr->insert[0] == insert[0]))
-               {
-                  startr = endr = pdbr;
-                  for(i=0; i<width; i++)
-                  {
-                     if(endr!=NULL)   endr   = endr->next;
-                     if(startr!=NULL) startr = startr->prev;
-                  }
-                  if(startr == NULL) return(NO_STARTRES);
-                  if(endr   == NULL) return(NO_ENDRES);
-
-                  strncpy(startres, startr->resid, RESBUFF);
-                  strncpy(endres,   endr->resid,   RESBUFF);
-
-                  return(0);
-               }
-            }
-            break;
-         }
-      }
-      return(NO_KEYRES);
-   }
+   if((index = btBuildResIndex(pdb))==NULL)
+      return(NO_MEMORY);
+   if(width < 0)
+      width = 0;
+
+   chainNum = btFindIndexedChain(index, chain);
+   res      = btFindIndexedResidue(index, chain, resnum, insert, ' ');
+
+   if((chainNum < 0) || (res < 0) || (index->chainOfRes[res] != chainNum))
+      retval = NO_KEYRES;
+   else if(res - width < index->chainStart[chainNum])
+      retval = NO_STARTRES;
+   else if(res + width >= index->chainStart[chainNum+1])
+      retval = NO_ENDRES;
    else
    {
-      return(NO_KEYRESPARSE);
+      blBuildResSpec(BTRESSTART(index, res - width), startres);
+      blBuildResSpec(BTRESSTART(index, res + width), endres);
    }
 
-   return(0);
+   btFreeResIndex(index);
+   return(retval);
 }
 
 
@@ -312,7 +311,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbfindresrange V1.5 (c) 2010-2015 UCL, Andrew \
+   fprintf(stderr,"\npdbfindresrange V1.9 (c) 2010-2015 UCL, Andrew \
 C.R. Martin\n");
    fprintf(stderr,"\nUsage: pdbfindresrange resspec width [input.pdb \
 [output.txt]]\n");
@@ -3,8 +3,8 @@
    Program:    pdbfit
    File:       pdbfit.c
    
-   Version:    V2.0
-   Date:       03.11.17
+   Version:    V2.2
+   Date:       19.10.26
    Function:   Simple program to fit 2 sets of coordinates for an 
                identical protein
    
@@ -42,6 +42,10 @@
    =================
    V1.0   12.12.01  Original pdbcafit (12.05.10) and pdbfit (12.12.01)
    V2.0   03.11.17  Combined pdbfit and pdbcafit
+   V2.1   19.10.26  Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c   By: agent
+   V2.2   19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
  
 *************************************************************************/
 /* Includes
@@ -50,6 +54,8 @@
 #include <stdlib.h>
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -80,6 +86,8 @@ int main(int argc, char **argv)
    int  type       = TYPE_ALL;
    BOOL showCoords = FALSE;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile1, infile2, &type, &showCoords))
    {
       FILE *in1, *in2;
@@ -100,12 +108,12 @@ int main(int argc, char **argv)
       }
       
             
-      if((pdb1=blReadPDB(in1, &natoms1))==NULL)
+      if((pdb1=btReadPDB(in1, &natoms1))==NULL)
       {
          fprintf(stderr,"Error: Can't read atoms from %s\n",argv[1]);
          return(1);
       }
-      if((pdb2=blReadPDB(in2, &natoms2))==NULL)
+      if((pdb2=btReadPDB(in2, &natoms2))==NULL)
       {
          fprintf(stderr,"Error: Can't read atoms from %s\n",argv[2]);
          return(1);
@@ -315,7 +323,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile1, char *infile2,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbfit V2.0 (c) 2001-2017, UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbfit V2.2 (c) 2001-2017, UCL, Dr. Andrew C.R. \
 Martin\n");
    fprintf(stderr,"\nUsage: pdbcafit [-c|-b][-w] file1.pdb file2.pdb\n");
    fprintf(stderr,"       -c Fit only C-alphas\n");
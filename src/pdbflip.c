@@ -3,8 +3,8 @@
 
    \file       pdbflip.c
    
-   \version    V1.5
-   \date       12.03.15
+   \version    V1.9
+   \date       19.10.26
    \brief      Standardise equivalent atom labelling
    
    \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
@@ -53,6 +53,13 @@
 -  V1.3   06.11.14 Renamed from flip
 -  V1.4   13.02.15 Added whole PDB support
 -  V1.5   12.03.15 Changed to allow multi-character chain names
+-  V1.6   19.10.26 Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+-  V1.7   19.10.26 Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-  V1.8   19.10.26 Writes with btWriteWholePDB() so the structure is
+                   passed on in memory in a bioptools pipeline
+-  V1.9   19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -63,6 +70,10 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/angle.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 
 /************************************************************************/
@@ -120,15 +131,17 @@ int main(int argc, char **argv)
    PDB      *pdb;
    BOOL     verbose, quiet;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &verbose, &quiet))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
             DoFlipping(pdb,verbose,quiet);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -228,7 +241,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbflip V1.5 (c) 2014-2015 Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\npdbflip V1.9 (c) 2014-2015 Dr. Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"\nUsage: pdbflip [in.pdb [out.pdb]]\n");
 
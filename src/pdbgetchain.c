@@ -3,8 +3,8 @@
 
    \file       pdbgetchain.c
    
-   \version    V2.1
-   \date       13.03.15
+   \version    V2.6
+   \date       19.10.26
    \brief      Extract chains from a PDB file
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2015
@@ -66,6 +66,16 @@
                   single character chain labels (not comma-separated) are
                   supported.
 -  V2.1  13.03.15 Modified to use bioplib routines for list parsing
+-  V2.2  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V2.3  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V2.4  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V2.5  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V2.6  19.10.26 The -n chain counter is kept at file scope and reset
+                  on entry so it can run more than once in a bioptools
+                  pipeline
 
 *************************************************************************/
 /* Includes
@@ -75,6 +85,10 @@
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
 #include "bioplib/array.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -93,6 +107,7 @@
 /************************************************************************/
 /* Globals
 */
+static int sChainCount = 0;
 
 /************************************************************************/
 /* Prototypes
@@ -121,6 +136,7 @@ BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Now always keeps header  By: ACRM
 - Removed lowercase
+-  19.10.26 Resets the chain counter   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -133,19 +149,24 @@ int main(int argc, char **argv)
         atomsOnly = FALSE;
    WHOLEPDB *wpdb = NULL;
    
+   btInitTiming(&argc, argv);
+
+   /* Reset the counter as this may be run more than once in a pipeline */
+   sChainCount = 0;
+
    if((chains = ParseCmdLine(argc, argv, InFile, OutFile, &numeric,
                              &atomsOnly))!=NULL)
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
          /* 29.06.09 Added atomsOnly option                             */
          if(atomsOnly)
          {
-            wpdb=blReadWholePDBAtoms(in);
+            wpdb=btReadWholePDBAtoms(in);
          }
          else
          {
-            wpdb=blReadWholePDB(in);
+            wpdb=btReadWholePDB(in);
          }
          
          if((wpdb == NULL)||
@@ -157,7 +178,7 @@ int main(int argc, char **argv)
          else
          {
             SelectPDBChains(wpdb, chains, numeric);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
       }
    }
@@ -203,7 +224,6 @@ void SelectPDBChains(WHOLEPDB *wpdb, char **chains, BOOL numeric)
 BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric)
 {
    int i;
-   static int sChainCount = 0;
 
    if(numeric)
    {
@@ -266,10 +286,11 @@ PDB *FindEndOfChain(PDB *chain)
 -  13.02.15 V1.8
 -  04.03.15 V2.0
 -  13.03.15 V2.1
+-  19.10.26 V2.6   By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbgetchain V2.1 (c) 1997-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbgetchain V2.6 (c) 1997-2015 Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbgetchain [-n] [-a] \
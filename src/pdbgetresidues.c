@@ -3,8 +3,8 @@
 
    \file       pdbgetresidues.c
    
-   \version    V1.5.1
-   \date       26.06.19
+   \version    V1.5.5
+   \date       19.10.26
    \brief      Extract a set of residues from a PDB file
    
    \copyright  (c) Prof. Andrew C. R. Martin 2010-2019
@@ -36,6 +36,10 @@
 
    Description:
    ============
+   The residue list is placed in a hash keyed on chain, residue number
+   and insert code, so each atom is checked with a single lookup
+   (made once per residue) rather than against every entry in the
+   list. With -s the PDB file is streamed rather than read into memory.
 
 **************************************************************************
 
@@ -55,21 +59,36 @@
 -  V1.5   13.03.19 Terminate strings after strncpy()
 -  V1.5.1 26.06.19 Fix to termination of resnam which was beyond array
                    boundary
+-  V1.5.2 19.10.26 Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+-  V1.5.3 19.10.26 Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-  V1.5.4 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.5.5 19.10.26 Residues are selected with a hash in a single pass.
+                   Added -s to stream the PDB file
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "bioplib/hash.h"
+#include "common/pdbread.h"
+#include "common/pdbstream.h"
+#include "common/pdbfilter.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
 #define MAXRESID 16
+#define MAXKEY   32
 typedef struct _reslist
 {
    char resid[MAXRESID],
@@ -79,6 +98,19 @@ typedef struct _reslist
    struct _reslist *next;
 }  RESLIST;
 
+typedef struct
+{
+   HASHTABLE *hash;         /* Residue key to entry in count[]          */
+   int       *count,        /* Times each residue appears in the list   */
+             lastCount,     /* Count for the residue of the last atom   */
+             lastResnum,
+             natoms;
+   char      lastChain[8],
+             lastInsert[8];
+   BOOL      gotLast;
+   FILE      *out;
+}  SELECTION;
+
    
 
 /************************************************************************/
@@ -90,10 +122,15 @@ typedef struct _reslist
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *resfile,
-                  char *infile, char *outfile);
+                  char *infile, char *outfile, BOOL *stream);
 void Usage(void);
 RESLIST *ReadResidueList(FILE *fp);
-void PrintResidues(FILE *out, PDB *pdb, RESLIST *reslist);
+void PrintResidues(FILE *out, PDB *pdb, SELECTION *selection);
+BOOL BuildSelection(SELECTION *selection, RESLIST *reslist, FILE *out);
+void FreeSelection(SELECTION *selection);
+void MakeResKey(char *key, char *chain, int resnum, char *insert);
+void WriteIfSelected(SELECTION *selection, PDB *p);
+BOOL StreamAtom(PDB *p, void *data);
 
 
 /************************************************************************/
@@ -106,6 +143,7 @@ void PrintResidues(FILE *out, PDB *pdb, RESLIST *reslist);
 -  22.07.96 Original    By: ACRM
 -  29.09.05 Modified for -l By: TL
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Residues are selected with a hash. Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -118,29 +156,60 @@ int main(int argc, char **argv)
    int  natom;
    PDB  *pdb;
    RESLIST *reslist = NULL;
+   SELECTION selection;
+   BOOL stream;
 
+   btInitTiming(&argc, argv);
 
-   if(ParseCmdLine(argc, argv, ResFile, InFile, OutFile))
+   if(ParseCmdLine(argc, argv, ResFile, InFile, OutFile, &stream))
    {
       if((rfp=fopen(ResFile, "r"))!=NULL)
       {
-         if(blOpenStdFiles(InFile, OutFile, &in, &out))
+         if(btOpenStdFiles(InFile, OutFile, &in, &out))
          {
-            if((pdb=blReadPDB(in, &natom))==NULL)
+            if(stream && btCanFilterPDB(in))
+            {
+               if(((reslist = ReadResidueList(rfp))==NULL) ||
+                  !BuildSelection(&selection, reslist, out))
+               {
+                  fprintf(stderr,"Error: pdbgetresidues - Failed to \
+read residues from list\n");
+                  return(1);
+               }
+               if(!btStreamPDB(in, FALSE, NULL, StreamAtom,
+                               (void *)&selection))
+               {
+                  fprintf(stderr,"Error: pdbgetresidues - No memory \
+to read PDB file\n");
+                  return(1);
+               }
+               if(selection.natoms == 0)
+               {
+                  fprintf(stderr,"Error: pdbgetresidues - No atoms \
+read from PDB file\n");
+                  return(1);
+               }
+               FreeSelection(&selection);
+               return(0);
+            }
+
+            if((pdb=btReadPDB(in, &natom))==NULL)
             {
                fprintf(stderr,"Error: pdbgetresidues - No atoms read from \
 PDB file\n");
                return(1);
             }
             
-            if((reslist = ReadResidueList(rfp))==NULL)
+            if(((reslist = ReadResidueList(rfp))==NULL) ||
+               !BuildSelection(&selection, reslist, out))
             {
                fprintf(stderr,"Error: pdbgetresidues - Failed to read \
 residues from list\n");
                return(1);
             }
             
-            PrintResidues(out, pdb, reslist);
+            PrintResidues(out, pdb, &selection);
+            FreeSelection(&selection);
          }
       }
    }
@@ -155,24 +224,174 @@ residues from list\n");
 /************************************************************************/
 /*
 -  12.03.15 Changed to allow multi-character chain names
+-  19.10.26 Takes the hashed selection rather than the residue list so
+            this is a single pass over the atoms   By: agent
 */
-void PrintResidues(FILE *out, PDB *pdb, RESLIST *reslist)
+void PrintResidues(FILE *out, PDB *pdb, SELECTION *selection)
 {
    PDB *p;
-   RESLIST *r;
    
    for(p=pdb; p!=NULL; NEXT(p))
    {
-      for(r=reslist; r!=NULL; NEXT(r))
+      WriteIfSelected(selection, p);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL BuildSelection(SELECTION *selection, RESLIST *reslist, FILE *out)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[out]     *selection   Hashed selection
+   \param[in]      *reslist     Residue list
+   \param[in]      *out         Output file for the selected atoms
+   \return                      Success?
+
+   Places the residues of the list in a hash. A residue listed more than
+   once is counted so that, as before, its atoms are written once for
+   each time it is listed.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL BuildSelection(SELECTION *selection, RESLIST *reslist, FILE *out)
+{
+   RESLIST *r;
+   char    key[MAXKEY];
+   int     nres = 0,
+           nkeys = 0;
+
+   for(r=reslist; r!=NULL; NEXT(r))
+      nres++;
+
+   selection->out     = out;
+   selection->natoms  = 0;
+   selection->gotLast = FALSE;
+   selection->hash    = blInitializeHash((ULONG)(2*nres+1));
+   selection->count   = (int *)calloc(nres+1, sizeof(int));
+   if((selection->hash == NULL) || (selection->count == NULL))
+   {
+      FreeSelection(selection);
+      return(FALSE);
+   }
+
+   for(r=reslist; r!=NULL; NEXT(r))
+   {
+      MakeResKey(key, r->chain, r->resnum, r->insert);
+      if(!blHashKeyDefined(selection->hash, key))
       {
-         if((p->resnum == r->resnum) &&
-            CHAINMATCH(p->chain, r->chain) &&
-            !strcmp(p->insert, r->insert))
+         if(!blSetHashValueInt(selection->hash, key, nkeys++))
          {
-            blWritePDBRecord(out, p);
+            FreeSelection(selection);
+            return(FALSE);
          }
       }
+      selection->count[blGetHashValueInt(selection->hash, key)]++;
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeSelection(SELECTION *selection)
+   ----------------------------------------
+*//**
+
+   \param[in,out]  *selection   Hashed selection
+
+-  19.10.26 Original    By: agent
+*/
+void FreeSelection(SELECTION *selection)
+{
+   if(selection->hash != NULL)
+      blFreeHash(selection->hash);
+   FREE(selection->count);
+   selection->hash = NULL;
+}
+
+
+/************************************************************************/
+/*>void MakeResKey(char *key, char *chain, int resnum, char *insert)
+   -----------------------------------------------------------------
+*//**
+
+   \param[out]     *key         Hash key (MAXKEY)
+   \param[in]      *chain       Chain label
+   \param[in]      resnum       Residue number
+   \param[in]      *insert      Insert code
+
+   The chain and insert code are compared as strings, as they were
+   when the list was searched
+
+-  19.10.26 Original    By: agent
+*/
+void MakeResKey(char *key, char *chain, int resnum, char *insert)
+{
+   sprintf(key, "%.7s|%d|%.7s", chain, resnum, insert);
+}
+
+
+/************************************************************************/
+/*>void WriteIfSelected(SELECTION *selection, PDB *p)
+   --------------------------------------------------
+*//**
+
+   \param[in,out]  *selection   Hashed selection
+   \param[in]      *p           Atom
+
+   Writes the atom once for each time its residue is listed. The hash
+   is only consulted when the residue changes.
+
+-  19.10.26 Original    By: agent
+*/
+void WriteIfSelected(SELECTION *selection, PDB *p)
+{
+   char key[MAXKEY];
+   int  i;
+
+   if(!selection->gotLast || (p->resnum != selection->lastResnum) ||
+      !CHAINMATCH(p->chain, selection->lastChain) ||
+      strcmp(p->insert, selection->lastInsert))
+   {
+      selection->gotLast    = TRUE;
+      selection->lastResnum = p->resnum;
+      strncpy(selection->lastChain, p->chain, 8);
+      selection->lastChain[7] = '\0';
+      strncpy(selection->lastInsert, p->insert, 8);
+      selection->lastInsert[7] = '\0';
+
+      MakeResKey(key, p->chain, p->resnum, p->insert);
+      selection->lastCount = blHashKeyDefined(selection->hash, key) ?
+         selection->count[blGetHashValueInt(selection->hash, key)] : 0;
    }
+
+   for(i=0; i<selection->lastCount; i++)
+      blWritePDBRecord(selection->out, p);
+}
+
+
+/************************************************************************/
+/*>BOOL StreamAtom(PDB *p, void *data)
+   -----------------------------------
+*//**
+
+   \param[in]      *p           Atom from btStreamPDB()
+   \param[in,out]  *data        Hashed selection
+   \return                      TRUE
+
+   Streaming callback
+
+-  19.10.26 Original    By: agent
+*/
+BOOL StreamAtom(PDB *p, void *data)
+{
+   SELECTION *selection = (SELECTION *)data;
+
+   WriteIfSelected(selection, p);
+   (selection->natoms)++;
+   free(p);
+   return(TRUE);
 }
 
 
@@ -228,7 +447,7 @@ RESLIST *ReadResidueList(FILE *fp)
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *resfile,
-                     char *infile, char *outfile)
+                     char *infile, char *outfile, BOOL *stream)
    ----------------------------------------------------------------------
 *//**
 
@@ -238,19 +457,22 @@ RESLIST *ReadResidueList(FILE *fp)
    \param[out]     *Zone2       Second end of zone
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *stream      Stream the PDB file
    \return                      Success?
 
    Parse the command line
    
 -  15.06.10 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *resfile,
-                  char *infile, char *outfile)
+                  char *infile, char *outfile, BOOL *stream)
 {
    argc--;
    argv++;
 
    resfile[0] = infile[0] = outfile[0] = '\0';
+   *stream    = FALSE;
 
    if(!argc)
    {
@@ -263,6 +485,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *resfile,
       {
          switch(argv[0][1])
          {
+         case 's':
+            *stream = TRUE;
+            break;
          case 'h':
             return(FALSE);
             break;
@@ -323,9 +548,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *resfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbgetresidues V1.5 (c) 2010-2019, UCL, Dr. Andrew \
+   fprintf(stderr,"\npdbgetresidues V1.5.5 (c) 2010-2019, UCL, Dr. Andrew \
 C.R. Martin\n");
-   fprintf(stderr,"\nUsage: pdbgetresidues resfile [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"\nUsage: pdbgetresidues [-s] resfile [in.pdb \
+[out.pdb]]\n");
+   fprintf(stderr,"       -s Stream the PDB file in constant memory\n");
 
    fprintf(stderr,"\nresfile is a file listing residue specifications in \
 the resspec format:\n\n");
@@ -338,4 +565,6 @@ files are specified. \n");
 just those residues \n");
    fprintf(stderr,"from a PDB file. Note that residue specifications are \
 case sensitive.\n");
+   fprintf(stderr,"With -s, binary PDB and PDBML files are still read \
+as a whole.\n\n");
 }
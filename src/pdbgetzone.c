@@ -3,8 +3,8 @@
 
    \file       pdbgetzone.c
    
-   \version    V1.10
-   \date       19.06.19
+   \version    V1.14
+   \date       19.10.26
    \brief      Extract a numbered zone from a PDB file
    
    \copyright  (c) Prof. Andrew C. R. Martin 1996-2019
@@ -66,6 +66,14 @@
 -  V1.8   02.10.15  Added -x (extend) and -f (force) parameters
 -  V1.9   07.10.15  Added -v (invert) parameter
 -  V1.10  26.06.19  -f with -v now ignores being unable to find the zone
+-  V1.11  19.10.26  Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c   By: agent
+-  V1.12  19.10.26  Opens files with btOpenStdFiles() so compressed
+                    input and output are handled in-process
+-  V1.13  19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
+-  V1.14  19.10.26  Extends zones (-x) with the shared residue index
+                    rather than a PDBSTRUCT
 
 *************************************************************************/
 /* Includes
@@ -73,6 +81,10 @@
 #include <stdio.h>
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/resindex.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -94,7 +106,7 @@ void Usage(void);
 BOOL UpdateResRange(PDB *pdb, int width,
                     char *chain1, int *res1, char *insert1,
                     char *chain2, int *res2, char *insert2);
-BOOL FindOffsetResidue(PDBSTRUCT *pdbs, int width,
+BOOL FindOffsetResidue(RESINDEX *index, int width,
                        char *chain, int *resnum, char *insert);
 
 
@@ -132,15 +144,16 @@ int main(int argc, char **argv)
             metadata = FALSE;
    WHOLEPDB *wpdb;
    
+   btInitTiming(&argc, argv);
 
    if(ParseCmdLine(argc, argv, Zone1, Zone2, InFile, OutFile, &width,
                    &force, &invert, &metadata))
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
          BOOL ParseResSpec1Result, ParseResSpec2Result;
 
-         if(((wpdb=blReadWholePDB(in))==NULL) || (wpdb->pdb == NULL))
+         if(((wpdb=btReadWholePDB(in))==NULL) || (wpdb->pdb == NULL))
          {
             fprintf(stderr,"pdbgetzone: No atoms read from PDB file\n");
             return(1);
@@ -384,37 +397,38 @@ deprecated\n");
    not step to another chain.
 
 -- 03.10.15  Original   By: ACRM
+-- 19.10.26  Uses the shared residue index rather than a PDBSTRUCT
 */
 BOOL UpdateResRange(PDB *pdb, int width,
                     char *chain1, int *resnum1, char *insert1,
                     char *chain2, int *resnum2, char *insert2)
 {
-   PDBSTRUCT  *pdbs;
+   RESINDEX   *index;
    BOOL       retval = TRUE;
    
    if(width == 0)
       return(TRUE);
    
-   if((pdbs = blAllocPDBStructure(pdb))==NULL)
+   if((index = btBuildResIndex(pdb))==NULL)
       return(FALSE);
 
-   if(!FindOffsetResidue(pdbs, -width, chain1, resnum1, insert1))
+   if(!FindOffsetResidue(index, -width, chain1, resnum1, insert1))
       retval = FALSE;
-   if(!FindOffsetResidue(pdbs,  width, chain2, resnum2, insert2))
+   if(!FindOffsetResidue(index,  width, chain2, resnum2, insert2))
       retval = FALSE;
    
-   blFreePDBStructure(pdbs);
+   btFreeResIndex(index);
 
    return(retval);
 }
 
 
 /************************************************************************/
-/*>BOOL FindOffsetResidue(PDBSTRUCT *pdbs, int width,
+/*>BOOL FindOffsetResidue(RESINDEX *index, int width,
                           char *chain, int *resnum, char *insert)
    --------------------------------------------------------------
 *//**
-   \param[in]     *pdbs     PDBSTRUCT structure
+   \param[in]     *index    Residue index
    \param[in]     width     Number of residues by which to step
    \param[in]     *chain    Chain label
    \param[in,out] *resnum   Residue nunmber
@@ -427,48 +441,32 @@ BOOL UpdateResRange(PDB *pdb, int width,
    The chain will never change in stepping
 
 -- 03.10.15  Original   By: ACRM
+-- 19.10.26  Looks the residue up in the residue index and steps by
+             residue number within the first chain with this label
 */
-BOOL FindOffsetResidue(PDBSTRUCT *pdbs, int width,
+BOOL FindOffsetResidue(RESINDEX *index, int width,
                        char *chain, int *resnum, char *insert)
 {
-   PDBCHAIN   *pdbc;
-   PDBRESIDUE *keyres, *newres;
-   int        i;
-   
-   for(pdbc = pdbs->chains; pdbc!=NULL; NEXT(pdbc))
-   {
-      if(CHAINMATCH(pdbc->chain, chain))
-      {
-         for(keyres = pdbc->residues; keyres!=NULL; NEXT(keyres))
-         {
-            if((keyres->resnum == *resnum) && 
-               INSERTMATCH(keyres->insert, insert))
-            {
-               newres = keyres;
-               for(i=0; i<ABS(width); i++)
-               {
-                  if(width < 0)
-                  {
-                     if(newres!=NULL) newres = newres->prev;
-                  }
-                  else
-                  {
-                     if(newres!=NULL) newres = newres->next;
-                  }
-               }
-               if(newres == NULL) return(FALSE);
-               
-               *resnum = newres->resnum;
-               strcpy(insert, newres->insert);
-               
-               return(TRUE);
-            }
-         }
-         break;
-      }
-   }
+   PDB *newres;
+   int chainNum,
+       res;
+
+   if(((chainNum = btFindIndexedChain(index, chain)) < 0) ||
+      ((res = btFindIndexedResidue(index, chain, *resnum, insert, ' '))
+       < 0) ||
+      (index->chainOfRes[res] != chainNum))
+      return(FALSE);
 
-   return(FALSE);
+   res += width;
+   if((res <  index->chainStart[chainNum]) ||
+      (res >= index->chainStart[chainNum+1]))
+      return(FALSE);
+
+   newres  = BTRESSTART(index, res);
+   *resnum = newres->resnum;
+   strcpy(insert, newres->insert);
+
+   return(TRUE);
 }
 
 
@@ -490,7 +488,7 @@ BOOL FindOffsetResidue(PDBSTRUCT *pdbs, int width,
 void Usage(void)
 {
    fprintf(stderr,"\n");
-   fprintf(stderr,"pdbgetzone V1.10 (c) 1996-2019, Prof. Andrew C.R. \
+   fprintf(stderr,"pdbgetzone V1.14 (c) 1996-2019, Prof. Andrew C.R. \
 Martin, UCL.\n");
    fprintf(stderr,"                    Modified by Tony Lewis, \
 UCL, 2005\n");
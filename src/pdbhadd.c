@@ -3,8 +3,8 @@
 
    \file       pdbhadd.c
    
-   \version    V1.7
-   \date       23.06.15
+   \version    V1.11
+   \date       19.10.26
    \brief      Add hydrogens to a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
@@ -56,6 +56,13 @@
 -  V1.5  23.02.15 Modified for new blRenumAtomsPDB()
 -  V1.6  20.03.15 Takes -v option and -n option
 -  V1.7  23.06.15 Fixed bug if unable to strip hydrogens
+-  V1.8  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.9  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.10 19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.11 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -69,6 +76,10 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -121,14 +132,16 @@ int main(int argc, char **argv)
             noStrip = FALSE,
             verbose = FALSE;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, pgpfile, &AllH, &Charmm,
                    &verbose, &noStrip))
    {
       if((pgp = blOpenPGPFile(pgpfile, AllH)) != NULL)
       {
-         if(blOpenStdFiles(infile, outfile, &in, &out))
+         if(btOpenStdFiles(infile, outfile, &in, &out))
          {
-            if((wpdb = blReadWholePDB(in)) != NULL)
+            if((wpdb = btReadWholePDB(in)) != NULL)
             {
                pdb = wpdb->pdb;
                FixNTerNames(pdb);
@@ -171,7 +184,7 @@ N-terminus\n");
 
                blRenumAtomsPDB(pdb, 1);
                
-               blWriteWholePDB(out, wpdb);
+               btWriteWholePDB(out, wpdb);
             }
             else
             {
@@ -319,7 +332,7 @@ void FixNTerNames(PDB *pdb)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nPDBHAdd V1.7 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\nPDBHAdd V1.11 (c) 1994-2015, Andrew C.R. Martin, \
 UCL\n\n");
    fprintf(stderr,"Usage: pdbhadd [-p pgpfile] [-a] [-c] [-n] [-v] \
 [<in.pdb> [<out.pdb>]]\n");
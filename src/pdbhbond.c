@@ -7,8 +7,8 @@ Handle PGP file in data directory
 
    \file       pdbhbond.c
    
-   \version    V2.1
-   \date       08.09.17
+   \version    V2.7
+   \date       19.10.26
    \brief      List hydrogen bonds
    
    \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2017
@@ -139,6 +139,18 @@ Handle PGP file in data directory
                    CONECT information rather than keeping its own version
                    of the CONECT data
 -   V2.1  08.09.17 Changed comment in output and spacing of fields
+-   V2.2  19.10.26 Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+-   V2.3  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-   V2.4  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-   V2.5  19.10.26 Finds the length of a chain for isAPeptide() from the
+                   shared residue index rather than walking the list for
+                   every atom
+-   V2.6  19.10.26 The PDB extras are allocated from an arena and
+                   released in one go
+-   V2.7  19.10.26 The HBond lists are no longer static so it can run
+                   more than once in a bioptools pipeline
 
 *************************************************************************/
 /* Includes
@@ -155,6 +167,11 @@ Handle PGP file in data directory
 #include "bioplib/hash.h"
 #include "bioplib/angle.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/resindex.h"
+#include "common/arena.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -279,7 +296,8 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   REAL *maxHBDistSq);
 HBLIST *FindProtProtHBonds(PDB *pdb);
 HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray,
-                             BOOL pseudo, REAL maxHBDistSq);
+                             RESINDEX *resIndex, BOOL pseudo,
+                             REAL maxHBDistSq);
 HBLIST *FindLigandLigandHBonds(PDB *pdb, 
                                PDB **pdbarray, BOOL pseudo,
                                REAL maxHBDistSq);
@@ -292,12 +310,12 @@ PDB *FindAntecedent(PDB *atom, PDB **pdbarray, int *count, int nth);
 PDB *FindBondedHydrogen(PDB *pdb, PDB *donor, PDB *acceptor);
 HBLIST *doTestForHBond(PDB *pdb, PDB *donor, PDB *acceptor, 
                        PDB **pdbarray, int donMax, REAL maxHBDistSq);
-HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray,
+HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, RESINDEX *resIndex,
                      HBLIST *hbonds, REAL minNBDistSq, REAL maxNBDistSq);
 BOOL IsListedAsHBonded(PDB *p, PDB *q, HBLIST *hbonds);
-BOOL isAPeptide(PDB *pdb, PDB *atm);
+BOOL isAPeptide(RESINDEX *resIndex, PDB *atm);
 void SetAtomNumExtras(PDB *pdb);
-BOOL UpdatePDBExtras(PDB *pdb);
+BOOL UpdatePDBExtras(ARENA *arena, PDB *pdb);
 BOOL SetMolecules(PDB *pdb);
 void MarkLinkedResidues(PDB *chainStart, PDB *resStart, 
                         PDB *nextChain, int id);
@@ -316,6 +334,8 @@ void DeleteMetalConects(PDB *pdb);
 -  16.06.99 Added min and max NB/HB distances as variables
 -  22.07.15 Modified to use PDB files and standard BiopLib structures
             and functions
+-  19.10.26 Builds a residue index for isAPeptide()   By: agent
+-  19.10.26 The extras are allocated from an arena
 */
 int main(int argc, char **argv)
 {
@@ -324,6 +344,8 @@ int main(int argc, char **argv)
               *pgp;
    PDB        *pdb,
               **pdbarray;
+   RESINDEX   *resIndex;
+   ARENA      *extrasArena;
    int        nhyd,
               indexSize;
    char       infile[MAXBUFF],
@@ -341,10 +363,12 @@ int main(int argc, char **argv)
               maxHBDistSq = MAXHBONDDISTSQ;
    STRINGLIST *warnings = NULL;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, pgpfile, &minNBDistSq, 
                    &maxNBDistSq, &maxHBDistSq))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          /* Open the PGP file                                           */
          if((pgp = blOpenPGPFile(pgpfile, FALSE))==NULL)
@@ -353,7 +377,7 @@ int main(int argc, char **argv)
             return(1);
          }
             
-         if((wpdb = blReadWholePDB(in))==NULL)
+         if((wpdb = btReadWholePDB(in))==NULL)
          {
             fprintf(stderr,"pdbhbond: (error) Unable to PDB file\n");
             return(1);
@@ -367,7 +391,8 @@ file\n");
          }
 
          /* Store the original atom numbers in the extras field         */
-         if(!UpdatePDBExtras(pdb))
+         if(((extrasArena = btNewArena(0))==NULL) ||
+            !UpdatePDBExtras(extrasArena, pdb))
          {
             fprintf(stderr,"pdbhbond: (error) No memory for extra PDB \
 data\n");
@@ -384,7 +409,7 @@ PDB file\n");
          }
 
          /* Create extras fields for the extra hydrogen atoms           */
-         if(!UpdatePDBExtras(pdb))
+         if(!UpdatePDBExtras(extrasArena, pdb))
          {
             fprintf(stderr,"pdbhbond: (error) No memory for extra PDB \
 data\n");
@@ -410,6 +435,13 @@ data\n");
          }
 
          DeleteMetalConects(pdb);
+
+         if((resIndex=btBuildResIndex(pdb))==NULL)
+         {
+            fprintf(stderr,"pdbhbond: (error) No memory for residue \
+index\n");
+            return(1);
+         }
             
          /* Find protein-protein HBonds                                 */
          blSetMaxProteinHBondDADistance((REAL)sqrt(maxHBDistSq));
@@ -418,12 +450,12 @@ data\n");
          FREELIST(ppHBonds, HBLIST);
 
          /* Find protein-ligand HBonds                                  */
-         plHBonds = FindProtLigandHBonds(pdb, pdbarray, FALSE,
+         plHBonds = FindProtLigandHBonds(pdb, pdbarray, resIndex, FALSE,
                                          maxHBDistSq);
          PrintHBList(out, plHBonds, "plhbonds", TRUE);
 
          /* Find protein-ligand pseudo-HBonds                           */
-         pplHBonds = FindProtLigandHBonds(pdb, pdbarray, TRUE,
+         pplHBonds = FindProtLigandHBonds(pdb, pdbarray, resIndex, TRUE,
                                           maxHBDistSq);
          PrintHBList(out, pplHBonds, "pseudohbonds", FALSE);
 
@@ -456,11 +488,13 @@ data\n");
          }
 
          /* Find non-bonded contacts                                    */
-         nbContacts = FindNonBonds(pdb, pdbarray, plHBonds,
+         nbContacts = FindNonBonds(pdb, pdbarray, resIndex, plHBonds,
                                    minNBDistSq, maxNBDistSq);
          PrintHBList(out, nbContacts, "nonbonds", FALSE);
 
-         FREEPDBEXTRAS(pdb);
+         btFreeResIndex(resIndex);
+
+         btFreeArena(extrasArena);
          FREELIST(pdb, PDB);
       }
    }
@@ -483,11 +517,12 @@ data\n");
 -  09.06.99 Added -q
 -  16.06.99 Added -n, -x, -b
 -  22.07.15 V2.0. Added -p
+-  19.10.26 V2.7   By: agent
 
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbhbond V2.0 (c) 2015, Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\npdbhbond V2.7 (c) 2015, Dr. Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"Usage: pdbhbond [-n dist][-x dist][-b dist]\
 [-p pgpfile] [infile [outfile]]\n");
@@ -624,13 +659,14 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  07.06.99 Original   By: ACRM
 -  22.07.15 Modified to use PDB files and standard BiopLib structures
             and functions
+-  19.10.26 The list is no longer static as main() frees it   By: agent
 */
 HBLIST *FindProtProtHBonds(PDB *pdb)
 {
-   PDB           *p, *q;
-   static HBLIST *hblist = NULL,
-                 *hbl,
-                 *hb;
+   PDB    *p, *q;
+   HBLIST *hblist = NULL,
+          *hbl    = NULL,
+          *hb;
    
    
    /* Loop through each residue                                         */
@@ -1309,13 +1345,15 @@ HBLIST *doTestForHBond(PDB *pdb, PDB *donor, PDB *acceptor,
 
 
 /************************************************************************/
-/*>HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, HBLIST *hbonds,
-                        REAL minNBDistSq, REAL maxNBDistSq)
-   --------------------------------------------------------------
+/*>HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, RESINDEX *resIndex,
+                        HBLIST *hbonds, REAL minNBDistSq,
+                        REAL maxNBDistSq)
+   -------------------------------------------------------------------
 *//**
    \param[in]    *pdb         The PDB linked list
    \param[in]    **pdbarray   Array of PDB structure indexed by atom
                               number
+   \param[in]    *resIndex    Residue index of the PDB linked list
    \param[in]    *hbonds      Linked list of HBonds
    \param[in]    minNBDistSq  Minimum distance for non-bond contact
    \param[in]    maxNBDistSq  Maximum distance for non-bond contact
@@ -1337,9 +1375,10 @@ HBLIST *doTestForHBond(PDB *pdb, PDB *donor, PDB *acceptor,
             min and max distances now variables (and parameters)
 -  21.07.15 Modified to use PDB files and standard BiopLib structures
             and functions - added pdb parameter. 
+-  19.10.26 Added resIndex parameter   By: agent
 */
-HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, HBLIST *hbonds, 
-                     REAL minNBDistSq, REAL maxNBDistSq)
+HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, RESINDEX *resIndex,
+                     HBLIST *hbonds, REAL minNBDistSq, REAL maxNBDistSq)
 {
    PDB    *p, 
           *q;
@@ -1355,7 +1394,7 @@ HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, HBLIST *hbonds,
       if(!strcmp(p->element, "H"))
          continue;
       
-      isPeptide = isAPeptide(pdb, p);
+      isPeptide = isAPeptide(resIndex, p);
       
       /* If it's a HET/METAL/BOUNDHET or a peptide                      */
       if(((p->atomtype & ATOMTYPE_NONRESIDUE) && 
@@ -1516,25 +1555,16 @@ BOOL IsListedAsHBonded(PDB *p, PDB *q, HBLIST *hbonds)
 -  16.06.99 Added maxHBDistSq parameter
 -  21.07.15 Modified to use PDB files and standard BiopLib structures
             and functions - added pdb parameter. 
+-  19.10.26 The list is no longer static   By: agent
 */
 HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
                                REAL maxHBDistSq)
 {
-   PDB           *p, *q;
-   static HBLIST *hblist = NULL,
-                 *hbl,
-                 *hb;
-   static int    prevPseudo = (-5);
+   PDB    *p, *q;
+   HBLIST *hblist = NULL,
+          *hbl    = NULL,
+          *hb;
 
-   
-   if(pseudo != prevPseudo)
-   {
-      prevPseudo = pseudo;
-      hblist = NULL;
-      hbl    = NULL;
-      hb     = NULL;
-   }
-   
    for(p=pdb; p!=NULL; NEXT(p))
    {
       /* If it's a HET/METAL/BOUNDHET                                   */
@@ -1584,13 +1614,15 @@ HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
 
 
 /************************************************************************/
-/*>HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
+/*>HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray,
+                                RESINDEX *resIndex, BOOL pseudo,
                                 REAL maxHBDistSq)
    -------------------------------------------------------------------
 *//**
    \param[in]     *pdb        PDB linked list
    \param[in]     **pdbarray  Array of PDB pointers indexed by atom
                               number
+   \param[in]     *resIndex   Residue index of the PDB linked list
    \param[in]     pseudo      Pseudo hbonds? (or true HBonds)
    \param[in]     maxHBDistSq Max D-A HBond distance
    \return                    Linked list of hbonds
@@ -1608,25 +1640,18 @@ HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
             molecules!
 -  21.07.15 Modified to use PDB files and standard BiopLib structures
             and functions - added pdb parameter. 
+-  19.10.26 Added resIndex parameter   By: agent
+-  19.10.26 The list is no longer static
 */
-HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
+HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray,
+                             RESINDEX *resIndex, BOOL pseudo,
                              REAL maxHBDistSq)
 {
-   PDB           *p, *q;
-   static HBLIST *hblist = NULL,
-                 *hbl,
-                 *hb;
-   static int    prevPseudo = (-5);
+   PDB    *p, *q;
+   HBLIST *hblist = NULL,
+          *hbl    = NULL,
+          *hb;
 
-   
-   if(pseudo != prevPseudo)
-   {
-      prevPseudo = pseudo;
-      hblist = NULL;
-      hbl    = NULL;
-      hb     = NULL;
-   }
-   
    for(p=pdb; p!=NULL; NEXT(p))
    {
       /* If it's a HET/METAL/BOUNDHET                                   */
@@ -1678,7 +1703,7 @@ HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
          /* If it's a nucleotide or a peptide                           */
          if((p->atomtype == ATOMTYPE_NUC) || 
             (p->atomtype == ATOMTYPE_MODNUC) ||
-            isAPeptide(pdb, p))
+            isAPeptide(resIndex, p))
          {
             /* Look for interactions with protein                       */
             for(q=pdb; q!=NULL; NEXT(q))
@@ -1729,39 +1754,30 @@ HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
 
 
 /************************************************************************/
-/*>BOOL isAPeptide(PDB *pdb, PDB *atm)
-   -----------------------------------
+/*>BOOL isAPeptide(RESINDEX *resIndex, PDB *atm)
+   ----------------------------------------------
 *//**
-   \param[in]    pdb    Start of PDB linked list
-   \param[in]    atm    An atom in the PDB linked list
-   \return              Is it a peptide
+   \param[in]    resIndex  Residue index of the PDB linked list
+   \param[in]    atm       An atom in the PDB linked list
+   \return                 Is it a peptide
 
    Tests whether the molecule containing the given atom is a peptide
    (i.e. less than MAX_PEPTIDE_LENGTH residues long)
 
 -  21.07.15  Original   By: ACRM
+-  19.10.26  Counts the residues from the residue index rather than
+             walking the list. As before, the chain is the first one
+             with the atom's chain label   By: agent
 */
-BOOL isAPeptide(PDB *pdb, PDB *atm)
+BOOL isAPeptide(RESINDEX *resIndex, PDB *atm)
 {
-   PDB *start, *stop, *res;
-   int nRes;
-   
+   int chain,
+       nRes;
    
-   /* Find the start of this chain                                      */
-   for(start=pdb; start!=atm; NEXT(start))
-   {
-      if(PDBCHAINMATCH(start, atm))
-         break;
-   }
-   /* Find the next chain                                               */
-   stop = blFindNextChain(start);
-   
-   /* Count the residues in the chain                                   */
-   for(res=start, nRes=0; res!=stop; res=blFindNextResidue(res))
-   {
-      nRes++;
-   }
+   if((chain = btFindIndexedChain(resIndex, atm->chain)) < 0)
+      return(FALSE);
 
+   nRes = resIndex->chainStart[chain+1] - resIndex->chainStart[chain];
    if(nRes > MAX_PEPTIDE_LENGTH)
       return(FALSE);
    
@@ -1790,9 +1806,10 @@ void SetAtomNumExtras(PDB *pdb)
 }
 
 /************************************************************************/
-/*>BOOL UpdatePDBExtras(PDB *pdb)
-   ------------------------------
+/*>BOOL UpdatePDBExtras(ARENA *arena, PDB *pdb)
+   ---------------------------------------------
 *//**
+   \param[in]        *arena  Arena for the extras
    \param[in, out]   *pdb    PDB linked list
    \return                   Success in allocations
 
@@ -1802,8 +1819,10 @@ void SetAtomNumExtras(PDB *pdb)
    and the PDB.extras.molid to 0
 
 -  21.07.15  Original   By: ACRM
+-  19.10.26  Allocates the extras from an arena, so they are all
+             released with the arena   By: agent
 */
-BOOL UpdatePDBExtras(PDB *pdb)
+BOOL UpdatePDBExtras(ARENA *arena, PDB *pdb)
 {
    PDB *p;
    
@@ -1811,7 +1830,8 @@ BOOL UpdatePDBExtras(PDB *pdb)
    {
       if(p->extras == NULL)
       {
-         if((p->extras = (APTR)malloc(sizeof(PDBEXTRAS)))==NULL)
+         if((p->extras = (APTR)btArenaAlloc(arena, sizeof(PDBEXTRAS)))
+            ==NULL)
             return(FALSE);
          PDBEXTRASPTR(p, PDBEXTRAS)->origAtnum = (-1);
          PDBEXTRASPTR(p, PDBEXTRAS)->molid     = 0;
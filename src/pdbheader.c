@@ -3,8 +3,8 @@
 
    \file       pdbheader.c
    
-   \version    V1.3
-   \date       22.06.15
+   \version    V1.7
+   \date       19.10.26
    \brief      Get header info from a PDB file
    
    \copyright  (c) UCL / Dr. Andrew C.R. Martin, 2015
@@ -35,7 +35,10 @@
 
    Description:
    ============
-
+   Only the header of the PDB file is read: reading stops at the first
+   coordinate record. When the chain labels are needed (i.e. neither -c
+   nor -n is given), the first model is skimmed for chain changes
+   without reading in the atoms.
 
 **************************************************************************
 
@@ -52,6 +55,13 @@
 -  V1.1  29.04.15 Added -p and fixed bug in -m
 -  V1.2  04.06.15 Fixed bug in -c
 -  V1.3  22.06.15 Added resolution info to header. With -r gives only this
+-  V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.6  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.7  19.10.26 Reads only the header of the file. Added -b for a
+                  one-line summary of each file in a list
 
 *************************************************************************/
 /* Includes
@@ -60,6 +70,9 @@
 #include <string.h>
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -81,8 +94,10 @@ int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                   char *chain, BOOL *doAll, BOOL *doSpecies,
                   BOOL *doMolecule, BOOL *noChains, BOOL *showPDB,
-                  BOOL *resolOnly);
+                  BOOL *resolOnly, BOOL *batch);
 void Usage(void);
+BOOL DoBatch(FILE *in, FILE *out);
+void PrintSummary(FILE *out, char *filename, WHOLEPDB *wpdb);
 void PrintValue(FILE *fp, char *label, int width, int type, 
                 char *string, int intval, REAL realval);
 void ProcessChain(FILE *out, WHOLEPDB *wpdb, char *chain, 
@@ -111,27 +126,34 @@ int main(int argc, char **argv)
              doMolecule = FALSE,
              noChains   = FALSE,
              showPDB    = FALSE,
-             resolOnly  = FALSE;
+             resolOnly  = FALSE,
+             batch      = FALSE;
    REAL      resolution,
              RFactor,
              FreeR;
 
+   btInitTiming(&argc, argv);
+
    if(!ParseCmdLine(argc, argv, infile, outfile, chain, &doAll,
                     &doSpecies, &doMolecule, &noChains, &showPDB,
-                    &resolOnly))
+                    &resolOnly, &batch))
    {
       Usage();
       return(0);
    }
    
-   if(!blOpenStdFiles(infile, outfile, &in, &out))
+   if(!btOpenStdFiles(infile, outfile, &in, &out))
    {
       fprintf(stderr,"Error (pdbheader): Unable to open input or output \
 file.\n");
       return(1);
    }
    
-   if((wpdb = blReadWholePDB(in))!=NULL)
+   if(batch)
+      return(DoBatch(in, out) ? 0 : 1);
+   
+   /* The atoms are only used for the chain labels                      */
+   if((wpdb = btReadWholePDBHeader(in, !noChains && !chain[0]))!=NULL)
    {
       if(doAll)
       {
@@ -204,6 +226,97 @@ file.\n");
 }
 
 
+/************************************************************************/
+/*>BOOL DoBatch(FILE *in, FILE *out)
+   ---------------------------------
+*//**
+
+   \param[in]   *in         List of PDB files, one per line
+   \param[in]   *out        Output file pointer
+   \return                  Were all the files read?
+
+   Prints a one-line summary of the header of each file in the list
+
+-  19.10.26  Original   By: agent
+*/
+BOOL DoBatch(FILE *in, FILE *out)
+{
+   WHOLEPDB *wpdb;
+   FILE     *fp;
+   char     filename[MAXBUFF];
+   BOOL     ok = TRUE;
+
+   while(fgets(filename, MAXBUFF, in))
+   {
+      TERMINATE(filename);
+      if(filename[0] == '\0')
+         continue;
+
+      if(!btOpenStdFiles(filename, NULL, &fp, NULL))
+      {
+         ok = FALSE;
+         continue;
+      }
+
+      if((wpdb = btReadWholePDBHeader(fp, FALSE)) == NULL)
+      {
+         fprintf(stderr,"Warning (pdbheader): Unable to read file: %s\n",
+                 filename);
+         ok = FALSE;
+      }
+      else
+      {
+         PrintSummary(out, filename, wpdb);
+         blFreeWholePDB(wpdb);
+      }
+      fclose(fp);
+   }
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void PrintSummary(FILE *out, char *filename, WHOLEPDB *wpdb)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]   *out        Output file pointer
+   \param[in]   *filename   Name of the PDB file
+   \param[in]   *wpdb       Whole PDB structure
+
+   Prints the filename, PDB code, date, structure type, resolution,
+   header and title separated by ' : '
+
+-  19.10.26  Original   By: agent
+*/
+void PrintSummary(FILE *out, char *filename, WHOLEPDB *wpdb)
+{
+   char header[MAXBUFF],
+        date[SMALLBUFF],
+        pdbcode[SMALLBUFF],
+        *title,
+        *sTypeStr   = "";
+   int  StrucType;
+   REAL resolution  = 0.0,
+        RFactor,
+        FreeR;
+
+   header[0] = date[0] = pdbcode[0] = '\0';
+   blGetHeaderWholePDB(wpdb, header, MAXBUFF, date, SMALLBUFF,
+                       pdbcode, SMALLBUFF);
+   if(blGetExptlWholePDB(wpdb, &resolution, &RFactor, &FreeR, 
+                         &StrucType))
+      sTypeStr = blReportStructureType(StrucType);
+   title = blGetTitleWholePDB(wpdb);
+
+   fprintf(out, "%s : %s : %s : %s : %.3f : %s : %s\n", 
+           filename, pdbcode, date, sTypeStr, resolution, header,
+           ((title != NULL) ? title : ""));
+   FREE(title);
+}
+
+
 /************************************************************************/
 /*>void ProcessChain(FILE *out, WHOLEPDB *wpdb, char *chain, 
                      BOOL doAll, BOOL doSpecies, BOOL doMolecule,
@@ -363,7 +476,7 @@ void PrintValue(FILE *fp, char *label, int width, int type,
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                      char *chain, BOOL *doAll, BOOL *doSpecies,
                      BOOL *doMolecule, BOOL *noChains, BOOL *showPDB,
-                     BOOL *resolOnly)
+                     BOOL *resolOnly, BOOL *batch)
    ----------------------------------------------------------------------
 *//**
    \param[in]   int    argc              Argument count
@@ -378,6 +491,7 @@ void PrintValue(FILE *fp, char *label, int width, int type,
    \param[out]  BOOL   *noChains         Do not print chain info
    \param[out]  BOOL   *showPDB          Show PDB code with -m or -s
    \param[out]  BOOL   *resolOnly        Show only resolution info
+   \param[out]  BOOL   *batch            Input is a list of files
    \return      BOOL                     Success
 
    Parse the command line
@@ -385,11 +499,12 @@ void PrintValue(FILE *fp, char *label, int width, int type,
    28.04.15 Original    By: ACRM
    29.04.15 Added -s and showPDB parameter
    22.06.15 Added -r and resolOnly parameter
+   19.10.26 Added -b and batch parameter   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                   char *chain, BOOL *doAll, BOOL *doSpecies,
                   BOOL *doMolecule, BOOL *noChains, BOOL *showPDB,
-                  BOOL *resolOnly)
+                  BOOL *resolOnly, BOOL *batch)
 {
    argc--;
    argv++;
@@ -430,6 +545,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          case 'r':
             *resolOnly  = TRUE;
             break;
+         case 'b':
+            *batch      = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -469,13 +587,15 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 
 -   28.04.15 Original   By: ACRM
 -   29.04.15 Added -p
+-   19.10.26 Added -b   By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbheader V1.3 (c) 2015 UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbheader V1.7 (c) 2015 UCL, Dr. Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Usage: pdbheader [-s][-m][-p][-c chain][-n][-r] \
 [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"       pdbheader -b [files.lst [out.txt]]\n");
    fprintf(stderr,"       -s Show species information rather than \
 everything\n");
    fprintf(stderr,"       -m Show molecule information rather than \
@@ -485,6 +605,8 @@ everything\n");
    fprintf(stderr,"       -n Do not show chain information - just the \
 main header\n");
    fprintf(stderr,"       -r Only show resolution information\n");
+   fprintf(stderr,"       -b Input is a list of PDB files, one per \
+line\n");
 
    fprintf(stderr,"\nParses and displays the header information from a \
 PDB file. The default\n");
@@ -499,5 +621,13 @@ compact view of\n");
    fprintf(stderr,"the species and molecule information for the chains \
 with no general\n");
    fprintf(stderr,"header information.\n\n");
+   fprintf(stderr,"With -b, one line is printed for each file giving \
+the filename, PDB\n");
+   fprintf(stderr,"code, date, structure type, resolution, header and \
+title separated by\n");
+   fprintf(stderr,"' : '.\n\n");
+   fprintf(stderr,"Reading stops at the first coordinate record, so \
+large files are handled\n");
+   fprintf(stderr,"quickly.\n\n");
 }
 
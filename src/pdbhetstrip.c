@@ -3,8 +3,8 @@
 
    \file       pdbhetstrip.c
    
-   \version    V1.3
-   \date       13.02.15
+   \version    V1.8
+   \date       19.10.26
    \brief      Strip het atoms from a PDB file. Acts as filter
    
    \copyright  (c) Dr. Andrew C. R. Martin 1995-2015
@@ -51,6 +51,15 @@
                   Added doxygen annotation. By: CTP
 -  V1.2  06.11.14 Renamed from hetstrip By: ACRM
 -  V1.3  13.02.15 Added whole PDB support
+-  V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.6  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.8  19.10.26 Added -s to filter the file as a stream in constant
+                  memory
 
 *************************************************************************/
 /* Includes
@@ -64,6 +73,11 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -79,7 +93,9 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
+BOOL KeepAtom(char *record, void *data);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -92,6 +108,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
 -  15.07.94 Now writes TER cards and returns 0 correctly
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Added whole PDB support  By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -100,14 +117,27 @@ int main(int argc, char **argv)
              *out = stdout;
    char      infile[MAXBUFF],
              outfile[MAXBUFF];
+   int       natoms;
+   BOOL      stream = FALSE;
 
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDBAtoms(in))!=NULL)
+         if(stream && btCanFilterPDB(in))
+         {
+            if(!btFilterPDB(in, out, FALSE, KeepAtom, NULL, &natoms))
+            {
+               fprintf(stderr,"Error: Failed while filtering the PDB \
+file\n");
+               return(1);
+            }
+         }
+         else if((wpdb=btReadWholePDBAtoms(in))!=NULL)
          {
-            blWriteWholePDB(out,wpdb);
+            btWriteWholePDB(out, wpdb);
          }
       }
    }
@@ -121,7 +151,8 @@ int main(int argc, char **argv)
 }
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *stream)
    ----------------------------------------------------------------------
 *//**
 
@@ -129,13 +160,16 @@ int main(int argc, char **argv)
    \param[in]      **argv      Argument array
    \param[out]     *infile     Input filename (or blank string)
    \param[out]     *outfile    Output filename (or blank string)
+   \param[out]     *stream     Filter the file as a stream
    \return                     Success
 
    Parse the command line
 
 -  16.08.94 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
@@ -151,6 +185,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
          case 'h':
             return(FALSE);
             break;
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -180,6 +217,25 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
    return(TRUE);
 }
 
+/************************************************************************/
+/*>BOOL KeepAtom(char *record, void *data)
+   ---------------------------------------
+*//**
+
+   \param[in]  *record   ATOM or HETATM record
+   \param[in]  *data     Unused
+   \return               Is this an ATOM record?
+
+   Record filter for -s
+
+-  19.10.26 Original    By: agent
+*/
+BOOL KeepAtom(char *record, void *data)
+{
+   return(strncmp(record, "HETATM", 6) != 0);
+}
+
+
 /************************************************************************/
 /*>void Usage(void)
    ----------------
@@ -194,10 +250,18 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 */
 void Usage(void)
 {            
-   fprintf(stderr,"\npdbhetstrip V1.3 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbhetstrip V1.8 (c) 1994-2015, Andrew C.R. \
 Martin, UCL\n");
-   fprintf(stderr,"Usage: pdbhetstrip [<in.pdb> [<out.pdb>]]\n\n");
+   fprintf(stderr,"Usage: pdbhetstrip [-s] [<in.pdb> [<out.pdb>]]\n");
+   fprintf(stderr,"       -s Stream the file, copying the records that \
+are kept unchanged\n\n");
    fprintf(stderr,"Removes het atoms from a PDB file. I/O is through \
 stdin/stdout if files\n");
    fprintf(stderr,"are not specified.\n\n");
+   fprintf(stderr,"With -s, memory use does not depend on the size of \
+the file. All models\n");
+   fprintf(stderr,"are filtered, the header and trailer are copied \
+verbatim (so CONECTs\n");
+   fprintf(stderr,"to het atoms are kept) and binary PDB or PDBML \
+input is read as normal.\n\n");
 }
@@ -3,8 +3,8 @@
 
    \file       pdbhphob.c
    
-   \version    V1.0
-   \date       24.09.18
+   \version    V1.3
+   \date       19.10.26
    \brief      Patches hydrophobicity data into B-value column of PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 2018
@@ -49,6 +49,11 @@
    =================
 
 -  V1.0  24.09.18 Original based on older FORTRan code
+-  V1.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.2  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.3  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -58,6 +63,9 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -109,14 +117,15 @@ int main(int argc, char **argv)
    PDB     *pdb    = NULL;
    HPHOB   hphob[MAXAATYPES];
 
+   btInitTiming(&argc, argv);
    
    if(ParseCmdLine(argc, argv, inFile, outFile, hphobFile))
    {
       if(ReadHPhobFile(hphobFile, hphob, MAXAATYPES))
       {
-         if(blOpenStdFiles(inFile, outFile, &in, &out))
+         if(btOpenStdFiles(inFile, outFile, &in, &out))
          {
-            if((pdb=blReadPDB(in, &natoms))!=NULL)
+            if((pdb=btReadPDB(in, &natoms))!=NULL)
             {
                PatchHPhob(pdb, hphob);
                blWritePDB(out, pdb);
@@ -356,7 +365,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   printf("\npdbhphob V1.0 (c) 2018 UCL, Dr. Andrew C.R. Martin\n");
+   printf("\npdbhphob V1.3 (c) 2018 UCL, Dr. Andrew C.R. Martin\n");
 
    printf("\nUsage: pdbhphob [-d datafile] [in.pdb [out.txt]]\n");
    printf("       -d Specify hydrophobicity data file [Default: %s]\n",
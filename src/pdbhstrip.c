@@ -3,8 +3,8 @@
 
    \file       pdbhstrip.c
    
-   \version    V1.4
-   \date       13.02.15
+   \version    V1.8
+   \date       19.10.26
    \brief      Strip hydrogens from a PDB file. Acts as filter
    
    \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
@@ -53,6 +53,13 @@
 -  V1.3  06.11.14 Renamed from hstrip  By: ACRM
 -  V1.4  13.02.15 Added whole PDB support and re-written to use
                   blStripHPDBAsCopy()
+-  V1.5  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.6  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.8  19.10.26 Added -s to filter the file as a stream in constant
+                  memory
 
 *************************************************************************/
 /* Includes
@@ -60,11 +67,16 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "bioplib/MathType.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 
 /************************************************************************/
@@ -80,6 +92,7 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
+BOOL KeepNonHydrogen(char *record, void *data);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -93,12 +106,17 @@ void Usage(void);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Added whole PDB support and re-written to use
             blStripHPDBAsCopy()  By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
    WHOLEPDB *wpdb;
    FILE     *in  = stdin, 
             *out = stdout;
+   int      natoms;
+   BOOL     stream = FALSE;
+
+   btInitTiming(&argc, argv);
 
    argc--;
    argv++;
@@ -113,6 +131,9 @@ int main(int argc, char **argv)
             Usage();
             return(0);
             break;
+         case 's':
+            stream = TRUE;
+            break;
          default:
             Usage();
             return(1);
@@ -156,22 +177,71 @@ int main(int argc, char **argv)
       return(1);
    }
 
-   if((wpdb=blReadWholePDB(in))!=NULL)
+   if(stream && btCanFilterPDB(in))
+   {
+      if(!btFilterPDB(in, out, FALSE, KeepNonHydrogen, NULL, &natoms))
+      {
+         fprintf(stderr,"Error: Failed while filtering the PDB file\n");
+         return(1);
+      }
+      return(0);
+   }
+
+   if((wpdb=btReadWholePDB(in))!=NULL)
    {
       PDB *pdbin  = NULL,
           *pdbout = NULL;
-      int natoms;
       pdbin  = wpdb->pdb;
       pdbout = blStripHPDBAsCopy(pdbin, &natoms);
       FREELIST(pdbin, PDB);
       wpdb->pdb = pdbout;
 
-      blWriteWholePDB(out, wpdb);
+      btWriteWholePDB(out, wpdb);
    }
 
    return(0);
 }
 
+/************************************************************************/
+/*>BOOL KeepNonHydrogen(char *record, void *data)
+   ----------------------------------------------
+*//**
+
+   \param[in]  *record   ATOM or HETATM record
+   \param[in]  *data     Unused
+   \return               Is this not a hydrogen (or deuterium)?
+
+   Record filter for -s. The element field is used where there is one,
+   otherwise the first letter of the atom name.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL KeepNonHydrogen(char *record, void *data)
+{
+   char element[3],
+        *name;
+   int  i, j,
+        len = strlen(record);
+
+   for(i=76, j=0; (i<78) && (i<len); i++)
+   {
+      if((record[i] != ' ') && (record[i] != '\n') && (record[i] != '\r'))
+         element[j++] = record[i];
+   }
+   element[j] = '\0';
+
+   if(j)
+      return(strcmp(element, "H") && strcmp(element, "D"));
+
+   /* No element: skip the leading blank or digit of the atom name      */
+   if(len < 16)
+      return(TRUE);
+   for(name=record+12;
+       (name<record+16) && ((*name==' ') || isdigit(*name));
+       name++);
+   return(*name != 'H');
+}
+
 /************************************************************************/
 /*>void Usage(void)
    ----------------
@@ -186,10 +256,18 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {            
-   fprintf(stderr,"\npdbhstrip V1.4 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\npdbhstrip V1.8 (c) 1994-2015, Andrew C.R. Martin, \
 UCL\n");
-   fprintf(stderr,"Usage: pdbhstrip [in.pdb [out.pdb]]\n\n");
+   fprintf(stderr,"Usage: pdbhstrip [-s] [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"       -s Stream the file, copying the records that \
+are kept unchanged\n\n");
    fprintf(stderr,"Removes hydrogens from a PDB file. I/O is through \
 stdin/stdout if files\n");
    fprintf(stderr,"are not specified.\n\n");
+   fprintf(stderr,"With -s, memory use does not depend on the size of \
+the file. All models\n");
+   fprintf(stderr,"are filtered, the header and trailer are copied \
+verbatim (so CONECTs\n");
+   fprintf(stderr,"to hydrogens are kept) and binary PDB or PDBML \
+input is read as normal.\n\n");
 }
@@ -3,8 +3,8 @@
 
    \file       pdbline.c
    
-   \version    V1.2
-   \date       24.10.14
+   \version    V1.5
+   \date       19.10.26
    \brief      Draws a best fit line through a specified set of CA atoms
    
    \copyright  (c) Dr. Andrew C. R. Martin, UCL, 2014
@@ -53,6 +53,11 @@
 -  V1.2   24.10.14 Fixed bug in plotting line when Eigen vector had X 
                    dimension close to zero. Added -v option
                    Moved regression code into BiopLib
+-  V1.3   19.10.26 Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+-  V1.4   19.10.26 Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-  V1.5   19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -68,6 +73,9 @@
 #include "bioplib/MathType.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/regression.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -119,6 +127,7 @@ int main(int argc, char **argv)
            resnam[MAXBUFF],
            atnam[MAXBUFF];
    
+   btInitTiming(&argc, argv);
 
    strcpy(resnam, DEF_RESNAM);
    PADMINTERM(resnam, 4);
@@ -128,10 +137,10 @@ int main(int argc, char **argv)
    if(ParseCmdLine(argc, argv, infile, outfile, firstRes, lastRes, resnam,
                    atnam, &verbose))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          /* Read PDB file                                               */
-         if((pdb = blReadPDB(in, &natoms)) == NULL)
+         if((pdb = btReadPDB(in, &natoms)) == NULL)
          {
             fprintf(stderr, "No atoms read from PDB file.\n");
             retval = 1;
@@ -471,7 +480,7 @@ BOOL DrawPDBRegressionLine(FILE *wfp, REAL **coordinates,
 */
 void Usage(void)
 {
-   printf("\npdbline V1.2 (c) 2014 UCL, Dr. Andrew C.R. Martin\n");
+   printf("\npdbline V1.5 (c) 2014 UCL, Dr. Andrew C.R. Martin\n");
    printf("        With contributions from Abhi Raghavan and Saba \
 Ferdous\n");
 
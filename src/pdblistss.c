@@ -3,8 +3,8 @@
 
    \file       pdblistss.c
    
-   \version    V1.1
-   \date       13.03.19
+   \version    V1.6
+   \date       19.10.26
    \brief      List disulphide bonds
    
    \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2019
@@ -38,6 +38,11 @@
    Displays a list of disulphides based on calculated distances rather 
    than SSBOND or CONECT record data
 
+   Only the CYS SG records are passed to the PDB reader, so the file is
+   effectively scanned as text. The SG atoms are then placed in a small
+   spatial grid to find the candidate pairs. With -a every model of a
+   multi-model file is processed in turn.
+
 **************************************************************************
 
    Usage:
@@ -49,6 +54,18 @@
    =================
 -   V1.0   20.07.15 Original   By: ACRM
 -   V1.1   13.03.19 Fixed some buffer sizes
+-   V1.2   19.10.26 Prefilters CYS SG records as text and uses a spatial
+                    grid to find pairs. Added -a to handle all models
+                    By: agent
+-   V1.3   19.10.26 Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c
+-   V1.4   19.10.26 Opens files with btOpenStdFiles() so compressed
+                    input and output are handled in-process
+-   V1.5   19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
+-   V1.6   19.10.26 No limit on the partners of an SG atom. The text
+                    prefilter accepts any spacing of the atom and
+                    residue names
 
 *************************************************************************/
 /* Includes
@@ -61,6 +78,10 @@
 #include "bioplib/macros.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/spatial.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -68,6 +89,10 @@
 #define MAXBUFF 160
 /* Ideal disulphide S-S length is 2.03A - we'll allow 2.25A             */
 #define DISULPHIDE_CUTOFFSQ    5.0625
+#define DISULPHIDE_CUTOFF      2.25
+
+#define ISCYSSG(p) (!strncmp((p)->resnam,"CYS",3) && \
+                    !strncmp((p)->atnam, "SG  ",4))
 
 
 /************************************************************************/
@@ -78,9 +103,12 @@
 /* Prototypes
 */
 int  main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *allModels);
 void Usage(void);
 void ListDisulphides(FILE *out, PDB *pdb);
+BOOL ReadModelSG(FILE *in, PDB **pdb, int *modelNum, BOOL *gotAtoms);
+BOOL MayBeCysSG(char *record);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -89,42 +117,166 @@ void ListDisulphides(FILE *out, PDB *pdb);
    Main program for finding disulphides
 
 -  20.07.15 Original   By: ACRM
+-  19.10.26 Reads just the SG atoms a model at a time and handles -a
+            By: agent
 */
 int main(int argc, char **argv)
 {
-   FILE     *in     = stdin,
-            *out    = stdout;
-   int      natoms;
+   FILE     *in       = stdin,
+            *out      = stdout;
    PDB      *pdb;
+   int      modelNum  = 0;
    char     infile[MAXBUFF],
             outfile[MAXBUFF];
+   BOOL     allModels = FALSE,
+            gotAtoms  = FALSE;
    
-   if(!ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(!ParseCmdLine(argc, argv, infile, outfile, &allModels))
    {
       Usage();
       return(0);
    }
 
-   if(!blOpenStdFiles(infile, outfile, &in, &out))
+   if(!btOpenStdFiles(infile, outfile, &in, &out))
    {
       fprintf(stderr, "Error (pdblistss): Unable to open input or output \
 file\n");
       return(1);
    }
 
-   if((pdb = blReadPDBAtoms(in, &natoms))==NULL)
+   while(ReadModelSG(in, &pdb, &modelNum, &gotAtoms))
+   {
+      if(allModels && modelNum)
+         fprintf(out, "MODEL %d\n", modelNum);
+      
+      if(pdb != NULL)
+      {
+         ListDisulphides(out, pdb);
+
+         /* Free up the memory for the PDB linked list                  */
+         FREELIST(pdb, PDB);
+      }
+
+      if(!allModels)
+         break;
+   }
+
+   if(!gotAtoms)
    {
       fprintf(stderr, "Error (pdblistss): No atoms read from PDB \
 file, %s\n", infile);
       return(1);
    }
 
-   ListDisulphides(out, pdb);
+   return(0);
+}
 
-   /* Free up the memory for the PDB linked list                        */
-   FREELIST(pdb, PDB);
 
-   return(0);
+/************************************************************************/
+/*>BOOL ReadModelSG(FILE *in, PDB **pdb, int *modelNum, BOOL *gotAtoms)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   *in        Input file pointer
+   \param[out]  **pdb      PDB linked list of the CYS SG atoms in the 
+                           model (NULL if there are none)
+   \param[out]  *modelNum  Model number from the MODEL record (0 if 
+                           there is none)
+   \param[out]  *gotAtoms  Set to TRUE if any ATOM records are seen
+   \return                 FALSE if there were no more models
+
+   Reads the next model (or the whole file if there are no MODEL 
+   records). Only the ATOM records that may be CYS SG atoms are copied
+   to a temporary file which is then read with blReadPDBAtoms() so
+   alternate positions etc. are handled as normal while the rest of
+   the structure is never parsed.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Uses MayBeCysSG() rather than requiring exact columns
+*/
+BOOL ReadModelSG(FILE *in, PDB **pdb, int *modelNum, BOOL *gotAtoms)
+{
+   char buffer[MAXBUFF];
+   FILE *tmp;
+   int  natoms;
+   BOOL gotModel = FALSE;
+   
+   *pdb = NULL;
+   
+   if((tmp = tmpfile())==NULL)
+   {
+      fprintf(stderr, "Error (pdblistss): Unable to open temporary \
+file\n");
+      return(FALSE);
+   }
+   
+   while(fgets(buffer, MAXBUFF, in))
+   {
+      if(!strncmp(buffer, "MODEL ", 6))
+      {
+         gotModel = TRUE;
+         if(sscanf(buffer+6, "%d", modelNum) != 1)
+            (*modelNum)++;
+      }
+      else if(!strncmp(buffer, "ENDMDL", 6))
+      {
+         break;
+      }
+      else if(!strncmp(buffer, "ATOM  ", 6))
+      {
+         gotModel  = TRUE;
+         *gotAtoms = TRUE;
+         if(MayBeCysSG(buffer))
+         {
+            fputs(buffer, tmp);
+         }
+      }
+   }
+
+   if(gotModel)
+   {
+      rewind(tmp);
+      *pdb = btReadPDBAtoms(tmp, &natoms);
+   }
+   fclose(tmp);
+   
+   return(gotModel);
+}
+
+
+/************************************************************************/
+/*>BOOL MayBeCysSG(char *record)
+   ------------------------------
+*//**
+   \param[in]   *record   ATOM record
+   \return               Could this be a CYS SG atom?
+
+   A loose test used to skip records before they are parsed. The atom
+   name field (with the alternate position column) need only contain
+   SG and the residue name field CYS, so odd spacing that the PDB
+   reader accepts still gets through. ISCYSSG() makes the real test
+   once the atoms have been read.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL MayBeCysSG(char *record)
+{
+   char atnam[8],
+        resnam[8];
+   int  len = strlen(record);
+
+   if(len < 21)
+      return(FALSE);
+
+   /* Columns 13-17 and 17-21                                           */
+   strncpy(atnam,  record+12, 5);
+   atnam[5]  = '\0';
+   strncpy(resnam, record+16, 5);
+   resnam[5] = '\0';
+
+   return((strstr(atnam, "SG") != NULL) &&
+          (strstr(resnam, "CYS") != NULL));
 }
 
 
@@ -137,58 +289,119 @@ file, %s\n", infile);
 
    Does the actual work of finding and printing the disulphides
 
+   The CYS SG atoms are collected into an array and placed in a 
+   spatial grid with the cell size equal to the cutoff. Partners of
+   each SG are sorted so that the output order is as for a simple
+   scan of the list.
+
 -  20.07.15   Original   By: ACRM
 -  13.03.19   Increased resid size from 16 to 32
+-  19.10.26   Uses a spatial grid of the SG atoms   By: agent
+-  19.10.26   The partner list is sized by the number of SG atoms
+              rather than being limited to MAXPARTNERS
 */
 void ListDisulphides(FILE *out, PDB *pdb)
 {
-   PDB *p, *q;
+   PDB         *p, 
+               **sg;
+   SPATIALGRID *grid;
+   GRIDQUERY   query;
+   int         nsg = 0,
+               *partner,
+               npartners,
+               i, j, k;
 
    for(p=pdb; p!=NULL; NEXT(p))
    {
-      if(!strncmp(p->resnam,"CYS",3) &&
-         !strncmp(p->atnam, "SG  ",4))
+      if(ISCYSSG(p))
+         nsg++;
+   }
+   if(nsg < 2)
+      return;
+
+   sg      = (PDB **)malloc(nsg * sizeof(PDB *));
+   partner = (int *)malloc(nsg * sizeof(int));
+   if((sg == NULL) || (partner == NULL))
+   {
+      fprintf(stderr, "Error (pdblistss): No memory for SG atoms\n");
+      FREE(sg);
+      FREE(partner);
+      return;
+   }
+   for(p=pdb, nsg=0; p!=NULL; NEXT(p))
+   {
+      if(ISCYSSG(p))
+         sg[nsg++] = p;
+   }
+
+   if((grid = btBuildSpatialGrid(sg, nsg, DISULPHIDE_CUTOFF))==NULL)
+   {
+      fprintf(stderr, "Error (pdblistss): No memory for spatial grid\n");
+      free(sg);
+      free(partner);
+      return;
+   }
+
+   for(i=0; i<nsg; i++)
+   {
+      REAL distSq;
+
+      /* Find the later SG atoms in range, keeping them in order        */
+      npartners = 0;
+      btStartGridQuery(&query, grid, sg[i]->x, sg[i]->y, sg[i]->z,
+                       DISULPHIDE_CUTOFFSQ);
+      while((j = btNextGridNeighbour(&query, &distSq)) >= 0)
       {
-         for(q=p->next; q!=NULL; NEXT(q))
+         if((j > i) && (distSq < DISULPHIDE_CUTOFFSQ))
          {
-            if(!strncmp(q->resnam,"CYS",3) &&
-               !strncmp(q->atnam, "SG  ",4))
-            {
-               if(DISTSQ(p,q) < DISULPHIDE_CUTOFFSQ)
-               {
-                  char resid1[32],
-                       resid2[32];
-                  MAKERESID(resid1, p);
-                  MAKERESID(resid2, q);
-
-                  fprintf(out, "%6s Atom %5d : %6s Atom %5d : %.3f\n", 
-                          resid1, p->atnum,
-                          resid2, q->atnum,
-                          DIST(p,q));
-               }
-            }
+            for(k=npartners; (k > 0) && (partner[k-1] > j); k--)
+               partner[k] = partner[k-1];
+            partner[k] = j;
+            npartners++;
          }
       }
+
+      for(k=0; k<npartners; k++)
+      {
+         char resid1[32],
+              resid2[32];
+         PDB  *q = sg[partner[k]];
+         
+         MAKERESID(resid1, sg[i]);
+         MAKERESID(resid2, q);
+
+         fprintf(out, "%6s Atom %5d : %6s Atom %5d : %.3f\n", 
+                 resid1, sg[i]->atnum,
+                 resid2, q->atnum,
+                 DIST(sg[i],q));
+      }
    }
 
+   btFreeSpatialGrid(grid);
+   free(sg);
+   free(partner);
 }
 
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *allModels)
    ----------------------------------------------------------------------
 *//**
    \param[in]   int    argc              Argument count
    \param[in]   char   **argv            Argument array
    \param[out]  char   *infile           Input filename (or blank string)
    \param[out]  char   *outfile          Output filename (or blank string)
+   \param[out]  BOOL   *allModels        Process all models
    \return      BOOL                     Success
 
    Parse the command line
 
 -  20.07.14 Original    By: ACRM
+-  19.10.26 Added -a   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *allModels)
 {
    argc--;
    argv++;
@@ -204,6 +417,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
          case 'h':
             return(FALSE);
             break;
+         case 'a':
+            *allModels = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -243,13 +459,16 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 
 -  20.07.15 Original   By: ACRM
 -  13.03.19 V1.1
+-  19.10.26 V1.2   By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdblistss V1.1 (c) 2015-2019 UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdblistss V1.6 (c) 2015-2026 UCL, Dr. Andrew C.R. \
 Martin\n");
 
-   fprintf(stderr,"\nUsage: pdblistss [in.pdb [out.txt]]\n");
+   fprintf(stderr,"\nUsage: pdblistss [-a] [in.pdb [out.txt]]\n");
+   fprintf(stderr,"       -a  Process all models, each preceded by a \
+MODEL line\n");
 
    fprintf(stderr,"\nDisplays a list of disulphides based on calculated \
 distances rather\n");
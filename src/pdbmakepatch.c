@@ -3,8 +3,8 @@
 
    \file       pdbmakepatch.c
    
-   \version    V1.12
-   \date       12.03.15
+   \version    V1.15
+   \date       19.10.26
    \brief      Build patches around a surface atom
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-2017
@@ -81,6 +81,11 @@
 -  V1.10 06.11.14  Renamed from makepatch
 -  V1.11 12.03.15  Changed to allow multi-character chain names
 -  V1.12 21.11.17  Updated usage to explain use with pdbsolv
+-  V1.13 19.10.26  Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+-  V1.14 19.10.26  Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-  V1.15 19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -91,6 +96,9 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 
 /************************************************************************/
@@ -174,12 +182,14 @@ int main(int argc, char **argv)
    BOOL summary,
         ringOnly;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, CentreRes, CentreAtom, InFile, OutFile,
                    &radius, &tolerance, &summary, &ringOnly, &minAccess))
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natom))==NULL)
+         if((pdb=btReadPDB(in, &natom))==NULL)
          {
             fprintf(stderr,"pdbmakepatch: (Error) No atoms read from PDB \
 file\n");
@@ -244,7 +254,7 @@ file\n");
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbmakepatch V1.12 Andrew C.R. Martin, Anja \
+   fprintf(stderr,"\npdbmakepatch V1.15 Andrew C.R. Martin, Anja \
 Baresic, UCL 2009-2017\n");
 
    fprintf(stderr,"\nUsage: pdbmakepatch [-r radius] [-t tolerance] [-c] \
@@ -3,8 +3,8 @@
 
    \file       pdbml2pdb.c
    
-   \version    V1.0
-   \date       25.06.15
+   \version    V1.6
+   \date       19.10.26
    \brief      Convert PDBML format to PDB
    
    \copyright  (c) Dr. Andrew C. R. Martin 2015
@@ -36,6 +36,16 @@
 
    Description:
    ============
+   PDBML input is read with the streaming SAX reader in
+   common/pdbmlread.c so that no XML document tree is built. By default
+   the structure is read into memory and written with its header. With
+   -s, atoms are written as they are parsed so memory use is constant.
+
+   Either way, the conversion stops with an error if an atom cannot be
+   represented in PDB format (a chain label of more than one character
+   or an atom number over 99999). With -s, the atoms before it will
+   already have been written. A warning is given if models after the
+   first were dropped.
 
 **************************************************************************
 
@@ -47,19 +57,45 @@
    Revision History:
    =================
 -  V1.0  25.06.15 Original
+-  V1.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.2  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.3  19.10.26 Reads PDBML with the streaming reader in
+                  common/pdbmlread.c. Added -s
+-  V1.4  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.5  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.6  19.10.26 Checks that atoms are suitable for PDB format (also
+                  with -s) and warns if models were dropped
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/pdbread.h"
+#include "common/pdbmlread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
-#define MAXBUFF 256
+#define MAXBUFF    256
+#define MAXPDBATNUM 99999
+
+typedef struct
+{
+   FILE *out;
+   char chain[blMAXCHAINLABEL];
+   BOOL first;
+}  STREAMOUT;
 
 /************************************************************************/
 /* Globals
@@ -70,7 +106,11 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
+BOOL WriteAtom(PDB *p, void *data);
+BOOL SuitableForPDB(PDB *p);
+void WarnDroppedModels(void);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -80,23 +120,64 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
    Main program
 
 -  25.06.15 Original    By: ACRM
+-  19.10.26 PDBML is read with btReadWholePDBML(). Added streaming
+            By: agent
+-  19.10.26 Checks the atoms with SuitableForPDB() and warns about
+            dropped models
 */
 int main(int argc, char **argv)
 {
-   FILE     *in      = stdin,
-            *out     = stdout;
-   WHOLEPDB *wpdb;
-   char     infile[MAXBUFF],
-            outfile[MAXBUFF];
+   FILE      *in      = stdin,
+             *out     = stdout;
+   WHOLEPDB  *wpdb;
+   PDB       *p;
+   STREAMOUT streamOut;
+   char      infile[MAXBUFF],
+             outfile[MAXBUFF];
+   BOOL      stream   = FALSE,
+             isPDBML;
 
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))!=NULL)
+         isPDBML = btIsPDBML(in);
+         if(stream && isPDBML)
+         {
+            streamOut.out   = out;
+            streamOut.first = TRUE;
+            if(!btStreamPDBML(in, FALSE, WriteAtom, (void *)&streamOut))
+               return(1);
+            if(streamOut.first)
+            {
+               fprintf(stderr,"No atoms read from PDB file\n");
+               return(1);
+            }
+            fprintf(out, "TER   \n");
+            fprintf(out, "END   \n");
+            WarnDroppedModels();
+            return(0);
+         }
+
+         if(isPDBML)
+            wpdb = btReadWholePDBML(in, FALSE);
+         else
+            wpdb = btReadWholePDB(in);
+
+         if(wpdb!=NULL)
          {
+            for(p=wpdb->pdb; p!=NULL; NEXT(p))
+            {
+               if(!SuitableForPDB(p))
+                  return(1);
+            }
+            if(isPDBML)
+               WarnDroppedModels();
+
             FORCEPDB;
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -121,23 +202,41 @@ int main(int argc, char **argv)
    Prints a usage message
 
 -  26.02.15 Original    By: ACRM
+-  19.10.26 Describes the format check and dropped data   By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbml2pdb V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdbml2pdb V1.6  (c) 2015 UCL, Andrew C.R. \
 Martin\n");
-   fprintf(stderr,"Usage: pdbml2pdb [<input.pdb> [<output.pdb>]]\n");
+   fprintf(stderr,"Usage: pdbml2pdb [-s] [<input.pdb> \
+[<output.pdb>]]\n");
+   fprintf(stderr,"       -s Stream the atoms straight to the output \
+with no header\n");
    fprintf(stderr,"I/O is to stdin/stdout if not specified\n\n");
    fprintf(stderr,"Converts a PDBML file to PDB format.\n");
    fprintf(stderr,"The file will only be converted if it is suitable \
-for PDB format\n");
-   fprintf(stderr,"\nNote that only key header information is retained \
-at present\n\n");
+for PDB format (no\n");
+   fprintf(stderr,"chain labels longer than one character or atom \
+numbers over %d). With\n", MAXPDBATNUM);
+   fprintf(stderr,"-s, the atoms before an unsuitable one will already \
+have been written.\n");
+   fprintf(stderr,"\nNote that only key header information (HEADER, \
+TITLE and EXPDTA) is\n");
+   fprintf(stderr,"retained at present (none with -s). Only the first \
+model is converted;\n");
+   fprintf(stderr,"a warning is given if there were others.\n");
+   fprintf(stderr,"\nThe PDBML file is parsed as a stream rather than \
+being read into\n");
+   fprintf(stderr,"memory as an XML tree. With -s, atoms are also written \
+as they are\n");
+   fprintf(stderr,"read, so memory use does not grow with the size of \
+the structure.\n\n");
 }
 
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *stream)
    ---------------------------------------------------------------------
 *//**
 
@@ -145,13 +244,16 @@ at present\n\n");
    \param[in]      **argv       Argument array
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *stream      Write atoms as they are read
    \return                      Success?
 
    Parse the command line
    
 -  25.06.15 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
@@ -164,6 +266,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       {
          switch(argv[0][1])
          {
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -193,3 +298,85 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
    return(TRUE);
 }
 
+
+/************************************************************************/
+/*>BOOL WriteAtom(PDB *p, void *data)
+   ----------------------------------
+*//**
+
+   \param[in]      *p           Atom from the PDBML file
+   \param[in,out]  *data        STREAMOUT output details
+   \return                      Success?
+
+   Callback for btStreamPDBML(). Writes and frees the atom, with a TER
+   card at each change of chain. Stops the parse if the atom is not
+   suitable for PDB format.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Checks the atom with SuitableForPDB()
+*/
+BOOL WriteAtom(PDB *p, void *data)
+{
+   STREAMOUT *streamOut = (STREAMOUT *)data;
+
+   if(!SuitableForPDB(p))
+   {
+      free(p);
+      return(FALSE);
+   }
+
+   if(!streamOut->first && strcmp(p->chain, streamOut->chain))
+      fprintf(streamOut->out, "TER   \n");
+   streamOut->first = FALSE;
+   strcpy(streamOut->chain, p->chain);
+
+   blWritePDBRecord(streamOut->out, p);
+   free(p);
+   return(!ferror(streamOut->out));
+}
+
+
+/************************************************************************/
+/*>BOOL SuitableForPDB(PDB *p)
+   ---------------------------
+*//**
+
+   \param[in]      *p           Atom
+   \return                      Can the atom be written in PDB format?
+
+   Prints an error if not. Used for both the streamed and the 
+   whole-structure conversion so the check and message are the same.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL SuitableForPDB(PDB *p)
+{
+   if((strlen(p->chain) > 1) || (p->atnum > MAXPDBATNUM))
+   {
+      fprintf(stderr,"Error (pdbml2pdb): The file is not suitable for \
+PDB format. Atom %d in\n", p->atnum);
+      fprintf(stderr,"                   chain %s has a chain label of \
+more than one character or\n", p->chain);
+      fprintf(stderr,"                   an atom number over %d\n",
+              MAXPDBATNUM);
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void WarnDroppedModels(void)
+   ----------------------------
+*//**
+
+   Warns if the PDBML reader skipped models after the first
+
+-  19.10.26 Original    By: agent
+*/
+void WarnDroppedModels(void)
+{
+   if(gPDBMultiNMR > 1)
+      fprintf(stderr,"Warning (pdbml2pdb): Only the first of %d models \
+was converted\n", (int)gPDBMultiNMR);
+}
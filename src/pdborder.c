@@ -3,8 +3,8 @@
 
    \file       pdborder.c
    
-   \version    V1.8
-   \date       13.03.19
+   \version    V1.13
+   \date       19.10.26
    \brief      Correct the atom order in a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin, UCL 1994-2019
@@ -56,6 +56,15 @@
 -  V1.6  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
 -  V1.7  12.03.15 Changed to allow multi-character chain names
 -  V1.8  13.03.19 Fixed possible unterminated string
+-  V1.9  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.10 19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.11 19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.12 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.13 19.10.26 Resets its globals and frees the atom lists so it can
+                  run more than once in a bioptools pipeline
 
 *************************************************************************/
 /* Includes
@@ -69,6 +78,10 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -84,6 +97,7 @@
 /* Globals
 */
 char ***gAtomLists = NULL;
+int  gNAtomLists = 0;
 BOOL gVerbose = FALSE,
      gWarnH   = FALSE;
 
@@ -126,11 +140,13 @@ int main(int argc, char **argv)
    BOOL     COLast    = FALSE,
             GromosILE = FALSE;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &COLast, &GromosILE))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
 
@@ -153,7 +169,7 @@ lists\n");
 hydrogens missing.\n");
                   }
                }
-               blWriteWholePDB(out, wpdb);
+               btWriteWholePDB(out, wpdb);
             }
          }
          else
@@ -190,6 +206,7 @@ hydrogens missing.\n");
    
 -  23.08.94 Original    By: ACRM
 -  24.08.94 Added verbose option
+-  19.10.26 Also resets gWarnH   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   BOOL *COLast, BOOL *GromosILE)
@@ -201,6 +218,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    *COLast    = FALSE;
    *GromosILE = FALSE;
    gVerbose   = FALSE;
+   gWarnH     = FALSE;
    
    while(argc)
    {
@@ -269,7 +287,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdborder V1.8 (c) 1994-2019, Andrew C.R. Martin, \
+   fprintf(stderr,"\npdborder V1.13 (c) 1994-2019, Andrew C.R. Martin, \
 UCL\n\n");
    fprintf(stderr,"Usage: pdborder [-c] [-i] [-g] [in.pdb \
 [out.pdb]]\n");
@@ -795,9 +813,11 @@ BOOL GotSomeHydrogens(PDB *pdb)
    \return                    Success?
 
    Initializes the global atom name array. We can't just use the static
-   hard-coded version since we need to write to it for Gromos ILE CD
+   hard-coded version since we need to write to it for Gromos ILE CD.
+   Any array from a previous run (in a bioptools pipeline) is freed.
 
 -  13.02.15  Original   By: ACRM
+-  19.10.26  Frees the previous array   By: agent
 */
 BOOL InitializeGlobalAtomLists(void)
 {
@@ -867,12 +887,19 @@ BOOL InitializeGlobalAtomLists(void)
    for(nres=0; atomLists[nres][0] != NULL; nres++);
    nres++;
 
+   if(gAtomLists != NULL)
+   {
+      blFreeArray3D((char ***)gAtomLists, gNAtomLists, MAXATOMS);
+      gAtomLists = NULL;
+   }
+
    /* Creat the malloc'd 3D array                                       */
    if((gAtomLists = (char ***)blArray3D(sizeof(char), nres, 
                                         MAXATOMS, MAXATNAM))==NULL)
    {
       return(FALSE);
    }
+   gNAtomLists = nres;
 
    /* Copy in the names                                                 */
    for(res=0; res<nres; res++)
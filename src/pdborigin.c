@@ -3,8 +3,8 @@
 
    \file       pdborigin.c
    
-   \version    V1.2
-   \date       13.02.15
+   \version    V1.7
+   \date       19.10.26
    \brief      Add hydrogens to a PDB file
    
    \copyright  (c) UCL, Dr. Andrew C. R. Martin 1999-2015
@@ -50,6 +50,15 @@
 -  V1.1  22.07.14 Renamed deprecated functions with bl prefix.
                   Added doxygen annotation. By: CTP
 -  V1.2  13.02.15 Added whole PDB support  By: ACRM
+-  V1.3  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.4  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.5  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.6  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.7  19.10.26 Added -s to move the file as a stream in constant
+                  memory
 
 *************************************************************************/
 /* Includes
@@ -63,6 +72,11 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -77,7 +91,8 @@
 /* Prototypes
 */
 int main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
 void Usage(void);
 
 /************************************************************************/
@@ -90,6 +105,7 @@ void Usage(void);
 -  28.01.99 Original    By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Added whole PDB support  By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -99,16 +115,44 @@ int main(int argc, char **argv)
             outfile[MAXBUFF];
    WHOLEPDB *wpdb;
    PDB      *pdb;
+   VEC3F    centroid;
+   REAL     matrix[3][4];
+   int      i, j,
+            natoms;
+   BOOL     stream = FALSE;
    
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   btInitTiming(&argc, argv);
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         /* The centroid is found in a first pass so the input must be
+            a file that can be read twice
+         */
+         if(stream && btCanFilterPDB(in) && btPDBCentroid(in, &centroid))
+         {
+            for(i=0; i<3; i++)
+            {
+               for(j=0; j<3; j++)
+                  matrix[i][j] = (i==j) ? (REAL)1.0 : (REAL)0.0;
+            }
+            matrix[0][3] = -centroid.x;
+            matrix[1][3] = -centroid.y;
+            matrix[2][3] = -centroid.z;
+
+            if(!btTransformPDB(in, out, matrix, &natoms))
+            {
+               fprintf(stderr,"Error: Failed while moving the PDB \
+file\n");
+               return(1);
+            }
+         }
+         else if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
             blOriginPDB(pdb);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -125,7 +169,8 @@ int main(int argc, char **argv)
 }
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     BOOL *stream)
    ---------------------------------------------------------------------
 *//**
 
@@ -133,13 +178,16 @@ int main(int argc, char **argv)
    \param[in]      **argv       Argument array
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *stream      Move the atoms as a stream
    \return                     Success?
 
    Parse the command line
    
 -  28.01.99 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
@@ -152,6 +200,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       {
          switch(argv[0][1])
          {
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -195,12 +246,22 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdborigin V1.2 (c) 1999-2015, UCL, Andrew C.R. \
+   fprintf(stderr,"\npdborigin V1.7 (c) 1999-2015, UCL, Andrew C.R. \
 Martin\n\n");
-   fprintf(stderr,"Usage: pdborigin [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"Usage: pdborigin [-s] [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"       -s Stream the file, rewriting only the \
+coordinates\n");
    fprintf(stderr,"\nMoves a set of PDB coordinates such that the \
 centre of geometry\n");
    fprintf(stderr,"is at the origin.\n\n");
+   fprintf(stderr,"With -s, the centre of geometry of the first model \
+is found in a first\n");
+   fprintf(stderr,"pass over the file and memory use does not depend \
+on its size. All models\n");
+   fprintf(stderr,"are moved and other records are copied verbatim. \
+Input that cannot be\n");
+   fprintf(stderr,"read twice (e.g. a pipe), binary PDB and PDBML are \
+read as normal.\n\n");
 }
 
 
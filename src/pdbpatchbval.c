@@ -3,8 +3,8 @@
 
    \file       pdbpatchbval.c
    
-   \version    V1.7
-   \date       12.03.15
+   \version    V1.12
+   \date       19.10.26
    \brief      Patch the b-value (or occupancy) column using values from 
                a file
    
@@ -37,6 +37,10 @@
 
    Description:
    ============
+   The patches are placed in a hash keyed on chain, residue number and
+   insert code so each residue is patched with a single lookup. With
+   -l, a list of patch files is applied to one read of the structure,
+   writing a separate output file for each.
 
 **************************************************************************
 
@@ -57,31 +61,49 @@
 -  V1.5  25.11.14 Initialized a variable 
 -  V1.6  13.02.15 Added whole PDB support
 -  V1.7  12.03.15 Changed to allow multi-character chain names
+-  V1.8  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.9  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.10 19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.11 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.12 19.10.26 Patches are looked up in a hash. Added -l to apply
+                  several patch files to one read of the structure
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "bioplib/MathType.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "bioplib/hash.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
+#define MAXKEY  32
 
 typedef struct _patch
 {
    struct _patch *next, 
-                 *prev;
+                 *prev,
+                 *nextSame; /* Next patch for the same residue          */
    REAL value;
    int  resnum;
    char chain[8],   /* 28.08.13 Now a string                            */
         insert[8];  /* 28.08.13 Now a string                            */
+   BOOL applied;
 }  PATCH;
 
 
@@ -95,9 +117,14 @@ typedef struct _patch
 int main(int argc, char **argv);
 BOOL ApplyPatches(FILE *in, FILE *out, PATCH *patchlist, BOOL occup,
                   BOOL verbose);
+BOOL PatchStructure(PDB *pdb, PATCH *patchlist, BOOL occup,
+                    BOOL verbose);
+void MakePatchKey(char *key, char *chain, int resnum, char *insert);
+BOOL ApplyPatchFileList(FILE *in, FILE *list, BOOL occup, BOOL verbose);
 PATCH *ReadPatchFile(FILE *fp);
 BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile, 
-                  char *outfile, BOOL *occup, BOOL *verbose);
+                  char *outfile, BOOL *occup, BOOL *verbose,
+                  char *listfile);
 void Usage(void);
 
 
@@ -110,6 +137,7 @@ void Usage(void);
 
 -  29.05.96 Original   By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Added -l   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -119,14 +147,30 @@ int main(int argc, char **argv)
    PATCH *patchlist = NULL;
    char  infile[MAXBUFF],
          outfile[MAXBUFF],
-         datafile[MAXBUFF];
+         datafile[MAXBUFF],
+         listfile[MAXBUFF];
    BOOL  occup   = FALSE,
          verbose = FALSE;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, datafile, infile, outfile, &occup, 
-                   &verbose))
+                   &verbose, listfile))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(listfile[0])
+      {
+         if((data=fopen(listfile,"r"))==NULL)
+         {
+            fprintf(stderr,"pdbpatchbval: Unable to open patch file \
+list: %s\n", listfile);
+            return(1);
+         }
+         if(!btOpenStdFiles(infile, NULL, &in, &out))
+            return(1);
+         return(ApplyPatchFileList(in, data, occup, verbose) ? 0 : 1);
+      }
+
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          if((data=fopen(datafile,"r"))!=NULL)
          {
@@ -179,25 +223,106 @@ data\n");
 -  28.08.13 PATCH.chain and PATCH.insert are now strings
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  12.03.15 Changed to allow multi-character chain names  By: ACRM
+-  19.10.26 Patching moved into PatchStructure()   By: agent
 */
 BOOL ApplyPatches(FILE *in, FILE *out, PATCH *patch, BOOL occup,
                   BOOL verbose)
 {
    WHOLEPDB *wpdb;
-   PDB      *pdb,
-            *end,
-            *p,
-            *q;
-   PATCH    *pa;
-   
    
-   if((wpdb = blReadWholePDB(in))==NULL)
+   if((wpdb = btReadWholePDB(in))==NULL)
    {
       fprintf(stderr,"Unable to read PDB file\n");
       return(FALSE);
    }
 
-   pdb = wpdb->pdb;
+   if(!PatchStructure(wpdb->pdb, patch, occup, verbose))
+      return(FALSE);
+   
+   /* Write the patched PDB file                                        */
+   btWriteWholePDB(out, wpdb);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL PatchStructure(PDB *pdb, PATCH *patchlist, BOOL occup,
+                       BOOL verbose)
+   -----------------------------------------------------------
+*//**
+
+   \param[in,out]  *pdb         PDB linked list
+   \param[in,out]  *patchlist   Patches (marked as they are applied)
+   \param[in]      occup        Patch the occupancy rather than B-value
+   \param[in]      verbose      Report patches that were not applied
+   \return                      Success? (FALSE if no memory)
+
+   Sets the B-values (or occupancies) to zero and then applies the
+   patches a residue at a time. The patches are placed in a hash, with
+   patches for the same residue chained in file order; as before, the
+   first unused patch for a residue is the one applied.
+
+-  19.10.26 Original (from ApplyPatches()) using a hash rather than
+            searching the patch list for each residue   By: agent
+*/
+BOOL PatchStructure(PDB *pdb, PATCH *patchlist, BOOL occup,
+                    BOOL verbose)
+{
+   HASHTABLE *hash;
+   PATCH     **first,
+             **last,
+             *pa;
+   PDB       *p,
+             *q,
+             *end;
+   char      key[MAXKEY];
+   int       npatch = 0,
+             nkeys  = 0,
+             nleft,
+             k;
+
+   for(pa=patchlist; pa!=NULL; NEXT(pa))
+      npatch++;
+   nleft = npatch;
+
+   /* first[k] is the next patch to apply for key k                     */
+   hash  = blInitializeHash((ULONG)(2*npatch+1));
+   first = (PATCH **)malloc((npatch+1) * sizeof(PATCH *));
+   last  = (PATCH **)malloc((npatch+1) * sizeof(PATCH *));
+   if((hash == NULL) || (first == NULL) || (last == NULL))
+   {
+      if(hash != NULL)
+         blFreeHash(hash);
+      FREE(first);
+      FREE(last);
+      return(FALSE);
+   }
+
+   for(pa=patchlist; pa!=NULL; NEXT(pa))
+   {
+      pa->applied  = FALSE;
+      pa->nextSame = NULL;
+      MakePatchKey(key, pa->chain, pa->resnum, pa->insert);
+      if(blHashKeyDefined(hash, key))
+      {
+         k = blGetHashValueInt(hash, key);
+         last[k]->nextSame = pa;
+         last[k]           = pa;
+      }
+      else
+      {
+         if(!blSetHashValueInt(hash, key, nkeys))
+         {
+            blFreeHash(hash);
+            free(first);
+            free(last);
+            return(FALSE);
+         }
+         first[nkeys] = last[nkeys] = pa;
+         nkeys++;
+      }
+   }
 
    /* Set values to 0.0                                                 */
    for(p=pdb; p!=NULL; NEXT(p))
@@ -207,69 +332,158 @@ BOOL ApplyPatches(FILE *in, FILE *out, PATCH *patch, BOOL occup,
    }
 
    /* Run through again a residue at a time                             */
-   for(p=pdb; p!=NULL; p=end)
+   for(p=pdb; (p!=NULL) && nleft; p=end)
    {
-      /* If all patches applied, break out of the linked list           */
-      if(patch==NULL)
-         break;
-      
       end = blFindNextResidue(p);
-      
-      /* Now compare this residue with items in the patch list          */
-      for(pa=patch; pa!=NULL; NEXT(pa))
+
+      MakePatchKey(key, p->chain, p->resnum, p->insert);
+      if(!blHashKeyDefined(hash, key))
+         continue;
+      k = blGetHashValueInt(hash, key);
+      if((pa = first[k]) == NULL)
+         continue;
+
+      for(q=p; q!=end; NEXT(q))
       {
-         if((pa->resnum == p->resnum)          &&
-            CHAINMATCH(pa->chain, p->chain) &&
-            (pa->insert[0] == p->insert[0]))
-         {
-            break;
-         }
+         if(occup) q->occ  = pa->value;
+         else      q->bval = pa->value;
       }
-      
+      pa->applied = TRUE;
+      first[k]    = pa->nextSame;
+      nleft--;
+   }
 
-      if(pa!=NULL)
+   blFreeHash(hash);
+   free(first);
+   free(last);
+
+   /* List any patches which weren't applied                            */
+   if(nleft && verbose)
+   {
+      fprintf(stderr,"The following patches were not applied:\n");
+      for(pa=patchlist; pa!=NULL; NEXT(pa))
       {
-         /* Since we broke out, then we have a match so apply patch     */
-         for(q=p; q!=end; NEXT(q))
+         if(!pa->applied)
          {
-            if(occup) q->occ  = pa->value;
-            else      q->bval = pa->value;
+            fprintf(stderr,"%s.%d%c %f\n",
+                    pa->chain,pa->resnum,pa->insert[0],pa->value);
          }
+      }
+   }
 
-         /* Unlink this from the patch list                             */
-         if(pa==patch)                    /* First in list              */
-         {
-            patch = pa->next;
-            if(patch!=NULL)
-               patch->prev = NULL;
-         }
-         else
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void MakePatchKey(char *key, char *chain, int resnum, char *insert)
+   -------------------------------------------------------------------
+*//**
+
+   \param[out]     *key         Hash key (MAXKEY)
+   \param[in]      *chain       Chain label
+   \param[in]      resnum       Residue number
+   \param[in]      *insert      Insert code
+
+   Only the first character of the insert code is used, as it always
+   has been when matching patches
+
+-  19.10.26 Original    By: agent
+*/
+void MakePatchKey(char *key, char *chain, int resnum, char *insert)
+{
+   sprintf(key, "%.7s|%d|%d", chain, resnum, (int)insert[0]);
+}
+
+
+/************************************************************************/
+/*>BOOL ApplyPatchFileList(FILE *in, FILE *list, BOOL occup,
+                           BOOL verbose)
+   ---------------------------------------------------------
+*//**
+
+   \param[in]      *in          Input PDB file
+   \param[in]      *list        File of patch file / output file pairs
+   \param[in]      occup        Patch the occupancy rather than B-value
+   \param[in]      verbose      Report patches that were not applied
+   \return                      Were all the files written?
+
+   Reads the structure once and then, for each line of the list, reads
+   the patch file, patches the structure and writes it to the output
+   file. Each output starts from zeroed values so the outputs do not
+   depend on each other. A patch file that cannot be read or an output
+   that cannot be written is reported and skipped.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL ApplyPatchFileList(FILE *in, FILE *list, BOOL occup, BOOL verbose)
+{
+   WHOLEPDB *wpdb;
+   PATCH    *patchlist;
+   FILE     *data,
+            *out;
+   char     buffer[MAXBUFF],
+            datafile[MAXBUFF],
+            outfile[MAXBUFF];
+   BOOL     ok = TRUE;
+
+   if((wpdb = btReadWholePDB(in))==NULL)
+   {
+      fprintf(stderr,"Unable to read PDB file\n");
+      return(FALSE);
+   }
+
+   while(fgets(buffer, MAXBUFF, list))
+   {
+      TERMINATE(buffer);
+      if(sscanf(buffer, "%s %s", datafile, outfile) != 2)
+      {
+         if(sscanf(buffer, "%s", datafile) == 1)
          {
-            if(pa->prev != NULL)
-               pa->prev->next = pa->next;
-            /* 17.02.97 Added update this way round                     */
-            if(pa->next != NULL)
-               pa->next->prev = pa->prev;
+            fprintf(stderr,"pdbpatchbval: No output file given for \
+patch file: %s\n", datafile);
+            ok = FALSE;
          }
-         free(pa);
+         continue;
       }
-   }
 
-   /* All patches should now ba applied; list any which weren't         */
-   if(patch!=NULL && verbose)
-   {
-      fprintf(stderr,"The following patches were not applied:\n");
-      for(pa=patch; pa!=NULL; NEXT(pa))
+      if((data=fopen(datafile,"r"))==NULL)
+      {
+         fprintf(stderr,"pdbpatchbval: Unable to open patch file: \
+%s\n", datafile);
+         ok = FALSE;
+         continue;
+      }
+      patchlist = ReadPatchFile(data);
+      fclose(data);
+      if(patchlist == NULL)
+      {
+         fprintf(stderr,"pdbpatchbval: Unable to read patch data: \
+%s\n", datafile);
+         ok = FALSE;
+         continue;
+      }
+
+      if(!PatchStructure(wpdb->pdb, patchlist, occup, verbose))
       {
-         fprintf(stderr,"%s.%d%c %f\n",
-                 pa->chain,pa->resnum,pa->insert[0],pa->value);
+         fprintf(stderr,"pdbpatchbval: Patching failed!\n");
+         FREELIST(patchlist, PATCH);
+         return(FALSE);
       }
+      FREELIST(patchlist, PATCH);
+
+      if((out=fopen(outfile,"w"))==NULL)
+      {
+         fprintf(stderr,"pdbpatchbval: Unable to open output file: \
+%s\n", outfile);
+         ok = FALSE;
+         continue;
+      }
+      btWriteWholePDB(out, wpdb);
+      fclose(out);
    }
-   
-   /* Write the patched PDB file                                        */
-   blWriteWholePDB(out,wpdb);
 
-   return(TRUE);
+   return(ok);
 }
 
 
@@ -322,7 +536,8 @@ PATCH *ReadPatchFile(FILE *fp)
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile, 
-                     char *outfile, BOOL *occup, BOOL *verbose)
+                     char *outfile, BOOL *occup, BOOL *verbose,
+                     char *listfile)
    ---------------------------------------------------------------------
 *//**
 
@@ -333,14 +548,19 @@ PATCH *ReadPatchFile(FILE *fp)
    \param[out]     *datafile    The patch datafile
    \param[out]     *occup       Put the patches in the occupancy column
    \param[out]     *verbose     Report failed patches
+   \param[out]     *listfile    File listing patch and output files
+                                (or blank string)
    \return                     Success?
 
-   Parse the command line
+   Parse the command line. With -l the only filename is the input PDB
+   file.
    
 -  29.05.96 Original    By: ACRM
+-  19.10.26 Added -l   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile, 
-                  char *outfile, BOOL *occup, BOOL *verbose)
+                  char *outfile, BOOL *occup, BOOL *verbose,
+                  char *listfile)
 {
    argc--;
    argv++;
@@ -348,7 +568,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile,
    *occup = FALSE;
    *verbose = FALSE;
    
-   infile[0] = outfile[0] = datafile[0] = '\0';
+   infile[0] = outfile[0] = datafile[0] = listfile[0] = '\0';
    
    while(argc)
    {
@@ -362,11 +582,27 @@ BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile,
          case 'o':
             *occup = TRUE;
             break;
+         case 'l':
+            argc--;
+            argv++;
+            if(!argc)
+               return(FALSE);
+            strncpy(listfile, argv[0], MAXBUFF-1);
+            listfile[MAXBUFF-1] = '\0';
+            break;
          default:
             return(FALSE);
             break;
          }
       }
+      else if(listfile[0])
+      {
+         /* Just the input file with -l                                 */
+         if(argc > 1)
+            return(FALSE);
+         strcpy(infile, argv[0]);
+         return(TRUE);
+      }
       else
       {
          /* Check that there are up to 3 arguments left                 */
@@ -396,7 +632,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile,
       argv++;
    }
 
-   if(!datafile[0])
+   if(!datafile[0] && !listfile[0])
       return(FALSE);
    
    return(TRUE);
@@ -420,20 +656,28 @@ BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbpatchbval V1.7 (c) 1996-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbpatchbval V1.12 (c) 1996-2015, Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbpatchbval [-o] [-v] patchfile [in.pdb \
 [out.pdb]]\n");
+   fprintf(stderr,"       pdbpatchbval [-o] [-v] -l listfile \
+[in.pdb]\n");
    fprintf(stderr,"       -o  Place the patches in the occupancy \
 column\n");
    fprintf(stderr,"       -v  Verbose: report failed patches\n");
+   fprintf(stderr,"       -l  Apply each patch file in listfile to \
+the same structure\n");
 
    fprintf(stderr,"\npdbpatchbval takes a patch file containing \
 resspec residue specifications\n");
    fprintf(stderr,"and values one to a line and patches the B-value (or \
 occupancy) for\n");
    fprintf(stderr,"that residue with the specified values.\n");
+   fprintf(stderr,"\nWith -l, each line of listfile gives a patch file \
+and the output file for\n");
+   fprintf(stderr,"it. The structure is read once and each output has \
+only its own patches.\n");
    blPrintResSpecHelp(stderr);
    fprintf(stderr,"\n");
 }
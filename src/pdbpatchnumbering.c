@@ -3,8 +3,8 @@
 
    \file       pdbpatchnumbering.c
    
-   \version    V1.9
-   \date       30.09.17
+   \version    V1.13
+   \date       19.10.26
    \brief      Patch the numbering of a PDB file from a file of numbers
                and sequence (as created by KabatSeq, etc)
    
@@ -63,6 +63,13 @@
 -  V1.9  30.09.17 Now allows the patch file to skip the first few residues.
                   i.e. if there is an N-terminal extension to the known
                   numbering, this will be removed from the file.
+-  V1.10 19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.11 19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.12 19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.13 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -76,6 +83,10 @@
 #include "bioplib/seq.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 
 /************************************************************************/
@@ -129,9 +140,11 @@ int main(int argc, char **argv)
    WHOLEPDB *wpdb;
    PDB      *pdb;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, patchfile))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          if((patchfp=fopen(patchfile,"r"))==NULL)
          {
@@ -147,13 +160,13 @@ file\n");
             return(1);
          }
 
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
             if(ApplyPatches(&pdb, patches))
             {
                wpdb->pdb = pdb;
-               blWriteWholePDB(out, wpdb);
+               btWriteWholePDB(out, wpdb);
             }
             else
             {
@@ -360,7 +373,7 @@ PATCH *ReadPatchFile(FILE *fp)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbpatchnumbering V1.9 (c) 1995-2017, Dr. Andrew \
+   fprintf(stderr,"\npdbpatchnumbering V1.13 (c) 1995-2017, Dr. Andrew \
 C.R. Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbpatchnumbering patchfile [in.pdb \
@@ -0,0 +1,440 @@
+/************************************************************************/
+/**
+
+   \file       pdbquery.c
+
+   \version    V1.2
+   \date       19.10.26
+   \brief      Send queries to pdbserver
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A simple client for pdbserver. The request is given on the command
+   line, exactly as the program would be run, e.g.
+      pdbquery pdbcheckforres L24 1abc.pdb
+   The last argument is made into an absolute path, since the server
+   may have been started in another directory. The output is written
+   to standard output and an error from the server to standard error.
+
+   With no request on the command line, requests are read one per line
+   from standard input and sent down a single connection. File names
+   are then passed to the server as they are.
+
+   The default socket is the same as pdbserver's. A private directory
+   in /tmp that does not belong to the user is refused.
+
+**************************************************************************
+
+   Usage:
+   ======
+   pdbquery [-s socket] [request]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.2  19.10.26 Default socket in $XDG_RUNTIME_DIR or a private
+                  directory, as for pdbserver
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "bioplib/SysDefs.h"
+#include "common/timing.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF       1024
+#define SOCKET_NAME   "pdbserver.sock"
+#define SOCKET_DIR    "/tmp/pdbserver-%lu"   /* Without XDG_RUNTIME_DIR */
+#define SOCKET_ENV    "PDBSERVER_SOCKET"
+#define RUNTIME_ENV   "XDG_RUNTIME_DIR"
+#define END_OF_REPLY  ".\n"
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                  int *firstWord);
+void Usage(void);
+BOOL DefaultSocketName(char *socketName);
+int ConnectToServer(char *socketName);
+BOOL BuildRequest(int nwords, char **words, char *request);
+BOOL SendRequest(FILE *toServer, FILE *fromServer, char *request);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Uses DefaultSocketName()
+*/
+int main(int argc, char **argv)
+{
+   FILE *toServer,
+        *fromServer;
+   char socketName[MAXBUFF],
+        request[MAXBUFF];
+   int  fd,
+        firstWord;
+   BOOL ok = TRUE;
+
+   btInitTiming(&argc, argv);
+
+   if(!ParseCmdLine(argc, argv, socketName, &firstWord))
+   {
+      Usage();
+      return(0);
+   }
+   if((socketName[0] == '\0') && !DefaultSocketName(socketName))
+      return(1);
+
+   if((fd = ConnectToServer(socketName)) < 0)
+      return(1);
+   if(((fromServer = fdopen(fd, "r")) == NULL) ||
+      ((toServer   = fdopen(dup(fd), "w")) == NULL))
+   {
+      fprintf(stderr,"Error: (pdbquery) No memory for connection\n");
+      return(1);
+   }
+
+   if(firstWord < argc)
+   {
+      if(!BuildRequest(argc-firstWord, argv+firstWord, request))
+      {
+         fprintf(stderr,"Error: (pdbquery) Request too long\n");
+         return(1);
+      }
+      ok = SendRequest(toServer, fromServer, request);
+   }
+   else
+   {
+      while(fgets(request, MAXBUFF, stdin))
+      {
+         if(strchr(request, '\n') == NULL)
+         {
+            fprintf(stderr,"Error: (pdbquery) Request too long\n");
+            return(1);
+         }
+         if(!SendRequest(toServer, fromServer, request))
+            ok = FALSE;
+      }
+   }
+
+   fclose(toServer);
+   fclose(fromServer);
+
+   return(ok ? 0 : 1);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                     int *firstWord)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]      argc         Argument count
+   \param[in]      **argv       Argument array
+   \param[out]     *socketName  Socket path (blank for the default)
+   \param[out]     *firstWord   Index in argv of the request
+   \return                      Success?
+
+   Parse the command line. Options after the program name in the
+   request belong to the request.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Leaves the default socket to DefaultSocketName()
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                  int *firstWord)
+{
+   int i;
+
+   socketName[0] = '\0';
+   if(getenv(SOCKET_ENV) != NULL)
+      strncpy(socketName, getenv(SOCKET_ENV), MAXBUFF);
+   socketName[MAXBUFF-1] = '\0';
+
+   for(i=1; (i<argc) && (argv[i][0] == '-'); i++)
+   {
+      switch(argv[i][1])
+      {
+      case 's':
+         if(++i >= argc)
+            return(FALSE);
+         strncpy(socketName, argv[i], MAXBUFF);
+         socketName[MAXBUFF-1] = '\0';
+         break;
+      default:
+         return(FALSE);
+      }
+   }
+
+   *firstWord = i;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Prints a usage message
+
+-  19.10.26 Original    By: agent
+-  19.10.26 V1.2
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\npdbquery V1.2 (c) 2026 UCL\n");
+   fprintf(stderr,"\nUsage: pdbquery [-s socket] [request]\n");
+   fprintf(stderr,"       -s Socket the server listens on (Default: \
+$%s,\n", SOCKET_ENV);
+   fprintf(stderr,"          $%s/%s or /tmp/pdbserver-<uid>/%s)\n",
+           RUNTIME_ENV, SOCKET_NAME, SOCKET_NAME);
+   fprintf(stderr,"\nSends a request to pdbserver and prints the reply. \
+A request is one of\n");
+   fprintf(stderr,"   pdbcheckforres [-H] resspec file\n");
+   fprintf(stderr,"   pdbsphere [-r radius] [-s] [-c] [-H] [-a] \
+[resspec] file\n");
+   fprintf(stderr,"   pdbfindresrange resspec width file\n");
+   fprintf(stderr,"   pdbgetchain [-n] [-a] chain[,chain...] file\n");
+   fprintf(stderr,"   load file\n");
+   fprintf(stderr,"   drop file\n");
+   fprintf(stderr,"   stats\n");
+   fprintf(stderr,"   shutdown\n");
+   fprintf(stderr,"The options are those of the programs themselves. \
+With no request,\n");
+   fprintf(stderr,"requests are read one per line from standard \
+input.\n\n");
+}
+
+
+/************************************************************************/
+/*>BOOL DefaultSocketName(char *socketName)
+   ----------------------------------------
+*//**
+
+   \param[out]     *socketName   Socket path
+   \return                       Success?
+
+   The default socket is in $XDG_RUNTIME_DIR or, if that is not set,
+   in /tmp/pdbserver-<uid> (see pdbserver). If that directory exists
+   but is not private to the user, it is refused so that we do not
+   talk to a server run by someone else.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL DefaultSocketName(char *socketName)
+{
+   char        dir[MAXBUFF],
+               *env;
+   struct stat statBuff;
+
+   if(((env = getenv(RUNTIME_ENV)) != NULL) && (env[0] != '\0'))
+   {
+      sprintf(socketName, "%.200s/%s", env, SOCKET_NAME);
+      return(TRUE);
+   }
+
+   sprintf(dir, SOCKET_DIR, (unsigned long)getuid());
+   if(!lstat(dir, &statBuff) &&
+      (!S_ISDIR(statBuff.st_mode) || (statBuff.st_uid != getuid()) ||
+       (statBuff.st_mode & 077)))
+   {
+      fprintf(stderr,"Error: (pdbquery) %s is not a private \
+directory\n", dir);
+      return(FALSE);
+   }
+
+   sprintf(socketName, "%s/%s", dir, SOCKET_NAME);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>int ConnectToServer(char *socketName)
+   -------------------------------------
+*//**
+
+   \param[in]      *socketName   Socket path
+   \return                       Connected socket (-1 on error)
+
+-  19.10.26 Original    By: agent
+*/
+int ConnectToServer(char *socketName)
+{
+   struct sockaddr_un addr;
+   int                fd;
+
+   if(strlen(socketName) >= sizeof(addr.sun_path))
+   {
+      fprintf(stderr,"Error: (pdbquery) Socket name too long: %s\n",
+              socketName);
+      return(-1);
+   }
+
+   memset(&addr, 0, sizeof(struct sockaddr_un));
+   addr.sun_family = AF_UNIX;
+   strcpy(addr.sun_path, socketName);
+
+   if(((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) ||
+      (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0))
+   {
+      fprintf(stderr,"Error: (pdbquery) Unable to connect to pdbserver \
+on %s: %s\n", socketName, strerror(errno));
+      if(fd >= 0)
+         close(fd);
+      return(-1);
+   }
+
+   return(fd);
+}
+
+
+/************************************************************************/
+/*>BOOL BuildRequest(int nwords, char **words, char *request)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]      nwords     Number of words
+   \param[in]      **words    Words of the request
+   \param[out]     *request   Request line (MAXBUFF)
+   \return                    FALSE if the request is too long
+
+   Joins the words into a request line. For a request with a file, a
+   relative file name (the last word) is prefixed with the current
+   directory.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL BuildRequest(int nwords, char **words, char *request)
+{
+   char cwd[MAXBUFF];
+   int  i;
+   size_t length = 0;
+
+   request[0] = '\0';
+   for(i=0; i<nwords; i++)
+   {
+      if((i == nwords-1) && (i > 0) && (words[i][0] != '/'))
+      {
+         if(getcwd(cwd, MAXBUFF) == NULL)
+            return(FALSE);
+         length += strlen(cwd) + 1;
+         if(length >= MAXBUFF)
+            return(FALSE);
+         strcat(request, cwd);
+         strcat(request, "/");
+      }
+
+      length += strlen(words[i]) + 1;
+      if(length >= MAXBUFF)
+         return(FALSE);
+      strcat(request, words[i]);
+      strcat(request, ((i == nwords-1) ? "\n" : " "));
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL SendRequest(FILE *toServer, FILE *fromServer, char *request)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *toServer     Connection for writing
+   \param[in]      *fromServer   Connection for reading
+   \param[in]      *request      Request line ending in a newline
+   \return                       Did the server reply OK?
+
+   Sends a request and copies the reply to stdout, or an error to
+   stderr
+
+-  19.10.26 Original    By: agent
+*/
+BOOL SendRequest(FILE *toServer, FILE *fromServer, char *request)
+{
+   char buffer[MAXBUFF];
+   BOOL ok        = FALSE,
+        lineStart = TRUE,
+        first     = TRUE;
+
+   fputs(request, toServer);
+   if(fflush(toServer) == EOF)
+   {
+      fprintf(stderr,"Error: (pdbquery) Unable to send request\n");
+      return(FALSE);
+   }
+
+   while(fgets(buffer, MAXBUFF, fromServer))
+   {
+      if(lineStart && !strcmp(buffer, END_OF_REPLY))
+         return(ok);
+
+      if(first)
+      {
+         if(!strcmp(buffer, "OK\n"))
+            ok = TRUE;
+         else if(!strncmp(buffer, "ERROR ", 6))
+            fprintf(stderr, "Error: (pdbquery) %s", buffer+6);
+         else
+            fprintf(stderr, "Error: (pdbquery) Bad reply: %s", buffer);
+         first = FALSE;
+      }
+      else
+      {
+         fputs(buffer, stdout);
+      }
+      lineStart = (strchr(buffer, '\n') != NULL);
+   }
+
+   fprintf(stderr,"Error: (pdbquery) Connection to server lost\n");
+   return(FALSE);
+}
+
@@ -3,8 +3,8 @@
 
    \file       pdbrenum.c
    
-   \version    V2.0
-   \date       10.03.15
+   \version    V2.4
+   \date       19.10.26
    \brief      Renumber a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin / UCL 1994-2015
@@ -64,6 +64,13 @@
                   Uses blRenumberAtomsPDB() to do the atoms
 -  V1.13 02.03.15 Deals better with header and trailer
 -  V2.0  10.03.15 Chains specified with -c are now comma separated
+-  V2.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V2.2  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V2.3  19.10.26 Passes the structure on in memory in a bioptools
+                  pipeline
+-  V2.4  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -77,6 +84,10 @@
 #include "bioplib/MathType.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -119,6 +130,7 @@ void DoRenumber(PDB *pdb, BOOL DoSequential, BOOL KeepChain,
 -  02.03.15 Now uses blWriteWholePDBHeaderNoRes() if residues have been
             renumbered and always does blWriteWholePDBTrailer() since
             this now deals properly with renumbered atoms.
+-  19.10.26 Passes the structure on with btPassWholePDB()   By: agent
 -  10.03.15 Chains now an array of strings
 */
 int main(int argc, char **argv)
@@ -137,12 +149,14 @@ int main(int argc, char **argv)
    int      ResStart[MAXCHAIN],
             AtomStart;
         
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &DoSequential, &KeepChain,
                    &DoAtoms, &chains, ResStart, &AtomStart, &DoRes))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))==NULL)
+         if((wpdb=btReadWholePDB(in))==NULL)
          {
             fprintf(stderr,"pdbrenum: Unable to read input PDB file\n");
          }
@@ -153,16 +167,23 @@ int main(int argc, char **argv)
             pdb=wpdb->pdb;
             DoRenumber(pdb,DoSequential,KeepChain,DoAtoms,DoRes,chains,
                        ResStart, AtomStart);
-            if(DoRes)
-            {
-               blWriteWholePDBHeaderNoRes(out, wpdb);
-            }
-            else
+
+            /* In a bioptools pipeline the structure is passed on
+               without being written
+            */
+            if(!btPassWholePDB(out, wpdb, DoRes))
             {
-               blWriteWholePDBHeader(out, wpdb);
+               if(DoRes)
+               {
+                  blWriteWholePDBHeaderNoRes(out, wpdb);
+               }
+               else
+               {
+                  blWriteWholePDBHeader(out, wpdb);
+               }
+               numTer = blWritePDB(out, pdb);
+               blWriteWholePDBTrailer(out, wpdb, numTer);
             }
-            numTer = blWritePDB(out, pdb);
-            blWriteWholePDBTrailer(out, wpdb, numTer);
          }
       }
       else
@@ -401,7 +422,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbrenum V2.0 (c) 1994-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbrenum V2.4 (c) 1994-2015 Dr. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbrenum [-s][-k][-c chain[,chain[...]]]\
 [-n][-d]\n");
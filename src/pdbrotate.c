@@ -3,8 +3,8 @@
 
    \file       pdbrotate.c
    
-   \version    V1.5
-   \date       13.02.15
+   \version    V1.9
+   \date       19.10.26
    \brief      Program to rotate PDB files
    
    \copyright  (c) Dr. Andrew C. R. Martin / UCL 1994-2015
@@ -53,6 +53,13 @@
                   Added doxygen annotation. By: CTP
 -  V1.4  06.11.14 Renamed from rotate  By: ACRM
 -  V1.5  13.02.15 Added whole PDB support
+-  V1.6  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.7  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.8  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.9  19.10.26 Added -s to rotate the file as a stream in constant
+                  memory
 
 *************************************************************************/
 /* Includes
@@ -67,6 +74,10 @@
 #include "bioplib/matrix.h"
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -90,6 +101,9 @@ void DoRotations(PDB *pdb, ROTLIST *rotlist);
 BOOL BuildRotInstruct(ROTLIST **pRotList, char direction, char *amount);
 void Usage(void);
 BOOL SetupMatrix(int argc, char **argv, REAL matrix[3][3]);
+void BuildTransform(ROTLIST *rotlist, BOOL GotMatrix, REAL matrix[3][3],
+                    VEC3F centre, REAL transform[3][4]);
+void AddRotation(REAL transform[3][4], REAL rotmat[3][3], VEC3F centre);
 
 
 /************************************************************************/
@@ -104,6 +118,7 @@ BOOL SetupMatrix(int argc, char **argv, REAL matrix[3][3]);
 -  29.09.97 Added -n
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Added whole PDB support   By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -114,8 +129,14 @@ int main(int argc, char **argv)
    PDB      *pdb;
    BOOL     GotMatrix = FALSE,
             GotRot    = FALSE,
-            DoCentre  = TRUE;
-   REAL     matrix[3][3];
+            DoCentre  = TRUE,
+            stream    = FALSE;
+   REAL     matrix[3][3],
+            transform[3][4];
+   VEC3F    centre;
+   int      natoms;
+
+   btInitTiming(&argc, argv);
 
    argc--;
    argv++;
@@ -175,6 +196,9 @@ int main(int argc, char **argv)
          case 'n':
             DoCentre = FALSE;
             break;
+         case 's':
+            stream = TRUE;
+            break;
          default:
             Usage();
             return(1);
@@ -228,8 +252,25 @@ with -m\n");
       argv++;
    }
    
+   /* With -s, rotations about the centre of geometry need a first pass
+      to find it, so the input must be a file that can be read twice
+   */
+   centre.x = centre.y = centre.z = (REAL)0.0;
+   if(stream && btCanFilterPDB(in) &&
+      ((GotMatrix && !DoCentre) || btPDBCentroid(in, &centre)))
+   {
+      BuildTransform(rotlist, GotMatrix, matrix, centre, transform);
+      if(!btTransformPDB(in, out, transform, &natoms))
+      {
+         fprintf(stderr,"pdbrotate: Failed while rotating the PDB \
+file\n");
+         return(1);
+      }
+      return(0);
+   }
+
    /* Read in the PDB file                                              */
-   if((wpdb = blReadWholePDB(in))==NULL)
+   if((wpdb = btReadWholePDB(in))==NULL)
    {
       fprintf(stderr,"pdbrotate: Unable to read from PDB file\n");
       return(1);
@@ -251,7 +292,7 @@ with -m\n");
    }
    
    /* Write the new PDB file                                            */
-   blWriteWholePDB(out,wpdb);
+   btWriteWholePDB(out, wpdb);
    
    return(0);
 }
@@ -283,6 +324,101 @@ void DoRotations(PDB *pdb, ROTLIST *rotlist)
 }
 
 
+/************************************************************************/
+/*>void BuildTransform(ROTLIST *rotlist, BOOL GotMatrix,
+                       REAL matrix[3][3], VEC3F centre,
+                       REAL transform[3][4])
+   -----------------------------------------------------
+*//**
+   \param[in]      *rotlist    Linked list of rotation instructions
+   \param[in]      GotMatrix   Use matrix rather than rotlist
+   \param[in]      matrix      Rotation matrix from -m
+   \param[in]      centre      Centre of rotation
+   \param[out]     transform   Combined transformation for
+                               btTransformPDB()
+
+   Combines the rotations that DoRotations() or blRotatePDB() would
+   apply one after another into a single rotation and translation
+
+-  19.10.26 Original    By: agent
+*/
+void BuildTransform(ROTLIST *rotlist, BOOL GotMatrix, REAL matrix[3][3],
+                    VEC3F centre, REAL transform[3][4])
+{
+   ROTLIST *p;
+   REAL    rotmat[3][3];
+   int     i, j;
+
+   for(i=0; i<3; i++)
+   {
+      for(j=0; j<4; j++)
+         transform[i][j] = (i==j) ? (REAL)1.0 : (REAL)0.0;
+   }
+
+   if(GotMatrix)
+   {
+      AddRotation(transform, matrix, centre);
+   }
+   else
+   {
+      for(p=rotlist; p!=NULL; NEXT(p))
+      {
+         blCreateRotMat(p->direction, p->angle, rotmat);
+         AddRotation(transform, rotmat, centre);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>void AddRotation(REAL transform[3][4], REAL rotmat[3][3],
+                    VEC3F centre)
+   ---------------------------------------------------------
+*//**
+   \param[in,out]  transform   Transformation
+   \param[in]      rotmat      Rotation matrix
+   \param[in]      centre      Centre of rotation
+
+   Follows the transformation with a rotation about the centre. The
+   rotation is applied with blMatMult3_33() exactly as
+   blApplyMatrixPDB() applies it to the atoms: to each column of the
+   rotation part and to the translation relative to the centre.
+
+-  19.10.26 Original    By: agent
+*/
+void AddRotation(REAL transform[3][4], REAL rotmat[3][3], VEC3F centre)
+{
+   VEC3F in,
+         out;
+   int   j;
+
+   for(j=0; j<4; j++)
+   {
+      in.x = transform[0][j];
+      in.y = transform[1][j];
+      in.z = transform[2][j];
+      if(j==3)
+      {
+         in.x -= centre.x;
+         in.y -= centre.y;
+         in.z -= centre.z;
+      }
+
+      blMatMult3_33(in, rotmat, &out);
+
+      if(j==3)
+      {
+         out.x += centre.x;
+         out.y += centre.y;
+         out.z += centre.z;
+      }
+      transform[0][j] = out.x;
+      transform[1][j] = out.y;
+      transform[2][j] = out.z;
+   }
+}
+
+
 /************************************************************************/
 /*>BOOL BuildRotInstruct(ROTLIST **pRotList, char direction, char *amount)
    ----------------------------------------------------------------------
@@ -337,21 +473,23 @@ BOOL BuildRotInstruct(ROTLIST **pRotList, char direction, char *amount)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbrotate V1.5 (c) 1994-2015 Andrew C.R. \
+   fprintf(stderr,"\npdbrotate V1.9 (c) 1994-2015 Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Freely distributable if no profit is made\n\n");
    fprintf(stderr,"Usage: pdbrotate [-m 11 12 13 21 22 23 31 32 33] \
 [-h]\n");
-   fprintf(stderr,"              [-n] [input.pdb [output.pdb]]\n");
+   fprintf(stderr,"              [-n] [-s] [input.pdb [output.pdb]]\n");
    fprintf(stderr,"       --or--\n");
    fprintf(stderr,"       pdbrotate [-x ang] [-y ang] [-z ang] \
 [-h]\n");
-   fprintf(stderr,"              [input.pdb [output.pdb]]\n\n");
+   fprintf(stderr,"              [-s] [input.pdb [output.pdb]]\n\n");
    fprintf(stderr,"       -m           Specify rotation matrix\n");
    fprintf(stderr,"       -n           Do not move to CofG before \
 applying\
  matrix\n");
    fprintf(stderr,"       -x, -y, -z   Specify rotations (in degrees)\n");
+   fprintf(stderr,"       -s           Stream the file, rewriting only \
+the coordinates\n");
    fprintf(stderr,"       -h           This help message\n");
    fprintf(stderr,"I/O is to stdin/stdout if not specified\n\n");
    fprintf(stderr,"Rotates a PDB file using the given rotation matrix \
@@ -362,6 +500,16 @@ around the centre\n");
 are applied in\n");
    fprintf(stderr,"sequence and as many rotations are are required may \
 be given.\n\n");
+   fprintf(stderr,"With -s, memory use does not depend on the size of \
+the file. The centre\n");
+   fprintf(stderr,"of geometry of the first model is found in a first \
+pass over the file.\n");
+   fprintf(stderr,"All models are rotated, ANISOU records are dropped \
+and other records are\n");
+   fprintf(stderr,"copied verbatim. Input that cannot be read twice \
+(e.g. a pipe) is read\n");
+   fprintf(stderr,"as normal unless -m and -n are given, as is binary \
+PDB or PDBML input.\n\n");
 }
 
 
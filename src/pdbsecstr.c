@@ -3,8 +3,8 @@
 
    \File       pdbsecstr.c
    
-   \version    V1.2
-   \date       06.08.18
+   \version    V1.6
+   \date       19.10.26
    \brief      Secondary structure calculation program
    
    \copyright  (c) Dr. Andrew C. R. Martin, UCL, 1999-2018
@@ -50,6 +50,12 @@
    V1.1   11.08.16 Rewritten to use PDB files rather than XMAS files
                    and to use blCalcSecStrucPDB() in Bioplib
    V1.2   06.08.18 Updated Usage message
+   V1.3   19.10.26 Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c   By: agent
+   V1.4   19.10.26 Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+   V1.5   19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+   V1.6   19.10.26 Removed the unused sNewChain global
 
 *************************************************************************/
 /* Includes
@@ -62,17 +68,15 @@
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
 #include "bioplib/secstr.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
    
-/************************************************************************/
-/* Globals
-*/
-BOOL sNewChain = FALSE;
-
 /************************************************************************/
 /* Prototypes
 */
@@ -105,6 +109,7 @@ int main(int argc, char **argv)
    int  natoms;
    BOOL debug = FALSE;
    
+   btInitTiming(&argc, argv);
    
    if(!ParseCmdLine(argc, argv, infile, outfile, &debug))
    {
@@ -113,9 +118,9 @@ int main(int argc, char **argv)
    }
    else
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDBAtoms(in, &natoms))!=NULL)
+         if((pdb = btReadPDBAtoms(in, &natoms))!=NULL)
          {
             PDB *start, *stop;
             
@@ -228,7 +233,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsecstr V1.2 (c) 1999-2018, UCL, \
+   fprintf(stderr,"\npdbsecstr V1.6 (c) 1999-2018, UCL, \
 Dr. Andrew C.R. Martin\n");
 
    fprintf(stderr,"\nUsage: pdbsecstr [-d] [in.pdb [out.pdb]]\n");
@@ -3,8 +3,8 @@
 
    \file       pdbselect.c
    
-   \version    V1.0
-   \date       30.02.15
+   \version    V1.3
+   \date       19.10.26
    \brief      Select alterbative occupancies of models from a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 2015
@@ -47,6 +47,11 @@
    Revision History:
    =================
 -  V1.0  30.02.15 Original
+-  V1.1  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process   By: agent
+-  V1.2  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.3  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -55,6 +60,9 @@
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -93,9 +101,11 @@ int main(int argc, char **argv)
             outfile[MAXBUFF];
    BOOL     getInfo = FALSE;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &OccRank, &ModelNum, &getInfo))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          BOOL DoWhole  = TRUE,
               AllAtoms = TRUE;
@@ -127,7 +137,7 @@ occupancies or multiple models\n");
             }
             else
             {
-               blWriteWholePDB(out, wpdb);
+               btWriteWholePDB(out, wpdb);
             }
             
          }
@@ -164,7 +174,7 @@ occupancies or multiple models\n");
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbselect V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdbselect V1.3  (c) 2015 UCL, Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Usage: pdbselect [-i] [-o occupancy] [-m model] \
 [<in.pdb> [<out.pdb>]]\n");
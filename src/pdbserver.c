@@ -0,0 +1,1689 @@
+/************************************************************************/
+/**
+
+   \file       pdbserver.c
+
+   \version    V1.3
+   \date       19.10.26
+   \brief      Answer structure queries from a cache over a Unix socket
+
+   \copyright  (c) UCL 2026
+   \author     agent
+   \par
+               agent@local
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A long-running server that answers the questions asked by
+   pdbcheckforres, pdbsphere, pdbfindresrange and pdbgetchain without
+   starting a program and parsing the file each time.
+
+   Structures are read once (with the shared reader, so binary, PDBML
+   and compressed files all work) and kept in a least-recently-used
+   cache. Each cached structure has an array of its atoms, a table of
+   its residues and chains, a hash of residue specs and a spatial grid,
+   all built when it is loaded. A cached structure is re-read if its
+   file changes (the same file stamp as the binary cache in
+   common/binpdb.c, so an edit that keeps the size and modification
+   time is still seen).
+
+   Clients connect to a Unix domain socket and send one request per
+   line. A request is the name of one of the programs followed by its
+   usual arguments, with the PDB file last:
+      pdbcheckforres [-H] resspec file
+      pdbsphere [-r radius] [-s] [-c] [-H] [-a] [resspec] file
+      pdbfindresrange resspec width file
+      pdbgetchain [-n] [-a] chain[,chain...] file
+   or one of the control requests:
+      load file       Read a file into the cache now
+      drop file       Remove a file from the cache
+      stats           Cache contents and hit counts
+      shutdown        Stop the server
+   The reply is a line 'OK' followed by what the program would have
+   written to standard output, or a line 'ERROR message'. Either way it
+   ends with a line containing only a full stop. None of the outputs
+   can contain such a line.
+
+   File names are taken relative to the directory the server was
+   started in; pdbquery sends absolute paths.
+
+   Requests are handled one at a time, but any number of clients may
+   stay connected. Replies are built in memory and sent without
+   blocking, so a client that does not read its reply holds up only
+   itself; it is dropped if nothing can be sent to it for SEND_TIMEOUT
+   seconds.
+
+   By default the socket is $XDG_RUNTIME_DIR/pdbserver.sock or, if that
+   is not set, pdbserver.sock in a directory /tmp/pdbserver-<uid> that
+   only the user can access. The socket itself is created with mode
+   0600. Only an old socket is ever removed to make way for it.
+
+**************************************************************************
+
+   Usage:
+   ======
+   pdbserver [-s socket] [-n maxstruct] [file.pdb ...]
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  19.10.26 Original   By: agent
+-  V1.1  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.2  19.10.26 Uses the shared residue index in common/resindex.c
+-  V1.3  19.10.26 Default socket in $XDG_RUNTIME_DIR or a private
+                  directory, created with mode 0600. Will not remove
+                  anything but a socket. Replies are sent without
+                  blocking. Cache entries use BTFILESTAMP
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200809L   /* open_memstream()                     */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+#include "bioplib/macros.h"
+#include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/spatial.h"
+#include "common/timing.h"
+#include "common/resindex.h"
+#include "common/binpdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF       256
+#define SMALLBUFF     32
+#define MAXLINE       1024     /* Longest request                       */
+#define MAXWORDS      32       /* Most words in a request               */
+#define MAXCHAINS     64       /* Most chains in a pdbgetchain request  */
+#define MAXCLIENTS    64
+#define DEF_MAXCACHE  16
+#define SOCKET_NAME   "pdbserver.sock"
+#define SOCKET_DIR    "/tmp/pdbserver-%lu"   /* Without XDG_RUNTIME_DIR */
+#define SOCKET_ENV    "PDBSERVER_SOCKET"
+#define RUNTIME_ENV   "XDG_RUNTIME_DIR"
+#define GRID_CELL     8.0      /* pdbsphere's default radius            */
+#define SEND_TIMEOUT  10       /* Seconds without progress before a
+                                  stuck client is dropped               */
+#define END_OF_REPLY  "."
+
+typedef struct _cacheentry
+{
+   struct _cacheentry *next,
+                      *prev;
+   char        *path;
+   BTFILESTAMP fileStamp;    /* Version of the file that was read       */
+   WHOLEPDB    *wpdb;
+   RESINDEX    *index;       /* Atoms, residues, chains and specs       */
+   int         *resStamp,    /* Last sphere query that flagged each
+                                residue                                 */
+               *hits;        /* Residues flagged by a sphere query      */
+   SPATIALGRID *grid;
+   int         stamp;
+}  CACHEENTRY;
+
+typedef struct
+{
+   int    fd;
+   char   buffer[MAXLINE];
+   int    nbuff;
+   char   *reply;            /* Reply not yet sent (NULL if none)       */
+   size_t replySize,
+          replySent;
+   time_t lastSent;          /* When the reply last made progress       */
+   BOOL   closing;           /* Drop the client once the reply is sent  */
+}  CLIENT;
+
+/************************************************************************/
+/* Globals
+*/
+static CACHEENTRY *sCache     = NULL;     /* Most recently used first  */
+static int        sNCached    = 0,
+                  sMaxCached  = DEF_MAXCACHE;
+static long       sHits       = 0,
+                  sMisses     = 0;
+static volatile sig_atomic_t sStop = 0;
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                  int *maxCached, int *firstFile);
+void Usage(void);
+BOOL DefaultSocketName(char *socketName);
+int OpenServerSocket(char *socketName);
+void CatchSignal(int sig);
+void ServeClients(int listenFd);
+BOOL ReadFromClient(CLIENT *client);
+BOOL SendReply(CLIENT *client);
+void CloseClient(CLIENT *client);
+BOOL HandleRequest(char *request, FILE *out);
+int SplitWords(char *line, char **words, int maxWords);
+CACHEENTRY *GetStructure(char *path, char *error);
+CACHEENTRY *LoadStructure(char *path, BTFILESTAMP *fileStamp,
+                          char *error);
+BOOL IndexStructure(CACHEENTRY *entry);
+void DropStructure(CACHEENTRY *entry);
+void FreeCacheEntry(CACHEENTRY *entry);
+BOOL QueryCheckForRes(int nwords, char **words, FILE *out);
+BOOL QuerySphere(int nwords, char **words, FILE *out);
+int FlagResiduesInRange(CACHEENTRY *entry, int central, REAL radiusSq);
+void WriteCentreSummary(CACHEENTRY *entry, int central, REAL radiusSq,
+                        BOOL colons, FILE *out);
+void WriteResidueID(PDB *p, FILE *out, BOOL colons, BOOL compact);
+BOOL QueryFindResRange(int nwords, char **words, FILE *out);
+BOOL QueryGetChain(int nwords, char **words, FILE *out);
+BOOL QueryControl(int nwords, char **words, FILE *out);
+void ReplyError(FILE *out, char *format, char *arg);
+int CompareInts(const void *a, const void *b);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Uses DefaultSocketName()
+*/
+int main(int argc, char **argv)
+{
+   char   socketName[MAXBUFF],
+          error[MAXBUFF];
+   int    listenFd,
+          firstFile,
+          i;
+   struct sigaction action;
+
+   btInitTiming(&argc, argv);
+
+   if(!ParseCmdLine(argc, argv, socketName, &sMaxCached, &firstFile))
+   {
+      Usage();
+      return(0);
+   }
+   if((socketName[0] == '\0') && !DefaultSocketName(socketName))
+      return(1);
+
+   for(i=firstFile; i<argc; i++)
+   {
+      if(GetStructure(argv[i], error) == NULL)
+         fprintf(stderr, "Warning: (pdbserver) %s\n", error);
+   }
+
+   if((listenFd = OpenServerSocket(socketName)) < 0)
+      return(1);
+
+   memset(&action, 0, sizeof(struct sigaction));
+   action.sa_handler = CatchSignal;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGINT,  &action, NULL);
+   sigaction(SIGTERM, &action, NULL);
+   action.sa_handler = SIG_IGN;
+   sigaction(SIGPIPE, &action, NULL);
+
+   ServeClients(listenFd);
+
+   close(listenFd);
+   unlink(socketName);
+   while(sCache != NULL)
+      DropStructure(sCache);
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                     int *maxCached, int *firstFile)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]      argc         Argument count
+   \param[in]      **argv       Argument array
+   \param[out]     *socketName  Socket path (blank for the default)
+   \param[out]     *maxCached   Most structures to keep
+   \param[out]     *firstFile   Index in argv of the first file to
+                                preload
+   \return                      Success?
+
+   Parse the command line
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Leaves the default socket to DefaultSocketName()
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *socketName,
+                  int *maxCached, int *firstFile)
+{
+   int i;
+
+   socketName[0] = '\0';
+   if(getenv(SOCKET_ENV) != NULL)
+      strncpy(socketName, getenv(SOCKET_ENV), MAXBUFF);
+   socketName[MAXBUFF-1] = '\0';
+
+   for(i=1; (i<argc) && (argv[i][0] == '-'); i++)
+   {
+      switch(argv[i][1])
+      {
+      case 's':
+         if(++i >= argc)
+            return(FALSE);
+         strncpy(socketName, argv[i], MAXBUFF);
+         socketName[MAXBUFF-1] = '\0';
+         break;
+      case 'n':
+         if(++i >= argc)
+            return(FALSE);
+         if((sscanf(argv[i], "%d", maxCached) != 1) || (*maxCached < 1))
+            return(FALSE);
+         break;
+      default:
+         return(FALSE);
+      }
+   }
+
+   *firstFile = i;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Prints a usage message
+
+-  19.10.26 Original    By: agent
+-  19.10.26 V1.3
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\npdbserver V1.3 (c) 2026 UCL\n");
+   fprintf(stderr,"\nUsage: pdbserver [-s socket] [-n maxstruct] \
+[file.pdb ...]\n");
+   fprintf(stderr,"       -s Socket to listen on (Default: $%s, \
+$%s/%s\n", SOCKET_ENV, RUNTIME_ENV, SOCKET_NAME);
+   fprintf(stderr,"          or /tmp/pdbserver-<uid>/%s)\n", \
+SOCKET_NAME);
+   fprintf(stderr,"       -n Number of structures to cache \
+(Default: %d)\n", DEF_MAXCACHE);
+   fprintf(stderr,"\nAnswers pdbcheckforres, pdbsphere, pdbfindresrange \
+and pdbgetchain\n");
+   fprintf(stderr,"queries over a Unix socket. Structures are read \
+once, indexed and kept\n");
+   fprintf(stderr,"in a least-recently-used cache. Any files named are \
+loaded at start-up.\n");
+   fprintf(stderr,"Use pdbquery to send queries. Stop the server with \
+'pdbquery shutdown'\n");
+   fprintf(stderr,"or by killing it.\n\n");
+}
+
+
+/************************************************************************/
+/*>BOOL DefaultSocketName(char *socketName)
+   ----------------------------------------
+*//**
+
+   \param[out]     *socketName   Socket path
+   \return                       Success?
+
+   The default socket is in $XDG_RUNTIME_DIR. If that is not set, it
+   is in /tmp/pdbserver-<uid>, which is created with mode 0700. That
+   directory is refused if it is not a real directory that belongs to
+   the user and only the user can access, since anyone can create it
+   first.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL DefaultSocketName(char *socketName)
+{
+   char        dir[MAXBUFF],
+               *env;
+   struct stat statBuff;
+
+   if(((env = getenv(RUNTIME_ENV)) != NULL) && (env[0] != '\0'))
+   {
+      sprintf(socketName, "%.200s/%s", env, SOCKET_NAME);
+      return(TRUE);
+   }
+
+   sprintf(dir, SOCKET_DIR, (unsigned long)getuid());
+   if(mkdir(dir, 0700) && (errno != EEXIST))
+   {
+      fprintf(stderr,"Error: (pdbserver) Unable to create %s: %s\n",
+              dir, strerror(errno));
+      return(FALSE);
+   }
+   if(lstat(dir, &statBuff) || !S_ISDIR(statBuff.st_mode) ||
+      (statBuff.st_uid != getuid()) || (statBuff.st_mode & 077))
+   {
+      fprintf(stderr,"Error: (pdbserver) %s is not a private \
+directory\n", dir);
+      return(FALSE);
+   }
+
+   sprintf(socketName, "%s/%s", dir, SOCKET_NAME);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>int OpenServerSocket(char *socketName)
+   --------------------------------------
+*//**
+
+   \param[in]      *socketName   Socket path
+   \return                       Listening socket (-1 on error)
+
+   Creates the socket with mode 0600. A stale socket left by a server
+   that was killed is removed, but one that a server is still
+   listening on is not, and nor is anything that is not a socket.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Created under umask 0177. Refuses to remove anything but
+            a socket
+*/
+int OpenServerSocket(char *socketName)
+{
+   struct sockaddr_un addr;
+   struct stat        statBuff;
+   mode_t             oldMask;
+   int                fd,
+                      ok = (-1);
+
+   if(strlen(socketName) >= sizeof(addr.sun_path))
+   {
+      fprintf(stderr,"Error: (pdbserver) Socket name too long: %s\n",
+              socketName);
+      return(-1);
+   }
+
+   memset(&addr, 0, sizeof(struct sockaddr_un));
+   addr.sun_family = AF_UNIX;
+   strcpy(addr.sun_path, socketName);
+
+   if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+   {
+      perror("pdbserver: socket");
+      return(-1);
+   }
+
+   if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0)
+   {
+      fprintf(stderr,"Error: (pdbserver) A server is already running \
+on %s\n", socketName);
+      close(fd);
+      return(-1);
+   }
+   close(fd);
+
+   if(!lstat(socketName, &statBuff))
+   {
+      if(!S_ISSOCK(statBuff.st_mode))
+      {
+         fprintf(stderr,"Error: (pdbserver) %s exists and is not a \
+socket\n", socketName);
+         return(-1);
+      }
+      unlink(socketName);
+   }
+
+   if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) >= 0)
+   {
+      oldMask = umask(0177);
+      ok      = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+      umask(oldMask);
+   }
+
+   if((fd < 0) || (ok < 0) || (listen(fd, MAXCLIENTS) < 0))
+   {
+      fprintf(stderr,"Error: (pdbserver) Unable to listen on %s: %s\n",
+              socketName, strerror(errno));
+      if(fd >= 0)
+         close(fd);
+      return(-1);
+   }
+
+   return(fd);
+}
+
+
+/************************************************************************/
+/*>void CatchSignal(int sig)
+   -------------------------
+*//**
+
+   \param[in]      sig     Signal number
+
+   Asks the server loop to stop so that the socket is removed
+
+-  19.10.26 Original    By: agent
+*/
+void CatchSignal(int sig)
+{
+   sStop = 1;
+}
+
+
+/************************************************************************/
+/*>void ServeClients(int listenFd)
+   -------------------------------
+*//**
+
+   \param[in]      listenFd    Listening socket
+
+   Accepts connections and handles requests until a shutdown request
+   or a signal. A client with a reply waiting is polled for writing
+   rather than reading, and is dropped if the reply makes no progress
+   for SEND_TIMEOUT seconds.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Client sockets are non-blocking and replies are sent with
+            SendReply()
+*/
+void ServeClients(int listenFd)
+{
+   struct pollfd  fds[MAXCLIENTS+1];
+   CLIENT         clients[MAXCLIENTS];
+   int            nclients = 0,
+                  npending,
+                  fd,
+                  i;
+   BOOL           keep;
+
+   while(!sStop)
+   {
+      fds[0].fd     = listenFd;
+      fds[0].events = (nclients < MAXCLIENTS) ? POLLIN : 0;
+      npending      = 0;
+      for(i=0; i<nclients; i++)
+      {
+         fds[i+1].fd = clients[i].fd;
+         if(clients[i].reply != NULL)
+         {
+            fds[i+1].events = POLLOUT;
+            npending++;
+         }
+         else
+         {
+            fds[i+1].events = POLLIN;
+         }
+      }
+
+      /* Wake up each second while replies are waiting so that stuck
+         clients can be dropped
+      */
+      if(poll(fds, nclients+1, (npending ? 1000 : -1)) < 0)
+      {
+         if(errno == EINTR)
+            continue;
+         perror("pdbserver: poll");
+         break;
+      }
+
+      /* Work backwards so that a client can be removed by moving the
+         last one into its place
+      */
+      for(i=nclients-1; i>=0; i--)
+      {
+         keep = TRUE;
+         if(clients[i].reply != NULL)
+         {
+            if(fds[i+1].revents)
+               keep = SendReply(&(clients[i]));
+            else if(time(NULL) - clients[i].lastSent > SEND_TIMEOUT)
+               keep = FALSE;
+         }
+         else if(fds[i+1].revents)
+         {
+            keep = ReadFromClient(&(clients[i]));
+         }
+
+         if(!keep)
+         {
+            CloseClient(&(clients[i]));
+            clients[i] = clients[--nclients];
+         }
+      }
+
+      if(fds[0].revents & POLLIN)
+      {
+         if((fd = accept(listenFd, NULL, NULL)) >= 0)
+         {
+            if(fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0)
+            {
+               close(fd);
+            }
+            else
+            {
+               memset(&(clients[nclients]), 0, sizeof(CLIENT));
+               clients[nclients].fd = fd;
+               nclients++;
+            }
+         }
+      }
+   }
+
+   /* Make one attempt to send what is left (such as the reply to the
+      shutdown request)
+   */
+   for(i=0; i<nclients; i++)
+   {
+      if(clients[i].reply != NULL)
+         SendReply(&(clients[i]));
+      CloseClient(&(clients[i]));
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL ReadFromClient(CLIENT *client)
+   -----------------------------------
+*//**
+
+   \param[in,out]  *client   Client with data waiting
+   \return                   FALSE if the client should be dropped
+
+   Reads what the client has sent and handles each complete line. The
+   replies are built in memory and then sent with SendReply().
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Builds the replies in memory
+*/
+BOOL ReadFromClient(CLIENT *client)
+{
+   FILE *out;
+   char *start,
+        *eol;
+   int  nread,
+        used;
+
+   nread = read(client->fd, client->buffer + client->nbuff,
+                MAXLINE - 1 - client->nbuff);
+   if(nread < 0)
+      return((errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+             (errno == EINTR));
+   if(nread == 0)
+      return(FALSE);
+
+   client->nbuff += nread;
+   client->buffer[client->nbuff] = '\0';
+
+   if((out = open_memstream(&(client->reply),
+                            &(client->replySize))) == NULL)
+      return(FALSE);
+
+   start = client->buffer;
+   while((eol = strchr(start, '\n')) != NULL)
+   {
+      *eol = '\0';
+      if(!HandleRequest(start, out))
+         sStop = 1;
+      fprintf(out, "%s\n", END_OF_REPLY);
+      start = eol + 1;
+   }
+
+   used = start - client->buffer;
+   client->nbuff -= used;
+   memmove(client->buffer, start, client->nbuff);
+
+   if(client->nbuff >= MAXLINE - 1)
+   {
+      ReplyError(out, "Request too long", NULL);
+      fprintf(out, "%s\n", END_OF_REPLY);
+      client->closing = TRUE;
+   }
+
+   if(fclose(out) == EOF)
+   {
+      FREE(client->reply);
+      return(FALSE);
+   }
+
+   if(client->replySize == 0)
+   {
+      FREE(client->reply);
+      return(TRUE);
+   }
+
+   client->replySent = 0;
+   client->lastSent  = time(NULL);
+   return(SendReply(client));
+}
+
+
+/************************************************************************/
+/*>BOOL SendReply(CLIENT *client)
+   ------------------------------
+*//**
+
+   \param[in,out]  *client   Client with a reply waiting
+   \return                   FALSE if the client should be dropped
+
+   Sends as much of the reply as the socket will take without
+   blocking. The reply is freed once it has all gone.
+
+-  19.10.26 Original    By: agent
+*/
+BOOL SendReply(CLIENT *client)
+{
+   ssize_t nsent;
+
+   while(client->replySent < client->replySize)
+   {
+      nsent = write(client->fd, client->reply + client->replySent,
+                    client->replySize - client->replySent);
+      if(nsent < 0)
+      {
+         if(errno == EINTR)
+            continue;
+         return((errno == EAGAIN) || (errno == EWOULDBLOCK));
+      }
+      client->replySent += nsent;
+      client->lastSent   = time(NULL);
+   }
+
+   FREE(client->reply);
+   client->replySize = client->replySent = 0;
+
+   return(!client->closing);
+}
+
+
+/************************************************************************/
+/*>void CloseClient(CLIENT *client)
+   --------------------------------
+*//**
+
+   \param[in,out]  *client   Client to close
+
+   Closes the connection and frees any reply that was not sent
+
+-  19.10.26 Original    By: agent
+*/
+void CloseClient(CLIENT *client)
+{
+   close(client->fd);
+   FREE(client->reply);
+}
+
+
+/************************************************************************/
+/*>BOOL HandleRequest(char *request, FILE *out)
+   --------------------------------------------
+*//**
+
+   \param[in]      *request   Request line (modified)
+   \param[in]      *out       Where to write the reply
+   \return                    FALSE if the server should stop
+
+   Writes the reply to one request, but not the line that ends it
+
+-  19.10.26 Original    By: agent
+*/
+BOOL HandleRequest(char *request, FILE *out)
+{
+   char *words[MAXWORDS];
+   int  nwords;
+
+   if((nwords = SplitWords(request, words, MAXWORDS)) < 0)
+   {
+      ReplyError(out, "Too many words in request", NULL);
+   }
+   else if(nwords == 0)
+   {
+      ReplyError(out, "Empty request", NULL);
+   }
+   else if(!strcmp(words[0], "pdbcheckforres"))
+   {
+      QueryCheckForRes(nwords, words, out);
+   }
+   else if(!strcmp(words[0], "pdbsphere"))
+   {
+      QuerySphere(nwords, words, out);
+   }
+   else if(!strcmp(words[0], "pdbfindresrange"))
+   {
+      QueryFindResRange(nwords, words, out);
+   }
+   else if(!strcmp(words[0], "pdbgetchain"))
+   {
+      QueryGetChain(nwords, words, out);
+   }
+   else
+   {
+      return(QueryControl(nwords, words, out));
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>int SplitWords(char *line, char **words, int maxWords)
+   ------------------------------------------------------
+*//**
+
+   \param[in,out]  *line      Line to split (modified)
+   \param[out]     **words    Pointers to the words
+   \param[in]      maxWords   Size of words[]
+   \return                    Number of words (-1 if too many)
+
+   Splits a line at white space
+
+-  19.10.26 Original    By: agent
+*/
+int SplitWords(char *line, char **words, int maxWords)
+{
+   char *word;
+   int  nwords = 0;
+
+   for(word=strtok(line, " \t\r"); word!=NULL; word=strtok(NULL, " \t\r"))
+   {
+      if(nwords == maxWords)
+         return(-1);
+      words[nwords++] = word;
+   }
+   return(nwords);
+}
+
+
+/************************************************************************/
+/*>CACHEENTRY *GetStructure(char *path, char *error)
+   -------------------------------------------------
+*//**
+
+   \param[in]      *path     PDB file
+   \param[out]     *error    Error message (if NULL returned)
+   \return                   Cached structure
+
+   Finds a structure in the cache, loading it if it is not there or if
+   the file has changed. The structure becomes the most recently used
+   and the least recently used is dropped if the cache is full.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Compares BTFILESTAMPs rather than the size and mtime
+*/
+CACHEENTRY *GetStructure(char *path, char *error)
+{
+   CACHEENTRY  *entry;
+   struct stat statBuff;
+   BTFILESTAMP fileStamp;
+
+   if(stat(path, &statBuff))
+   {
+      sprintf(error, "Unable to access %.200s", path);
+      return(NULL);
+   }
+   btGetFileStamp(&statBuff, &fileStamp);
+
+   for(entry=sCache; entry!=NULL; NEXT(entry))
+   {
+      if(!strcmp(entry->path, path))
+         break;
+   }
+
+   if((entry != NULL) && !btSameFileStamp(&(entry->fileStamp),
+                                          &fileStamp))
+   {
+      DropStructure(entry);
+      entry = NULL;
+   }
+
+   if(entry == NULL)
+   {
+      sMisses++;
+      if((entry = LoadStructure(path, &fileStamp, error)) == NULL)
+         return(NULL);
+      while(sNCached >= sMaxCached)
+      {
+         CACHEENTRY *last;
+         for(last=sCache; last->next!=NULL; NEXT(last))
+            continue;
+         DropStructure(last);
+      }
+      sNCached++;
+   }
+   else
+   {
+      sHits++;
+      if(entry == sCache)
+         return(entry);
+      /* Unlink it                                                      */
+      entry->prev->next = entry->next;
+      if(entry->next != NULL)
+         entry->next->prev = entry->prev;
+   }
+
+   /* Put it at the front                                               */
+   entry->prev = NULL;
+   entry->next = sCache;
+   if(sCache != NULL)
+      sCache->prev = entry;
+   sCache = entry;
+
+   return(entry);
+}
+
+
+/************************************************************************/
+/*>CACHEENTRY *LoadStructure(char *path, BTFILESTAMP *fileStamp,
+                             char *error)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]      *path        PDB file
+   \param[in]      *fileStamp   File stamp when it was opened
+   \param[out]     *error       Error message (if NULL returned)
+   \return                      New cache entry (not in the cache)
+
+   Reads a structure, with HETATMs, and builds its indexes
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Takes a BTFILESTAMP rather than the stat() information
+*/
+CACHEENTRY *LoadStructure(char *path, BTFILESTAMP *fileStamp,
+                          char *error)
+{
+   CACHEENTRY *entry;
+   FILE       *in,
+              *out = stdout;
+
+   if((entry = (CACHEENTRY *)calloc(1, sizeof(CACHEENTRY))) == NULL)
+   {
+      strcpy(error, "No memory for cache entry");
+      return(NULL);
+   }
+   entry->fileStamp = *fileStamp;
+
+   if((entry->path = (char *)malloc(strlen(path)+1)) == NULL)
+   {
+      strcpy(error, "No memory for cache entry");
+      FreeCacheEntry(entry);
+      return(NULL);
+   }
+   strcpy(entry->path, path);
+
+   if(!btOpenStdFiles(path, NULL, &in, &out))
+   {
+      sprintf(error, "Unable to read %.200s", path);
+      FreeCacheEntry(entry);
+      return(NULL);
+   }
+   entry->wpdb = btReadWholePDB(in);
+   fclose(in);
+
+   if((entry->wpdb == NULL) || (entry->wpdb->pdb == NULL))
+   {
+      sprintf(error, "No atoms read from %.200s", path);
+      FreeCacheEntry(entry);
+      return(NULL);
+   }
+
+   if(!IndexStructure(entry))
+   {
+      strcpy(error, "No memory for structure index");
+      FreeCacheEntry(entry);
+      return(NULL);
+   }
+
+   return(entry);
+}
+
+
+/************************************************************************/
+/*>BOOL IndexStructure(CACHEENTRY *entry)
+   --------------------------------------
+*//**
+
+   \param[in,out]  *entry    Cache entry with the structure read
+   \return                   Success?
+
+   Builds the residue index (see common/resindex.c), the tables used by
+   sphere queries and the spatial grid.
+
+-  19.10.26 Original    By: agent
+-  19.10.26 Uses the shared residue index
+*/
+BOOL IndexStructure(CACHEENTRY *entry)
+{
+   int nres;
+
+   if((entry->index = btBuildResIndex(entry->wpdb->pdb)) == NULL)
+      return(FALSE);
+   nres = entry->index->nres;
+
+   entry->resStamp   = (int *)calloc(nres+1, sizeof(int));
+   entry->hits       = (int *)malloc((nres+1) * sizeof(int));
+   if((entry->resStamp == NULL) || (entry->hits == NULL))
+      return(FALSE);
+
+   if((entry->grid = btBuildSpatialGrid(entry->index->atoms,
+                                        entry->index->natoms,
+                                        GRID_CELL)) == NULL)
+      return(FALSE);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void DropStructure(CACHEENTRY *entry)
+   -------------------------------------
+*//**
+
+   \param[in]      *entry    Cached structure
+
+   Removes a structure from the cache and frees it
+
+-  19.10.26 Original    By: agent
+*/
+void DropStructure(CACHEENTRY *entry)
+{
+   if(entry->prev != NULL)
+      entry->prev->next = entry->next;
+   else
+      sCache = entry->next;
+   if(entry->next != NULL)
+      entry->next->prev = entry->prev;
+
+   sNCached--;
+   FreeCacheEntry(entry);
+}
+
+
+/************************************************************************/
+/*>void FreeCacheEntry(CACHEENTRY *entry)
+   --------------------------------------
+*//**
+
+   \param[in]      *entry    Cache entry (not in the cache)
+
+   Frees a cache entry, its structure and its indexes
+
+-  19.10.26 Original    By: agent
+*/
+void FreeCacheEntry(CACHEENTRY *entry)
+{
+   if(entry->wpdb != NULL)
+   {
+      FREELIST(entry->wpdb->pdb, PDB);
+      blFreeStringList(entry->wpdb->header);
+      blFreeStringList(entry->wpdb->trailer);
+      free(entry->wpdb);
+   }
+   btFreeResIndex(entry->index);
+   btFreeSpatialGrid(entry->grid);
+   FREE(entry->path);
+   FREE(entry->resStamp);
+   FREE(entry->hits);
+   free(entry);
+}
+
+
+/************************************************************************/
+/*>BOOL QueryCheckForRes(int nwords, char **words, FILE *out)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]      nwords     Number of words in the request
+   \param[in]      **words    The request
+   \param[in]      *out       Where to write the reply
+   \return                    Success?
+
+   pdbcheckforres [-H] resspec file
+
+   As pdbcheckforres, HETATM residues only count with -H
+
+-  19.10.26 Original   By: agent
+*/
+BOOL QueryCheckForRes(int nwords, char **words, FILE *out)
+{
+   CACHEENTRY *entry;
+   char       error[MAXBUFF];
+   BOOL       readHet = FALSE;
+   int        i,
+              res;
+
+   for(i=1; (i<nwords) && (words[i][0] == '-'); i++)
+   {
+      if(!strcmp(words[i], "-H"))
+      {
+         readHet = TRUE;
+      }
+      else
+      {
+         ReplyError(out, "Unknown pdbcheckforres option %s", words[i]);
+         return(FALSE);
+      }
+   }
+   if(nwords - i != 2)
+   {
+      ReplyError(out, "Usage: pdbcheckforres [-H] resspec file", NULL);
+      return(FALSE);
+   }
+
+   if((entry = GetStructure(words[i+1], error)) == NULL)
+   {
+      ReplyError(out, "%s", error);
+      return(FALSE);
+   }
+
+   if((res = btFindIndexedResSpec(entry->index, words[i],
+                                  (readHet?' ':'A'))) == -2)
+   {
+      ReplyError(out, "Illegal residue specification (%s)", words[i]);
+      return(FALSE);
+   }
+
+   fprintf(out, "OK\n%s\n", ((res >= 0) ? "YES" : "NO"));
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL QuerySphere(int nwords, char **words, FILE *out)
+   -----------------------------------------------------
+*//**
+
+   \param[in]      nwords     Number of words in the request
+   \param[in]      **words    The request
+   \param[in]      *out       Where to write the reply
+   \return                    Success?
+
+   pdbsphere [-r radius] [-s] [-c] [-H] [-a] [resspec] file
+
+   As pdbsphere: the atoms (or with -s the residues) within the radius
+   of a residue, or with -a or a comma-separated list of residues a
+   summary line for each. Residues in a list that are not found are
+   skipped (pdbsphere warns about them).
+
+-  19.10.26 Original   By: agent
+*/
+BOOL QuerySphere(int nwords, char **words, FILE *out)
+{
+   CACHEENTRY *entry;
+   PDB        *p;
+   char       error[MAXBUFF],
+              *resspec = NULL,
+              *spec;
+   REAL       radius   = GRID_CELL;
+   BOOL       summary  = FALSE,
+              colons   = FALSE,
+              isHet    = FALSE,
+              doAuto   = FALSE;
+   int        i,
+              res,
+              nhits;
+
+   for(i=1; (i<nwords) && (words[i][0] == '-'); i++)
+   {
+      if((words[i][1] == '\0') || (words[i][2] != '\0'))
+      {
+         ReplyError(out, "Unknown pdbsphere option %s", words[i]);
+         return(FALSE);
+      }
+      switch(words[i][1])
+      {
+      case 's':
+         summary = TRUE;
+         break;
+      case 'c':
+         colons = TRUE;
+         break;
+      case 'H':
+         isHet = TRUE;
+         break;
+      case 'a':
+         doAuto = TRUE;
+         break;
+      case 'r':
+         if((++i >= nwords) || (sscanf(words[i], "%lf", &radius) != 1))
+         {
+            ReplyError(out, "-r must be followed by a radius", NULL);
+            return(FALSE);
+         }
+         break;
+      default:
+         ReplyError(out, "Unknown pdbsphere option %s", words[i]);
+         return(FALSE);
+      }
+   }
+
+   if(nwords - i != (doAuto ? 1 : 2))
+   {
+      ReplyError(out, "Usage: pdbsphere [-r radius] [-s] [-c] [-H] [-a] \
+[resspec] file", NULL);
+      return(FALSE);
+   }
+   if(!doAuto)
+      resspec = words[i++];
+
+   if((entry = GetStructure(words[i], error)) == NULL)
+   {
+      ReplyError(out, "%s", error);
+      return(FALSE);
+   }
+
+   if(doAuto)
+   {
+      fprintf(out, "OK\n");
+      for(res=0; res<entry->index->nres; res++)
+         WriteCentreSummary(entry, res, radius*radius, colons, out);
+      return(TRUE);
+   }
+
+   if(strchr(resspec, ',') != NULL)
+   {
+      fprintf(out, "OK\n");
+      for(spec=strtok(resspec, ","); spec!=NULL; spec=strtok(NULL, ","))
+      {
+         if((res = btFindIndexedResSpec(entry->index, spec,
+                                        (isHet?'H':' '))) >= 0)
+            WriteCentreSummary(entry, res, radius*radius, colons, out);
+      }
+      return(TRUE);
+   }
+
+   if((res = btFindIndexedResSpec(entry->index, resspec,
+                                  (isHet?'H':' '))) < 0)
+   {
+      ReplyError(out, "Residue %s not found", resspec);
+      return(FALSE);
+   }
+
+   nhits = FlagResiduesInRange(entry, res, radius*radius);
+
+   fprintf(out, "OK\n");
+   for(i=0; i<nhits; i++)
+   {
+      res = entry->hits[i];
+      if(summary)
+      {
+         WriteResidueID(BTRESSTART(entry->index, res), out, colons,
+                        FALSE);
+      }
+      else
+      {
+         for(p=BTRESSTART(entry->index, res);
+             p!=BTRESEND(entry->index, res);
+             NEXT(p))
+            blWritePDBRecord(out, p);
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>int FlagResiduesInRange(CACHEENTRY *entry, int central, REAL radiusSq)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in,out]  *entry      Cached structure
+   \param[in]      central     Central residue number
+   \param[in]      radiusSq    Squared radius
+   \return                     Number of residues in range
+
+   Finds the residues with any atom within range of any atom of the
+   central residue, as pdbsphere does. The residue numbers are placed
+   in entry->hits[] in file order.
+
+-  19.10.26 Original   By: agent
+*/
+int FlagResiduesInRange(CACHEENTRY *entry, int central, REAL radiusSq)
+{
+   PDB       *p;
+   GRIDQUERY query;
+   REAL      distSq;
+   int       nhits = 0,
+             atom,
+             res;
+
+   entry->stamp++;
+   for(p=BTRESSTART(entry->index, central);
+       p!=BTRESEND(entry->index, central);
+       NEXT(p))
+   {
+      btStartGridQuery(&query, entry->grid, p->x, p->y, p->z, radiusSq);
+      while((atom = btNextGridNeighbour(&query, &distSq)) >= 0)
+      {
+         res = entry->index->resOfAtom[atom];
+         if((entry->resStamp[res] != entry->stamp) && (distSq < radiusSq))
+         {
+            entry->resStamp[res] = entry->stamp;
+            entry->hits[nhits++] = res;
+         }
+      }
+   }
+
+   qsort(entry->hits, nhits, sizeof(int), CompareInts);
+
+   return(nhits);
+}
+
+
+/************************************************************************/
+/*>void WriteCentreSummary(CACHEENTRY *entry, int central, REAL radiusSq,
+                           BOOL colons, FILE *out)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in,out]  *entry      Cached structure
+   \param[in]      central     Central residue number
+   \param[in]      radiusSq    Squared radius
+   \param[in]      colons      Include colons in output format
+   \param[in]      *out        output file
+
+   Writes pdbsphere's one-line summary for a central residue
+
+-  19.10.26 Original   By: agent
+*/
+void WriteCentreSummary(CACHEENTRY *entry, int central, REAL radiusSq,
+                        BOOL colons, FILE *out)
+{
+   PDB *p = BTRESSTART(entry->index, central);
+   int nhits,
+       i;
+
+   nhits = FlagResiduesInRange(entry, central, radiusSq);
+   fprintf(out, "%s %s%d%s:", p->resnam, p->chain, p->resnum, p->insert);
+   for(i=0; i<nhits; i++)
+      WriteResidueID(BTRESSTART(entry->index, entry->hits[i]), out,
+                     colons, TRUE);
+   fprintf(out, "\n");
+}
+
+
+/************************************************************************/
+/*>void WriteResidueID(PDB *p, FILE *out, BOOL colons, BOOL compact)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *p       First atom of a residue
+   \param[in]      *out     output file
+   \param[in]      colons   Include colons in output format
+   \param[in]      compact  Space-separated on one line
+
+   Writes the ID of one residue in the formats used by pdbsphere
+
+-  19.10.26 Original   By: agent
+*/
+void WriteResidueID(PDB *p, FILE *out, BOOL colons, BOOL compact)
+{
+   if(colons && !compact)
+   {
+      fprintf(out, "%s:%d:%s\n", p->chain, p->resnum, p->insert);
+   }
+   else
+   {
+      fprintf(out, "%s%s%s%d%c%s", (compact?" ":""), p->chain,
+              (isdigit(p->chain[0])?".":""), p->resnum, p->insert[0],
+              (compact?"":"\n"));
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL QueryFindResRange(int nwords, char **words, FILE *out)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]      nwords     Number of words in the request
+   \param[in]      **words    The request
+   \param[in]      *out       Where to write the reply
+   \return                    Success?
+
+   pdbfindresrange resspec width file
+
+   As pdbfindresrange, the residues width before and after the key
+   residue in the first chain with its chain label.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Finds the chain with the shared residue index
+*/
+BOOL QueryFindResRange(int nwords, char **words, FILE *out)
+{
+   CACHEENTRY *entry;
+   RESINDEX   *index;
+   char       error[MAXBUFF],
+              chain[blMAXCHAINLABEL],
+              insert[8],
+              startres[SMALLBUFF],
+              endres[SMALLBUFF];
+   int        width,
+              resnum,
+              res,
+              ch;
+
+   if((nwords != 4) || (sscanf(words[2], "%d", &width) != 1))
+   {
+      ReplyError(out, "Usage: pdbfindresrange resspec width file",
+                 NULL);
+      return(FALSE);
+   }
+
+   if((entry = GetStructure(words[3], error)) == NULL)
+   {
+      ReplyError(out, "%s", error);
+      return(FALSE);
+   }
+
+   index = entry->index;
+
+   if((res = btFindIndexedResSpec(index, words[1], ' ')) == -2)
+   {
+      ReplyError(out, "Illegal key residue specification: %s", words[1]);
+      return(FALSE);
+   }
+   blParseResSpec(words[1], chain, &resnum, insert);
+
+   /* pdbfindresrange only looks in the first chain with this label. The
+      first residue with a spec is in that chain if the chain has it
+   */
+   ch = btFindIndexedChain(index, chain);
+   if((res < 0) || (index->chainOfRes[res] != ch))
+   {
+      ReplyError(out, "Key residue %s not found", words[1]);
+      return(FALSE);
+   }
+   if(res - width < index->chainStart[ch])
+   {
+      sprintf(error, "No residue %d before key residue %.200s", width,
+              words[1]);
+      ReplyError(out, "%s", error);
+      return(FALSE);
+   }
+   if(res + width >= index->chainStart[ch+1])
+   {
+      sprintf(error, "No residue %d after key residue %.200s", width,
+              words[1]);
+      ReplyError(out, "%s", error);
+      return(FALSE);
+   }
+
+   blBuildResSpec(BTRESSTART(index, res-width), startres);
+   blBuildResSpec(BTRESSTART(index, res+width), endres);
+   fprintf(out, "OK\n%s %s\n", startres, endres);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL QueryGetChain(int nwords, char **words, FILE *out)
+   -------------------------------------------------------
+*//**
+
+   \param[in]      nwords     Number of words in the request
+   \param[in]      **words    The request
+   \param[in]      *out       Where to write the reply
+   \return                    Success?
+
+   pdbgetchain [-n] [-a] chain[,chain...] file
+
+   As pdbgetchain, the header, the atoms of the chains requested and
+   the trailer. The selected atoms are linked together in place for
+   writing and the links are then put back from the atom array, so
+   nothing is copied.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL QueryGetChain(int nwords, char **words, FILE *out)
+{
+   CACHEENTRY *entry;
+   RESINDEX   *index;
+   WHOLEPDB   wpdb;
+   PDB        *p,
+              *prev      = NULL,
+              *last      = NULL;
+   char       error[MAXBUFF],
+              *chains[MAXCHAINS],
+              *word;
+   BOOL       numeric    = FALSE,
+              atomsOnly  = FALSE,
+              keep       = FALSE;
+   int        nchains    = 0,
+              chainCount = 0,
+              number,
+              i,
+              j;
+
+   for(i=1; (i<nwords) && (words[i][0] == '-'); i++)
+   {
+      if(!strcmp(words[i], "-n"))
+      {
+         numeric = TRUE;
+      }
+      else if(!strcmp(words[i], "-a"))
+      {
+         atomsOnly = TRUE;
+      }
+      else
+      {
+         ReplyError(out, "Unknown pdbgetchain option %s", words[i]);
+         return(FALSE);
+      }
+   }
+   if(nwords - i != 2)
+   {
+      ReplyError(out, "Usage: pdbgetchain [-n] [-a] chain[,chain...] \
+file", NULL);
+      return(FALSE);
+   }
+
+   if((entry = GetStructure(words[i+1], error)) == NULL)
+   {
+      ReplyError(out, "%s", error);
+      return(FALSE);
+   }
+
+   for(word=strtok(words[i], ","); word!=NULL; word=strtok(NULL, ","))
+   {
+      if(nchains == MAXCHAINS)
+      {
+         ReplyError(out, "Too many chains requested", NULL);
+         return(FALSE);
+      }
+      chains[nchains++] = word;
+   }
+
+   index    = entry->index;
+   wpdb     = *(entry->wpdb);
+   wpdb.pdb = NULL;
+   wpdb.natoms = 0;
+
+   for(i=0; i<index->natoms; i++)
+   {
+      p = index->atoms[i];
+      if(atomsOnly && !strncmp(p->record_type, "HETATM", 6))
+         continue;
+
+      /* A new chain in the list of atoms being considered              */
+      if((prev == NULL) || !CHAINMATCH(p->chain, prev->chain))
+      {
+         chainCount++;
+         keep = FALSE;
+         for(j=0; j<nchains; j++)
+         {
+            if(numeric)
+            {
+               if((sscanf(chains[j], "%d", &number) == 1) &&
+                  (number == chainCount))
+                  keep = TRUE;
+            }
+            else if(CHAINMATCH(p->chain, chains[j]))
+            {
+               keep = TRUE;
+            }
+         }
+      }
+      prev = p;
+
+      if(keep)
+      {
+         if(last == NULL)
+            wpdb.pdb = p;
+         else
+            last->next = p;
+         last = p;
+         wpdb.natoms++;
+      }
+   }
+   if(last != NULL)
+      last->next = NULL;
+
+   fprintf(out, "OK\n");
+   blWriteWholePDB(out, &wpdb);
+
+   /* Restore the links                                                 */
+   for(i=0; i<index->natoms; i++)
+      index->atoms[i]->next = ((i+1 < index->natoms) ?
+                               index->atoms[i+1] : NULL);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL QueryControl(int nwords, char **words, FILE *out)
+   ------------------------------------------------------
+*//**
+
+   \param[in]      nwords     Number of words in the request
+   \param[in]      **words    The request
+   \param[in]      *out       Where to write the reply
+   \return                    FALSE if the server should stop
+
+   Handles the load, drop, stats and shutdown requests
+
+-  19.10.26 Original   By: agent
+*/
+BOOL QueryControl(int nwords, char **words, FILE *out)
+{
+   CACHEENTRY *entry;
+   char       error[MAXBUFF];
+
+   if(!strcmp(words[0], "load") && (nwords == 2))
+   {
+      if((entry = GetStructure(words[1], error)) == NULL)
+         ReplyError(out, "%s", error);
+      else
+         fprintf(out, "OK\n%d atoms %d residues %d chains\n",
+                 entry->index->natoms, entry->index->nres,
+                 entry->index->nchains);
+   }
+   else if(!strcmp(words[0], "drop") && (nwords == 2))
+   {
+      for(entry=sCache; entry!=NULL; NEXT(entry))
+      {
+         if(!strcmp(entry->path, words[1]))
+            break;
+      }
+      if(entry == NULL)
+      {
+         ReplyError(out, "%s is not cached", words[1]);
+      }
+      else
+      {
+         DropStructure(entry);
+         fprintf(out, "OK\n");
+      }
+   }
+   else if(!strcmp(words[0], "stats") && (nwords == 1))
+   {
+      fprintf(out, "OK\ncached %d/%d hits %ld misses %ld\n",
+              sNCached, sMaxCached, sHits, sMisses);
+      for(entry=sCache; entry!=NULL; NEXT(entry))
+         fprintf(out, "%s %d atoms %d residues %d chains\n",
+                 entry->path, entry->index->natoms, entry->index->nres,
+                 entry->index->nchains);
+   }
+   else if(!strcmp(words[0], "shutdown") && (nwords == 1))
+   {
+      fprintf(out, "OK\n");
+      return(FALSE);
+   }
+   else
+   {
+      ReplyError(out, "Unknown request %s", words[0]);
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void ReplyError(FILE *out, char *format, char *arg)
+   ---------------------------------------------------
+*//**
+
+   \param[in]      *out       Where to write the reply
+   \param[in]      *format    Message format with at most one %s
+   \param[in]      *arg       String for the %s (or NULL)
+
+   Writes an error reply line
+
+-  19.10.26 Original   By: agent
+*/
+void ReplyError(FILE *out, char *format, char *arg)
+{
+   fprintf(out, "ERROR ");
+   fprintf(out, format, ((arg == NULL) ? "" : arg));
+   fprintf(out, "\n");
+}
+
+
+/************************************************************************/
+/*>int CompareInts(const void *a, const void *b)
+   ---------------------------------------------
+*//**
+
+   qsort() comparison for integers
+
+-  19.10.26 Original   By: agent
+*/
+int CompareInts(const void *a, const void *b)
+{
+   return(*(const int *)a - *(const int *)b);
+}
+
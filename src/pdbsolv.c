@@ -3,8 +3,8 @@
 
    \file       pdbsolv.c
    
-   \version    V1.6
-   \date       21.11.17
+   \version    V1.12
+   \date       19.10.26
    \brief      Solvent accessibility using bioplib
    
    \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2017
@@ -55,6 +55,16 @@
 -   V1.5   08.03.16 Corrected insert code printing so it is left-justified
                     and now touches the residue number
 -   V1.7   21.11.17 Added -x flag to add radii in occupancy column
+-   V1.8   19.10.26 Reads the PDB file with the shared memory-mapped
+                    reader in common/pdbread.c   By: agent
+-   V1.9   19.10.26 Opens files with btOpenStdFiles() so compressed
+                    input and output are handled in-process
+-   V1.10  19.10.26 Writes with btWriteWholePDB() so the structure is
+                    passed on in memory in a bioptools pipeline
+-   V1.11  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is
+                    set
+-   V1.12  19.10.26 Atoms are read and copied into arenas and released
+                    in one go rather than one at a time
 
 *************************************************************************/
 /* Includes
@@ -67,6 +77,11 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/access.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/arena.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -104,6 +119,8 @@ void PrintResidueAccessibility(FILE *out, PDB *pdb, RESRAD *resrad);
 -  19.08.14 Fixed call to renamed function: blStripWatersPDBAsCopy()
                   By: CTP
 -  13.02.15 Modified to use whole PDB   By: ACRM
+-  19.10.26 Reads the atoms and strips the waters into arenas, so each
+            list is released in one go   By: agent
 
 */
 int main(int argc, char **argv)
@@ -116,6 +133,8 @@ int main(int argc, char **argv)
    int      natoms;
    WHOLEPDB *wpdb;
    PDB      *pdb;
+   ARENA    *readArena,
+            *arena;
    BOOL     doAccessibility = FALSE,
             noenv           = FALSE,
             noAtoms         = FALSE,
@@ -128,6 +147,8 @@ int main(int argc, char **argv)
             radfile[MAXBUFF],
             resfile[MAXBUFF];
    
+   btInitTiming(&argc, argv);
+
    if(!ParseCmdLine(argc, argv, infile, outfile, 
                     &integrationAccuracy, &probeRadius, 
                     radfile, &doAccessibility, resfile, &noAtoms,
@@ -148,14 +169,21 @@ for residue accessibility data (%s)\n", resfile);
       }
    }
 
-   if(!blOpenStdFiles(infile, outfile, &in, &out))
+   if(!btOpenStdFiles(infile, outfile, &in, &out))
    {
       fprintf(stderr, "Error (pdbsolv): Unable to open input or output \
 file\n");
       return(1);
    }
 
-   if((wpdb = blReadWholePDB(in))==NULL)
+   if(((readArena = btNewArena(0))==NULL) ||
+      ((arena     = btNewArena(0))==NULL))
+   {
+      fprintf(stderr, "Error (pdbsolv): No memory for atoms\n");
+      return(1);
+   }
+
+   if((wpdb = btReadWholePDBInArena(in, readArena))==NULL)
    {
       fprintf(stderr, "Error (pdbsolv): No atoms read from PDB \
 file, %s\n", infile);
@@ -163,7 +191,8 @@ file, %s\n", infile);
    }
 
    /* Strip waters                                                      */
-   if((pdb = blStripWatersPDBAsCopy(wpdb->pdb, &natoms))==NULL)
+   if((pdb = btArenaCopyPDB(arena, wpdb->pdb, btSelectNonWater, NULL,
+                            &natoms))==NULL)
    {
       fprintf(stderr, "Error (pdbsolv): No memory to strip waters from \
 PDB file, %s\n",
@@ -171,8 +200,8 @@ PDB file, %s\n",
       return(1);
    }
 
-   /* Free the original linked list of atoms and patch in the new one   */
-   FREELIST(wpdb->pdb, PDB);
+   /* Release the original atoms in one go and patch in the new list    */
+   btFreeArena(readArena);
    wpdb->pdb = pdb;
 
    /* Open the radius file                                              */
@@ -192,6 +221,7 @@ not set\n", DATA_ENV);
    resrad = blSetAtomRadii(pdb, fpRad);
 
    /* Do the actual accessibility calculations                          */
+   btStartTimer("accessibility");
    if(!blCalcAccess(pdb, natoms, 
                     integrationAccuracy, probeRadius,
                     doAccessibility))
@@ -200,6 +230,7 @@ not set\n", DATA_ENV);
 arrays\n");
       return(1);
    }
+   btStopTimer("accessibility");
 
    /* And populate the B-values with the accessibility and write the
       new PDB file
@@ -212,7 +243,7 @@ arrays\n");
          PopulateOccWithRadii(pdb);
       }
       
-      blWriteWholePDB(out, wpdb);
+      btWriteWholePDB(out, wpdb);
    }
 
    if(doResaccess)
@@ -222,7 +253,8 @@ arrays\n");
    }
 
    /* Free up the memory for the PDB linked list                        */
-   FREELIST(pdb, PDB);
+   btFreeWholePDBInArena(wpdb);
+   btFreeArena(arena);
    /* Free up the memory from the residue radii                         */
    FREELIST(resrad, RESRAD);
 
@@ -353,7 +385,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsolv V1.6 (c) 2014-2017 UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbsolv V1.12 (c) 2014-2017 UCL, Dr. Andrew C.R. \
 Martin\n");
 
    fprintf(stderr,"\nUsage: pdbsolv [-i val] [-p val] [-f radfile] \
@@ -3,8 +3,8 @@
 
    \file       pdbsphere.c
    
-   \version    V1.10
-   \date       12.03.15
+   \version    V1.15
+   \date       19.10.26
    \brief      Output all aminoacids within range from central aminoacid 
                in a PDB file
    
@@ -42,6 +42,11 @@
    Outputs all residues from that PDB file, within 8 angstroms (default 
    range) of central residue's coordinates.
 
+   A comma-separated list of central residues (or a file of them, -f)
+   may be given instead, in which case a summary is produced for each
+   centre as in 'auto' mode. A single spatial grid is built over the
+   structure and used for all centres.
+
 **************************************************************************
 
    Usage:
@@ -70,20 +75,53 @@
 -  V1.9  22.07.14  Renamed deprecated functions with bl prefix.
                    Added doxygen annotation. By: CTP
 -  V1.10 12.03.15  Changed to allow multi-character chain names
+-  V1.11 19.10.26  Added multi-centre mode (comma-separated resspecs 
+                   or -f file). Residue flagging now uses a spatial
+                   grid built once per structure and stops testing a
+                   residue as soon as one atom is in range   By: agent
+-  V1.12 19.10.26  Reads the PDB file with the shared memory-mapped
+                   reader in common/pdbread.c
+-  V1.13 19.10.26  Opens files with btOpenStdFiles() so compressed input
+                   and output are handled in-process
+-  V1.14 19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.15 19.10.26  Names stdin in the missing residue messages when
+                   reading from standard input
 
 **************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include "bioplib/pdb.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
 #include "bioplib/macros.h"
+#include "bioplib/general.h"
+#include "bioplib/hash.h"
+#include "common/spatial.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
+#define SMALLBUFF 32
+
+typedef struct
+{
+   SPATIALGRID *grid;
+   HASHTABLE   *resHash;     /* Residue spec to residue number          */
+   PDB         **atoms,      /* All atoms in file order                 */
+               **resStart;   /* First atom of each residue              */
+   int         *resOfAtom,   /* Residue number of each atom             */
+               *resStamp,    /* Last centre that flagged each residue   */
+               *hits;        /* Residues flagged for current centre     */
+   int         natoms,
+               nres;
+}  SPHEREINDEX;
 
 /************************************************************************/
 /* Globals
@@ -93,13 +131,25 @@
 /* Prototypes
 */
 int main(int argc, char **argv);
-void FlagResiduesInRange(PDB *pdb, PDB *central, REAL radiusSq);
+int FlagResiduesInRange(SPHEREINDEX *index, PDB *central, 
+                        REAL radiusSq, int stamp);
 void WriteAtoms(PDB *pdb, FILE *out);
 void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact);
+void WriteResidueID(PDB *p, FILE *out, BOOL colons, BOOL compact);
+void WriteCentreSummary(SPHEREINDEX *index, PDB *central, int nhits,
+                        FILE *out, BOOL colons);
 BOOL ParseCmdLine(int argc, char **argv,char *resspec, char *InFile, 
                   char *OutFile, BOOL *summary, REAL *radiusSq,
-                  BOOL *colons, BOOL *isHet, BOOL *doAuto);
+                  BOOL *colons, BOOL *isHet, BOOL *doAuto,
+                  char *CentreFile);
 void ClearExtras(PDB *pdb);
+SPHEREINDEX *BuildSphereIndex(PDB *pdb, REAL radiusSq);
+void FreeSphereIndex(SPHEREINDEX *index);
+void MakeResidueKey(char *key, char *chain, int resnum, char *insert,
+                    BOOL isHet);
+PDB *FindCentre(SPHEREINDEX *index, char *resspec, BOOL isHet);
+STRINGLIST *ReadCentres(char *resspec, char *CentreFile);
+int CompareInts(const void *a, const void *b);
 void Usage(void);
 
 /************************************************************************/
@@ -112,6 +162,12 @@ void Usage(void);
    a specified radius (default 8A, override with -r). Summary output
    (just the residue list) can be generated with -s and -c provides an
    alternative output format.
+
+   If a comma-separated list of central residues, or a file of them
+   (-f), is given, a summary line is written for each centre.
+
+-  19.10.26 Added multi-centre mode and the spatial index   By: agent
+-  19.10.26 Names stdin rather than a blank file in messages
 */
 int main(int argc, char **argv)
 {
@@ -119,27 +175,42 @@ int main(int argc, char **argv)
           *out = stdout;
    PDB    *pdb,
           *central;         
-   int    natom;
+   int    natom,
+          nhits,
+          stamp = 0,
+          i;
    REAL   radiusSq;
    char   resspec[MAXBUFF],
           InFile[MAXBUFF],
-          OutFile[MAXBUFF];
+          OutFile[MAXBUFF],
+          CentreFile[MAXBUFF];
    BOOL   summary,
           colons = FALSE,
           isHet = FALSE,
           doAuto = FALSE;
+   SPHEREINDEX *index;
+   STRINGLIST  *centres,
+               *s;
    
+   btInitTiming(&argc, argv);
+
    if (ParseCmdLine(argc, argv, resspec, InFile, OutFile, &summary, 
-                    &radiusSq, &colons, &isHet, &doAuto))
+                    &radiusSq, &colons, &isHet, &doAuto, CentreFile))
    {
-      if (blOpenStdFiles(InFile, OutFile, &in, &out))
+      if (btOpenStdFiles(InFile, OutFile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natom))==NULL)
+         if((pdb=btReadPDB(in, &natom))==NULL)
          {
             fprintf(stderr,"Error: (pdbsphere) No atoms read from PDB \
 file\n");
             return(1);
          }
+         else if((index=BuildSphereIndex(pdb, radiusSq))==NULL)
+         {
+            fprintf(stderr,"Error: (pdbsphere) No memory for spatial \
+index\n");
+            return(1);
+         }
          else
          {        
             /* Clear the ->extras field                                 */
@@ -147,17 +218,42 @@ file\n");
 
             if(doAuto)
             {
-               for(central=pdb; central!=NULL; central=blFindNextResidue(central))
+               for(i=0; i<index->nres; i++)
                {
-                  FlagResiduesInRange(pdb, central, radiusSq);
-                  fprintf(out, "%s %s%d%s:",central->resnam, 
-                          central->chain,
-                          central->resnum,
-                          central->insert);
-                  WriteResidues(pdb, out, colons, TRUE);
-                  ClearExtras(pdb);
+                  central = index->resStart[i];
+                  nhits   = FlagResiduesInRange(index, central, 
+                                                radiusSq, ++stamp);
+                  WriteCentreSummary(index, central, nhits, out, 
+                                     colons);
                }
             }
+            else if((CentreFile[0] != '\0') || 
+                    (strchr(resspec, ',') != NULL))
+            {
+               if((centres = ReadCentres(resspec, CentreFile))==NULL)
+               {
+                  fprintf(stderr,"Error: (pdbsphere) No central \
+residues read\n");
+                  return(1);
+               }
+               
+               for(s=centres; s!=NULL; NEXT(s))
+               {
+                  if((central=FindCentre(index, s->string, isHet))==NULL)
+                  {
+                     fprintf(stderr,"Warning: (pdbsphere) Residue %s \
+not found in %s\n", s->string, (InFile[0] ? InFile : "stdin"));
+                  }
+                  else
+                  {
+                     nhits = FlagResiduesInRange(index, central, 
+                                                 radiusSq, ++stamp);
+                     WriteCentreSummary(index, central, nhits, out, 
+                                        colons);
+                  }
+               }
+               blFreeStringList(centres);
+            }
             else
             {
                if(isHet)
@@ -172,12 +268,26 @@ file\n");
                if(central==NULL)
                {
                   fprintf(stderr,"Error: (pdbsphere) Residue %s not \
-found in %s\n", resspec, InFile);
+found in %s\n", resspec, (InFile[0] ? InFile : "stdin"));
                   return(1);
                }
                else                  
                {
-                  FlagResiduesInRange(pdb, central, radiusSq);
+                  PDB *p;
+                  
+                  nhits = FlagResiduesInRange(index, central, radiusSq,
+                                              ++stamp);
+
+                  /* Mark the atoms of the residues in range            */
+                  for(i=0; i<nhits; i++)
+                  {
+                     for(p=index->resStart[index->hits[i]];
+                         p!=index->resStart[index->hits[i]+1];
+                         NEXT(p))
+                     {
+                        p->extras=(APTR)1;
+                     }
+                  }
                
                   if (summary)
                   {
@@ -189,6 +299,8 @@ found in %s\n", resspec, InFile);
                   }      
                }
             }
+
+            FreeSphereIndex(index);
          }
       }      
    }
@@ -200,59 +312,63 @@ found in %s\n", resspec, InFile);
 }
 
 /**********************************************************************/
-/*>void FlagResiduesInRange(PDB *pdb, PDB *central, REAL *radiusSq)
+/*>int FlagResiduesInRange(SPHEREINDEX *index, PDB *central, 
+                           REAL radiusSq, int stamp)
    ----------------------------------------------------------------
 *//**
 
-   \param[in]      *pdb     
+   \param[in,out]  *index      Spatial and residue index of the 
+                               structure
    \param[in]      *central    Pointer to the first atom of a central 
-   \param[in]      Input:   REAL   radiusSq    To be flagged, atom has to be within that 
-   \param[in]      (radius is squared for speed)
+                               residue
+   \param[in]      radiusSq    To be flagged, atom has to be within
+                               this distance (radius is squared for 
+                               speed)
+   \param[in]      stamp       Unique number for this centre
+   \return                     Number of residues in range
 
-   If any atom in a residue is within range from *central, marks all 
-   atoms in that residue (sets extras field to 1) 
+   Finds the residues with any atom within range of any atom in 
+   *central. The residue numbers are placed in index->hits[] in file
+   order. Each atom of the central residue queries the spatial grid 
+   and a residue is not considered further once it has been flagged 
+   with this stamp.
 
 -  17.05.11 Changed double to REAL and use extras field rather than occ
             By: ACRM
+-  19.10.26 Rewritten to use the spatial index and to record the 
+            residues in range rather than setting the extras field
+            By: agent
 */
-void FlagResiduesInRange(PDB *pdb, PDB *central, REAL radiusSq)
+int FlagResiduesInRange(SPHEREINDEX *index, PDB *central, 
+                        REAL radiusSq, int stamp)
 {
-   PDB  *p,
-        *q,
-        *current,
-        *nextPRes,
-        *nextCurrentRes;
-   BOOL aaInRange;
-      
+   PDB       *p,
+             *nextPRes;
+   GRIDQUERY query;
+   REAL      distSq;
+   int       nhits = 0,
+             atom,
+             res;
 
    nextPRes=blFindNextResidue(central);
   
-   for (current=pdb; current!=NULL; current=nextCurrentRes)
+   for(p=central; p!=nextPRes; NEXT(p))
    {
-      aaInRange=FALSE;
-      nextCurrentRes=blFindNextResidue(current);
-      
-      for (q=current; q!=nextCurrentRes; NEXT(q))
-      {            
-         for (p=central; p!=nextPRes; NEXT(p))
-         {
-            if (DISTSQ(p, q)<radiusSq)
-            {
-               aaInRange=TRUE;
-               /*q=nextCurrentRes;
-                 break;*/
-            }
-         }
-      }
-      
-      if (aaInRange)
+      btStartGridQuery(&query, index->grid, p->x, p->y, p->z, radiusSq);
+      while((atom = btNextGridNeighbour(&query, &distSq)) >= 0)
       {
-         for (q=current; q!=nextCurrentRes; NEXT(q))
+         res = index->resOfAtom[atom];
+         if((index->resStamp[res] != stamp) && (distSq < radiusSq))
          {
-            q->extras=(APTR)1;
-         }    
+            index->resStamp[res]  = stamp;
+            index->hits[nhits++]  = res;
+         }
       }
    }
+
+   qsort(index->hits, nhits, sizeof(int), CompareInts);
+   
+   return(nhits);
 } 
 
 
@@ -299,6 +415,8 @@ void WriteAtoms(PDB *pdb, FILE *out)
             old format and uses extras rather than occ
 -  14.05.12 Added compact
 -  12.03.15 Changed to allow multi-character chain names
+-  19.10.26 Moved the printing of each residue into WriteResidueID()
+            By: agent
 */
 void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
 {
@@ -309,48 +427,104 @@ void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
       if (p->extras)
       {
          p->extras=(APTR)0;
-         if(compact)
+         WriteResidueID(p, out, colons, compact);
+      }
+   }
+
+   if(compact)
+   {
+      fprintf(out,"\n");
+   }
+   
+}  
+
+
+/************************************************************************/
+/*>void WriteResidueID(PDB *p, FILE *out, BOOL colons, BOOL compact)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *p       First atom of a residue
+   \param[in]      *out     output file
+   \param[in]      colons   Include colons in output format
+   \param[in]      compact  Space-separated on one line
+
+   Writes the ID of one residue in the requested format
+
+-  19.10.26 Split out of WriteResidues()   By: agent
+*/
+void WriteResidueID(PDB *p, FILE *out, BOOL colons, BOOL compact)
+{
+   if(compact)
+   {
+      if(isdigit(p->chain[0]))
+      {
+         fprintf(out, " %s.%d%c", p->chain, p->resnum, 
+                 p->insert[0]);
+      }
+      else
+      {
+         fprintf(out, " %s%d%c", p->chain, p->resnum, 
+                 p->insert[0]);
+      }
+   }
+   else
+   {
+      if(colons)
+      {
+         fprintf(out, "%s:%d:%s\n", p->chain, p->resnum, p->insert);
+      }
+      else
+      {
+         if(isdigit(p->chain[0]))
          {
-            if(isdigit(p->chain[0]))
-            {
-               fprintf(out, " %s.%d%c", p->chain, p->resnum, 
-                       p->insert[0]);
-            }
-            else
-            {
-               fprintf(out, " %s%d%c", p->chain, p->resnum, 
-                       p->insert[0]);
-            }
+            fprintf(out, "%s.%d%c\n", p->chain, p->resnum, 
+                    p->insert[0]);
          }
          else
          {
-            if(colons)
-            {
-               fprintf(out, "%s:%d:%s\n", p->chain, p->resnum, p->insert);
-            }
-            else
-            {
-               if(isdigit(p->chain[0]))
-               {
-                  fprintf(out, "%s.%d%c\n", p->chain, p->resnum, 
-                          p->insert[0]);
-               }
-               else
-               {
-                  fprintf(out, "%s%d%c\n", p->chain, p->resnum, 
-                          p->insert[0]);
-               }
-            }
+            fprintf(out, "%s%d%c\n", p->chain, p->resnum, 
+                    p->insert[0]);
          }
       }
    }
+}
 
-   if(compact)
+
+/************************************************************************/
+/*>void WriteCentreSummary(SPHEREINDEX *index, PDB *central, int nhits,
+                           FILE *out, BOOL colons)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]      *index   Index with the residues in range in hits[]
+   \param[in]      *central First atom of the central residue
+   \param[in]      nhits    Number of residues in range
+   \param[in]      *out     output file
+   \param[in]      colons   Include colons in output format
+
+   Writes the one-line summary for a central residue used by the auto
+   and multi-centre modes
+
+-  19.10.26 Original   By: agent
+*/
+void WriteCentreSummary(SPHEREINDEX *index, PDB *central, int nhits,
+                        FILE *out, BOOL colons)
+{
+   int i;
+   
+   fprintf(out, "%s %s%d%s:",central->resnam, 
+           central->chain,
+           central->resnum,
+           central->insert);
+
+   for(i=0; i<nhits; i++)
    {
-      fprintf(out,"\n");
+      WriteResidueID(index->resStart[index->hits[i]], out, colons, TRUE);
    }
    
-}  
+   fprintf(out,"\n");
+}
 
 
 /***********************************************************************/
@@ -366,16 +540,21 @@ void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
 -  27.07.12 V1.8 By: ACRM
 -  22.07.14 V1.9 By: CTP
 -  12.03.15 V1.10 By: ACRM
+-  19.10.26 V1.11 By: agent
 */
 void Usage(void)
 {
    fprintf(stderr,"\n");
-   fprintf(stderr,"PDBsphere V1.10 (c) 2011-2015 UCL, Anja Baresic, \
+   fprintf(stderr,"PDBsphere V1.15 (c) 2011-2026 UCL, Anja Baresic, \
 Andrew Martin.\n");
    fprintf(stderr,"\nUsage: \
 pdbsphere [-s] [-c] [-r radius] [-h] [-H] resspec\n                 \
 [in.pdb [out.pdb/out.txt]]\n");
    fprintf(stderr,"-or-   \
+pdbsphere [-r radius] [-H] resspec,resspec[,...] [in.pdb [out.txt]]\n");
+   fprintf(stderr,"-or-   \
+pdbsphere -f resfile [-r radius] [-H] [in.pdb [out.txt]]\n");
+   fprintf(stderr,"-or-   \
 pdbsphere -a [-r radius] [in.pdb [out.txt]]\n");
    fprintf(stderr,"       -s  Output summary: only list of residue \
 IDs.\n");
@@ -385,6 +564,9 @@ IDs.\n");
    fprintf(stderr,"       -r  Set your own allowed range to radius.\n");
    fprintf(stderr,"       -a  'Auto' mode - analyses all residues \
 producing\n           summary for each.\n");
+   fprintf(stderr,"       -f  Read central residues from a file \
+(whitespace or comma\n           separated) producing summary for \
+each.\n");
 
    fprintf(stderr,"\npdbsphere identifies residues within a specified \
 radius of a specified\n");
@@ -394,6 +576,10 @@ one atom within \n");
 a summary format\n");
    fprintf(stderr,"listing the residues in range instead of providing \
 PDB output.\n");
+   fprintf(stderr,"If several central residues are given as a comma \
+separated list or\n");
+   fprintf(stderr,"with -f, a summary is produced for each in the same \
+format as -a.\n");
    blPrintResSpecHelp(stderr);
    fprintf(stderr,"I/O is through standard input/output if files not \
 specified.\n\n");   
@@ -403,7 +589,8 @@ specified.\n\n");
 /**********************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *resspec, char *InFile, 
                     char *OutFile, BOOL *summary, REAL *radiusSq,
-                    BOOL *colons, BOOL *isHet, BOOL *doAuto)
+                    BOOL *colons, BOOL *isHet, BOOL *doAuto,
+                    char *CentreFile)
    ----------------------------------------------------------------------
 *//**
 
@@ -420,6 +607,8 @@ specified.\n\n");
                                 (Default:64, max range:8 angstroms)
    \param[out]     *colons      Colon separated output format
    \param[out]     *isHet       Residue spec is for a HETATM (-H)
+   \param[out]     *doAuto      Analyse every residue (-a)
+   \param[out]     *CentreFile  File of central residues (-f) or blank
    \return                     Success?
 
    Parse the command line
@@ -429,15 +618,17 @@ specified.\n\n");
 -  26.10.11 Added -H
 -  14.05.12 Added -a
 -  27.07.12 Fixed bug in checking of doAuto
+-  19.10.26 Added -f   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv,char *resspec, char *InFile, 
                   char *OutFile, BOOL *summary, REAL *radiusSq, 
-                  BOOL *colons, BOOL *isHet, BOOL *doAuto)
+                  BOOL *colons, BOOL *isHet, BOOL *doAuto,
+                  char *CentreFile)
 {
    argc--;
    argv++;
 
-   InFile[0] = OutFile[0] = '\0';
+   InFile[0] = OutFile[0] = resspec[0] = CentreFile[0] = '\0';
    *summary = FALSE;
    *radiusSq = 64.00;
    *colons   = FALSE;
@@ -486,6 +677,14 @@ BOOL ParseCmdLine(int argc, char **argv,char *resspec, char *InFile,
             case 'a':
                *doAuto = TRUE;
                break;
+            case 'f':
+               argc--;
+               argv++;
+               if(!argc)
+                  return(FALSE);
+               strncpy(CentreFile, argv[0], MAXBUFF);
+               CentreFile[MAXBUFF-1] = '\0';
+               break;
             default:
                return(FALSE);
                break;
@@ -499,7 +698,7 @@ BOOL ParseCmdLine(int argc, char **argv,char *resspec, char *InFile,
             return(FALSE);
 
          /* Copy the first to resspec                                   */
-         if(!(*doAuto))
+         if(!(*doAuto) && (CentreFile[0] == '\0'))
          {
             if(argc)
             {
@@ -557,3 +756,271 @@ void ClearExtras(PDB *pdb)
       p->extras = (APTR)0;
    }
 }
+
+
+/************************************************************************/
+/*>SPHEREINDEX *BuildSphereIndex(PDB *pdb, REAL radiusSq)
+   ------------------------------------------------------
+*//**
+
+   \param[in]      *pdb       PDB linked list
+   \param[in]      radiusSq   Squared radius that will be searched
+   \return                    Index or NULL if no memory
+
+   Builds the residue tables, the residue spec hash and the spatial
+   grid (with the cell size equal to the search radius) used for all
+   central residues
+
+-  19.10.26 Original   By: agent
+*/
+SPHEREINDEX *BuildSphereIndex(PDB *pdb, REAL radiusSq)
+{
+   SPHEREINDEX *index;
+   PDB         *p,
+               *res,
+               *nextRes;
+   int         atom = 0,
+               nres = 0;
+   char        key[SMALLBUFF];
+
+   if((index = (SPHEREINDEX *)malloc(sizeof(SPHEREINDEX)))==NULL)
+      return(NULL);
+
+   index->grid     = NULL;
+   index->resHash  = NULL;
+   index->resStart = NULL;
+   index->resOfAtom = index->resStamp = index->hits = NULL;
+   index->nres     = 0;
+
+   if((index->atoms = blIndexPDB(pdb, &(index->natoms)))==NULL)
+   {
+      FreeSphereIndex(index);
+      return(NULL);
+   }
+   
+   for(res=pdb; res!=NULL; res=blFindNextResidue(res))
+      nres++;
+
+   index->resStart  = (PDB **)malloc((nres+1) * sizeof(PDB *));
+   index->resOfAtom = (int *)malloc((index->natoms+1) * sizeof(int));
+   index->resStamp  = (int *)calloc(nres+1, sizeof(int));
+   index->hits      = (int *)malloc((nres+1) * sizeof(int));
+   index->resHash   = blInitializeHash((ULONG)(nres+1));
+   if((index->resStart == NULL) || (index->resOfAtom == NULL) ||
+      (index->resStamp == NULL) || (index->hits      == NULL) ||
+      (index->resHash  == NULL))
+   {
+      FreeSphereIndex(index);
+      return(NULL);
+   }
+
+   /* Number the residues and hash their specs. The first residue 
+      matching a spec wins, as with blFindResidueSpec()
+   */
+   for(res=pdb; res!=NULL; res=nextRes)
+   {
+      nextRes = blFindNextResidue(res);
+      index->resStart[index->nres] = res;
+      for(p=res; p!=nextRes; NEXT(p))
+         index->resOfAtom[atom++] = index->nres;
+
+      MakeResidueKey(key, res->chain, res->resnum, res->insert, FALSE);
+      if(!blHashKeyDefined(index->resHash, key))
+         blSetHashValueInt(index->resHash, key, index->nres);
+
+      if(!strncmp(res->record_type, "HETATM", 6))
+      {
+         MakeResidueKey(key, res->chain, res->resnum, res->insert, TRUE);
+         if(!blHashKeyDefined(index->resHash, key))
+            blSetHashValueInt(index->resHash, key, index->nres);
+      }
+      
+      index->nres++;
+   }
+   index->resStart[index->nres] = NULL;
+
+   if((index->grid = btBuildSpatialGrid(index->atoms, index->natoms,
+                                        sqrt(radiusSq)))==NULL)
+   {
+      FreeSphereIndex(index);
+      return(NULL);
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>void FreeSphereIndex(SPHEREINDEX *index)
+   ----------------------------------------
+*//**
+
+   \param[in]      *index     Index to free
+
+   Frees an index created by BuildSphereIndex(). The PDB linked list is
+   not freed.
+
+-  19.10.26 Original   By: agent
+*/
+void FreeSphereIndex(SPHEREINDEX *index)
+{
+   if(index != NULL)
+   {
+      btFreeSpatialGrid(index->grid);
+      if(index->resHash != NULL)
+         blFreeHash(index->resHash);
+      FREE(index->atoms);
+      FREE(index->resStart);
+      FREE(index->resOfAtom);
+      FREE(index->resStamp);
+      FREE(index->hits);
+      free(index);
+   }
+}
+
+
+/************************************************************************/
+/*>void MakeResidueKey(char *key, char *chain, int resnum, char *insert,
+                       BOOL isHet)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[out]     *key       Hash key
+   \param[in]      *chain     Chain label
+   \param[in]      resnum     Residue number
+   \param[in]      *insert    Insert code
+   \param[in]      isHet      Key for HETATM-only lookup
+
+   Builds the residue hash key. Blank and missing insert codes are
+   treated as the same.
+
+-  19.10.26 Original   By: agent
+*/
+void MakeResidueKey(char *key, char *chain, int resnum, char *insert,
+                    BOOL isHet)
+{
+   sprintf(key, "%s%s|%d|%c", (isHet?"H|":""), chain, resnum,
+           ((insert[0]=='\0')?' ':insert[0]));
+}
+
+
+/************************************************************************/
+/*>PDB *FindCentre(SPHEREINDEX *index, char *resspec, BOOL isHet)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]      *index     Index of the structure
+   \param[in]      *resspec   Residue specification
+   \param[in]      isHet      Only match HETATM residues
+   \return                    First atom of the residue or NULL
+
+   Hashed equivalent of blFindResidueSpec() / blFindHetatmResidueSpec()
+
+-  19.10.26 Original   By: agent
+*/
+PDB *FindCentre(SPHEREINDEX *index, char *resspec, BOOL isHet)
+{
+   char chain[blMAXCHAINLABEL],
+        insert[8],
+        key[SMALLBUFF];
+   int  resnum;
+   
+   if(!blParseResSpec(resspec, chain, &resnum, insert))
+      return(NULL);
+   
+   MakeResidueKey(key, chain, resnum, insert, isHet);
+   if(!blHashKeyDefined(index->resHash, key))
+      return(NULL);
+   
+   return(index->resStart[blGetHashValueInt(index->resHash, key)]);
+}
+
+
+/************************************************************************/
+/*>STRINGLIST *ReadCentres(char *resspec, char *CentreFile)
+   --------------------------------------------------------
+*//**
+
+   \param[in]      *resspec     Comma-separated residue specs
+   \param[in]      *CentreFile  File of residue specs (or blank)
+   \return                      List of residue specs (NULL if none or
+                                the file could not be read)
+
+   Builds the list of central residues either from the file, where 
+   they may be separated by white space or commas, or from the
+   comma-separated command line list.
+
+-  19.10.26 Original   By: agent
+*/
+STRINGLIST *ReadCentres(char *resspec, char *CentreFile)
+{
+   STRINGLIST *centres = NULL,
+              *last    = NULL;
+   char       buffer[MAXBUFF],
+              *word;
+   FILE       *fp      = NULL;
+   
+   if(CentreFile[0] != '\0')
+   {
+      if((fp=fopen(CentreFile, "r"))==NULL)
+      {
+         fprintf(stderr,"Error: (pdbsphere) Unable to read %s\n", 
+                 CentreFile);
+         return(NULL);
+      }
+   }
+   
+   do
+   {
+      if(fp != NULL)
+      {
+         if(!fgets(buffer, MAXBUFF, fp))
+            break;
+      }
+      else
+      {
+         strncpy(buffer, resspec, MAXBUFF);
+         buffer[MAXBUFF-1] = '\0';
+      }
+      
+      for(word=strtok(buffer, " \t\n\r,"); 
+          word!=NULL; 
+          word=strtok(NULL, " \t\n\r,"))
+      {
+         /* blStoreString() walks the list, so append to the end 
+            ourselves
+         */
+         if((last = blStoreString(last, word))==NULL)
+         {
+            blFreeStringList(centres);
+            if(fp != NULL)
+               fclose(fp);
+            return(NULL);
+         }
+         if(centres == NULL)
+            centres = last;
+         else
+            last = last->next;
+      }
+   }  while(fp != NULL);
+   
+   if(fp != NULL)
+      fclose(fp);
+   
+   return(centres);
+}
+
+
+/************************************************************************/
+/*>int CompareInts(const void *a, const void *b)
+   ---------------------------------------------
+*//**
+
+   qsort() comparison for integers
+
+-  19.10.26 Original   By: agent
+*/
+int CompareInts(const void *a, const void *b)
+{
+   return(*(const int *)a - *(const int *)b);
+}
@@ -3,8 +3,8 @@
 
    \file       pdbsplitchains.c
    
-   \version    V2.0
-   \date       26.03.15
+   \version    V2.7
+   \date       19.10.26
    \brief      Split a PDB file into separate chains
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2015
@@ -36,6 +36,14 @@
 
    Description:
    ============
+   The atoms are divided among the chains in a single pass, relinking
+   them into one list per chain, so the structure is neither rescanned
+   nor copied for each chain.
+
+   With -s the PDB file is streamed and each atom is written straight
+   to the file for its chain. At most MAXOPEN chain files are open at
+   once; when more are needed, the least recently used is closed and
+   later reopened for appending.
 
 **************************************************************************
 
@@ -53,15 +61,38 @@
 -  V1.3    06.11.14  Renamed from splitchains By: ACRM
 -  V1.4    12.03.15  Checks blank chain as string
 -  V2.0    26.03.15  Major rewrite to handled whole PDB
+-  V2.1    19.10.26  Reads the PDB file with the shared memory-mapped
+                     reader in common/pdbread.c   By: agent
+-  V2.2    19.10.26  Opens files with btOpenStdFiles() so compressed
+                     input and output are handled in-process
+-  V2.3    19.10.26  Reports timings with -T or if BIOPTOOLS_TIMING is
+                     set
+-  V2.4    19.10.26  Reads the atoms into an arena and copies each chain
+                     into a second arena that is reused for every chain
+-  V2.5    19.10.26  Splits the atoms among the chains in a single pass.
+                     Added -s to stream the input with bounded open
+                     files
+-  V2.6    19.10.26  Resets gQuiet so it can run more than once in a
+                     bioptools pipeline
+-  V2.7    19.10.26  -s no longer grows the chain table for every new
+                     chain, which failed after a few chains
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "bioplib/hash.h"
+#include "common/pdbread.h"
+#include "common/pdbstream.h"
+#include "common/pdbfilter.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
+#include "common/arena.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -69,6 +100,33 @@
 #define MAXBUFF     160
 #define MAXCHAINID    8
 #define MAXCHAINS  1024
+#define MAXOPEN      64          /* Chain files open at once with -s    */
+
+/* Output file for one chain with -s                                    */
+typedef struct
+{
+   PDB           last;           /* Last atom written (for the TER card)*/
+   FILE          *fp;            /* NULL when closed                    */
+   unsigned long lastUse;
+   char          label[MAXCHAINID],
+                 OutFile[MAXBUFF];
+   BOOL          started;        /* File created and header written     */
+}  CHAINOUT;
+
+typedef struct
+{
+   HASHTABLE     *hash;          /* Chain label to entry in chains[]    */
+   CHAINOUT      *chains;
+   STRINGLIST    *header;
+   char          *InFile;
+   unsigned long clock;
+   int           nChains,
+                 maxChains,
+                 nOpen,
+                 lastChain,
+                 natoms;
+   BOOL          currentDir;
+}  SPLITTER;
    
 
 /************************************************************************/
@@ -80,8 +138,14 @@ static BOOL gQuiet = FALSE;
 /* Prototypes
 */
 int main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current,
+                  BOOL *stream);
 BOOL WriteEachPDBChain(char *InFile, WHOLEPDB *wpdb, BOOL current);
+BOOL SplitPDBStream(FILE *in, char *InFile, BOOL currentDir);
+BOOL StoreHeader(STRINGLIST *header, void *data);
+BOOL RouteAtom(PDB *p, void *data);
+int  FindChainOutput(SPLITTER *split, char *label);
+FILE *OpenChainOutput(SPLITTER *split, int chainNum);
 void Usage(void);
 BOOL BuildFileName(char *OutFile, int maxFileName, char *InFile, 
                    char *chain, BOOL current);
@@ -96,21 +160,38 @@ BOOL BuildFileName(char *OutFile, int maxFileName, char *InFile,
 
 -  07.02.97 Original   By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Reads the atoms into an arena   By: agent
+-  19.10.26 Added -s
 */
 int main(int argc, char **argv)
 {
    char InFile[MAXBUFF];
    FILE *in  = stdin;
    WHOLEPDB *wpdb;
-   BOOL current;
+   ARENA *arena;
+   BOOL current,
+        stream;
 
+   btInitTiming(&argc, argv);
    
    
-   if(ParseCmdLine(argc, argv, InFile, &current))
+   if(ParseCmdLine(argc, argv, InFile, &current, &stream))
    {
-      if(blOpenStdFiles(InFile, NULL, &in, NULL))
+      if(btOpenStdFiles(InFile, NULL, &in, NULL))
       {
-         if((wpdb=blReadWholePDB(in))==NULL)
+         if(stream && btCanFilterPDB(in))
+         {
+            if(!SplitPDBStream(in, InFile, current))
+            {
+               if(!gQuiet)
+                  fprintf(stderr,"pdbsplitchains: Failed to write all \
+output files\n");
+            }
+            return(0);
+         }
+
+         if(((arena=btNewArena(0))==NULL) ||
+            ((wpdb=btReadWholePDBInArena(in, arena))==NULL))
          {
             if(!gQuiet)
                fprintf(stderr,"No atoms read from input PDB file\n");
@@ -124,6 +205,8 @@ int main(int argc, char **argv)
                   fprintf(stderr,"pdbsplitchains: Failed to write all \
 output files\n");
             }
+            btFreeWholePDBInArena(wpdb);
+            btFreeArena(arena);
          }
       }
    }
@@ -136,26 +219,34 @@ output files\n");
 }
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current)
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current,
+                     BOOL *stream)
    ---------------------------------------------------------------------
 *//**
 
    \param[in]      argc        Argument count
    \param[in]      **argv      Argument array
    \param[out]     *infile     Input filename (or blank string)
+   \param[out]     *current    Write to the current directory
+   \param[out]     *stream     Stream the PDB file
    \return                     Success
 
    Parse the command line
 
 -  10.07.97 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
+-  19.10.26 Resets gQuiet
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current,
+                  BOOL *stream)
 {
    argc--;
    argv++;
    
    infile[0] = '\0';
    *current = FALSE;
+   *stream  = FALSE;
+   gQuiet   = FALSE;
    
    while(argc)
    {
@@ -172,6 +263,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current)
          case 'c':
             *current = TRUE;
             break;
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -212,12 +306,13 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current)
 */
 void Usage(void)
 {
-   fprintf(stderr,"pdbsplitchains V2.0 (c) 1997-2015 \
+   fprintf(stderr,"pdbsplitchains V2.7 (c) 1997-2015 \
 Dr. Andrew C.R. Martin, UCL\n");
 
-   fprintf(stderr,"\nUsage: pdbsplitchains [-c][-q] [in.pdb]\n");
+   fprintf(stderr,"\nUsage: pdbsplitchains [-c][-q][-s] [in.pdb]\n");
    fprintf(stderr,"       -c  Output to current directory\n");
    fprintf(stderr,"       -q  Quiet - no error messages\n");
+   fprintf(stderr,"       -s  Stream the PDB file in constant memory\n");
 
    fprintf(stderr,"\npdbsplitchains takes a PDB file (of the specified name \
 or from stdin if a\n");
@@ -246,7 +341,13 @@ output will simply\n");
 placed in the\n");
    fprintf(stderr,"current directory.\n");
 
-   fprintf(stderr,"\nA blank chain name is converted to the digit 0\n\n");
+   fprintf(stderr,"\nA blank chain name is converted to the digit 0\n");
+
+   fprintf(stderr,"\nWith -s, each output file has the header of the \
+input file, but\n");
+   fprintf(stderr,"CONECT and MASTER records are not written. Binary PDB \
+and PDBML files\n");
+   fprintf(stderr,"are still read as a whole.\n\n");
 }
 
 
@@ -349,27 +450,39 @@ BOOL BuildFileName(char *OutFile, int maxOutFileName, char *InFile,
 *//**
 
    \param[in]      *InFile     Input filename
-   \param[in]      *wpdb       Whole PDB linked list
+   \param[in,out]  *wpdb       Whole PDB linked list
    \param[in]      currentDir  Strip path and write to current directory
 
    Writes each chain to a separate file
 
    Builds a list of the chain IDs using a STRINGLIST
-   Uses blGetPDBChainAsCopy() to copy each chain in turn, attaching it to
-   the whole PDB structure and writing it to a file.
-   Then frees the copy and moves onto the next chain.
+   Makes a single pass through the atoms, unlinking each one and
+   appending it to the list for its chain (found with a hash). CONECTs
+   to atoms in other chains are dropped, as they were when each chain
+   was copied. Each chain list is then attached to the whole PDB
+   structure in turn and written to a file. Finally the chain lists are
+   joined up again (in chain order) so the structure can be freed.
 
 -  16.01.14 Rewritten to deal with HETATMs properly   By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  25.03.15 Complete rewrite to support whole PDB  By: ACRM
+-  19.10.26 Copies chains into an arena rather than with
+            blGetPDBChainAsCopy()   By: agent
+-  19.10.26 Splits the atoms among the chains in a single pass rather
+            than copying each chain
 */
 BOOL WriteEachPDBChain(char *InFile, WHOLEPDB *wpdb, BOOL currentDir)
 {
    PDB        *pdb,
-              *chain;
+              *p,
+              *next,
+              **heads,
+              **tails;
    FILE       *fp;
+   HASHTABLE  *hash;
    char       **chainLabels = NULL;
-   int        nChains, chainNum;
+   int        nChains, chainNum, i, j;
+   BOOL       ok = TRUE;
 
    pdb  = wpdb->pdb;
 
@@ -377,53 +490,374 @@ BOOL WriteEachPDBChain(char *InFile, WHOLEPDB *wpdb, BOOL currentDir)
    if((chainLabels = blGetPDBChainLabels(pdb, &nChains))==NULL)
       return(FALSE);
 
+   hash  = blInitializeHash((ULONG)(2*nChains+1));
+   heads = (PDB **)calloc(nChains+1, sizeof(PDB *));
+   tails = (PDB **)calloc(nChains+1, sizeof(PDB *));
+   if((hash==NULL) || (heads==NULL) || (tails==NULL))
+   {
+      if(hash!=NULL)
+         blFreeHash(hash);
+      FREE(heads);
+      FREE(tails);
+      return(FALSE);
+   }
+   for(chainNum=0; chainNum<nChains; chainNum++)
+   {
+      if(!blSetHashValueInt(hash, chainLabels[chainNum], chainNum))
+      {
+         blFreeHash(hash);
+         free(heads);
+         free(tails);
+         return(FALSE);
+      }
+   }
+
+   /* Route each atom to the list for its chain. Atoms of a chain are
+      usually together so the hash is only used when the chain changes
+   */
+   chainNum = 0;
+   for(p=pdb; p!=NULL; p=next)
+   {
+      next    = p->next;
+      p->next = NULL;
+
+      if(!CHAINMATCH(p->chain, chainLabels[chainNum]))
+         chainNum = blGetHashValueInt(hash, p->chain);
+
+      if(heads[chainNum]==NULL)
+         heads[chainNum] = p;
+      else
+         tails[chainNum]->next = p;
+      tails[chainNum] = p;
+
+      for(i=0, j=0; i<p->nConect; i++)
+      {
+         if(CHAINMATCH(p->conect[i]->chain, p->chain))
+            p->conect[j++] = p->conect[i];
+      }
+      p->nConect = j;
+   }
+   blFreeHash(hash);
+
    /* Step through the list of chain labels                             */
    for(chainNum=0; chainNum<nChains; chainNum++)
    {
+      char OutFile[MAXBUFF];
+
       if(!gQuiet)
          fprintf(stderr,"Writing chain '%s'\n", chainLabels[chainNum]);
       
-      /* Make a copy of this chain                                      */
-      if((chain=blGetPDBChainAsCopy(pdb, chainLabels[chainNum]))!=NULL)
+      /* Link this chain into the whole pdb structure, build a filename
+         and write the chain
+      */
+      wpdb->pdb = heads[chainNum];
+      if(BuildFileName(OutFile, MAXBUFF, InFile, 
+                       chainLabels[chainNum], currentDir))
       {
-         char OutFile[MAXBUFF];
-
-         /* Link this into the whole pdb structure, build a filename
-            and write the chain
-         */
-         wpdb->pdb = chain;
-         if(BuildFileName(OutFile, MAXBUFF, InFile, 
-                          chainLabels[chainNum], currentDir))
+         if((fp=fopen(OutFile, "w"))!=NULL)
          {
-            if((fp=fopen(OutFile, "w"))!=NULL)
-            {
-               blWriteWholePDB(fp, wpdb);
-               fclose(fp);
-            }
-            else
-            {
-               if(!gQuiet)
-                  fprintf(stderr,"pdbsplitchains: Could not write output \
-file: %s\n", OutFile);
-               return(FALSE);
-            }
+            blWriteWholePDB(fp, wpdb);
+            fclose(fp);
          }
          else
          {
             if(!gQuiet)
-               fprintf(stderr,"pdbsplitchains: No memory to build output \
-filename\n");
-            return(FALSE);
+               fprintf(stderr,"pdbsplitchains: Could not write output \
+file: %s\n", OutFile);
+            ok = FALSE;
          }
+      }
+      else
+      {
+         if(!gQuiet)
+            fprintf(stderr,"pdbsplitchains: No memory to build output \
+filename\n");
+         ok = FALSE;
+      }
+
+      if(!ok)
+         break;
+   }
 
-         /* Free the storage for the copy of this chain and restore the
-            whole PDB structure
-         */
-         FREELIST(chain, PDB);
-         wpdb->pdb = pdb;
+   /* Join the chains back into a single list                           */
+   for(chainNum=0; chainNum<nChains-1; chainNum++)
+      tails[chainNum]->next = heads[chainNum+1];
+   wpdb->pdb = heads[0];
+
+   free(heads);
+   free(tails);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL SplitPDBStream(FILE *in, char *InFile, BOOL currentDir)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]      *in         Input PDB file
+   \param[in]      *InFile     Input filename
+   \param[in]      currentDir  Strip path and write to current directory
+   \return                     Were all the files written?
+
+   Streams the PDB file, writing each atom to the file for its chain.
+   Each file starts with the header of the input file and ends with a
+   TER card for its last atom and an END record.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL SplitPDBStream(FILE *in, char *InFile, BOOL currentDir)
+{
+   SPLITTER split;
+   FILE     *fp;
+   int      chainNum;
+   BOOL     ok;
+
+   split.hash       = blInitializeHash((ULONG)(2*MAXCHAINS+1));
+   split.chains     = NULL;
+   split.header     = NULL;
+   split.InFile     = InFile;
+   split.currentDir = currentDir;
+   split.clock      = 0;
+   split.nChains    = 0;
+   split.maxChains  = 0;
+   split.nOpen      = 0;
+   split.lastChain  = (-1);
+   split.natoms     = 0;
+   if(split.hash == NULL)
+      return(FALSE);
+
+   ok = btStreamPDB(in, FALSE, StoreHeader, RouteAtom, (void *)&split);
+   if(ok && (split.natoms == 0) && !gQuiet)
+      fprintf(stderr,"No atoms read from input PDB file\n");
+
+   /* Finish each file                                                  */
+   for(chainNum=0; chainNum<split.nChains; chainNum++)
+   {
+      if((fp = OpenChainOutput(&split, chainNum))==NULL)
+      {
+         ok = FALSE;
+         continue;
       }
+      blWriteTerCard(fp, &(split.chains[chainNum].last));
+      fprintf(fp, "END   \n");
+      if(fclose(fp))
+         ok = FALSE;
+      split.chains[chainNum].fp = NULL;
+      split.nOpen--;
+   }
+
+   blFreeHash(split.hash);
+   FREE(split.chains);
+   FREELIST(split.header, STRINGLIST);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL StoreHeader(STRINGLIST *header, void *data)
+   ------------------------------------------------
+*//**
+
+   \param[in]      *header     PDB header records
+   \param[in,out]  *data       SPLITTER
+   \return                     Success?
+
+   Header callback for btStreamPDB(). Keeps a copy of the header to
+   start each output file.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL StoreHeader(STRINGLIST *header, void *data)
+{
+   SPLITTER   *split = (SPLITTER *)data;
+   STRINGLIST *s,
+              *last  = NULL;
+
+   for(s=header; s!=NULL; NEXT(s))
+   {
+      if((last = blStoreString(last, s->string))==NULL)
+         return(FALSE);
+      if(split->header == NULL)
+         split->header = last;
+      else
+         last = last->next;
    }
    return(TRUE);
 }
 
 
+/************************************************************************/
+/*>BOOL RouteAtom(PDB *p, void *data)
+   ----------------------------------
+*//**
+
+   \param[in]      *p          Atom from btStreamPDB()
+   \param[in,out]  *data       SPLITTER
+   \return                     Success?
+
+   Atom callback for btStreamPDB(). Writes the atom to the file for its
+   chain and frees it.
+
+-  19.10.26 Original   By: agent
+*/
+BOOL RouteAtom(PDB *p, void *data)
+{
+   SPLITTER *split = (SPLITTER *)data;
+   CHAINOUT *chain;
+   FILE     *fp;
+   int      chainNum;
+
+   split->natoms++;
+   if(((chainNum = FindChainOutput(split, p->chain)) < 0) ||
+      ((fp = OpenChainOutput(split, chainNum)) == NULL))
+   {
+      free(p);
+      return(FALSE);
+   }
+
+   chain = &(split->chains[chainNum]);
+   blWritePDBRecord(fp, p);
+   chain->last      = *p;
+   chain->last.next = NULL;
+   free(p);
+
+   return(!ferror(fp));
+}
+
+
+/************************************************************************/
+/*>int FindChainOutput(SPLITTER *split, char *label)
+   -------------------------------------------------
+*//**
+
+   \param[in,out]  *split      SPLITTER
+   \param[in]      *label      Chain label
+   \return                     Entry in split->chains[] (-1 if no
+                               memory or the file name can't be built)
+
+   Finds the output for a chain, adding it if the chain has not been
+   seen before. The last chain found is checked before the hash.
+
+-  19.10.26 Original   By: agent
+-  19.10.26 Only grows split->chains when it is full
+*/
+int FindChainOutput(SPLITTER *split, char *label)
+{
+   CHAINOUT *chain;
+   char     fileLabel[MAXCHAINID];
+   int      chainNum;
+
+   if((split->lastChain >= 0) &&
+      CHAINMATCH(split->chains[split->lastChain].label, label))
+      return(split->lastChain);
+
+   if(blHashKeyDefined(split->hash, label))
+   {
+      split->lastChain = blGetHashValueInt(split->hash, label);
+      return(split->lastChain);
+   }
+
+   if(split->nChains == split->maxChains)
+   {
+      CHAINOUT *chains;
+      split->maxChains = (split->maxChains ? 2*split->maxChains : MAXOPEN);
+      if((chains = (CHAINOUT *)realloc(split->chains,
+                                       split->maxChains *
+                                       sizeof(CHAINOUT)))==NULL)
+         return(-1);
+      split->chains = chains;
+   }
+
+   chainNum = split->nChains;
+   chain    = &(split->chains[chainNum]);
+   strncpy(chain->label, label, MAXCHAINID);
+   chain->label[MAXCHAINID-1] = '\0';
+   chain->fp      = NULL;
+   chain->lastUse = 0;
+   chain->started = FALSE;
+   memset(&(chain->last), 0, sizeof(PDB));
+
+   /* BuildFileName() changes a blank label so give it a copy           */
+   strcpy(fileLabel, chain->label);
+   if(!BuildFileName(chain->OutFile, MAXBUFF, split->InFile, fileLabel,
+                     split->currentDir) ||
+      !blSetHashValueInt(split->hash, chain->label, chainNum))
+   {
+      if(!gQuiet)
+         fprintf(stderr,"pdbsplitchains: No memory to build output \
+filename\n");
+      return(-1);
+   }
+
+   if(!gQuiet)
+      fprintf(stderr,"Writing chain '%s'\n", fileLabel);
+
+   split->nChains++;
+   split->lastChain = chainNum;
+   return(chainNum);
+}
+
+
+/************************************************************************/
+/*>FILE *OpenChainOutput(SPLITTER *split, int chainNum)
+   ----------------------------------------------------
+*//**
+
+   \param[in,out]  *split      SPLITTER
+   \param[in]      chainNum    Entry in split->chains[]
+   \return                     Output file (NULL on failure)
+
+   Returns the open file for a chain. A new file is created and the
+   header written to it; a file that was closed to keep within MAXOPEN
+   is reopened for appending. If MAXOPEN files are already open, the
+   least recently used is closed first.
+
+-  19.10.26 Original   By: agent
+*/
+FILE *OpenChainOutput(SPLITTER *split, int chainNum)
+{
+   CHAINOUT   *chain = &(split->chains[chainNum]),
+              *lru   = NULL;
+   STRINGLIST *s;
+   int        i;
+
+   chain->lastUse = ++(split->clock);
+   if(chain->fp != NULL)
+      return(chain->fp);
+
+   if(split->nOpen >= MAXOPEN)
+   {
+      for(i=0; i<split->nChains; i++)
+      {
+         if((split->chains[i].fp != NULL) &&
+            ((lru == NULL) || (split->chains[i].lastUse < lru->lastUse)))
+            lru = &(split->chains[i]);
+      }
+      if(lru != NULL)
+      {
+         fclose(lru->fp);
+         lru->fp = NULL;
+         split->nOpen--;
+      }
+   }
+
+   if((chain->fp = fopen(chain->OutFile, chain->started ? "a" : "w"))
+      == NULL)
+   {
+      if(!gQuiet)
+         fprintf(stderr,"pdbsplitchains: Could not write output \
+file: %s\n", chain->OutFile);
+      return(NULL);
+   }
+   split->nOpen++;
+
+   if(!chain->started)
+   {
+      for(s=split->header; s!=NULL; NEXT(s))
+         fputs(s->string, chain->fp);
+      chain->started = TRUE;
+   }
+
+   return(chain->fp);
+}
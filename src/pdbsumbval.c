@@ -3,8 +3,8 @@
 
    \file       pdbsumbval.c
    
-   \version    V1.6
-   \date       05.03.15
+   \version    V1.10
+   \date       19.10.26
    \brief      Sum B-vals over each residue and replace with the
                summed or average value
    
@@ -55,6 +55,13 @@
 -  V1.4  06.11.14 Renamed from sumbval  By: ACRM
 -  V1.5  13.02.15 Added whole PDB support
 -  V1.6  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  V1.7  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.8  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.9  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.10 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -68,6 +75,10 @@
 #include "bioplib/macros.h"
 #include "bioplib/MathUtil.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -111,16 +122,18 @@ int main(int argc, char **argv)
    WHOLEPDB *wpdb;
    PDB      *pdb;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &average, &sidechain,
                    &quiet))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb = blReadWholePDB(in)) != NULL)
+         if((wpdb = btReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
             SumBVals(pdb, average, sidechain, quiet);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -224,7 +237,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsumbval V1.6 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbsumbval V1.10 (c) 1994-2015, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbsumbval [-a] [-s] [-q] [in.pdb \
 [[out.pdb]\n");
@@ -3,8 +3,8 @@
 
    \file       pdbsymm.c
    
-   \version    V1.0
-   \date       06.02.17
+   \version    V1.3
+   \date       19.10.26
    \brief      Program to apply non-crystollographic symmetry operations
                from the REMARK 350 data in a PDB file
    
@@ -56,6 +56,12 @@
    Revision History:
    =================
 -  V1.0  06.02.17 Original
+-  V1.1  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.2  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.3  19.10.26 The position in the symmetry operators is kept at file
+                  scope and reset on entry so it can run more than once
+                  in a bioptools pipeline
 
 *************************************************************************/
 /* Includes
@@ -72,6 +78,8 @@
 #include "bioplib/macros.h"
 #include "bioplib/fsscanf.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/timing.h"
 
 #define MAXCHAINS 62
 
@@ -82,6 +90,10 @@
 /************************************************************************/
 /* Globals
 */
+static STRINGLIST *sSymOp  = NULL;
+static BOOL       sCalled  = FALSE;
+static char       sChains[MAXCHAINS][8];
+static int        sNChains = 0;
 
 /************************************************************************/
 /* Prototypes
@@ -107,6 +119,7 @@ char FindLastChainLabel(PDB *pdb);
    Main program for applying non-crystallographic symmertry operators
 
 -  09.02.17 Original    By: ACRM
+-  19.10.26 Resets the position in the symmetry operators   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -114,6 +127,15 @@ int main(int argc, char **argv)
             *out     = stdout;
    WHOLEPDB *wpdb;
 
+   btInitTiming(&argc, argv);
+
+   /* Reset the position as this may be run more than once in a 
+      pipeline
+   */
+   sSymOp   = NULL;
+   sCalled  = FALSE;
+   sNChains = 0;
+
    argc--;
    argv++;
 
@@ -167,7 +189,7 @@ int main(int argc, char **argv)
    }
    
    /* Read in the PDB file                                              */
-   if((wpdb = blReadWholePDB(in))==NULL)
+   if((wpdb = btReadWholePDB(in))==NULL)
    {
       fprintf(stderr,"pdbrotate: Unable to read from PDB file\n");
       return(1);
@@ -291,26 +313,23 @@ void WriteSymmetryCopies(FILE *out, WHOLEPDB *wpdb)
    %6s   %4d %3x%5s%1d%4d %10.6f    %10.6f    %10.6f    %5x  %10.6f
    records which specify the rotatation matrix and translation vector.
 
-   A static variable is used to keep track of where we are in the header
-   data. Successive calls will give the next set of operations. The 
+   File-scope variables are used to keep track of where we are in the
+   header data. Successive calls will give the next set of operations. The 
    routine returns the number of chains affected or zero when there are
    no more NC symmetry records.
  
 -  09.02.17  Original   By: ACRM
+-  19.10.26  The position is kept at file scope   By: agent
 */
 int ReadSymmetryData(WHOLEPDB *wpdb, REAL matrix[3][3], REAL trans[3], 
                      char chains[MAXCHAINS][8])
 {
-   static STRINGLIST *sSymOp = NULL;
-   static BOOL       called  = FALSE;
-   static char       sChains[MAXCHAINS][8];
-   static int        sNChains = 0;
-   int               i;
+   int i;
 
    /* First call - step to the start of the symmertry operators         */
-   if((sSymOp == NULL) && !called)
+   if((sSymOp == NULL) && !sCalled)
    {
-      called = TRUE;
+      sCalled = TRUE;
 
       sSymOp = wpdb->header;
    }
@@ -560,10 +579,11 @@ void ApplyMatrixAndWriteCopy(FILE *out, PDB *pdb, char oldChain[8],
    Prints a usage message
 
 -  09.02.17 Original    By: ACRM
+-  19.10.26 V1.3   By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsymm V1.0 (c) 2017 Andrew C.R. \
+   fprintf(stderr,"\npdbsymm V1.3 (c) 2017 Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbsymm [in.pdb [out.pdb]]\n");
 
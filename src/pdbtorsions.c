@@ -3,8 +3,8 @@
 
    \file       pdbtorsions.c
    
-   \version    V2.3
-   \date       13.03.19
+   \version    V2.6
+   \date       19.10.26
    \brief      Calculate torsion angles for a PDB file
    
    \copyright  (c) Dr. Andrew C. R. Martin 1996-2019
@@ -69,6 +69,11 @@
 -  V2.2  28.01.17 Updated size of label array
 -  V2.3  13.03.19 Made a local copy in MakeLabel() to avoid -Wrestrict
                   for GCC V8. Introduced MAXLABEL rather than 32
+-  V2.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V2.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V2.6  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -85,6 +90,9 @@
 #include "bioplib/seq.h"
 #include "bioplib/angle.h"
 #include "bioplib/macros.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -164,6 +172,8 @@ int main(int argc, char **argv)
    BOOL    Radians    = FALSE;
    BOOL    oldStyle   = FALSE;
 
+   btInitTiming(&argc, argv);
+
    /* Set the default output style based on whether the program is called
       pdbtorsions or torsions
    */
@@ -172,9 +182,9 @@ int main(int argc, char **argv)
    if(ParseCmdLine(argc, argv, inFile, outFile, 
                    &CATorsions, &terse, &Radians, &oldStyle))
    {
-      if(blOpenStdFiles(inFile, outFile, &in, &out))
+      if(btOpenStdFiles(inFile, outFile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natoms))!=NULL)
+         if((pdb=btReadPDB(in, &natoms))!=NULL)
          {
             if(!CalculateAndDisplayTorsions(out, pdb, CATorsions, terse, 
                                             Radians, oldStyle))
@@ -725,7 +735,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbtorsions V2.2 (c) 1994-2018 Andrew Martin, \
+   fprintf(stderr,"\npdbtorsions V2.6 (c) 1994-2018 Andrew Martin, \
 UCL.\n");
    fprintf(stderr,"\nUsage: pdbtorsions [-h][-r][-c][-t][-o][-n] \
 [in.pdb [out.tor]]\n");
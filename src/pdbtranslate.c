@@ -3,8 +3,8 @@
 
    \file       pdbtranslate.c
    
-   \version    V1.3
-   \date       12.02.15
+   \version    V1.8
+   \date       19.10.26
    \brief      Simple program to translate PDB files
    
    \copyright  (c) Dr. Andrew C. R. Martin 1995-2015
@@ -51,6 +51,15 @@
                   Added doxygen annotation. By: CTP
 -  V1.2  06.11.14 Renamed from transpdb  By: ACRM
 -  V1.3  12.02.15 Uses whole PDB
+-  V1.4  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.5  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.6  19.10.26 Writes with btWriteWholePDB() so the structure is
+                  passed on in memory in a bioptools pipeline
+-  V1.7  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.8  19.10.26 Added -s to translate the file as a stream in constant
+                  memory
 
 *************************************************************************/
 /* Includes
@@ -65,6 +74,11 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/pipeline.h"
+#include "common/timing.h"
+#include "common/pdbfilter.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -80,8 +94,9 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
+void SetTranslation(REAL matrix[3][4], VEC3F TVec);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  REAL *x, REAL *y, REAL *z);
+                  REAL *x, REAL *y, REAL *z, BOOL *stream);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -93,6 +108,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  17.06.94 Original    By: ACRM
 -  21.07.95 Added -m
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Added -s   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -103,19 +119,34 @@ int main(int argc, char **argv)
    VEC3F    TVec;
    char     infile[MAXBUFF],
             outfile[MAXBUFF];
+   REAL     matrix[3][4];
+   int      natoms;
+   BOOL     stream   = FALSE;
+
+   btInitTiming(&argc, argv);
 
    TVec.x = TVec.y = TVec.z = (REAL)0.0;
 
    if(ParseCmdLine(argc, argv, infile, outfile, 
-                   &(TVec.x), &(TVec.y), &(TVec.z)))
+                   &(TVec.x), &(TVec.y), &(TVec.z), &stream))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))!=NULL)
+         if(stream && btCanFilterPDB(in))
+         {
+            SetTranslation(matrix, TVec);
+            if(!btTransformPDB(in, out, matrix, &natoms))
+            {
+               fprintf(stderr,"Error: Failed while translating the PDB \
+file\n");
+               return(1);
+            }
+         }
+         else if((wpdb=btReadWholePDB(in))!=NULL)
          {
             pdb = wpdb->pdb;
             blTranslatePDB(pdb, TVec);
-            blWriteWholePDB(out, wpdb);
+            btWriteWholePDB(out, wpdb);
          }
          else
          {
@@ -133,6 +164,33 @@ int main(int argc, char **argv)
 }
 
    
+/************************************************************************/
+/*>void SetTranslation(REAL matrix[3][4], VEC3F TVec)
+   --------------------------------------------------
+*//**
+
+   \param[out]     matrix       Transformation for btTransformPDB()
+   \param[in]      TVec         Translation
+
+   Sets up a matrix that only translates
+
+-  19.10.26 Original    By: agent
+*/
+void SetTranslation(REAL matrix[3][4], VEC3F TVec)
+{
+   int i, j;
+
+   for(i=0; i<3; i++)
+   {
+      for(j=0; j<3; j++)
+         matrix[i][j] = (i==j) ? (REAL)1.0 : (REAL)0.0;
+   }
+   matrix[0][3] = TVec.x;
+   matrix[1][3] = TVec.y;
+   matrix[2][3] = TVec.z;
+}
+
+
 /************************************************************************/
 /*>void Usage(void)
    ----------------
@@ -145,19 +203,26 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbtranslate V1.3  (c) 1995-2015 Andrew C.R. \
+   fprintf(stderr,"\npdbtranslate V1.8  (c) 1995-2015 Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Freely distributable if no profit is made\n\n");
-   fprintf(stderr,"Usage: pdbtranslate [-x x] [-y y] [-z z] [-h]\n");
+   fprintf(stderr,"Usage: pdbtranslate [-x x] [-y y] [-z z] [-s] [-h]\n");
    fprintf(stderr,"              [input.pdb [output.pdb]]\n");
+   fprintf(stderr,"       -s Stream the file, rewriting only the \
+coordinates\n");
    fprintf(stderr,"I/O is to stdin/stdout if not specified\n\n");
    fprintf(stderr,"Translates a PDB file\n\n");
+   fprintf(stderr,"With -s, memory use does not depend on the size of \
+the file. All models\n");
+   fprintf(stderr,"are translated, other records are copied verbatim \
+and binary PDB or\n");
+   fprintf(stderr,"PDBML input is read as normal.\n\n");
 }
 
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                     REAL *x, REAL *y, REAL *z)
+                     REAL *x, REAL *y, REAL *z, BOOL *stream)
    ---------------------------------------------------------------------
 *//**
 
@@ -168,14 +233,16 @@ Martin\n");
    \param[out]     *x           X-translation
    \param[out]     *y           Y-translation
    \param[out]     *z           Z-translation
+   \param[out]     *stream      Transform the file as a stream
    \return                     Success?
 
    Parse the command line
    
 -  05.07.94 Original    By: ACRM
+-  19.10.26 Added -s   By: agent
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  REAL *x, REAL *y, REAL *z)
+                  REAL *x, REAL *y, REAL *z, BOOL *stream)
 {
    REAL temp;
    
@@ -211,6 +278,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                return(FALSE);
             *z += temp;
             break;
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -3,8 +3,8 @@
    Program:    rangecontacts
    File:       rangecontacts.c
    
-   Version:    V1.3
-   Date:       28.10.15
+   Version:    V1.5
+   Date:       19.10.26
    Function:   Finds residues contacting a specified range of residues
    
    Copyright:  (c) Prof. Andrew C. R. Martin 2020
@@ -46,11 +46,22 @@
    Revision History:
    =================
    V1.0  26.03.20 Original
+   V1.1  19.10.26 The atoms of the range are placed in a spatial grid
+                  and the sidechain test is precomputed as a bitmask
+                  By: agent
+   V1.2  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c
+   V1.3  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+   V1.4  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+   V1.5  19.10.26 Exits with status 1 if the range is not found or
+                  memory runs out
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
@@ -59,6 +70,10 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/spatial.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -66,6 +81,9 @@
 #define MAXBUFF 160
 #define DEF_RAD 3.0
 
+#define SETBIT(mask, i)  ((mask)[(i)>>3] |= (1 << ((i)&7)))
+#define TESTBIT(mask, i) ((mask)[(i)>>3] &  (1 << ((i)&7)))
+
 /************************************************************************/
 /* Globals
 */
@@ -77,12 +95,13 @@ int main(int argc, char **argv);
 void Usage(void);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   REAL *radsq, char *startres, char *stopres);
-void DoAnalysis(FILE *out, PDB *pdb, REAL RadSq, char *startres,
+BOOL DoAnalysis(FILE *out, PDB *pdb, REAL RadSq, char *startres,
                 char *stopres);
-BOOL MakesContact(PDB *res, PDB *nextRes, PDB *pStart, PDB *pStop,
-                  REAL RadSq);
+BOOL MakesContact(PDB *res, PDB *nextRes, int firstAtom, 
+                  unsigned char *scMask, SPATIALGRID *grid, REAL RadSq);
 void PrintContact(FILE *out, PDB *p);
 BOOL IsSidechain(PDB *p);
+unsigned char *BuildSidechainMask(PDB *pdb);
 
 
 /************************************************************************/
@@ -104,14 +123,17 @@ int main(int argc, char **argv)
         *out       = stdout;
    REAL radsq      = DEF_RAD * DEF_RAD;
    
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &radsq,
                    startres, stopres))
    {
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDBAtoms(in, &natom))!=NULL)
+         if((pdb = btReadPDBAtoms(in, &natom))!=NULL)
          {
-            DoAnalysis(out, pdb, radsq, startres, stopres);
+            if(!DoAnalysis(out, pdb, radsq, startres, stopres))
+               return(1);
          }
          else
          {
@@ -136,10 +158,12 @@ int main(int argc, char **argv)
    17.10.95 Original    By: ACRM
    04.03.15 V1.2
    28.10.15 V1.3
+   19.10.26 V1.4   By: agent
+   19.10.26 V1.5
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nRangeContacts V1.0 (c) 2020, Andrew C.R. \
+   fprintf(stderr,"\nRangeContacts V1.5 (c) 2020-2026, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: rangecontacts [-r radius] startres stopres \
 [in.pdb [out.dat]]\n");
@@ -228,7 +252,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 }
 
 /************************************************************************/
-/*>void DoAnalysis(FILE *out, PDB *pdb, REAL RadSq, char *startres,
+/*>BOOL DoAnalysis(FILE *out, PDB *pdb, REAL RadSq, char *startres,
                    char *stopres)
    ----------------------------------------------------------------
    Input:   FILE    *out       Output file pointer
@@ -236,68 +260,165 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
             REAL    RadSq      Squared radius for contact
             char    *startres  Start residue for range
             char    *stopres   Stop residue for range
+   Returns: BOOL               Success (FALSE if a residue of the range
+                               is not found or no memory)
 
    Main routine to do the contacts analysis between the range and the 
-   rest of the protein
+   rest of the protein. The atoms of the range are placed in a spatial
+   grid once and the sidechain atoms of the whole structure are
+   flagged in a bitmask so that each residue simply queries the grid
+   with its sidechain atoms.
 
    26.03.20 Original (based on code from rangecontacts.c)   By: ACRM
+   19.10.26 Builds the spatial grid and sidechain mask   By: agent
+   19.10.26 Returns BOOL
 */   
-void DoAnalysis(FILE *out, PDB *pdb, REAL RadSq, char *startres,
+BOOL DoAnalysis(FILE *out, PDB *pdb, REAL RadSq, char *startres,
                 char *stopres)
 {
-   PDB  *p,
-      *pStart, *pStop,
-      *nextRes;
-   
-
-
-
-
-
+   PDB           *p,
+                 *q,
+                 *pStart, *pStop,
+                 *nextRes,
+                 **rangeAtoms = NULL;
+   SPATIALGRID   *grid        = NULL;
+   unsigned char *scMask      = NULL;
+   int           nRange       = 0,
+                 atom         = 0;
+   BOOL          ok           = TRUE;
 
    /* Find the first residue of the range                               */
-   pStart = blFindResidueSpec(pdb, startres);
+   if((pStart = blFindResidueSpec(pdb, startres))==NULL)
+   {
+      fprintf(stderr,"Error: Residue %s not found\n", startres);
+      return(FALSE);
+   }
    /* and the one after the last residue                                */
-   pStop  = blFindResidueSpec(pdb, stopres);
+   if((pStop  = blFindResidueSpec(pdb, stopres))==NULL)
+   {
+      fprintf(stderr,"Error: Residue %s not found\n", stopres);
+      return(FALSE);
+   }
    pStop  = blFindNextResidue(pStop);
-   
-   /* Run through the linked list a residue at a time                   */
-   for(p=pdb; p!=NULL; p = nextRes)
+
+   /* Index the atoms of the range                                      */
+   for(q=pStart; q!=pStop; NEXT(q))
+      nRange++;
+   if((rangeAtoms = (PDB **)malloc((nRange+1) * sizeof(PDB *)))==NULL)
    {
-      nextRes = blFindNextResidue(p);
+      fprintf(stderr,"Error: No memory for range atoms\n");
+      return(FALSE);
+   }
+   for(q=pStart, nRange=0; q!=pStop; NEXT(q))
+      rangeAtoms[nRange++] = q;
 
-      if(!blInPDBZoneSpec(p, startres, stopres))
+   if(((grid = btBuildSpatialGrid(rangeAtoms, nRange, sqrt(RadSq)))
+       ==NULL) ||
+      ((scMask = BuildSidechainMask(pdb))==NULL))
+   {
+      fprintf(stderr,"Error: No memory for spatial index\n");
+      ok = FALSE;
+   }
+   else
+   {
+      /* Run through the linked list a residue at a time                */
+      for(p=pdb; p!=NULL; p = nextRes)
       {
-         if(MakesContact(p, nextRes, pStart, pStop, RadSq))
+         int nAtoms = 0;
+
+         nextRes = blFindNextResidue(p);
+         for(q=p; q!=nextRes; NEXT(q))
+            nAtoms++;
+         
+         if(!blInPDBZoneSpec(p, startres, stopres))
          {
-            PrintContact(out, p);
+            if(MakesContact(p, nextRes, atom, scMask, grid, RadSq))
+            {
+               PrintContact(out, p);
+            }
          }
+         
+         atom += nAtoms;
       }
    }
+
+   btFreeSpatialGrid(grid);
+   FREE(scMask);
+   free(rangeAtoms);
+   return(ok);
 }
 
 /************************************************************************/
-BOOL MakesContact(PDB *res, PDB *nextRes, PDB *pStart, PDB *pStop,
-                  REAL RadSq)
+/*>BOOL MakesContact(PDB *res, PDB *nextRes, int firstAtom, 
+                     unsigned char *scMask, SPATIALGRID *grid, 
+                     REAL RadSq)
+   ---------------------------------------------------------------------
+   Input:   PDB           *res        Start of residue
+            PDB           *nextRes    Start of next residue
+            int           firstAtom   Index of res in the whole list
+            unsigned char *scMask     Sidechain bitmask for the whole
+                                      list
+            SPATIALGRID   *grid       Spatial grid of the range atoms
+            REAL          RadSq       Squared radius for contact
+   Returns: BOOL                      Does a sidechain atom contact
+                                      the range?
+
+   26.03.20 Original   By: ACRM
+   19.10.26 Uses the grid of range atoms and the sidechain bitmask
+            By: agent
+*/
+BOOL MakesContact(PDB *res, PDB *nextRes, int firstAtom, 
+                  unsigned char *scMask, SPATIALGRID *grid, REAL RadSq)
 {
-   PDB *p, *q;
+   PDB       *p;
+   GRIDQUERY query;
+   int       atom = firstAtom;
    
-   for(p=res; p!=nextRes; NEXT(p))
+   for(p=res; p!=nextRes; NEXT(p), atom++)
    {
-      if(IsSidechain(p))
+      if(TESTBIT(scMask, atom))
       {
-         for(q=pStart; q!=pStop; NEXT(q))
+         btStartGridQuery(&query, grid, p->x, p->y, p->z, RadSq);
+         if(btNextGridNeighbour(&query, NULL) >= 0)
          {
-            if(DISTSQ(p, q) <= RadSq)
-            {
-               return(TRUE);
-            }
+            return(TRUE);
          }
       }
-      
    }
    return(FALSE);
+}
+
+/************************************************************************/
+/*>unsigned char *BuildSidechainMask(PDB *pdb)
+   -------------------------------------------
+   Input:   PDB           *pdb     PDB linked list
+   Returns: unsigned char *        Bitmask with a bit set for each 
+                                   sidechain atom (NULL if no memory)
+
+   Applies IsSidechain() once to each atom in the list
+
+   19.10.26 Original   By: agent
+*/
+unsigned char *BuildSidechainMask(PDB *pdb)
+{
+   PDB           *p;
+   unsigned char *scMask;
+   int           natoms = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+
+   if((scMask = (unsigned char *)calloc((natoms+7)/8 + 1, 
+                                        sizeof(unsigned char)))==NULL)
+      return(NULL);
+
+   for(p=pdb, natoms=0; p!=NULL; NEXT(p), natoms++)
+   {
+      if(IsSidechain(p))
+         SETBIT(scMask, natoms);
+   }
    
+   return(scMask);
 }
 
 /************************************************************************/
@@ -3,8 +3,8 @@
    Program:    scorecons
    File:       scorecons.c
    
-   Version:    V1.6
-   Date:       11.10.19
+   Version:    V1.10
+   Date:       19.10.26
    Function:   Scores conservation from a PIR sequence alignment
                Not to be confused with the program of the same name
                by Will Valdar (this one predates his!)
@@ -123,6 +123,13 @@
    V1.5  24.08.15 Implemented the Valdar01 scoring By: TCN
    V1.6  11.10.19 Fixed reading of a specified matrix - it was ignoring
                   -m before!
+   V1.7  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process   By: agent
+   V1.8  19.10.26 Reports timings if BIOPTOOLS_TIMING is set
+   V1.9  19.10.26 Resets the valdar01 weights so it can run more than
+                  once in a bioptools pipeline
+   V1.10 19.10.26 Also reports timings with -T as it is not one of the
+                  options
 
 *************************************************************************/
 /* Includes
@@ -137,6 +144,8 @@
 #include "bioplib/array.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 
 /************************************************************************/
@@ -219,6 +228,8 @@ REAL valdarMatrixScore(char res1, char res2, int MaxInMatrix);
    18.09.96 Added check on environment variable if ReadMDM() failed.
    15.07.08 Added -x/Extended handling
    11.10.19 Fixed code to actually read a different matrix if specified!
+   19.10.26 Resets the valdar01 weights   By: agent
+   19.10.26 Accepts -T for timings
 */
 int main(int argc, char **argv)
 {
@@ -231,12 +242,19 @@ int main(int argc, char **argv)
         Method = METH_MDM;
    BOOL Extended = FALSE;
 
+   btInitTiming(&argc, argv);
+
+   /* Reset the valdar01 weights from any previous run in a pipeline    */
+   FREE(sSeqWeights);
+   sSeqWeights = SEQWEIGHTS_UNITIALIZED;
+   sLambda     = LAMBDA_UNITIALIZED;
+
    strncpy(matrix, MUTMAT, MAXBUFF-1);
    
    if(ParseCmdLine(argc, argv, InFile, OutFile, matrix, &Method,
                    &Extended))
    {
-      if(blOpenStdFiles(InFile, OutFile, &in, &out))
+      if(btOpenStdFiles(InFile, OutFile, &in, &out))
       {
          if(!blReadMDM(matrix))
          {
@@ -1032,10 +1050,11 @@ REAL valdarMatrixScore(char res1, char res2, int MaxInMatrix)
    11.08.15 V1.4
    24.08.15 V1.5 (added -d Valdar method)
    11.10.19 V1.6 Fixed reading of matrix with -m
+   19.10.26 V1.10   By: agent
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nScoreCons V1.6 (c) 1996-2019 Prof. Andrew C.R. \
+   fprintf(stderr,"\nScoreCons V1.10 (c) 1996-2019 Prof. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"          valdar01 scoring implemented by Tom \
 Northey\n");
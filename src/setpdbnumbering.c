@@ -3,8 +3,8 @@
 
    \file       setpdbnumbering.c
    
-   \version    V1.7
-   \date       13.03.19
+   \version    V1.11
+   \date       19.10.26
    \brief      Apply standard numbering to a set of PDB files
    
    \copyright  (c) Dr. Andrew C. R. Martin 1996-2019
@@ -63,10 +63,19 @@
 -  V1.5  12.03.15 Changed to allow multi-character chain names
 -  V1.6  28.01.18 Increased label buffer sizes
 -  V1.7  13.03.19 Increase buffer sizes
+-  V1.8  19.10.26 Reads the PDB file with the shared memory-mapped
+                  reader in common/pdbread.c   By: agent
+-  V1.9  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process
+-  V1.10 19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
+-  V1.11 19.10.26 Makes the patch file with mkstemp() rather than from
+                  the PID so it can run more than once in a bioptools
+                  pipeline
 
 *************************************************************************/
 /* Includes
 */
+#define _POSIX_C_SOURCE 200809L   /* mkstemp()                            */
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -80,6 +89,9 @@
 #include "bioplib/seq.h"
 #include "bioplib/macros.h"
 #include "bioplib/array.h"
+#include "common/pdbread.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -123,6 +135,7 @@ void BumpLabel(char *label);
 
 -  05.02.96 Original    By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  19.10.26 Patch file name is made in ApplyNumbering()   By: agent
 */
 int main(int argc, char **argv)
 {
@@ -132,15 +145,12 @@ int main(int argc, char **argv)
            **Numbering;
    NAMSEQ  *namseq;
    int     nres;
-   pid_t   pid;
 
-   /* Save a unique name for temp files                                 */
-   pid = getpid();
-   sprintf(gPatchFile,"/tmp/Patch.in.%d",pid);
+   btInitTiming(&argc, argv);
 
    if(ParseCmdLine(argc, argv, AlnFile))
    {
-      if(blOpenStdFiles(AlnFile, NULL, &in, &out))
+      if(btOpenStdFiles(AlnFile, NULL, &in, &out))
       {
          if((namseq = ReadSequenceData(in, &nres))!=NULL)
          {
@@ -185,7 +195,7 @@ int main(int argc, char **argv)
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nsetpdbnumbering V1.7 (c) 1996-2019 Dr. Andrew C.R. \
+   fprintf(stderr,"\nsetpdbnumbering V1.11 (c) 1996-2019 Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: setpdbnumbering alnfile\n");
@@ -409,7 +419,7 @@ BOOL GetNumbering(NAMSEQ *namseq, char **numbering)
    }
 
    /* Read the PDB file                                                 */
-   if((pdb=blReadPDB(fp, &natoms))!=NULL)
+   if((pdb=btReadPDB(fp, &natoms))!=NULL)
    {
       nres = strlen(namseq->seq);
       p    = pdb;
@@ -515,21 +525,35 @@ the alphabet\n");
 -  05.02.96 Original    By: ACRM
 -  28.01.18 Increased buffer size to *3
 -  13.03.19 Increased buffer size to *4
+-  19.10.26 Makes the patch file here with mkstemp()   By: agent
 */
 BOOL ApplyNumbering(NAMSEQ *namseq, char **Numbering)
 {
    NAMSEQ *ns;
    FILE   *fp;
-   int    i;
+   int    i,
+          fd;
    char   buffer[MAXBUFF*4];
    
+   /* Make a unique patch file. mkstemp() rather than the PID so that
+      this can run more than once in a bioptools pipeline
+   */
+   strcpy(gPatchFile, "/tmp/Patch.in.XXXXXX");
+   if((fd = mkstemp(gPatchFile)) == (-1))
+   {
+      fprintf(stderr,"Unable to create temp file (%s).\n", gPatchFile);
+      return(FALSE);
+   }
+   close(fd);
+
    for(ns=namseq; ns!=NULL; NEXT(ns))
    {
-      /* Open a patch file with a unique id                             */
+      /* Open the patch file                                            */
       if((fp=fopen(gPatchFile,"w"))==NULL)
       {
          fprintf(stderr,"Unable to open temp file (%s) for writing.\n",
                  gPatchFile);
+         unlink(gPatchFile);
          return(FALSE);
       }
 
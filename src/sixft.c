@@ -4,8 +4,8 @@
    Program:    sixft
    \file       sexft.c
    
-   \version    V1.0
-   \date       10.11.17   
+   \version    V1.2
+   \date       19.10.26
    \brief      Six-frame translation
    
    \copyright  (c) UCL / Dr. Andrew C. R. Martin 2017
@@ -46,6 +46,10 @@
 
    Revision History:
    =================
+-  V1.0  10.11.17 Original
+-  V1.1  19.10.26 Opens files with btOpenStdFiles() so compressed input
+                  and output are handled in-process   By: agent
+-  V1.2  19.10.26 Reports timings with -T or if BIOPTOOLS_TIMING is set
 
 *************************************************************************/
 /* Includes
@@ -54,6 +58,8 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/sequtil.h"
+#include "common/stdfiles.h"
+#include "common/timing.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -90,12 +96,14 @@ int main(int argc, char **argv)
    FILE *in     = stdin,
         *out    = stdout;
 
+   btInitTiming(&argc, argv);
+
    if(ParseCmdLine(argc, argv, infile, outfile, &showDNA, &showRF))
    {
       if(showDNA && showRF)
          showDNA = FALSE;
 
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(btOpenStdFiles(infile, outfile, &in, &out))
       {
          if(!DoTranslate(in, out, showDNA, showRF))
          {
@@ -260,7 +268,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nsixft V1.0 (c) 2017, UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\nsixft V1.2 (c) 2017, UCL, Dr. Andrew C.R. \
 Martin\n");
    fprintf(stderr,"\nUsage: sixft [-d|-r] [dna.faa [protein.faa]]\n");
    fprintf(stderr,"       -d Output the original DNA as well\n");
@@ -0,0 +1,151 @@
+#!/bin/sh
+#*************************************************************************
+#
+#   Program:    regress
+#   File:       regress.sh
+#
+#   Version:    V1.2
+#   Date:       19.10.26
+#   Function:   Compare the output of the programs with a baseline
+#               version of BiopTools
+#
+#   Copyright:  (c) UCL 2026
+#   Author:     agent
+#   EMail:      agent@local
+#
+#*************************************************************************
+#
+#   This program is not in the public domain, but it may be copied
+#   according to the conditions laid out in the accompanying LICENCE file
+#
+#*************************************************************************
+#
+#   Description:
+#   ============
+#   Builds the baseline version of the programs (by default the last
+#   commit before the shared code in common/ was introduced) and the
+#   version in this source tree, each in a scratch directory, against
+#   the installed BiopLib. Each test case in the file 'cases' is then
+#   run with both versions and the standard output compared.
+#
+#   Each line of 'cases' is
+#      name : command
+#   or
+#      name : baseline command ::: new command
+#   Blank lines and lines starting with # are ignored. A command is run
+#   with sh in an empty directory with the programs of the version
+#   being tested first in the PATH and $T set to the src/test
+#   directory (DATADIR is set to the data directory of this tree).
+#   The second form is used when a new option should give
+#   the same output as the baseline's default behaviour.
+#   The benchmark programs in bench/ are also in the PATH, for cases
+#   that generate their input with pdbgen.
+#
+#*************************************************************************
+#
+#   Usage:
+#   ======
+#   ./regress.sh [-r ref] [-k] [makemake options]
+#   -r ref  - git reference for the baseline (default e53697e)
+#   -k      - Keep the scratch directory
+#   The makemake options (e.g. -libdir=xxx -incdir=xxx) are passed to
+#   makemake.pl for both builds.
+#
+#   Exits with the number of failed cases.
+#
+#*************************************************************************
+#
+#   Revision History:
+#   =================
+#   V1.0    19.10.26  Original   By: agent
+#   V1.1    19.10.26  Reads the cases with read -r so backslashes in
+#                     commands are kept (printf rather than echo)
+#   V1.2    19.10.26  Builds the programs named in the cases from bench/
+#
+#*************************************************************************
+BASELINE=e53697e
+KEEP=0
+
+while [ $# -gt 0 ]
+do
+    case "$1" in
+    -r) BASELINE=$2; shift 2 ;;
+    -k) KEEP=1; shift ;;
+    *)  break ;;
+    esac
+done
+
+HERE=`cd \`dirname $0\`; pwd`
+TESTDIR=`cd $HERE/..; pwd`
+SRCDIR=`cd $TESTDIR/..; pwd`
+CASES=$HERE/cases
+WORK=`mktemp -d ${TMPDIR:-/tmp}/regress.XXXXXX`
+
+# The programs named in the cases that exist in both trees
+PROGS=`grep -v '^#' $CASES | cut -d: -f2- | tr ' |;&()' '\n\n\n\n\n\n' | \
+       sort -u | while read word
+       do
+          if [ -f $SRCDIR/$word.c ] || [ -f $SRCDIR/multi/$word.c ]
+          then
+             echo $word
+          elif [ -f $SRCDIR/bench/$word.c ]
+          then
+             echo bench/$word
+          fi
+       done`
+
+echo "Building baseline ($BASELINE)"
+mkdir -p $WORK/base
+(cd $SRCDIR/.. && git archive $BASELINE src) | (cd $WORK/base && tar xf -)
+(cd $WORK/base/src && ./makemake.pl "$@" && \
+     make -k $PROGS) > $WORK/base.log 2>&1
+
+echo "Building current tree"
+mkdir -p $WORK/new
+cp -R $SRCDIR $WORK/new/src
+(cd $WORK/new/src && ./makemake.pl "$@" && make clean && \
+     make -k $PROGS) > $WORK/new.log 2>&1
+
+NPASS=0
+NFAIL=0
+grep -v '^#' $CASES | grep -v '^ *$' > $WORK/cases
+while read -r line
+do
+    name=`printf "%s\n" "$line" | sed 's/ *:.*//'`
+    basecmd=`printf "%s\n" "$line" | sed 's/^[^:]*: *//; s/ *:::.*//'`
+    newcmd=`printf "%s\n" "$line" | sed 's/^[^:]*: *//; s/.*::: *//'`
+
+    for version in base new
+    do
+        if [ $version = base ]; then cmd=$basecmd; else cmd=$newcmd; fi
+        rm -rf $WORK/run
+        mkdir $WORK/run
+        (cd $WORK/run && T=$TESTDIR DATADIR=$SRCDIR/../data \
+            PATH=$WORK/$version/src:$WORK/$version/src/bench:$PATH \
+            sh -c "$cmd" > $WORK/$version.out 2> $WORK/$version.err \
+            < /dev/null)
+    done
+
+    if cmp -s $WORK/base.out $WORK/new.out && [ -s $WORK/base.out ]
+    then
+        NPASS=`expr $NPASS + 1`
+        echo "PASS: $name"
+    else
+        NFAIL=`expr $NFAIL + 1`
+        echo "FAIL: $name"
+        diff $WORK/base.out $WORK/new.out | head -10
+        if [ ! -s $WORK/base.out ]; then
+            echo "   (no output from the baseline)"
+            head -5 $WORK/base.err
+        fi
+    fi
+done < $WORK/cases
+
+echo " "
+echo "$NPASS passed, $NFAIL failed"
+if [ $KEEP -eq 1 ]; then
+    echo "Scratch directory: $WORK"
+else
+    rm -rf $WORK
+fi
+exit $NFAIL